@@ -0,0 +1,188 @@
+// Coroutine sleep benchmark: 100k sleepers that go straight back to sleep when they
+// wake (like entity AI loops), over simulated 60hz frames, in the scheduler's timing
+// wheel against the binary heap it replaced. Short, mixed and long sleep durations,
+// plus insert and cancel on their own, then 100k real coroutines sleeping through
+// AsyncContext.
+
+#include <bench.h>
+#include <containers/timing_wheel.h>
+#include <engine/contexts/async/async.h>
+#include <functional>
+#include <queue>
+
+using namespace v;
+
+namespace {
+    constexpr u32 k_sleepers = 100'000;
+    constexpr u64 k_frame_ns = 16'666'667;
+    constexpr u64 k_ms       = 1'000'000;
+
+    /// The scheduler's old sleep queue
+    class HeapSleeper {
+    public:
+        void schedule(u64 wake_time_ns, u32 id) { heap_.push({ wake_time_ns, id }); }
+
+        template <typename F>
+        void advance(u64 now_ns, F&& fn)
+        {
+            while (!heap_.empty() && heap_.top().wake_time_ns <= now_ns)
+            {
+                const u32 id = heap_.top().id;
+                heap_.pop();
+                fn(id);
+            }
+        }
+
+        usize size() const { return heap_.size(); }
+
+    private:
+        struct Entry {
+            u64 wake_time_ns;
+            u32 id;
+
+            bool operator>(const Entry& other) const
+            {
+                return wake_time_ns > other.wake_time_ns;
+            }
+        };
+
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<>> heap_;
+    };
+
+    struct Wheel : TimingWheel<u32> {
+        Wheel() : TimingWheel(CoroutineScheduler::k_sleep_resolution_ns) {}
+    };
+
+    struct Range {
+        const char* name;
+        u64         min_ms;
+        u64         max_ms;
+        u32         frames;
+    };
+
+    /// Every sleeper goes back to sleep for a random duration in range when woken
+    template <typename Q>
+    void run_loop(bench::BenchContext& bctx, const char* queue, const Range& range)
+    {
+        rand::seed(99);
+        Q   q;
+        u64 now = 0;
+        for (u32 i = 0; i < k_sleepers; ++i)
+            q.schedule(rand::urange(range.min_ms, range.max_ms) * k_ms, i);
+
+        u64       wakes = 0;
+        const f64 secs  = bench::time_secs(
+            [&]
+            {
+                for (u32 f = 0; f < range.frames; ++f)
+                {
+                    now += k_frame_ns;
+                    q.advance(
+                        now,
+                        [&](u32 id)
+                        {
+                            wakes++;
+                            const u64 ms = rand::urange(range.min_ms, range.max_ms);
+                            q.schedule(now + ms * k_ms, id);
+                        });
+                }
+            });
+
+        const std::string prefix = std::format("{} {}", queue, range.name);
+        bctx.report(prefix + " frame", secs / range.frames * 1e6, "us");
+        bctx.report(prefix + " wake", secs / std::max<f64>(wakes, 1) * 1e9, "ns");
+        bctx.report(prefix + " wakes/frame", static_cast<f64>(wakes) / range.frames);
+    }
+
+    template <typename Q>
+    void run_insert(bench::BenchContext& bctx, const char* queue)
+    {
+        rand::seed(100);
+        std::vector<u64> deadlines(k_sleepers);
+        for (u64& d : deadlines)
+            d = rand::urange(1, 60'000) * k_ms;
+
+        Q         q;
+        const f64 secs = bench::time_secs(
+            [&]
+            {
+                for (u32 i = 0; i < k_sleepers; ++i)
+                    q.schedule(deadlines[i], i);
+            });
+        bctx.report(std::format("{} insert", queue), secs / k_sleepers * 1e9, "ns");
+    }
+} // namespace
+
+int main()
+{
+    auto [engine, bctx] = bench::init_bench("coro_sleep");
+
+    const Range ranges[] = {
+        { "short 1-16ms", 1, 16, 600 },
+        { "mixed 1ms-10s", 1, 10'000, 1200 },
+        { "long 1-600s", 1'000, 600'000, 1200 },
+    };
+    for (const Range& range : ranges)
+    {
+        run_loop<HeapSleeper>(bctx, "heap", range);
+        run_loop<Wheel>(bctx, "wheel", range);
+    }
+
+    run_insert<HeapSleeper>(bctx, "heap");
+    run_insert<Wheel>(bctx, "wheel");
+
+    // a heap can't take entries out, the wheel unlinks them
+    {
+        Wheel                  wheel;
+        std::vector<Wheel::Id> ids(k_sleepers);
+        for (u32 i = 0; i < k_sleepers; ++i)
+            ids[i] = wheel.schedule(rand::urange(1, 60'000) * k_ms, i);
+        const f64 secs = bench::time_secs(
+            [&]
+            {
+                for (const Wheel::Id id : ids)
+                    wheel.cancel(id);
+            });
+        bctx.report("wheel cancel", secs / k_sleepers * 1e9, "ns");
+    }
+
+    // real coroutines, woken through the scheduler for a second
+    {
+        auto* async = engine->add_ctx<AsyncContext>(1);
+        bool  stop  = false;
+        u64   wakes = 0;
+        for (u32 i = 0; i < k_sleepers; ++i)
+        {
+            const u64 ms = rand::urange(1, 100);
+            async->spawn(
+                [&, ms](CoroutineInterface& ci) -> Coroutine<void>
+                {
+                    while (!stop && co_await ci.sleep(ms))
+                        wakes++;
+                });
+        }
+
+        u64       ticks = 0;
+        Stopwatch sw{};
+        const f64 secs = bench::time_secs(
+            [&]
+            {
+                while (sw.elapsed() < 1.0)
+                {
+                    async->update();
+                    ticks++;
+                }
+            });
+        bctx.report("coroutines update", secs / ticks * 1e6, "us");
+        bctx.report("coroutines wake", secs / std::max<f64>(wakes, 1) * 1e9, "ns");
+        bctx.report("coroutines wakes/sec", wakes / secs);
+
+        // let them all finish
+        stop = true;
+        while (async->scheduler().sleeping() > 0)
+            async->update();
+        async->update();
+    }
+
+    return 0;
+}
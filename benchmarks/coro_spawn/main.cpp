@@ -0,0 +1,161 @@
+// Coroutine spawn benchmark: 1M short coroutines spawned and finished through
+// AsyncContext, ones that return right away (handle dropped or kept until after they
+// finish) and ones that sleep a tick first, with heap allocations per coroutine.
+// Against the bookkeeping spawn used to do per coroutine (shared_ptrs for the state,
+// lambda and interface, a heap frame, and entries in two hash containers).
+
+#include <atomic>
+#include <bench.h>
+#include <containers/ud_map.h>
+#include <containers/ud_set.h>
+#include <cstdlib>
+#include <engine/contexts/async/async.h>
+#include <mem/frame_pool.h>
+#include <new>
+
+using namespace v;
+
+namespace {
+    std::atomic<u64> g_allocs{ 0 };
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+    constexpr u32 k_coroutines = 1'000'000;
+    constexpr u32 k_sleepers   = 100'000;
+
+    void report(
+        bench::BenchContext& bctx, const char* name, f64 secs, u64 allocs, u32 count)
+    {
+        bctx.report(std::format("{} per coroutine", name), secs / count * 1e9, "ns");
+        bctx.report(
+            std::format("{} allocs/coroutine", name), static_cast<f64>(allocs) / count);
+    }
+
+    /// Frame sized like a small spawned coroutine's
+    struct FakeFrame {
+        u8 bytes[192];
+    };
+} // namespace
+
+int main()
+{
+    auto [engine, bctx] = bench::init_bench("coro_spawn");
+    auto* async         = engine->add_ctx<AsyncContext>(1);
+
+    u64        sum    = 0;
+    const auto finish = [&](u32 i)
+    {
+        return async->spawn(
+            [&sum, i](CoroutineInterface&) -> Coroutine<void>
+            {
+                sum += i;
+                co_return;
+            });
+    };
+
+    // warm the pool up
+    finish(0);
+
+    // finished before spawn returns, handle dropped right away
+    {
+        const u64 before = g_allocs.load();
+        const f64 secs   = bench::time_secs(
+            [&]
+            {
+                for (u32 i = 0; i < k_coroutines; ++i)
+                    finish(i);
+            });
+        report(bctx, "finish", secs, g_allocs.load() - before, k_coroutines);
+    }
+
+    // handles kept past finishing, so every frame is out of the pool at once
+    {
+        std::vector<Coroutine<void>> kept;
+        kept.reserve(k_coroutines);
+
+        const u64 before = g_allocs.load();
+        const f64 secs   = bench::time_secs(
+            [&]
+            {
+                for (u32 i = 0; i < k_coroutines; ++i)
+                    kept.push_back(finish(i));
+                kept.clear();
+            });
+        report(bctx, "kept", secs, g_allocs.load() - before, k_coroutines);
+        bctx.report("pool cached frames", mem::FramePool::local().cached());
+
+        // same again with the pool holding all of them
+        kept.reserve(k_coroutines);
+        const u64 warm_before = g_allocs.load();
+        const f64 warm_secs   = bench::time_secs(
+            [&]
+            {
+                for (u32 i = 0; i < k_coroutines; ++i)
+                    kept.push_back(finish(i));
+                kept.clear();
+            });
+        report(bctx, "kept warm", warm_secs, g_allocs.load() - warm_before, k_coroutines);
+    }
+
+    // suspended once, finished by the scheduler on a later tick
+    {
+        const u64 before = g_allocs.load();
+        const f64 secs   = bench::time_secs(
+            [&]
+            {
+                for (u32 i = 0; i < k_sleepers; ++i)
+                {
+                    async->spawn(
+                        [](CoroutineInterface& ci) -> Coroutine<void>
+                        { co_await ci.sleep(1); });
+                }
+                while (async->scheduler().alive() > 0)
+                    async->update();
+            });
+        report(bctx, "sleep once", secs, g_allocs.load() - before, k_sleepers);
+    }
+
+    // what spawn used to do around every coroutine
+    {
+        ud_set<void*>                        handles;
+        ud_map<void*, std::shared_ptr<void>> heap_state;
+
+        const u64 before = g_allocs.load();
+        const f64 secs   = bench::time_secs(
+            [&]
+            {
+                for (u32 i = 0; i < k_coroutines; ++i)
+                {
+                    auto lambda = std::make_shared<u64*>(&sum);
+                    auto iface  = std::make_shared<CoroutineInterface>(
+                        async->scheduler(), *engine);
+                    auto state = std::make_shared<std::pair<bool, u64>>();
+                    auto* frame = new FakeFrame;
+
+                    handles.insert(frame);
+                    heap_state[frame] = state;
+                    **lambda += i + iface.use_count();
+
+                    delete frame;
+                    handles.erase(frame);
+                    heap_state.erase(frame);
+                }
+            });
+        report(bctx, "old bookkeeping", secs, g_allocs.load() - before, k_coroutines);
+    }
+
+    LOG_INFO("checksum {}", sum);
+    return 0;
+}
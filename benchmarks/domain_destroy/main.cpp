@@ -0,0 +1,95 @@
+// Domain destroy benchmark: the tick that removes 5k loaded chunks at once, destroying
+// them one post_tick lambda at a time vs the batched destroy with background release
+
+#include <bench.h>
+#include <world/world.h>
+
+using namespace v;
+
+namespace {
+    constexpr i32 k_chunks           = 5000;
+    constexpr i32 k_voxels_per_chunk = 128;
+    constexpr i32 k_rounds           = 3;
+
+    FORCEINLINE i32 random_coord()
+    {
+        return static_cast<i32>(rand::irange(0, ChunkDomain::k_size - 1));
+    }
+
+    // scattered voxels, so every chunk holds a few hundred octree nodes
+    void fill_chunk(ChunkDomain& chunk)
+    {
+        for (i32 i = 0; i < k_voxels_per_chunk; ++i)
+        {
+            chunk.set(
+                { random_coord(), random_coord(), random_coord() },
+                static_cast<u16>(rand::irange(1, 8)));
+        }
+    }
+
+    FORCEINLINE ChunkPos chunk_pos(i32 i)
+    {
+        return { i % 71, i / (71 * 71), (i / 71) % 71 };
+    }
+} // namespace
+
+int main()
+{
+    auto [engine, bctx] = bench::init_bench("domain_destroy");
+    rand::seed(1234);
+
+    auto& world = engine->add_domain<WorldDomain>();
+    // eviction would get in the way of removing them ourselves
+    ChunkCacheConfig config{};
+    config.memory_budget = 0;
+    world.set_cache_config(config);
+
+    f64 per_entity_ms = 0;
+    f64 batched_ms    = 0;
+    f64 release_ms    = 0;
+    for (i32 round = 0; round < k_rounds; ++round)
+    {
+        // what remove_chunk used to do: one lambda and one registry destroy per chunk,
+        // the octrees freed right there on the main thread
+        {
+            std::vector<entt::entity> ids;
+            for (i32 i = 0; i < k_chunks; ++i)
+            {
+                auto& chunk = engine->add_domain<ChunkDomain>(chunk_pos(i));
+                fill_chunk(chunk);
+                ids.push_back(chunk.entity());
+            }
+            engine->tick();
+
+            for (auto id : ids)
+            {
+                engine->post_tick(
+                    [&engine, id]
+                    {
+                        if (engine->registry().valid(id))
+                            engine->registry().destroy(id);
+                    });
+            }
+            per_entity_ms += bench::time_secs([&] { engine->tick(); }) * 1e3;
+        }
+
+        {
+            for (i32 i = 0; i < k_chunks; ++i)
+                fill_chunk(world.get_or_create_chunk(chunk_pos(i)));
+            engine->tick();
+
+            for (i32 i = 0; i < k_chunks; ++i)
+                world.remove_chunk(chunk_pos(i));
+            batched_ms += bench::time_secs([&] { engine->tick(); }) * 1e3;
+            release_ms += bench::time_secs([&] { engine->wait_for_releases(); }) * 1e3;
+        }
+    }
+
+    bctx.report("chunks removed", k_chunks);
+    bctx.report("per entity destroy tick", per_entity_ms / k_rounds, "ms");
+    bctx.report("batched destroy tick", batched_ms / k_rounds, "ms");
+    bctx.report("background release left", release_ms / k_rounds, "ms");
+    bctx.report("speedup", per_entity_ms / batched_ms, "x");
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+// Domain view benchmark: iterating 50k chunk domains stored behind owned_ptrs vs
+// inline in the registry's pool
+
+#include <bench.h>
+#include <world/world.h>
+
+using namespace v;
+
+namespace {
+    constexpr i32 k_domains = 50'000;
+    constexpr i32 k_passes  = 200;
+
+    FORCEINLINE ChunkPos chunk_pos(i32 i)
+    {
+        return { i % 37, i / (37 * 37), (i / 37) % 37 };
+    }
+
+    // a few octree nodes per chunk, so the boxed domains end up spread between them
+    // the way they are after real chunk loads
+    template <typename Chunk>
+    void fill_chunk(Chunk& chunk)
+    {
+        for (i32 i = 0; i < 4; ++i)
+        {
+            chunk.set(
+                { static_cast<i32>(rand::irange(0, ChunkDomain::k_size - 1)),
+                  static_cast<i32>(rand::irange(0, ChunkDomain::k_size - 1)),
+                  static_cast<i32>(rand::irange(0, ChunkDomain::k_size - 1)) },
+                1);
+        }
+    }
+
+    // what a per tick system over chunks would read
+    FORCEINLINE u64 visit(const ChunkDomain& chunk)
+    {
+        const ChunkPos& cp = chunk.pos();
+        return chunk.version() + static_cast<u64>(cp.x + cp.y + cp.z) + chunk.dirty();
+    }
+} // namespace
+
+int main()
+{
+    auto [engine, bctx] = bench::init_bench("domain_view");
+    rand::seed(1234);
+
+    // before: ChunkDomain as a regular Domain<> would be stored, each one behind its
+    // own allocation
+    for (i32 i = 0; i < k_domains; ++i)
+    {
+        auto e = engine->registry().create();
+        fill_chunk(*engine->registry().emplace<mem::owned_ptr<ChunkDomain>>(
+            e, chunk_pos(i)));
+    }
+
+    // after: InlineDomain, straight in the pool
+    for (i32 i = 0; i < k_domains; ++i)
+        fill_chunk(engine->add_domain<ChunkDomain>(chunk_pos(i)));
+
+    u64       sink = 0;
+    const f64 boxed_secs = bench::time_secs(
+        [&]
+        {
+            auto view = engine->raw_view<mem::owned_ptr<ChunkDomain>>();
+            for (i32 pass = 0; pass < k_passes; ++pass)
+                for (auto [entity, chunk] : view.each())
+                    sink += visit(*chunk);
+        });
+    const f64 inline_secs = bench::time_secs(
+        [&]
+        {
+            auto view = engine->view<ChunkDomain>();
+            for (i32 pass = 0; pass < k_passes; ++pass)
+                for (auto [entity, chunk] : view.each())
+                    sink += visit(chunk);
+        });
+
+    const f64 visits = static_cast<f64>(k_domains) * k_passes;
+    bctx.report("domains", k_domains);
+    bctx.report("owned_ptr view", boxed_secs / visits * 1e9, "ns/domain");
+    bctx.report("inline view", inline_secs / visits * 1e9, "ns/domain");
+    bctx.report("speedup", boxed_secs / inline_secs, "x");
+    bctx.report("checksum", static_cast<f64>(sink % 1000));
+
+    return 0;
+}
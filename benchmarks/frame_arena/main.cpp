@@ -0,0 +1,232 @@
+// Frame arena benchmark: heap allocations per voxel edit, chunk creation, task
+// continuation and a representative server tick (edits into loaded chunks, a few new
+// chunks, worker tasks reporting back through then(), engine tick), plus the
+// set_voxel walk's temporaries on the heap against the frame arena
+
+#include <atomic>
+#include <bench.h>
+#include <cstdlib>
+#include <engine/contexts/async/async.h>
+#include <mem/frame_arena.h>
+#include <new>
+#include <vox/store/64tree.h>
+#include <world/world.h>
+
+using namespace v;
+
+namespace {
+    std::atomic<u64> g_allocs{ 0 };
+} // namespace
+
+// every allocation in the process, like the post_tick benchmark
+void* operator new(std::size_t size)
+{
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+    constexpr i32 k_edits         = 200'000;
+    constexpr i32 k_ticks         = 200;
+    constexpr i32 k_tick_edits    = 256;
+    constexpr i32 k_tick_chunks   = 2;
+    constexpr i32 k_tick_tasks    = 16;
+    constexpr u8  k_depth         = 4;
+    constexpr u32 k_tree_extent   = 1u << (2 * k_depth);
+    constexpr i32 k_walk_reps     = 1'000'000;
+    constexpr i32 k_loaded_chunks = 4;
+
+    /// Allocations made by fn
+    template <typename F>
+    u64 count_allocs(F&& fn)
+    {
+        const u64 before = g_allocs.load();
+        fn();
+        return g_allocs.load() - before;
+    }
+
+    WorldPos random_pos()
+    {
+        const i32 extent = WorldDomain::k_chunk_size * 2;
+        return { static_cast<i32>(rand::urange(0, extent - 1)),
+                 static_cast<i32>(rand::urange(0, extent - 1)),
+                 static_cast<i32>(rand::urange(0, WorldDomain::k_chunk_size - 1)) };
+    }
+
+    /// The walk down set_voxel does, path and index per level, into `Vec`s reserved up
+    /// front, so the heap version is already at its best case
+    template <typename Vec, typename... Args>
+    u64 walk(u32 reps, Args&&... args)
+    {
+        u64 sum = 0;
+        for (u32 i = 0; i < reps; ++i)
+        {
+            Vec path{ args... };
+            Vec indices{ args... };
+            path.reserve(k_depth + 2);
+            indices.reserve(k_depth + 2);
+            for (u8 level = 0; level < k_depth + 2; ++level)
+            {
+                path.push_back(i + level);
+                indices.push_back(level);
+            }
+            sum += path.back() + indices.back();
+        }
+        return sum;
+    }
+} // namespace
+
+int main()
+{
+    auto [engine, bctx] = bench::init_bench("frame_arena");
+    auto* async         = engine->add_ctx<AsyncContext>(2);
+    rand::seed(42);
+
+    // voxel edits into a tree that already has every node the edits touch
+    {
+        Sparse64Tree tree{ k_depth };
+        for (i32 i = 0; i < k_edits; ++i)
+            tree.set_voxel(
+                rand::urange(0, k_tree_extent - 1), rand::urange(0, k_tree_extent - 1),
+                rand::urange(0, k_tree_extent - 1), 1);
+
+        rand::seed(42);
+        const u64 allocs = count_allocs(
+            [&]
+            {
+                for (i32 i = 0; i < k_edits; ++i)
+                    tree.set_voxel(
+                        rand::urange(0, k_tree_extent - 1),
+                        rand::urange(0, k_tree_extent - 1),
+                        rand::urange(0, k_tree_extent - 1), 2);
+            });
+        bctx.report("set_voxel", static_cast<f64>(allocs) / k_edits, "allocs/edit");
+    }
+
+    // the same walk's temporaries on the heap (how set_voxel used to) and on the frame
+    // arena
+    {
+        u64       checksum    = 0;
+        u64       heap_allocs = 0;
+        const f64 heap_secs   = bench::time_secs(
+            [&]
+            {
+                heap_allocs = count_allocs(
+                    [&] { checksum += walk<std::vector<u64>>(k_walk_reps); });
+            });
+
+        mem::FrameArena& arena        = mem::FrameArena::local();
+        u64              arena_allocs = 0;
+        const f64        arena_secs   = bench::time_secs(
+            [&]
+            {
+                arena_allocs = count_allocs(
+                    [&]
+                    {
+                        for (i32 i = 0; i < k_walk_reps; i += 1000)
+                        {
+                            mem::FrameArena::Scope scope{ arena };
+                            checksum +=
+                                walk<std::pmr::vector<u64>>(1000, arena.resource());
+                        }
+                    });
+            });
+
+        bctx.report(
+            "walk heap", static_cast<f64>(heap_allocs) / k_walk_reps, "allocs/walk");
+        bctx.report(
+            "walk arena", static_cast<f64>(arena_allocs) / k_walk_reps, "allocs/walk");
+        bctx.report("walk heap", heap_secs / k_walk_reps * 1e9, "ns/walk");
+        bctx.report("walk arena", arena_secs / k_walk_reps * 1e9, "ns/walk");
+        bctx.report("checksum", static_cast<f64>(checksum % 1000));
+    }
+
+    auto& world = engine->add_domain<WorldDomain>();
+    for (i32 i = 0; i < k_loaded_chunks; ++i)
+        world.get_or_create_chunk({ i % 2, i / 2, 0 });
+    engine->tick();
+
+    // chunk creation, which also counts the domain and its stores
+    {
+        i32       next   = 0;
+        const u64 allocs = count_allocs(
+            [&]
+            {
+                for (; next < 256; ++next)
+                    world.get_or_create_chunk({ 100 + next, 0, 0 });
+            });
+        bctx.report(
+            "get_or_create_chunk", static_cast<f64>(allocs) / next, "allocs/chunk");
+        for (i32 i = 0; i < next; ++i)
+            world.remove_chunk({ 100 + i, 0, 0 });
+        engine->tick();
+    }
+
+    // a task handing a result back through then(), and the post_tick drain running it
+    {
+        constexpr i32    k_tasks = 10'000;
+        std::atomic<i32> done{ 0 };
+        const u64        allocs = count_allocs(
+            [&]
+            {
+                for (i32 i = 0; i < k_tasks; ++i)
+                    async->task([i] { return i; }).then([&](i32) { ++done; });
+                while (done.load() < k_tasks)
+                    engine->tick();
+            });
+        bctx.report("task + then", static_cast<f64>(allocs) / k_tasks, "allocs/task");
+    }
+
+    // server tick
+    {
+        std::atomic<i32> done{ 0 };
+        i32              created  = 0;
+        const auto       one_tick = [&]
+        {
+            for (i32 i = 0; i < k_tick_edits; ++i)
+                world.set_voxel(random_pos(), static_cast<u16>(rand::urange(1, 8)));
+            for (i32 i = 0; i < k_tick_chunks; ++i)
+            {
+                world.get_or_create_chunk({ 1000 + created, 0, 0 });
+                world.remove_chunk({ 1000 + created, 0, 0 });
+                created++;
+            }
+            for (i32 i = 0; i < k_tick_tasks; ++i)
+                async->task([i] { return i * 2; }).then([&](i32) { ++done; });
+            engine->tick();
+        };
+
+        // warm up, so loaded chunks have their nodes and the arenas their blocks
+        for (i32 i = 0; i < 20; ++i)
+            one_tick();
+
+        const u64 arena_before = mem::FrameArena::local().capacity();
+        u64       allocs       = 0;
+        const f64 secs         = bench::time_secs(
+            [&]
+            {
+                allocs = count_allocs(
+                    [&]
+                    {
+                        for (i32 i = 0; i < k_ticks; ++i)
+                            one_tick();
+                    });
+            });
+        async->executor().wait_for_all();
+        engine->tick();
+
+        bctx.report("server tick", static_cast<f64>(allocs) / k_ticks, "allocs/tick");
+        bctx.report("server tick", secs / k_ticks * 1e6, "us/tick");
+        bctx.report(
+            "main arena growth",
+            static_cast<f64>(mem::FrameArena::local().capacity() - arena_before), "B");
+    }
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+// Flood fill lighting benchmark: full chunk relights (serial and on the executor)
+// and single voxel edits followed by an update
+
+#include <algorithm>
+#include <bench.h>
+#include <engine/contexts/async/async.h>
+#include <thread>
+#include <world/light.h>
+
+using namespace v;
+
+namespace {
+    constexpr i32 k_chunks_xz = 4;
+    constexpr i32 k_chunks_y  = 2;
+    constexpr u16 k_stone     = 1;
+    constexpr u16 k_torch     = 5;
+    constexpr i32 k_edits     = 2000;
+
+    // rolling terrain with a cave layer and scattered torches
+    void generate(WorldDomain& world)
+    {
+        const i32 extent = k_chunks_xz * ChunkDomain::k_size;
+        for (i32 x = 0; x < extent; ++x)
+        {
+            for (i32 z = 0; z < extent; ++z)
+            {
+                const i32 h = 150 + (x * 7 + z * 13) % 40;
+                for (i32 y = 0; y < h; ++y)
+                {
+                    if (y > 60 && y < 72 && (x / 16 + z / 16) % 3 != 0)
+                        continue;
+                    world.set_voxel({ x, y, z }, k_stone);
+                }
+            }
+        }
+        for (i32 i = 0; i < 512; ++i)
+        {
+            const WorldPos wp{ static_cast<i32>(rand::urange(0, extent - 1)),
+                               static_cast<i32>(rand::urange(60, 71)),
+                               static_cast<i32>(rand::urange(0, extent - 1)) };
+            world.set_voxel(wp, k_torch);
+        }
+    }
+
+    LightEngine& setup(Engine& engine, bool parallel)
+    {
+        auto& world = engine.add_domain<WorldDomain>();
+        // keep everything resident
+        world.set_cache_config({ .memory_budget = 0 });
+        auto& light = engine.add_domain<LightEngine>(LightConfig{ .parallel = parallel });
+        light.set_emission(k_torch, 14);
+        generate(world);
+        return light;
+    }
+
+    f64 relight_all(Engine& engine, LightEngine& light)
+    {
+        auto world = engine.get_domain<WorldDomain>();
+        return bench::time_secs(
+            [&]
+            {
+                world->for_each_chunk([&](ChunkDomain& chunk)
+                                      { light.queue_relight(chunk.pos()); });
+                light.update();
+            });
+    }
+} // namespace
+
+int main()
+{
+    auto [engine, bctx] = bench::init_bench("lighting");
+    const u16 threads   = static_cast<u16>(std::max(1u, std::thread::hardware_concurrency()));
+    engine->add_ctx<AsyncContext>(threads);
+
+    rand::seed(29);
+    auto&     light  = setup(*engine, true);
+    const f64 chunks = static_cast<f64>(k_chunks_xz * k_chunks_xz * k_chunks_y);
+
+    // relights
+    const f64 parallel_secs = relight_all(*engine, light);
+    {
+        auto serial_engine = std::make_unique<Engine>();
+        rand::seed(29);
+        auto&     serial_light = setup(*serial_engine, false);
+        const f64 serial_secs  = relight_all(*serial_engine, serial_light);
+
+        bctx.report("relight serial", serial_secs / chunks * 1e3, "ms/chunk");
+        bctx.report("relight serial", chunks / serial_secs, "chunks/sec");
+    }
+    bctx.report("relight parallel", parallel_secs / chunks * 1e3, "ms/chunk");
+    bctx.report("relight parallel", chunks / parallel_secs, "chunks/sec");
+    bctx.report("relight threads", threads);
+
+    // single voxel edits, each followed by a full update. digging and placing near the
+    // surface mostly moves sky light, torches in the caves move block light
+    std::vector<f64> samples;
+    samples.reserve(k_edits);
+    const i32 extent = k_chunks_xz * ChunkDomain::k_size;
+    for (i32 i = 0; i < k_edits; ++i)
+    {
+        const bool     cave = i % 2 == 1;
+        const WorldPos wp{ static_cast<i32>(rand::urange(1, extent - 2)),
+                           cave ? static_cast<i32>(rand::urange(61, 71))
+                                : static_cast<i32>(rand::urange(140, 190)),
+                           static_cast<i32>(rand::urange(1, extent - 2)) };
+        const u16 value = rand::urange(0, 1) ? 0 : (cave ? k_torch : k_stone);
+
+        samples.push_back(bench::time_secs(
+            [&]
+            {
+                light.set_voxel(wp, value);
+                light.update();
+            }));
+    }
+
+    std::sort(samples.begin(), samples.end());
+    f64 total = 0;
+    for (f64 s : samples)
+        total += s;
+
+    bctx.report("edit updates", k_edits / total, "updates/sec");
+    bctx.report("edit avg", total / k_edits * 1e6, "us");
+    bctx.report("edit p50", samples[samples.size() / 2] * 1e6, "us");
+    bctx.report("edit p99", samples[samples.size() * 99 / 100] * 1e6, "us");
+    bctx.report("edit max", samples.back() * 1e6, "us");
+
+    usize light_bytes = 0;
+    engine->get_domain<WorldDomain>()->for_each_chunk(
+        [&](ChunkDomain& chunk)
+        {
+            if (auto l = light.try_get(chunk.pos()))
+                light_bytes += l->memory_usage();
+        });
+    bctx.report("light memory", light_bytes / chunks / (1 << 20), "MiB/chunk");
+
+    return 0;
+}
@@ -0,0 +1,200 @@
+// Parallel algorithms benchmark: AsyncContext's parallel_for, reduce, transform_reduce,
+// prefix scans and sort over 10M-element arrays against the serial loops they replace,
+// with a grain size sweep for a loop body too cheap to split finely and the
+// non-blocking variants awaited from a coroutine
+
+#include <algorithm>
+#include <bench.h>
+#include <cmath>
+#include <engine/contexts/async/async.h>
+#include <numeric>
+#include <thread>
+
+using namespace v;
+
+namespace {
+    constexpr usize k_count = 10'000'000;
+
+    struct Pair {
+        f64 serial;
+        f64 parallel;
+    };
+
+    void report(bench::BenchContext& bctx, const std::string& name, const Pair& p)
+    {
+        bctx.report(name + " serial", p.serial * 1e3, "ms");
+        bctx.report(name + " parallel", p.parallel * 1e3, "ms");
+        bctx.report(name + " speedup", p.serial / p.parallel, "x");
+        bctx.report(name + " throughput", k_count / p.parallel / 1e6, "M elems/sec");
+    }
+
+    /// Some math per element, heavy enough that splitting the loop pays off
+    FORCEINLINE f32 work(f32 x) { return std::sqrt(x * x + 1.f) * std::sin(x); }
+} // namespace
+
+int main()
+{
+    auto [engine, bctx] = bench::init_bench("parallel");
+    const u16 threads   = std::max(2u, std::thread::hardware_concurrency());
+    auto*     async     = engine->add_ctx<AsyncContext>(threads);
+    engine->on_tick.connect({}, {}, "async_coro", [async] { async->update(); });
+    bctx.report("workers", threads);
+
+    rand::seed(42);
+    std::vector<f32> src(k_count), dst(k_count);
+    std::vector<i64> ints(k_count), scanned(k_count);
+    for (usize i = 0; i < k_count; ++i)
+    {
+        src[i]  = static_cast<f32>(rand::urange(0, 1'000'000)) / 1000.f;
+        ints[i] = static_cast<i64>(rand::urange(0, 1'000));
+    }
+
+    // warm the workers up
+    async->parallel_for(usize{ 0 }, k_count, [&](usize i) { dst[i] = src[i]; });
+
+    {
+        const f64 serial = bench::time_secs(
+            [&]
+            {
+                for (usize i = 0; i < k_count; ++i)
+                    dst[i] = work(src[i]);
+            });
+        const f64 parallel = bench::time_secs(
+            [&]
+            {
+                async->parallel_for(
+                    usize{ 0 }, k_count, [&](usize i) { dst[i] = work(src[i]); });
+            });
+        report(bctx, "for", { serial, parallel });
+    }
+
+    // a single add per element, where the grain decides whether splitting is worth it
+    {
+        const f64 serial = bench::time_secs(
+            [&]
+            {
+                for (usize i = 0; i < k_count; ++i)
+                    dst[i] = src[i] + 1.f;
+            });
+        bctx.report("for, cheap body serial", serial * 1e3, "ms");
+        for (const usize grain : { 0, 64, 1024, 16384, 262144 })
+        {
+            const f64 parallel = bench::time_secs(
+                [&]
+                {
+                    async->parallel_for(
+                        usize{ 0 }, k_count, [&](usize i) { dst[i] = src[i] + 1.f; },
+                        grain);
+                });
+            bctx.report(
+                std::format("for, cheap body grain {}", grain), parallel * 1e3, "ms");
+        }
+
+        const f64 chunked = bench::time_secs(
+            [&]
+            {
+                async->parallel_for_chunks(
+                    usize{ 0 }, k_count,
+                    [&](usize first, usize last)
+                    {
+                        for (usize i = first; i < last; ++i)
+                            dst[i] = src[i] + 1.f;
+                    },
+                    16384);
+            });
+        bctx.report("for_chunks, cheap body grain 16384", chunked * 1e3, "ms");
+    }
+
+    {
+        i64       serial_sum = 0, parallel_sum = 0;
+        const f64 serial = bench::time_secs(
+            [&] { serial_sum = std::accumulate(ints.begin(), ints.end(), i64{ 0 }); });
+        const f64 parallel = bench::time_secs(
+            [&]
+            {
+                parallel_sum = async->parallel_reduce(
+                    ints.begin(), ints.end(), i64{ 0 }, std::plus<>{}, 16384);
+            });
+        report(bctx, "reduce", { serial, parallel });
+        bctx.report("reduce matches", serial_sum == parallel_sum);
+    }
+
+    {
+        f64       serial_sum = 0, parallel_sum = 0;
+        const f64 serial = bench::time_secs(
+            [&]
+            {
+                for (const f32 x : src)
+                    serial_sum += work(x);
+            });
+        const f64 parallel = bench::time_secs(
+            [&]
+            {
+                parallel_sum = async->parallel_transform_reduce(
+                    src.begin(), src.end(), f64{ 0 }, std::plus<>{},
+                    [](f32 x) -> f64 { return work(x); }, 4096);
+            });
+        report(bctx, "transform_reduce", { serial, parallel });
+        bctx.report(
+            "transform_reduce relative error",
+            std::abs(serial_sum - parallel_sum) / std::abs(serial_sum));
+    }
+
+    {
+        const f64 serial = bench::time_secs(
+            [&] { std::inclusive_scan(ints.begin(), ints.end(), scanned.begin()); });
+        const i64 expected = scanned.back();
+        const f64 parallel = bench::time_secs(
+            [&]
+            {
+                async->parallel_inclusive_scan(
+                    ints.begin(), ints.end(), scanned.begin());
+            });
+        report(bctx, "inclusive_scan", { serial, parallel });
+        bctx.report("inclusive_scan matches", scanned.back() == expected);
+    }
+
+    {
+        std::vector<f32> keys   = src;
+        const f64        serial = bench::time_secs(
+            [&] { std::sort(keys.begin(), keys.end()); });
+        keys               = src;
+        const f64 parallel = bench::time_secs(
+            [&] { async->parallel_sort(keys.begin(), keys.end()); });
+        report(bctx, "sort", { serial, parallel });
+        bctx.report("sort sorted", std::is_sorted(keys.begin(), keys.end()));
+    }
+
+    // the main thread keeps ticking while a coroutine awaits the work
+    {
+        bool done  = false;
+        f64  sum   = 0;
+        u64  ticks = 0;
+
+        const f64 secs = bench::time_secs(
+            [&]
+            {
+                async->spawn(
+                    [&](CoroutineInterface&) -> Coroutine<void>
+                    {
+                        co_await async->parallel_for_async(
+                            usize{ 0 }, k_count, [&](usize i) { dst[i] = work(src[i]); });
+                        sum = co_await async->parallel_reduce_async(
+                            dst.begin(), dst.end(), f64{ 0 }, std::plus<>{}, 16384);
+                        done = true;
+                    });
+                while (!done)
+                {
+                    engine->tick();
+                    ticks++;
+                    // on few cores a spinning main thread holds the workers up
+                    std::this_thread::yield();
+                }
+            });
+        bctx.report("async for + reduce", secs * 1e3, "ms");
+        bctx.report("async main thread ticks", static_cast<f64>(ticks));
+        bctx.report("async checksum", sum);
+    }
+
+    return 0;
+}
@@ -0,0 +1,135 @@
+// Voxel physics benchmark: 10k boxes walking around generated terrain, stepped
+// serially and over the executor, plus raw sweeps against the octree
+
+#include <bench.h>
+#include <engine/components.h>
+#include <engine/contexts/async/async.h>
+#include <thread>
+#include <world/physics.h>
+
+using namespace v;
+
+namespace {
+    constexpr i32 k_chunks_xz = 4;
+    constexpr i32 k_extent    = k_chunks_xz * ChunkDomain::k_size;
+    constexpr i32 k_bodies    = 10000;
+    constexpr i32 k_warmup    = 40;
+    constexpr i32 k_steps     = 200;
+    constexpr f64 k_dt        = 1.0 / 20;
+    constexpr u16 k_stone     = 1;
+
+    f32 frand(f32 lo, f32 hi) { return static_cast<f32>(rand::frange(lo, hi)); }
+
+    // rolling hills with a cave layer and scattered pillars
+    void generate(WorldDomain& world)
+    {
+        for (i32 x = 0; x < k_extent; ++x)
+        {
+            for (i32 z = 0; z < k_extent; ++z)
+            {
+                const i32 h = 150 + (x / 4 * 7 + z / 4 * 13) % 40;
+                for (i32 y = 0; y < h; ++y)
+                {
+                    if (y > 60 && y < 72 && (x / 16 + z / 16) % 3 != 0)
+                        continue;
+                    world.set_voxel({ x, y, z }, k_stone);
+                }
+                if (x % 23 == 0 && z % 19 == 0)
+                    for (i32 y = h; y < h + 12; ++y)
+                        world.set_voxel({ x, y, z }, k_stone);
+            }
+        }
+    }
+
+    VoxelPhysics& setup(Engine& engine, const PhysicsConfig& config)
+    {
+        auto& world = engine.add_domain<WorldDomain>();
+        world.set_cache_config({ .memory_budget = 0 });
+        generate(world);
+
+        // half on the surface, half walking around the caves
+        for (i32 i = 0; i < k_bodies; ++i)
+        {
+            const f32  y = i % 2 ? frand(195, 210) : frand(62, 66);
+            const auto e = engine.registry().create();
+            engine.registry().emplace<Pos3d>(
+                e, glm::vec3{ frand(8, k_extent - 8), y, frand(8, k_extent - 8) });
+            engine.registry().emplace<Size3d>(e, glm::vec3{ 0.6f, 1.8f, 0.6f });
+            engine.registry().emplace<VoxelBody>(
+                e, VoxelBody{ .velocity = { frand(-4, 4), 0, frand(-4, 4) } });
+        }
+        return engine.add_domain<VoxelPhysics>(config);
+    }
+
+    /// Average seconds per step
+    f64 run_steps(VoxelPhysics& physics)
+    {
+        for (i32 i = 0; i < k_warmup; ++i)
+            physics.step(k_dt);
+        return bench::time_secs(
+                   [&]
+                   {
+                       for (i32 i = 0; i < k_steps; ++i)
+                           physics.step(k_dt);
+                   }) /
+            k_steps;
+    }
+} // namespace
+
+int main()
+{
+    auto [engine, bctx] = bench::init_bench("physics");
+    const u16 threads   = static_cast<u16>(std::max(1u, std::thread::hardware_concurrency()));
+    engine->add_ctx<AsyncContext>(threads);
+
+    rand::seed(31);
+    auto&     parallel      = setup(*engine, {});
+    const f64 parallel_secs = run_steps(parallel);
+
+    f64 serial_secs = 0;
+    {
+        auto serial_engine = std::make_unique<Engine>();
+        rand::seed(31);
+        auto& serial = setup(*serial_engine, { .parallel = false });
+        serial_secs  = run_steps(serial);
+    }
+
+    bctx.report("step serial", serial_secs * 1e3, "ms");
+    bctx.report("step parallel", parallel_secs * 1e3, "ms");
+    bctx.report("step threads", threads);
+    bctx.report("bodies", k_bodies);
+    bctx.report("bodies serial", k_bodies / serial_secs, "bodies/sec");
+    bctx.report("bodies parallel", k_bodies / parallel_secs, "bodies/sec");
+    bctx.report("collisions", parallel.stats().collisions, "bodies/step");
+
+    // single thread sweeps with no batching, the cost of the octree query alone
+    auto          world = engine->get_domain<WorldDomain>();
+    VoxelCollider collider{ *world };
+    constexpr i32 k_sweeps = 200000;
+
+    std::vector<std::pair<AABB, glm::vec3>> sweeps;
+    sweeps.reserve(k_sweeps);
+    for (i32 i = 0; i < k_sweeps; ++i)
+    {
+        const glm::vec3 half{ 0.3f, 0.9f, 0.3f };
+        const glm::vec3 p{
+            frand(8, k_extent - 8),
+            frand(140, 200),
+            frand(8, k_extent - 8),
+        };
+        sweeps.push_back({ AABB{ p - half, p + half },
+                           glm::vec3{ frand(-1, 1), frand(-2, 0.5f), frand(-1, 1) } });
+    }
+
+    u64       blocked    = 0;
+    const f64 sweep_secs = bench::time_secs(
+        [&]
+        {
+            for (const auto& [box, delta] : sweeps)
+                blocked += collider.sweep(box, delta).blocked != 0;
+        });
+    bctx.report("sweep", sweep_secs / k_sweeps * 1e9, "ns");
+    bctx.report("sweep blocked", static_cast<f64>(blocked) / k_sweeps * 100, "%");
+
+    return 0;
+}
@@ -0,0 +1,151 @@
+// post_tick benchmark: 1M deferred callbacks posted from 8 threads and drained on the
+// main thread, through the engine's InlineFn queue against the std::function queue
+// it replaced (one try_dequeue and one try block per callback), with allocations
+// counted for a small capture (like chunk removal) and a task result sized one
+
+#include <atomic>
+#include <bench.h>
+#include <cstdlib>
+#include <functional>
+#include <moodycamel/concurrentqueue.h>
+#include <new>
+#include <thread>
+
+using namespace v;
+
+namespace {
+    std::atomic<u64> g_allocs{ 0 };
+} // namespace
+
+// every allocation in the process, the point of the change is to not make them
+void* operator new(std::size_t size)
+{
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+    constexpr i32 k_threads    = 8;
+    constexpr i32 k_total      = 1'000'000;
+    constexpr i32 k_per_thread = k_total / k_threads;
+
+    /// What a completed task hands back through post_tick, a bit over what
+    /// std::function keeps inline
+    struct Result {
+        u64 id;
+        f64 values[3];
+    };
+
+    /// Posts k_total callbacks from k_threads threads through `post`, seconds taken
+    template <typename Post>
+    f64 post_all(Post&& post)
+    {
+        std::atomic<i32>         ready{ 0 };
+        std::vector<std::thread> threads;
+        Stopwatch                sw{};
+        for (i32 t = 0; t < k_threads; ++t)
+        {
+            threads.emplace_back(
+                [&, t]
+                {
+                    ++ready;
+                    while (ready.load() < k_threads)
+                        ;
+                    for (i32 i = 0; i < k_per_thread; ++i)
+                        post(static_cast<u64>(t) * k_per_thread + i);
+                });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        return sw.elapsed();
+    }
+
+    struct Sample {
+        f64 post;
+        f64 drain;
+        f64 allocs;
+    };
+
+    void report(bench::BenchContext& bctx, const std::string& name, const Sample& s)
+    {
+        bctx.report(name + " post", s.post / k_total * 1e9, "ns");
+        bctx.report(name + " drain", s.drain / k_total * 1e9, "ns");
+        bctx.report(name + " allocs", s.allocs, "per callback");
+    }
+} // namespace
+
+int main()
+{
+    auto [engine, bctx] = bench::init_bench("post_tick");
+    bctx.report("threads", k_threads);
+    bctx.report("callbacks", k_total);
+
+    std::atomic<u64> sum{ 0 };
+    const auto       small = [&](u64 id) { return [&sum, id] { sum += id; }; };
+    const auto       task  = [&](u64 id)
+    {
+        Result result{ id, { 1, 2, 3 } };
+        return [&sum, result] { sum += result.id; };
+    };
+
+    // what Engine did before: std::function in the queue, one dequeue and one try
+    // block per callback
+    const auto old_queue = [&](auto make)
+    {
+        moodycamel::ConcurrentQueue<std::function<void()>> queue;
+        Sample                                             s{};
+        const u64 allocs_before = g_allocs.load();
+        s.post = post_all([&](u64 id) { queue.enqueue(make(id)); });
+        s.drain = bench::time_secs(
+            [&]
+            {
+                std::function<void()> fn;
+                while (queue.try_dequeue(fn))
+                {
+                    try
+                    {
+                        if (fn)
+                            fn();
+                    }
+                    catch (...)
+                    {
+                        LOG_ERROR("post_tick callback threw");
+                    }
+                }
+            });
+        s.allocs = static_cast<f64>(g_allocs.load() - allocs_before) / k_total;
+        return s;
+    };
+
+    // through the engine, tick() drains
+    const auto new_queue = [&](auto make)
+    {
+        Sample    s{};
+        const u64 allocs_before = g_allocs.load();
+        s.post   = post_all([&](u64 id) { engine->post_tick(make(id)); });
+        s.drain  = bench::time_secs([&] { engine->tick(); });
+        s.allocs = static_cast<f64>(g_allocs.load() - allocs_before) / k_total;
+        return s;
+    };
+
+    // warm both up so queue blocks are already allocated
+    old_queue(small);
+    new_queue(small);
+
+    report(bctx, "std::function small", old_queue(small));
+    report(bctx, "InlineFn small", new_queue(small));
+    report(bctx, "std::function task", old_queue(task));
+    report(bctx, "InlineFn task", new_queue(task));
+
+    const u64 expected = static_cast<u64>(k_total) * (k_total - 1) / 2 * 6;
+    if (sum != expected)
+        LOG_ERROR("callbacks went missing: {} vs {}", sum.load(), expected);
+
+    return 0;
+}
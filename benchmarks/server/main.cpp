@@ -0,0 +1,283 @@
+// Headless server benchmark: a server engine (NetworkContext, WorldDomain, and the
+// ServerDomain with its ChunkStreamer) and N loopback clients, each an engine of its
+// own with a ChunkReceiver, all ticked from this thread. Clients follow a fixed
+// script: they walk across the generated terrain (moving their chunk interest), edit
+// voxels around themselves and chat. Reports server tick percentiles, per subsystem
+// time, bytes sent and allocations, and writes them as JSON. The streamer's budget
+// refills by a fixed amount per tick, so only the timings depend on the machine.
+//
+// usage: vbench-server [clients = 8] [ticks = 2000] [json = vbench-server.json]
+
+#include <algorithm>
+#include <atomic>
+#include <bench.h>
+#include <cstdlib>
+#include <engine/contexts/net/connection.h>
+#include <engine/contexts/net/ctx.h>
+#include <engine/contexts/net/listener.h>
+#include <net/channels.h>
+#include <new>
+#include <server.h>
+#include <thread>
+#include <world/streaming.h>
+
+using namespace v;
+
+namespace {
+    std::atomic<u64> g_allocs{ 0 };
+    /// Only the server's side of a step is counted, the clients share the process
+    thread_local bool g_counting = false;
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    if (g_counting)
+        g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+    constexpr const char* k_host          = "127.0.0.1";
+    constexpr u16         k_port          = 28557;
+    /// (2r+1)^2 generated chunks around the origin
+    constexpr i32         k_radius        = 3;
+    constexpr i32         k_view_distance = 2;
+    constexpr i32         k_warmup_ticks  = 200;
+    /// A client moves to the next chunk this often
+    constexpr u64 k_move_every = 50;
+    constexpr u64 k_edit_every = 4;
+    constexpr i32 k_edits      = 8;
+    constexpr u64 k_chat_every = 60;
+    /// Simulated tick length for the streamer's send budget, the server's real rate
+    constexpr f64 k_tick_secs = 1.0 / 144.0;
+
+    void generate_chunk(ChunkDomain& chunk)
+    {
+        const ChunkPos cp = chunk.pos();
+        for (i32 x = 0; x < ChunkDomain::k_size; ++x)
+        {
+            for (i32 z = 0; z < ChunkDomain::k_size; ++z)
+            {
+                const i32 h = 40 + ((x * 7 + z * 3 + cp.x * 11 + cp.z * 5) % 24);
+                chunk.set({ x, h, z }, static_cast<u16>(1 + (x + z) % 3));
+            }
+        }
+    }
+
+    struct Client {
+        std::unique_ptr<Engine>               engine;
+        NetworkContext*                       net{};
+        ChunkReceiver*                        receiver{};
+        std::shared_ptr<NetConnection>        con{};
+        NetChannel<ChatChannel, ChatMessage>* chat{};
+        u64                                   chats_received{ 0 };
+    };
+
+    /// Where client `i` stands at tick `t`: walking along its own row of chunks,
+    /// wrapping around at the edge of the generated area
+    ChunkPos client_center(i32 i, u64 t)
+    {
+        constexpr i32 side = 2 * k_radius + 1;
+        const i32     step = static_cast<i32>(t / k_move_every) + i * 3;
+        return { step % side - k_radius, 0, i % side - k_radius };
+    }
+
+    /// One tick of client `i`'s script, the same every run
+    void script(Client& client, i32 i, u64 t)
+    {
+        const ChunkPos center = client_center(i, t);
+        client.receiver->set_interest(center, k_view_distance);
+
+        if (t % k_edit_every == 0)
+        {
+            for (i32 e = 0; e < k_edits; ++e)
+            {
+                const i32 k = static_cast<i32>(t) * 31 + i * 17 + e * 7;
+                client.receiver->queue_edit(
+                    { center.x * ChunkDomain::k_size + k % ChunkDomain::k_size,
+                      64 + e,
+                      center.z * ChunkDomain::k_size + (k / 3) % ChunkDomain::k_size },
+                    static_cast<u16>(1 + (k % 7)));
+            }
+        }
+
+        if (t % k_chat_every == static_cast<u64>(i) % k_chat_every)
+            client.chat->send(ChatMessage{ .msg = std::format("client {} at {}", i, t) });
+    }
+
+    f64 percentile(std::vector<u64>& samples, f64 p)
+    {
+        if (samples.empty())
+            return 0;
+        const usize idx = std::min(
+            samples.size() - 1, static_cast<usize>(p * static_cast<f64>(samples.size())));
+        std::nth_element(samples.begin(), samples.begin() + idx, samples.end());
+        return static_cast<f64>(samples[idx]);
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const i32         n_clients = argc > 1 ? std::max(1, std::atoi(argv[1])) : 8;
+    const u64         n_ticks   = argc > 2 ? std::max(1, std::atoi(argv[2])) : 2000;
+    const std::string json_path = argc > 3 ? argv[3] : "vbench-server.json";
+
+    auto [server, bctx] = bench::init_bench("server");
+
+    // server, set up like server/src/main.cpp
+    auto* server_net   = server->add_ctx<NetworkContext>(1.0 / 1000.0);
+    auto& server_world = server->add_domain<WorldDomain>();
+    for (i32 x = -k_radius; x <= k_radius; ++x)
+        for (i32 z = -k_radius; z <= k_radius; ++z)
+            generate_chunk(server_world.get_or_create_chunk({ x, 0, z }));
+
+    ServerConfig config{ k_host, k_port,
+                         ChunkStreamConfig{ .fixed_tick_secs = k_tick_secs } };
+    server->add_domain<ServerDomain>(config);
+    auto* streamer = server->get_domain<ChunkStreamer>();
+
+    // clients
+    std::vector<Client> clients(n_clients);
+    for (i32 i = 0; i < n_clients; ++i)
+    {
+        Client& client  = clients[i];
+        client.engine   = std::make_unique<Engine>();
+        client.net      = client.engine->add_ctx<NetworkContext>(1.0 / 1000.0);
+        client.engine->add_domain<WorldDomain>();
+        client.receiver = &client.engine->add_domain<ChunkReceiver>();
+        client.con      = client.net->create_connection(k_host, k_port);
+        client.receiver->attach(client.con);
+
+        client.chat = &client.con->create_channel<ChatChannel>();
+        client.chat->received().connect([&client](const ChatMessage&)
+                                        { client.chats_received++; });
+        client.con->create_channel<ConnectServerChannel>().send(
+            ConnectionRequest{ .uuid = std::format("bench-{}", i) });
+    }
+
+    std::vector<u64> tick_ns;
+    tick_ns.reserve(n_ticks);
+    // script time only advances on scripted steps, so connecting taking a few more or
+    // less steps doesn't change what the clients do
+    u64        script_tick = 0;
+    const auto step        = [&](bool scripted, bool measure)
+    {
+        for (i32 i = 0; i < n_clients; ++i)
+        {
+            if (scripted)
+                script(clients[i], i, script_tick);
+            clients[i].net->update();
+            clients[i].engine->tick();
+        }
+        if (scripted)
+            script_tick++;
+
+        g_counting      = measure;
+        const u64 start = time::ns();
+        server_net->update();
+        server->tick();
+        const u64 end = time::ns();
+        g_counting    = false;
+
+        if (measure)
+            tick_ns.push_back(end - start);
+        // let the io threads run, the sandbox may only have one core
+        std::this_thread::yield();
+    };
+
+    for (u64 i = 0; i < 5000 && streamer->connection_count() < clients.size(); ++i)
+    {
+        step(false, false);
+        time::sleep_ms(1);
+    }
+    if (streamer->connection_count() < clients.size())
+    {
+        LOG_ERROR(
+            "[server] only {} of {} clients connected", streamer->connection_count(),
+            clients.size());
+        return 1;
+    }
+
+    for (i32 i = 0; i < k_warmup_ticks; ++i)
+        step(true, false);
+
+    const NetStats         net_before    = server_net->stats();
+    const ChunkStreamStats stream_before = streamer->stats();
+    const u64              allocs_before = g_allocs.load();
+    const f64              secs          = bench::time_secs(
+        [&]
+        {
+            for (u64 i = 0; i < n_ticks; ++i)
+                step(true, true);
+        });
+    const u64              allocs        = g_allocs.load() - allocs_before;
+    const NetStats         net           = server_net->stats();
+    const ChunkStreamStats stream        = streamer->stats();
+
+    const f64 ticks = static_cast<f64>(n_ticks);
+    bctx.report("clients", n_clients);
+    bctx.report("ticks", ticks);
+    bctx.report("wall, clients included", secs, "s");
+    bctx.report("ticks/sec, clients included", ticks / secs);
+
+    f64 total_ns = 0;
+    for (const u64 ns : tick_ns)
+        total_ns += static_cast<f64>(ns);
+    bctx.report("tick mean", total_ns / ticks / 1e3, "us");
+    bctx.report("tick p50", percentile(tick_ns, 0.50) / 1e3, "us");
+    bctx.report("tick p90", percentile(tick_ns, 0.90) / 1e3, "us");
+    bctx.report("tick p99", percentile(tick_ns, 0.99) / 1e3, "us");
+    bctx.report("tick max", percentile(tick_ns, 1.0) / 1e3, "us");
+
+    // the engine only keeps the last TimingRing::capacity runs of each
+    for (const TaskTiming& timing : server->tick_timings())
+    {
+        bctx.report(std::format("{} p50", timing.name), timing.p50_ns / 1e3, "us");
+        bctx.report(std::format("{} p99", timing.name), timing.p99_ns / 1e3, "us");
+    }
+
+    bctx.report(
+        "bytes sent", static_cast<f64>(net.bytes_sent - net_before.bytes_sent), "B");
+    bctx.report(
+        "bytes sent/tick", (net.bytes_sent - net_before.bytes_sent) / ticks, "B");
+    bctx.report(
+        "packets sent/tick", (net.packets_sent - net_before.packets_sent) / ticks);
+    bctx.report(
+        "bytes received/tick", (net.bytes_received - net_before.bytes_received) / ticks,
+        "B");
+    bctx.report(
+        "chunk bytes/tick", (stream.bytes_sent - stream_before.bytes_sent) / ticks, "B");
+    bctx.report(
+        "full chunks sent", static_cast<f64>(stream.full_sent - stream_before.full_sent));
+    bctx.report(
+        "deltas sent", static_cast<f64>(stream.deltas_sent - stream_before.deltas_sent));
+    bctx.report(
+        "edits received",
+        static_cast<f64>(stream.edits_received - stream_before.edits_received));
+
+    u64 chats = 0;
+    for (const Client& client : clients)
+        chats += client.chats_received;
+    bctx.report("chats echoed", static_cast<f64>(chats));
+
+    bctx.report("allocs/tick", static_cast<f64>(allocs) / ticks);
+    bctx.report("peak rss", bench::peak_rss_bytes() / (1024.0 * 1024.0), "MiB");
+
+    for (Client& client : clients)
+        client.con->request_close();
+    for (i32 i = 0; i < 50; ++i)
+        step(false, false);
+
+    if (bctx.write_json(json_path))
+        LOG_INFO("[server] wrote {}", json_path);
+    else
+        LOG_ERROR("[server] couldn't write {}", json_path);
+
+    return 0;
+}
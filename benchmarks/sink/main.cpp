@@ -0,0 +1,187 @@
+// DependentSink benchmark: synthetic CPU bound tick tasks run one after another
+// against compiled to a taskflow, for independent tasks, chains, main thread tasks and
+// empty tasks (the fixed cost of a parallel execute), plus the per task overhead of
+// execute(), what timing every task adds to it, and the cost of connecting with 1k
+// tasks
+
+#include <atomic>
+#include <bench.h>
+#include <cmath>
+#include <containers/ud_map.h>
+#include <engine/contexts/async/async.h>
+#include <engine/sink.h>
+#include <thread>
+
+using namespace v;
+
+namespace {
+    constexpr i32 k_executes = 200;
+
+    std::atomic<u64> g_sink{ 0 };
+
+    /// Roughly `iters` dependent multiply adds, enough to keep a core busy
+    void burn(u32 iters)
+    {
+        f64 x = 1.0;
+        for (u32 i = 0; i < iters; ++i)
+            x = std::fma(x, 1.0000001, 1e-9);
+        g_sink.fetch_add(static_cast<u64>(x), std::memory_order_relaxed);
+    }
+
+    /// Average seconds per execute()
+    f64 run(DependentSink& sink)
+    {
+        for (i32 i = 0; i < 10; ++i)
+            sink.execute();
+        return bench::time_secs(
+                   [&]
+                   {
+                       for (i32 i = 0; i < k_executes; ++i)
+                           sink.execute();
+                   }) /
+            k_executes;
+    }
+
+    void compare(
+        bench::BenchContext& bctx, tf::Executor& executor, const std::string& name,
+        DependentSink& sink)
+    {
+        sink.set_executor(nullptr);
+        const f64 serial = run(sink);
+        sink.set_executor(&executor);
+        const f64 parallel = run(sink);
+
+        bctx.report(name + " serial", serial * 1e3, "ms");
+        bctx.report(name + " parallel", parallel * 1e3, "ms");
+        bctx.report(name + " speedup", serial / parallel, "x");
+    }
+} // namespace
+
+int main()
+{
+    auto [engine, bctx] = bench::init_bench("sink");
+    const u16 threads   = static_cast<u16>(std::max(1u, std::thread::hardware_concurrency()));
+    auto&     executor  = engine->add_ctx<AsyncContext>(threads)->executor();
+    bctx.report("threads", threads);
+
+    constexpr u32 k_work = 200000;
+
+    // 16 tasks that don't depend on each other
+    {
+        DependentSink sink;
+        for (i32 i = 0; i < 16; ++i)
+            sink.connect({}, {}, std::format("task{}", i), [] { burn(k_work); });
+        compare(bctx, executor, "independent x16", sink);
+    }
+
+    // 4 chains of 4, only the chains can overlap
+    {
+        DependentSink sink;
+        for (i32 c = 0; c < 4; ++c)
+        {
+            for (i32 i = 0; i < 4; ++i)
+            {
+                std::vector<std::string> after;
+                if (i > 0)
+                    after.push_back(std::format("chain{}_{}", c, i - 1));
+                sink.connect(
+                    after, {}, std::format("chain{}_{}", c, i), [] { burn(k_work); });
+            }
+        }
+        compare(bctx, executor, "chains 4x4", sink);
+    }
+
+    // the independent tasks with two of them pinned to the main thread, like window
+    // and render in the client
+    {
+        DependentSink sink;
+        for (i32 i = 0; i < 16; ++i)
+        {
+            sink.connect(
+                {}, {}, std::format("task{}", i), [] { burn(k_work); },
+                i < 2 ? TaskAffinity::main_thread : TaskAffinity::any);
+        }
+        compare(bctx, executor, "main thread 2 of 16", sink);
+    }
+
+    // empty tasks, what scheduling alone costs
+    {
+        DependentSink sink;
+        for (i32 i = 0; i < 32; ++i)
+            sink.connect({}, {}, std::format("empty{}", i), [] {});
+        sink.set_executor(nullptr);
+        const f64 serial = run(sink);
+        sink.set_executor(&executor);
+        const f64 parallel = run(sink);
+        bctx.report("empty x32 serial", serial * 1e6, "us");
+        bctx.report("empty x32 parallel", parallel * 1e6, "us");
+    }
+
+    // 1k tasks in a random dag, what execute() itself costs per task
+    {
+        constexpr i32 k_tasks = 1000;
+        rand::seed(35);
+
+        std::vector<std::vector<std::string>> after(k_tasks);
+        for (i32 i = 1; i < k_tasks; ++i)
+            for (i32 e = 0; e < 2; ++e)
+                after[i].push_back(std::format("dag{}", rand::irange(0, i - 1)));
+
+        // connected back to front so most connects have to reorder
+        u64           counter = 0;
+        DependentSink sink;
+        const f64     connect = bench::time_secs(
+            [&]
+            {
+                for (i32 i = k_tasks - 1; i >= 0; --i)
+                    sink.connect(
+                        after[i], {}, std::format("dag{}", i), [&] { ++counter; });
+            });
+        bctx.report("dag x1k connect", connect / k_tasks * 1e6, "us");
+
+        const f64 serial = run(sink);
+        bctx.report("dag x1k serial", serial * 1e6, "us");
+        bctx.report("dag x1k serial per task", serial / k_tasks * 1e9, "ns");
+
+        // what a string keyed lookup per task added on top
+        ud_map<std::string, std::function<void()>> by_name;
+        std::vector<std::string>                    names = sink.sorted();
+        for (const auto& name : names)
+            by_name.emplace(name, [&] { ++counter; });
+        const f64 lookup = bench::time_secs(
+                               [&]
+                               {
+                                   for (i32 e = 0; e < k_executes; ++e)
+                                       for (const auto& name : names)
+                                           by_name.at(name)();
+                               }) /
+            k_executes;
+        bctx.report("dag x1k by name per task", lookup / k_tasks * 1e9, "ns");
+
+        sink.set_timing(true);
+        const f64 timed = run(sink);
+        bctx.report("dag x1k timed per task", timed / k_tasks * 1e9, "ns");
+        bctx.report("timing cost per task", (timed - serial) / k_tasks * 1e9, "ns");
+
+        // nearly all of that is the one clock read per task
+        u64       clock_sum = 0;
+        const f64 clock     = bench::time_secs(
+            [&]
+            {
+                for (i32 i = 0; i < 1'000'000; ++i)
+                    clock_sum += v::time::ns();
+            });
+        bctx.report("clock read", clock * 1e3, "ns");
+        g_sink.fetch_add(clock_sum & 1, std::memory_order_relaxed);
+
+        sink.set_executor(&executor);
+        const f64 parallel_timed = run(sink);
+        sink.set_timing(false);
+        const f64 parallel = run(sink);
+        bctx.report("dag x1k parallel", parallel * 1e6, "us");
+        bctx.report("dag x1k parallel timed", parallel_timed * 1e6, "us");
+        g_sink.fetch_add(counter, std::memory_order_relaxed);
+    }
+
+    return 0;
+}
@@ -0,0 +1,155 @@
+// Spatial index benchmark: radius, box and nearest queries over 100k entities against
+// a linear scan of the Pos3d pool, plus what keeping the index in sync costs
+
+#include <algorithm>
+#include <bench.h>
+#include <engine/components.h>
+#include <engine/spatial.h>
+
+using namespace v;
+
+namespace {
+    constexpr i32 k_entities = 100000;
+    constexpr i32 k_queries  = 2000;
+    constexpr f32 k_extent   = 2048;
+    constexpr f32 k_radius   = 32;
+    constexpr i32 k_k        = 8;
+
+    f32 frand(f32 lo, f32 hi) { return static_cast<f32>(rand::frange(lo, hi)); }
+
+    glm::vec3 random_pos()
+    {
+        return { frand(0, k_extent), frand(0, 128), frand(0, k_extent) };
+    }
+} // namespace
+
+int main()
+{
+    auto [engine, bctx] = bench::init_bench("spatial");
+    auto& registry      = engine->registry();
+    rand::seed(33);
+
+    std::vector<entt::entity> entities(k_entities);
+    for (auto& e : entities)
+    {
+        e = registry.create();
+        registry.emplace<Pos3d>(e, random_pos());
+    }
+
+    std::vector<glm::vec3> centers(k_queries);
+    for (auto& c : centers)
+        c = random_pos();
+
+    // small moves through patch, before and after the index is listening
+    const auto move_all = [&]
+    {
+        const glm::vec3 step{ 0.25f, 0, 0.1f };
+        for (const auto e : entities)
+            registry.patch<Pos3d>(e, [&](Pos3d& p) { p.val += step; });
+    };
+    const f64 patch_plain = bench::time_secs(move_all);
+
+    SpatialIndex* index{};
+    const f64     build = bench::time_secs(
+        [&]
+        {
+            index = &engine->add_domain<SpatialIndex>(SpatialConfig{ .cell_size = 32 });
+        });
+    const f64 patch_indexed = bench::time_secs(move_all);
+
+    bctx.report("entities", k_entities);
+    bctx.report("cells", index->hash().cell_count());
+    bctx.report("build", build * 1e3, "ms");
+    bctx.report("patch", patch_plain / k_entities * 1e9, "ns");
+    bctx.report("patch indexed", patch_indexed / k_entities * 1e9, "ns");
+
+    // radius
+    usize     found_scan = 0, found_index = 0;
+    const f64 radius_scan = bench::time_secs(
+        [&]
+        {
+            for (const auto& c : centers)
+            {
+                for (auto [e, pos] : registry.view<Pos3d>().each())
+                {
+                    const glm::vec3 d = pos.val - c;
+                    found_scan += glm::dot(d, d) <= k_radius * k_radius;
+                }
+            }
+        });
+    const f64 radius_index = bench::time_secs(
+        [&]
+        {
+            for (const auto& c : centers)
+                index->for_each_in_radius(
+                    c, k_radius, [&](entt::entity, const glm::vec3&) { ++found_index; });
+        });
+    bctx.report("radius scan", radius_scan / k_queries * 1e6, "us");
+    bctx.report("radius index", radius_index / k_queries * 1e6, "us");
+    bctx.report("radius speedup", radius_scan / radius_index, "x");
+    bctx.report("radius hits", static_cast<f64>(found_index) / k_queries);
+    if (found_scan != found_index)
+        LOG_ERROR("radius queries disagree: {} vs {}", found_scan, found_index);
+
+    // boxes, flat and wide like a region around a player
+    const glm::vec3 half{ 48, 16, 48 };
+    found_scan = found_index = 0;
+    const f64 box_scan       = bench::time_secs(
+        [&]
+        {
+            for (const auto& c : centers)
+            {
+                const AABB box{ c - half, c + half };
+                for (auto [e, pos] : registry.view<Pos3d>().each())
+                {
+                    const glm::vec3& p = pos.val;
+                    found_scan += p.x >= box.min.x && p.y >= box.min.y &&
+                        p.z >= box.min.z && p.x <= box.max.x && p.y <= box.max.y &&
+                        p.z <= box.max.z;
+                }
+            }
+        });
+    const f64 box_index = bench::time_secs(
+        [&]
+        {
+            for (const auto& c : centers)
+                index->for_each_in_box(
+                    { c - half, c + half },
+                    [&](entt::entity, const glm::vec3&) { ++found_index; });
+        });
+    bctx.report("box scan", box_scan / k_queries * 1e6, "us");
+    bctx.report("box index", box_index / k_queries * 1e6, "us");
+    bctx.report("box speedup", box_scan / box_index, "x");
+    if (found_scan != found_index)
+        LOG_ERROR("box queries disagree: {} vs {}", found_scan, found_index);
+
+    // k nearest, the scan keeps a partial sort of every distance
+    std::vector<std::pair<f32, entt::entity>> all;
+    all.reserve(k_entities);
+    const f64 nearest_scan = bench::time_secs(
+        [&]
+        {
+            for (const auto& c : centers)
+            {
+                all.clear();
+                for (auto [e, pos] : registry.view<Pos3d>().each())
+                {
+                    const glm::vec3 d = pos.val - c;
+                    all.emplace_back(glm::dot(d, d), e);
+                }
+                std::ranges::partial_sort(all, all.begin() + k_k);
+            }
+        });
+    std::vector<entt::entity> out;
+    const f64                 nearest_index = bench::time_secs(
+        [&]
+        {
+            for (const auto& c : centers)
+                index->nearest(c, k_k, out);
+        });
+    bctx.report("nearest scan", nearest_scan / k_queries * 1e6, "us");
+    bctx.report("nearest index", nearest_index / k_queries * 1e6, "us");
+    bctx.report("nearest speedup", nearest_scan / nearest_index, "x");
+
+    return 0;
+}
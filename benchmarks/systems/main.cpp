@@ -0,0 +1,111 @@
+// SystemScheduler benchmark: 20 synthetic systems over 100k entities, run one after
+// another against in conflict free batches on taskflow
+
+#include <bench.h>
+#include <cmath>
+#include <engine/contexts/async/async.h>
+#include <engine/systems.h>
+#include <thread>
+
+using namespace v;
+
+namespace {
+    constexpr i32 k_entities = 100'000;
+    constexpr i32 k_executes = 50;
+
+    template <i32 N>
+    struct Comp {
+        f32 val[4];
+    };
+
+    /// A few flops per entity, so a system is memory and compute bound like a real one
+    template <i32 In, i32 Out>
+    void add_system(SystemScheduler& systems)
+    {
+        systems.add<System<Read<Comp<In>>, Write<Comp<Out>>>>(
+            std::format("c{}_to_c{}", In, Out),
+            [](auto view)
+            {
+                for (auto [e, in, out] : view.each())
+                {
+                    for (i32 i = 0; i < 4; ++i)
+                        out.val[i] = std::sqrt(out.val[i] * out.val[i] + in.val[i]);
+                }
+            });
+    }
+
+    template <i32... N>
+    void populate(entt::registry& registry, std::integer_sequence<i32, N...>)
+    {
+        for (i32 i = 0; i < k_entities; ++i)
+        {
+            const auto e = registry.create();
+            (registry.emplace<Comp<N>>(e, Comp<N>{ { 1.f, 2.f, 3.f, 4.f } }), ...);
+        }
+    }
+
+    f64 run(SystemScheduler& systems)
+    {
+        systems.execute();
+        return bench::time_secs(
+                   [&]
+                   {
+                       for (i32 i = 0; i < k_executes; ++i)
+                           systems.execute();
+                   }) /
+            k_executes;
+    }
+} // namespace
+
+int main()
+{
+    auto [engine, bctx] = bench::init_bench("systems");
+    const u16 threads   = static_cast<u16>(std::max(1u, std::thread::hardware_concurrency()));
+    auto&     executor  = engine->add_ctx<AsyncContext>(threads)->executor();
+    bctx.report("threads", threads);
+
+    entt::registry registry;
+    populate(registry, std::make_integer_sequence<i32, 12>{});
+
+    // 20 systems over 12 component types: some fan out from the same input, some chain,
+    // so the graph has both wide batches and dependencies
+    SystemScheduler systems{ registry };
+    add_system<0, 1>(systems);
+    add_system<0, 2>(systems);
+    add_system<0, 3>(systems);
+    add_system<0, 4>(systems);
+    add_system<1, 5>(systems);
+    add_system<2, 6>(systems);
+    add_system<3, 7>(systems);
+    add_system<4, 8>(systems);
+    add_system<5, 9>(systems);
+    add_system<6, 10>(systems);
+    add_system<7, 11>(systems);
+    add_system<8, 0>(systems);
+    add_system<9, 1>(systems);
+    add_system<10, 2>(systems);
+    add_system<11, 3>(systems);
+    add_system<1, 4>(systems);
+    add_system<2, 5>(systems);
+    add_system<3, 6>(systems);
+    add_system<4, 7>(systems);
+    add_system<5, 8>(systems);
+
+    bctx.report("systems", static_cast<f64>(systems.size()));
+    bctx.report("batches", static_cast<f64>(systems.batches().size()));
+    bctx.report("entities", k_entities);
+
+    systems.set_executor(nullptr);
+    const f64 serial = run(systems);
+    systems.set_executor(&executor);
+    const f64 parallel = run(systems);
+
+    const f64 updates = static_cast<f64>(k_entities) * systems.size();
+    bctx.report("serial execute", serial * 1e3, "ms");
+    bctx.report("parallel execute", parallel * 1e3, "ms");
+    bctx.report("serial throughput", updates / serial / 1e6, "M entity-systems/s");
+    bctx.report("parallel throughput", updates / parallel / 1e6, "M entity-systems/s");
+    bctx.report("speedup", serial / parallel, "x");
+
+    return 0;
+}
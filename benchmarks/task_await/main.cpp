@@ -0,0 +1,139 @@
+// Task await benchmark: a round trip from the main thread to a worker and back with a
+// result, through .then() callbacks (std::function, post_tick) against co_await on
+// the Task from a coroutine (resumed by the scheduler), one chain at a time for
+// latency and many chains at once for throughput, with allocations per round trip
+
+#include <atomic>
+#include <bench.h>
+#include <cstdlib>
+#include <engine/contexts/async/async.h>
+#include <functional>
+#include <new>
+#include <thread>
+
+using namespace v;
+
+namespace {
+    std::atomic<u64> g_allocs{ 0 };
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+    constexpr i32 k_round_trips = 20'000;
+    constexpr i32 k_chains      = 1'000;
+    constexpr i32 k_chain_len   = 100;
+
+    struct Result {
+        f64 secs;
+        u64 allocs;
+        i64 sum;
+    };
+
+    /// `chains` chains of `len` round trips each, every round trip starting when the
+    /// previous one's result is back on the main thread
+    Result callbacks(Engine& engine, AsyncContext& async, i32 chains, i32 len)
+    {
+        i64 sum       = 0;
+        i32 remaining = chains;
+
+        std::function<void(i32)> next = [&](i32 i)
+        {
+            async.task([i] { return i; })
+                .then(
+                    [&, i](i32 v)
+                    {
+                        sum += v;
+                        if (i + 1 < len)
+                            next(i + 1);
+                        else
+                            remaining--;
+                    });
+        };
+
+        const u64 before = g_allocs.load();
+        const f64 secs   = bench::time_secs(
+            [&]
+            {
+                for (i32 c = 0; c < chains; ++c)
+                    next(0);
+                while (remaining > 0)
+                {
+                    engine.tick();
+                    // on few cores a spinning main thread holds the workers up
+                    std::this_thread::yield();
+                }
+            });
+        return { secs, g_allocs.load() - before, sum };
+    }
+
+    Result awaits(Engine& engine, AsyncContext& async, i32 chains, i32 len)
+    {
+        i64 sum       = 0;
+        i32 remaining = chains;
+
+        const u64 before = g_allocs.load();
+        const f64 secs   = bench::time_secs(
+            [&]
+            {
+                for (i32 c = 0; c < chains; ++c)
+                {
+                    async.spawn(
+                        [&, len](CoroutineInterface&) -> Coroutine<void>
+                        {
+                            for (i32 i = 0; i < len; ++i)
+                                sum += co_await async.task([i] { return i; });
+                            remaining--;
+                        });
+                }
+                while (remaining > 0)
+                {
+                    engine.tick();
+                    // on few cores a spinning main thread holds the workers up
+                    std::this_thread::yield();
+                }
+            });
+        return { secs, g_allocs.load() - before, sum };
+    }
+
+    void report(
+        bench::BenchContext& bctx, const std::string& name, const Result& r, i32 trips)
+    {
+        bctx.report(name + " round trip", r.secs / trips * 1e6, "us");
+        bctx.report(name + " round trips/sec", trips / r.secs);
+        bctx.report(name + " allocs", static_cast<f64>(r.allocs) / trips, "allocs/trip");
+        bctx.report(name + " checksum", static_cast<f64>(r.sum));
+    }
+} // namespace
+
+int main()
+{
+    auto [engine, bctx] = bench::init_bench("task_await");
+    auto* async         = engine->add_ctx<AsyncContext>(2);
+    engine->on_tick.connect({}, {}, "async_coro", [async] { async->update(); });
+
+    // warm up the workers and queues
+    callbacks(*engine, *async, 16, 16);
+    awaits(*engine, *async, 16, 16);
+
+    report(bctx, "then", callbacks(*engine, *async, 1, k_round_trips), k_round_trips);
+    report(bctx, "co_await", awaits(*engine, *async, 1, k_round_trips), k_round_trips);
+
+    constexpr i32 trips = k_chains * k_chain_len;
+    const Result then_chains  = callbacks(*engine, *async, k_chains, k_chain_len);
+    const Result await_chains = awaits(*engine, *async, k_chains, k_chain_len);
+    report(bctx, "then, 1k chains", then_chains, trips);
+    report(bctx, "co_await, 1k chains", await_chains, trips);
+
+    return 0;
+}
@@ -0,0 +1,220 @@
+// Task benchmark: spawning and completing 1M tiny tasks through AsyncContext::task,
+// against the Task it replaced (std::future from executor.async, a TaskState with an
+// RwLock and std::function callbacks, rebuilt here), both waited on with get() and
+// collected through .then() on the main thread, with allocations per task
+
+#include <atomic>
+#include <bench.h>
+#include <cstdlib>
+#include <engine/contexts/async/async.h>
+#include <engine/sync.h>
+#include <functional>
+#include <future>
+#include <new>
+#include <thread>
+
+using namespace v;
+
+namespace {
+    std::atomic<u64> g_allocs{ 0 };
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+    constexpr i32 k_tasks = 1'000'000;
+    /// Tasks in flight at once when waiting with get()
+    constexpr i32 k_batch = 1'024;
+
+    /// The old Task, minus the parts that don't run here
+    struct LegacyState {
+        Engine&                                 engine;
+        std::atomic_bool                        is_completed{ false };
+        std::function<void(i32)>                callback{};
+        std::function<void(std::exception_ptr)> error_callback{};
+        std::exception_ptr                      stored_exception{};
+        RwLock<int>                             lock{};
+
+        explicit LegacyState(Engine& eng) : engine(eng) {}
+    };
+
+    struct LegacyTask {
+        std::future<i32>             future;
+        std::shared_ptr<LegacyState> state;
+
+        template <typename Callback>
+        void then(Callback&& callback)
+        {
+            auto guard = state->lock.write();
+            if (state->is_completed && !state->stored_exception)
+                state->engine.post_tick(
+                    [callback = std::forward<Callback>(callback),
+                     value    = future.get()]() mutable { callback(value); });
+            else
+                state->callback = std::forward<Callback>(callback);
+        }
+    };
+
+    LegacyTask
+    legacy_task(Engine& engine, tf::Executor& executor, std::function<i32()> func)
+    {
+        LegacyTask ret{ {}, std::make_shared<LegacyState>(engine) };
+        auto       state = ret.state;
+        ret.future       = executor.async(
+            [func, state]()
+            {
+                try
+                {
+                    i32 result = func();
+
+                    auto guard          = state->lock.write();
+                    state->is_completed = true;
+                    if (state->callback)
+                        state->engine.post_tick(
+                            [callback = std::move(state->callback), result]() mutable
+                            { callback(result); });
+                    return result;
+                }
+                catch (...)
+                {
+                    {
+                        auto guard              = state->lock.write();
+                        state->is_completed     = true;
+                        state->stored_exception = std::current_exception();
+                        if (state->error_callback)
+                            state->engine.post_tick(std::bind(
+                                state->error_callback, state->stored_exception));
+                    }
+                    throw;
+                }
+            });
+        return ret;
+    }
+
+    struct Result {
+        f64 secs;
+        u64 allocs;
+        i64 sum;
+    };
+
+    template <typename F>
+    Result measure(F&& fn)
+    {
+        i64       sum    = 0;
+        const u64 before = g_allocs.load();
+        const f64 secs   = bench::time_secs([&] { sum = fn(); });
+        return { secs, g_allocs.load() - before, sum };
+    }
+
+    void report(bench::BenchContext& bctx, const std::string& name, const Result& r)
+    {
+        bctx.report(name, r.secs / k_tasks * 1e9, "ns/task");
+        bctx.report(name + " tasks/sec", k_tasks / r.secs);
+        bctx.report(
+            name + " allocs", static_cast<f64>(r.allocs) / k_tasks, "allocs/task");
+        bctx.report(name + " checksum", static_cast<f64>(r.sum));
+    }
+
+    /// Ticks until `done` reaches k_tasks
+    void drain(Engine& engine, const i32& done)
+    {
+        while (done < k_tasks)
+        {
+            engine.tick();
+            // on few cores a spinning main thread holds the workers up
+            std::this_thread::yield();
+        }
+    }
+} // namespace
+
+int main()
+{
+    auto [engine, bctx] = bench::init_bench("tasks");
+    auto*         async = engine->add_ctx<AsyncContext>(2);
+    tf::Executor& exec  = async->executor();
+
+    const Result legacy_get = measure(
+        [&]
+        {
+            i64                     sum = 0;
+            std::vector<LegacyTask> batch;
+            batch.reserve(k_batch);
+            for (i32 i = 0; i < k_tasks; i += k_batch)
+            {
+                for (i32 j = i; j < i + k_batch && j < k_tasks; ++j)
+                    batch.push_back(legacy_task(*engine, exec, [j] { return j; }));
+                for (LegacyTask& task : batch)
+                    sum += task.future.get();
+                batch.clear();
+            }
+            return sum;
+        });
+
+    const Result task_get = measure(
+        [&]
+        {
+            i64                    sum = 0;
+            std::vector<Task<i32>> batch;
+            batch.reserve(k_batch);
+            for (i32 i = 0; i < k_tasks; i += k_batch)
+            {
+                for (i32 j = i; j < i + k_batch && j < k_tasks; ++j)
+                    batch.push_back(async->task([j] { return j; }));
+                for (Task<i32>& task : batch)
+                    sum += task.get();
+                batch.clear();
+            }
+            return sum;
+        });
+
+    const Result legacy_then = measure(
+        [&]
+        {
+            i64 sum  = 0;
+            i32 done = 0;
+            for (i32 i = 0; i < k_tasks; ++i)
+                legacy_task(*engine, exec, [i] { return i; })
+                    .then(
+                        [&](i32 v)
+                        {
+                            sum += v;
+                            done++;
+                        });
+            drain(*engine, done);
+            return sum;
+        });
+
+    const Result task_then = measure(
+        [&]
+        {
+            i64 sum  = 0;
+            i32 done = 0;
+            for (i32 i = 0; i < k_tasks; ++i)
+                async->task([i] { return i; })
+                    .then(
+                        [&](i32 v)
+                        {
+                            sum += v;
+                            done++;
+                        });
+            drain(*engine, done);
+            return sum;
+        });
+
+    report(bctx, "legacy get", legacy_get);
+    report(bctx, "task get", task_get);
+    report(bctx, "legacy then", legacy_then);
+    report(bctx, "task then", task_then);
+
+    return 0;
+}
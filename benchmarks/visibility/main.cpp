@@ -0,0 +1,126 @@
+// Chunk culling benchmark: a 32 chunk view distance over flat terrain with solid rock
+// and tunnels underneath, culled from above the surface and from inside a cave
+
+#include <bench.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <world/visibility.h>
+
+using namespace v;
+
+namespace {
+    constexpr i32 k_view   = 32;
+    constexpr i32 k_depth  = 6;
+    constexpr i32 k_frames = 500;
+    constexpr u16 k_stone  = 1;
+
+    glm::mat4 look(const glm::vec3& eye, const glm::vec3& target)
+    {
+        return glm::perspective(glm::radians(70.f), 16.f / 9.f, 0.1f, 8000.f) *
+            glm::lookAt(eye, target, glm::vec3{ 0, 1, 0 });
+    }
+
+    // a layer of surface chunks with pillars on top of k_depth layers of solid rock,
+    // every 4th row of rock has a tunnel running along x
+    void generate(WorldDomain& world)
+    {
+        constexpr i32 k = ChunkDomain::k_size;
+        for (i32 cz = -k_view; cz <= k_view; ++cz)
+        {
+            for (i32 cx = -k_view; cx <= k_view; ++cx)
+            {
+                auto& surface = world.get_or_create_chunk({ cx, 0, cz });
+                for (i32 i = 0; i < 4; ++i)
+                    for (i32 y = 0; y < 24; ++y)
+                        surface.set({ 16 + i * 29, y, 40 + i * 17 }, k_stone);
+
+                for (i32 cy = -k_depth; cy < 0; ++cy)
+                {
+                    auto& rock = world.get_or_create_chunk({ cx, cy, cz });
+                    rock.svo().fill(k_stone);
+                    if (cz % 4 != 0 || cy != -2)
+                        continue;
+                    for (i32 x = 0; x < k; ++x)
+                        for (i32 y = 56; y < 72; ++y)
+                            for (i32 z = 56; z < 72; ++z)
+                                rock.set({ x, y, z }, 0);
+                }
+            }
+        }
+    }
+
+    struct Result {
+        CullStats stats;
+        f64       first_us;
+    };
+
+    /// Culls k_frames frames while slowly turning the camera, returns the averages
+    Result run(ChunkCuller& culler, const WorldDomain& world, const glm::vec3& eye)
+    {
+        culler.invalidate();
+        Result result{};
+
+        const auto frame = [&](i32 i)
+        {
+            const f32       a = static_cast<f32>(i) * 0.01f;
+            const glm::vec3 dir{ std::cos(a), -0.1f, std::sin(a) };
+            culler.cull(world, look(eye, eye + dir), eye);
+        };
+
+        // the first frame computes connectivity for every reached chunk
+        frame(0);
+        result.first_us = culler.stats().total_us;
+
+        for (i32 i = 1; i <= k_frames; ++i)
+        {
+            frame(i);
+            const CullStats& s = culler.stats();
+            result.stats.in_range += s.in_range;
+            result.stats.frustum_culled += s.frustum_culled;
+            result.stats.occlusion_culled += s.occlusion_culled;
+            result.stats.visible += s.visible;
+            result.stats.connectivity_rebuilds += s.connectivity_rebuilds;
+            result.stats.frustum_us += s.frustum_us;
+            result.stats.occlusion_us += s.occlusion_us;
+            result.stats.total_us += s.total_us;
+        }
+        return result;
+    }
+
+    void report(bench::BenchContext& bctx, const std::string& name, const Result& r)
+    {
+        const auto avg = [](f64 total) { return total / k_frames; };
+        bctx.report(name + " in range", avg(r.stats.in_range), "chunks");
+        bctx.report(name + " frustum culled", avg(r.stats.frustum_culled), "chunks");
+        bctx.report(name + " occlusion culled", avg(r.stats.occlusion_culled), "chunks");
+        bctx.report(name + " visible", avg(r.stats.visible), "chunks");
+        bctx.report(name + " rebuilds", avg(r.stats.connectivity_rebuilds), "chunks");
+        bctx.report(name + " frustum", avg(r.stats.frustum_us), "us/frame");
+        bctx.report(name + " occlusion", avg(r.stats.occlusion_us), "us/frame");
+        bctx.report(name + " total", avg(r.stats.total_us), "us/frame");
+        bctx.report(name + " first frame", r.first_us, "us");
+    }
+} // namespace
+
+int main()
+{
+    auto [engine, bctx] = bench::init_bench("visibility");
+
+    auto& world = engine->add_domain<WorldDomain>();
+    world.set_cache_config({ .memory_budget = 0 });
+    generate(world);
+    bctx.report("chunks loaded", world.chunk_count());
+
+    ChunkCuller culler{ { .view_distance = k_view } };
+    ChunkCuller frustum_only{ { .view_distance = k_view, .occlusion = false } };
+
+    // just above the surface, and inside the tunnel two chunks down
+    const glm::vec3 surface{ 64, 150, 64 };
+    const glm::vec3 cave{ 64, -2 * ChunkDomain::k_size + 64, 64 };
+
+    report(bctx, "surface", run(culler, world, surface));
+    report(bctx, "surface frustum only", run(frustum_only, world, surface));
+    report(bctx, "cave", run(culler, world, cave));
+    report(bctx, "cave frustum only", run(frustum_only, world, cave));
+
+    return 0;
+}
@@ -0,0 +1,262 @@
+// Voxel store microbenchmarks: set, get, box fill, iteration and clear on every store,
+// over fixed seed random, clustered and terrain-like workloads inside a 128^3 volume,
+// with the memory each ends up holding per solid voxel. A new store only needs an
+// adapter below and a line in main().
+//
+// usage: vbench-vox_store [--json path] [--csv path]
+
+#include <bench.h>
+#include <cmath>
+#include <cstring>
+#include <vox/store/64tree.h>
+#include <vox/store/svo.h>
+
+using namespace v;
+
+namespace {
+    constexpr i32 k_extent = 128;
+    constexpr i32 k_gets   = 1'000'000;
+    constexpr i32 k_boxes  = 64;
+    constexpr u64 k_seed   = 1234;
+
+    struct Voxel {
+        i32 x, y, z;
+        u8  value;
+    };
+
+    // adapters, so every store is driven through the same calls. iterate() counts
+    // solid voxels the fastest way the store offers
+
+    struct Tree64Store {
+        static constexpr const char* name = "Sparse64Tree";
+
+        // depth 4 covers 256^3, the workloads only use the low 128^3
+        Sparse64Tree tree{ 4 };
+
+        FORCEINLINE void set(i32 x, i32 y, i32 z, u8 v) { tree.set_voxel(x, y, z, v); }
+        FORCEINLINE u8   get(i32 x, i32 y, i32 z) const
+        {
+            return tree.get_voxel(x, y, z);
+        }
+
+        void fill_box(glm::ivec3 min, glm::ivec3 max, u8 v)
+        {
+            tree.fill_aabb(AABB(glm::vec3(min), glm::vec3(max)), v);
+        }
+
+        // no leaf walk yet, so a dense sweep
+        u64 iterate() const
+        {
+            u64 solid = 0;
+            for (i32 y = 0; y < k_extent; ++y)
+                for (i32 z = 0; z < k_extent; ++z)
+                    for (i32 x = 0; x < k_extent; ++x)
+                        solid += tree.get_voxel(x, y, z) != 0;
+            return solid;
+        }
+
+        void  clear() { tree.clear(); }
+        usize bytes() const { return tree.memory_usage(); }
+    };
+
+    struct Svo128Store {
+        static constexpr const char* name = "SparseVoxelOctree128";
+
+        SparseVoxelOctree128 svo;
+
+        FORCEINLINE void set(i32 x, i32 y, i32 z, u8 v) { svo.set(x, y, z, v); }
+        FORCEINLINE u8   get(i32 x, i32 y, i32 z) const
+        {
+            return static_cast<u8>(svo.get(x, y, z));
+        }
+
+        // no region fill, one set per voxel
+        void fill_box(glm::ivec3 min, glm::ivec3 max, u8 v)
+        {
+            for (i32 y = min.y; y < max.y; ++y)
+                for (i32 z = min.z; z < max.z; ++z)
+                    for (i32 x = min.x; x < max.x; ++x)
+                        svo.set(x, y, z, v);
+        }
+
+        u64 iterate() const
+        {
+            u64 solid = 0;
+            svo.for_each_leaf([&](i32, i32, i32, i32 size, u16)
+                              { solid += static_cast<u64>(size) * size * size; });
+            return solid;
+        }
+
+        void  clear() { svo.clear(); }
+        usize bytes() const { return svo.memory_usage(); }
+    };
+
+    FORCEINLINE i32 rand_coord(i32 max = k_extent - 1)
+    {
+        return static_cast<i32>(rand::urange(0, max));
+    }
+
+    std::vector<Voxel> random_workload()
+    {
+        rand::seed(k_seed);
+        std::vector<Voxel> voxels(200'000);
+        for (Voxel& v : voxels)
+            v = { rand_coord(), rand_coord(), rand_coord(),
+                  static_cast<u8>(rand::urange(1, 7)) };
+        return voxels;
+    }
+
+    // what building looks like: solid boxes, a handful of block types
+    std::vector<Voxel> clustered_workload()
+    {
+        rand::seed(k_seed);
+        std::vector<Voxel> voxels;
+        while (voxels.size() < 200'000)
+        {
+            const i32 ext = static_cast<i32>(rand::urange(2, 16));
+            const i32 ox  = rand_coord(k_extent - ext);
+            const i32 oy  = rand_coord(k_extent - ext);
+            const i32 oz  = rand_coord(k_extent - ext);
+            const u8  v   = static_cast<u8>(rand::urange(1, 3));
+            for (i32 y = oy; y < oy + ext; ++y)
+                for (i32 z = oz; z < oz + ext; ++z)
+                    for (i32 x = ox; x < ox + ext; ++x)
+                        voxels.push_back({ x, y, z, v });
+        }
+        return voxels;
+    }
+
+    // rolling hills, stone under a few layers of dirt under grass
+    std::vector<Voxel> terrain_workload()
+    {
+        std::vector<Voxel> voxels;
+        for (i32 z = 0; z < k_extent; ++z)
+        {
+            for (i32 x = 0; x < k_extent; ++x)
+            {
+                const f64 h = 48 + 12 * std::sin(x * 0.07) * std::cos(z * 0.05) +
+                    5 * std::sin((x + z) * 0.21);
+                const i32 top = static_cast<i32>(h);
+                for (i32 y = 0; y <= top; ++y)
+                {
+                    const u8 v = y == top ? 3 : (y > top - 4 ? 2 : 1);
+                    voxels.push_back({ x, y, z, v });
+                }
+            }
+        }
+        return voxels;
+    }
+
+    template <typename Store>
+    void
+    run(bench::BenchContext& bctx, const char* workload, const std::vector<Voxel>& voxels)
+    {
+        const std::string prefix = std::format("{} {}", Store::name, workload);
+        const f64         n      = static_cast<f64>(voxels.size());
+
+        Store     store;
+        const f64 set_secs = bench::time_secs(
+            [&]
+            {
+                for (const Voxel& v : voxels)
+                    store.set(v.x, v.y, v.z, v.value);
+            });
+        bctx.report(prefix + " set", set_secs / n * 1e9, "ns/voxel");
+
+        // same points for every store, half of them on solid voxels
+        rand::seed(k_seed + 1);
+        u64       checksum = 0;
+        const f64 get_secs = bench::time_secs(
+            [&]
+            {
+                for (i32 i = 0; i < k_gets; ++i)
+                {
+                    const Voxel& on = voxels[rand::urange(0, voxels.size() - 1)];
+                    const i32    x = rand_coord(), y = rand_coord(), z = rand_coord();
+                    checksum += i % 2 ? store.get(on.x, on.y, on.z) : store.get(x, y, z);
+                }
+            });
+        bctx.report(prefix + " get", get_secs / k_gets * 1e9, "ns/get");
+
+        u64       solid     = 0;
+        const f64 iter_secs = bench::time_secs([&] { solid = store.iterate(); });
+        bctx.report(prefix + " iterate", iter_secs * 1e3, "ms");
+        bctx.report(prefix + " solid", static_cast<f64>(solid), "voxels");
+        bctx.report(prefix + " memory", static_cast<f64>(store.bytes()), "B");
+        bctx.report(
+            prefix + " bytes/voxel",
+            static_cast<f64>(store.bytes()) / std::max<f64>(static_cast<f64>(solid), 1),
+            "B");
+
+        const f64 clear_secs = bench::time_secs([&] { store.clear(); });
+        bctx.report(prefix + " clear", clear_secs * 1e3, "ms");
+        bctx.report(prefix + " checksum", static_cast<f64>(checksum));
+    }
+
+    /// Boxes from 4^3 up to 32^3 into an empty store
+    template <typename Store>
+    void run_fill(bench::BenchContext& bctx)
+    {
+        rand::seed(k_seed + 2);
+        Store store;
+        f64   volume = 0;
+
+        const f64 secs = bench::time_secs(
+            [&]
+            {
+                for (i32 i = 0; i < k_boxes; ++i)
+                {
+                    const i32        ext = 4 << (i % 4);
+                    const glm::ivec3 min{ rand_coord(k_extent - ext),
+                                          rand_coord(k_extent - ext),
+                                          rand_coord(k_extent - ext) };
+                    store.fill_box(min, min + ext, static_cast<u8>(1 + i % 3));
+                    volume += static_cast<f64>(ext) * ext * ext;
+                }
+            });
+
+        const std::string prefix = std::format("{} fill_box", Store::name);
+        bctx.report(prefix, secs / k_boxes * 1e6, "us/box");
+        bctx.report(prefix + " throughput", volume / secs / 1e6, "M voxels/s");
+    }
+
+    template <typename Store>
+    void run_all(
+        bench::BenchContext& bctx, const std::vector<Voxel>& random,
+        const std::vector<Voxel>& clustered, const std::vector<Voxel>& terrain)
+    {
+        run<Store>(bctx, "random", random);
+        run<Store>(bctx, "clustered", clustered);
+        run<Store>(bctx, "terrain", terrain);
+        run_fill<Store>(bctx);
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    auto [engine, bctx] = bench::init_bench("vox_store");
+
+    const std::vector<Voxel> random    = random_workload();
+    const std::vector<Voxel> clustered = clustered_workload();
+    const std::vector<Voxel> terrain   = terrain_workload();
+    bctx.report("random voxels", static_cast<f64>(random.size()));
+    bctx.report("clustered voxels", static_cast<f64>(clustered.size()));
+    bctx.report("terrain voxels", static_cast<f64>(terrain.size()));
+
+    run_all<Tree64Store>(bctx, random, clustered, terrain);
+    run_all<Svo128Store>(bctx, random, clustered, terrain);
+
+    for (i32 i = 1; i + 1 < argc; i += 2)
+    {
+        const std::string path = argv[i + 1];
+        bool              ok   = true;
+        if (std::strcmp(argv[i], "--json") == 0)
+            ok = bctx.write_json(path);
+        else if (std::strcmp(argv[i], "--csv") == 0)
+            ok = bctx.write_csv(path);
+        if (!ok)
+            LOG_ERROR("[vox_store] couldn't write {}", path);
+    }
+
+    return 0;
+}
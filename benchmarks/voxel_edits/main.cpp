@@ -0,0 +1,99 @@
+// Voxel edit codec benchmark: bytes/edit and throughput for random and clustered
+// edit patterns, compared to a flat (3 byte index + 2 byte value) encoding
+
+#include <bench.h>
+#include <format>
+#include <world/edit_codec.h>
+
+using namespace v;
+
+namespace {
+    constexpr usize k_flat_bytes_per_edit = 5;
+    constexpr i32   k_reps                = 50;
+
+    std::vector<ChunkEdit> random_edits(usize n)
+    {
+        std::vector<ChunkEdit> edits;
+        edits.reserve(n);
+        for (usize i = 0; i < n; ++i)
+        {
+            edits.push_back({ static_cast<u32>(rand::urange(0, (1u << 21) - 1)),
+                              static_cast<u16>(rand::urange(1, 8)) });
+        }
+        return edits;
+    }
+
+    // what a player actually does: dig/fill boxes, a handful of block types
+    std::vector<ChunkEdit> clustered_edits(usize n)
+    {
+        std::vector<ChunkEdit> edits;
+        edits.reserve(n);
+        while (edits.size() < n)
+        {
+            const i32 ox  = static_cast<i32>(rand::urange(0, 111));
+            const i32 oy  = static_cast<i32>(rand::urange(0, 111));
+            const i32 oz  = static_cast<i32>(rand::urange(0, 111));
+            const i32 ext = static_cast<i32>(rand::urange(2, 16));
+            const u16 v   = static_cast<u16>(rand::urange(0, 3));
+            for (i32 z = oz; z < oz + ext && edits.size() < n; ++z)
+                for (i32 y = oy; y < oy + ext && edits.size() < n; ++y)
+                    for (i32 x = ox; x < ox + ext && edits.size() < n; ++x)
+                        edits.push_back({ ChunkEdit::pack({ x, y, z }), v });
+        }
+        return edits;
+    }
+
+    void run(bench::BenchContext& bctx, const char* pattern, std::vector<ChunkEdit> edits)
+    {
+        const usize n = edits.size();
+
+        std::vector<ChunkEdit> scratch;
+        std::vector<std::byte> bytes;
+
+        const f64 encode_secs = bench::time_secs(
+            [&]
+            {
+                for (i32 i = 0; i < k_reps; ++i)
+                {
+                    scratch = edits;
+                    VoxelEditCodec::normalize(scratch);
+                    bytes.clear();
+                    ByteWriter w{ bytes };
+                    VoxelEditCodec::encode(w, scratch);
+                }
+            });
+
+        std::vector<ChunkEdit> decoded;
+        const f64              decode_secs = bench::time_secs(
+            [&]
+            {
+                for (i32 i = 0; i < k_reps; ++i)
+                {
+                    decoded.clear();
+                    ByteReader r{ reinterpret_cast<const u8*>(bytes.data()), bytes.size() };
+                    VoxelEditCodec::decode(r, decoded);
+                }
+            });
+
+        const std::string prefix = std::format("{} x{}", pattern, n);
+        bctx.report(prefix + " bytes/edit", static_cast<f64>(bytes.size()) / n, "B");
+        bctx.report(
+            prefix + " vs flat", 100.0 * bytes.size() / (n * k_flat_bytes_per_edit), "%");
+        bctx.report(prefix + " encode", encode_secs / k_reps / n * 1e9, "ns/edit");
+        bctx.report(prefix + " decode", decode_secs / k_reps / n * 1e9, "ns/edit");
+    }
+} // namespace
+
+int main()
+{
+    auto [engine, bctx] = bench::init_bench("voxel_edits");
+    rand::seed(1234);
+
+    for (usize n : { 16, 256, 4096, 65536 })
+    {
+        run(bctx, "random", random_edits(n));
+        run(bctx, "clustered", clustered_edits(n));
+    }
+
+    return 0;
+}
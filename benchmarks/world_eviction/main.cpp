@@ -0,0 +1,131 @@
+// Chunk eviction benchmark: players walking through a generated world under a
+// memory budget
+
+#include <bench.h>
+#include <cmath>
+#include <world/world.h>
+
+using namespace v;
+
+namespace {
+    constexpr i32   k_players        = 4;
+    constexpr i32   k_ticks          = 2000;
+    constexpr i32   k_view_radius    = 2; // chunks generated around each player
+    constexpr f32   k_walk_speed     = 16.f; // voxels per tick
+    constexpr usize k_memory_budget  = 64ull << 20;
+    constexpr i32   k_chunk_size     = WorldDomain::k_chunk_size;
+
+    // cheap deterministic heightmap, two voxels thick so the svo doesn't collapse
+    void generate_chunk(ChunkDomain& chunk)
+    {
+        const ChunkPos cp = chunk.pos();
+        for (i32 x = 0; x < k_chunk_size; ++x)
+        {
+            for (i32 z = 0; z < k_chunk_size; ++z)
+            {
+                const f32 wx = static_cast<f32>(cp.x * k_chunk_size + x);
+                const f32 wz = static_cast<f32>(cp.z * k_chunk_size + z);
+                const i32 h  = 64 + static_cast<i32>(
+                                       std::sin(wx * 0.05f) * 20.f +
+                                       std::cos(wz * 0.07f) * 20.f);
+                chunk.set({ x, h, z }, 1);
+                chunk.set({ x, h - 1, z }, 2);
+            }
+        }
+    }
+} // namespace
+
+int main()
+{
+    auto [engine, bctx] = bench::init_bench("world_eviction");
+    rand::seed(1234);
+
+    auto& world = engine->add_domain<WorldDomain>();
+
+    ChunkCacheConfig config{};
+    config.memory_budget = k_memory_budget;
+    world.set_cache_config(config);
+
+    // pretend to persist chunks, generated terrain marks them dirty
+    usize saved_bytes = 0;
+    world.set_chunk_saver([&](const ChunkDomain& chunk)
+                          { saved_bytes += chunk.memory_usage(); });
+
+    struct Walker {
+        entt::entity entity;
+        glm::vec3    dir;
+    };
+    std::vector<Walker> walkers;
+    for (i32 i = 0; i < k_players; ++i)
+    {
+        auto e = engine->registry().create();
+        engine->registry().emplace<Pos3d>(e, glm::vec3{ i * 512.f, 64.f, 0.f });
+        engine->registry().emplace<ChunkAnchor>(e, k_view_radius);
+        walkers.push_back({ e, glm::vec3{ 1.f, 0.f, 0.f } });
+    }
+
+    f64 gen_secs = 0;
+    u64 generated = 0;
+
+    Stopwatch total_sw{};
+    for (i32 tick = 0; tick < k_ticks; ++tick)
+    {
+        for (auto& w : walkers)
+        {
+            auto& pos = engine->registry().get<Pos3d>(w.entity).val;
+
+            // wander: pick a new horizontal direction every so often
+            if (rand::chance(0.01))
+            {
+                const f32 angle = static_cast<f32>(rand::frange(0.0, 6.283185307));
+                w.dir           = glm::vec3{ std::cos(angle), 0.f, std::sin(angle) };
+            }
+            pos += w.dir * k_walk_speed;
+
+            auto [center, _] = WorldDomain::world_to_chunk(
+                { static_cast<i32>(std::floor(pos.x)), 64,
+                  static_cast<i32>(std::floor(pos.z)) });
+
+            for (i32 dx = -k_view_radius; dx <= k_view_radius; ++dx)
+            {
+                for (i32 dz = -k_view_radius; dz <= k_view_radius; ++dz)
+                {
+                    const ChunkPos cp{ center.x + dx, 0, center.z + dz };
+                    if (world.try_get_chunk(cp))
+                        continue;
+
+                    gen_secs += bench::time_secs(
+                        [&] { generate_chunk(world.get_or_create_chunk(cp)); });
+                    generated++;
+                }
+            }
+        }
+
+        engine->tick();
+    }
+    const f64 total_secs = total_sw.elapsed();
+
+    const auto& stats   = world.cache_stats();
+    const u64   lookups = stats.hits + stats.misses;
+
+    bctx.report("ticks", k_ticks);
+    bctx.report("avg tick", total_secs / k_ticks * 1e3, "ms");
+    bctx.report("chunks generated", static_cast<f64>(generated));
+    bctx.report("generation time", gen_secs, "s");
+    bctx.report("chunks loaded at end", static_cast<f64>(world.chunk_count()));
+    bctx.report("memory budget", k_memory_budget / (1024.0 * 1024.0), "MiB");
+    bctx.report("peak chunk memory", stats.peak_memory_bytes / (1024.0 * 1024.0), "MiB");
+    bctx.report("peak rss", bench::peak_rss_bytes() / (1024.0 * 1024.0), "MiB");
+    bctx.report("evictions", static_cast<f64>(stats.evictions));
+    bctx.report("saves", static_cast<f64>(stats.saves));
+    bctx.report("saved", saved_bytes / (1024.0 * 1024.0), "MiB");
+    bctx.report(
+        "hit rate", lookups ? 100.0 * static_cast<f64>(stats.hits) / lookups : 0.0, "%");
+    bctx.report("evict passes", static_cast<f64>(stats.evict_passes));
+    bctx.report(
+        "avg evict pass",
+        stats.evict_passes ? stats.evict_secs / stats.evict_passes * 1e3 : 0.0, "ms");
+    bctx.report("evict overhead", stats.evict_secs / total_secs * 100.0, "% of run");
+
+    return 0;
+}
@@ -12,6 +12,8 @@
 #include <net/channels.h>
 #include <render/mandelbulb_renderer.h>
 #include <render/triangle_domain.h>
+#include <world/light.h>
+#include <world/streaming.h>
 #include <world/world.h>
 #include "engine/contexts/async/async.h"
 #include "engine/contexts/async/coro_interface.h"
@@ -73,24 +75,35 @@ namespace v {
         msg.msg = "hi server man";
         channel.send(msg);
 
-        // windows update task does not depend on anything
+        // local copy of the world, streamed from the server
+        engine_.add_domain<WorldDomain>();
+        auto& receiver = engine_.add_domain<ChunkReceiver>();
+        engine_.add_domain<LightEngine>();
+        receiver.attach(connection_);
+
+        // windows update task does not depend on anything, SDL wants the main thread
         engine_.on_tick.connect(
             {}, {}, "windows",
             [this]()
             {
                 window_ctx_->update();
                 sdl_ctx_->update();
-            });
+            },
+            TaskAffinity::main_thread);
 
         // render depends on the window input update task to be finished
         engine_.on_tick.connect(
-            { "windows" }, {}, "render", [this]() { render_ctx_->update(); });
+            { "windows" }, {}, "render", [this]() { render_ctx_->update(); },
+            TaskAffinity::main_thread);
 
         // network update task does not depend on anything
         engine_.on_tick.connect({}, {}, "network", [this]() { net_ctx_->update(); });
 
         // async coroutine scheduler update
-        engine_.on_tick.connect({}, {}, "async", [async_ctx]() { async_ctx->update(); });
+        // resumes coroutines that expect the main thread
+        engine_.on_tick.connect(
+            {}, {}, "async", [async_ctx]() { async_ctx->update(); },
+            TaskAffinity::main_thread);
 
         // handle the sdl quit event (includes keyboard interrupt)
         sdl_ctx_->quit().connect([this]() { running_ = false; });
@@ -0,0 +1,169 @@
+//
+// Lightweight benchmark utilities, the counterpart of test.h
+//
+
+#pragma once
+
+#include <cmath>
+#include <defs.h>
+#include <engine/engine.h>
+#include <format>
+#include <fstream>
+#include <prelude.h>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+namespace v::bench {
+    /// Peak resident set size of this process in bytes, 0 if unavailable
+    inline usize peak_rss_bytes()
+    {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS pmc{};
+        if (K32GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+            return pmc.PeakWorkingSetSize;
+        return 0;
+#else
+        rusage usage{};
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0;
+    #ifdef __APPLE__
+        return static_cast<usize>(usage.ru_maxrss);
+    #else
+        // linux reports kilobytes
+        return static_cast<usize>(usage.ru_maxrss) * 1024;
+    #endif
+#endif
+    }
+
+    /// Time a callable, in seconds
+    template <typename F>
+    f64 time_secs(F&& f)
+    {
+        Stopwatch sw{};
+        f();
+        return sw.elapsed();
+    }
+
+    struct Metric {
+        std::string name;
+        f64         value;
+        std::string unit;
+    };
+
+    struct BenchContext {
+        const char*         name{ "bench" };
+        Engine&             engine;
+        std::vector<Metric> metrics{};
+
+        BenchContext(Engine& eng, const char* bench_name = "bench") :
+            name(bench_name), engine(eng)
+        {
+            LOG_INFO("[{}] bench start", name);
+        }
+
+        ~BenchContext()
+        {
+            LOG_INFO("[{}] results:", name);
+            for (const auto& m : metrics)
+                LOG_INFO("[{}]   {:<32} {:>16.3f} {}", name, m.name, m.value, m.unit);
+        }
+
+        /// Record a result, printed when the context is destroyed
+        void report(std::string metric, f64 value, std::string unit = "")
+        {
+            LOG_DEBUG("[{}] {} = {} {}", name, metric, value, unit);
+            metrics.push_back({ std::move(metric), value, std::move(unit) });
+        }
+
+        /// Every metric reported so far, for regression tracking:
+        /// {"bench": name, "metrics": [{"name", "value", "unit"}, ...]}
+        std::string to_json() const
+        {
+            const auto quoted = [](std::string_view str)
+            {
+                std::string out = "\"";
+                for (const char c : str)
+                {
+                    if (c == '"' || c == '\\')
+                        out += '\\';
+                    out += c;
+                }
+                return out + '"';
+            };
+
+            std::string out =
+                std::format("{{\"bench\": {}, \"metrics\": [", quoted(name));
+            for (usize i = 0; i < metrics.size(); ++i)
+            {
+                const Metric& m = metrics[i];
+                out += std::format(
+                    "{}\n  {{\"name\": {}, \"value\": {}, \"unit\": {}}}",
+                    i ? "," : "", quoted(m.name), std::isfinite(m.value) ? m.value : 0.0,
+                    quoted(m.unit));
+            }
+            return out + "\n]}\n";
+        }
+
+        /// Every metric reported so far as bench,name,value,unit rows, with a header
+        std::string to_csv() const
+        {
+            // names are ours, but may still have commas in them
+            const auto field = [](std::string_view str)
+            {
+                if (str.find_first_of(",\"") == std::string_view::npos)
+                    return std::string{ str };
+                std::string out = "\"";
+                for (const char c : str)
+                {
+                    if (c == '"')
+                        out += '"';
+                    out += c;
+                }
+                return out + '"';
+            };
+
+            std::string out = "bench,name,value,unit\n";
+            for (const Metric& m : metrics)
+            {
+                out += std::format(
+                    "{},{},{},{}\n", field(name), field(m.name), m.value, field(m.unit));
+            }
+            return out;
+        }
+
+        /// Writes to_json() to a file, false if it couldn't be written
+        bool write_json(const std::string& path) const
+        {
+            std::ofstream file{ path };
+            file << to_json();
+            return static_cast<bool>(file);
+        }
+
+        /// Writes to_csv() to a file, false if it couldn't be written
+        bool write_csv(const std::string& path) const
+        {
+            std::ofstream file{ path };
+            file << to_csv();
+            return static_cast<bool>(file);
+        }
+    };
+
+    // Initialize core subsystems and return a fresh engine with bench context
+    inline std::pair<std::unique_ptr<Engine>, BenchContext>
+    init_bench(const char* name = "vbench")
+    {
+        v::init(name);
+
+        auto    engine_ptr = std::make_unique<Engine>();
+        Engine& engine_ref = *engine_ptr;
+        return { std::piecewise_construct, std::forward_as_tuple(std::move(engine_ptr)),
+                 std::forward_as_tuple(engine_ref, name) };
+    }
+} // namespace v::bench
@@ -0,0 +1,132 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <defs.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace v {
+    /// A move-only void() callable that stores small callables in place instead of on
+    /// the heap like std::function does. Anything up to inline_size bytes that can be
+    /// moved without throwing lives inline, bigger callables cost one allocation.
+    /// Sized to a cache line so a queue of them packs tightly.
+    class InlineFn {
+    public:
+        static constexpr usize inline_size = 48;
+
+        InlineFn() noexcept = default;
+        InlineFn(std::nullptr_t) noexcept {}
+
+        template <typename F>
+            requires(
+                !std::is_same_v<std::decay_t<F>, InlineFn> &&
+                std::is_invocable_v<std::decay_t<F>&>)
+        InlineFn(F&& fn)
+        {
+            using Fn = std::decay_t<F>;
+
+            // an empty std::function or null function pointer stays empty
+            if constexpr (requires(const Fn& f) { f == nullptr; })
+            {
+                if (fn == nullptr)
+                    return;
+            }
+
+            if constexpr (fits_inline<Fn>)
+            {
+                ::new (static_cast<void*>(storage_)) Fn(std::forward<F>(fn));
+                ops_ = &inline_ops<Fn>;
+            }
+            else
+            {
+                ::new (static_cast<void*>(storage_)) Fn*(new Fn(std::forward<F>(fn)));
+                ops_ = &heap_ops<Fn>;
+            }
+        }
+
+        InlineFn(InlineFn&& other) noexcept { take(other); }
+
+        InlineFn& operator=(InlineFn&& other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                take(other);
+            }
+            return *this;
+        }
+
+        InlineFn(const InlineFn&)            = delete;
+        InlineFn& operator=(const InlineFn&) = delete;
+
+        ~InlineFn() { reset(); }
+
+        FORCEINLINE void operator()() { ops_->invoke(storage_); }
+
+        FORCEINLINE explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+        /// Destroys the callable (and whatever it captured) right away
+        FORCEINLINE void reset() noexcept
+        {
+            if (ops_)
+            {
+                ops_->destroy(storage_);
+                ops_ = nullptr;
+            }
+        }
+
+        /// Whether F would be stored without allocating
+        template <typename F>
+        static constexpr bool fits_inline = sizeof(F) <= inline_size &&
+            alignof(F) <= alignof(std::max_align_t) &&
+            std::is_nothrow_move_constructible_v<F>;
+
+    private:
+        struct Ops {
+            void (*invoke)(void* self);
+            /// Move constructs into dst and destroys src
+            void (*relocate)(void* dst, void* src) noexcept;
+            void (*destroy)(void* self) noexcept;
+        };
+
+        template <typename Fn>
+        static constexpr Ops inline_ops{
+            [](void* self) { (*std::launder(static_cast<Fn*>(self)))(); },
+            [](void* dst, void* src) noexcept
+            {
+                Fn* from = std::launder(static_cast<Fn*>(src));
+                ::new (dst) Fn(std::move(*from));
+                from->~Fn();
+            },
+            [](void* self) noexcept { std::launder(static_cast<Fn*>(self))->~Fn(); },
+        };
+
+        template <typename Fn>
+        static constexpr Ops heap_ops{
+            [](void* self) { (**std::launder(static_cast<Fn**>(self)))(); },
+            [](void* dst, void* src) noexcept
+            { ::new (dst) Fn*(*std::launder(static_cast<Fn**>(src))); },
+            [](void* self) noexcept { delete *std::launder(static_cast<Fn**>(self)); },
+        };
+
+        FORCEINLINE void take(InlineFn& other) noexcept
+        {
+            if (other.ops_)
+            {
+                other.ops_->relocate(storage_, other.storage_);
+                ops_       = other.ops_;
+                other.ops_ = nullptr;
+            }
+        }
+
+        const Ops* ops_{ nullptr };
+        alignas(std::max_align_t) std::byte storage_[inline_size];
+    };
+
+    static_assert(sizeof(InlineFn) <= 64);
+} // namespace v
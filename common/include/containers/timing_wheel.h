@@ -0,0 +1,274 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <defs.h>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace v {
+    /// Hierarchical timing wheel: timers bucketed by tick (resolution_ns wide) into
+    /// k_levels wheels of k_slots slots, each level 256x coarser than the one below.
+    /// Scheduling and cancelling are O(1). Advancing only visits ticks that have timers
+    /// to fire or move down a level (found through a bitmap of non-empty slots per
+    /// level), and each timer moves down at most k_levels - 1 times. Timers never fire
+    /// early, and fire at most one tick late.
+    ///
+    /// Nodes live in one vector and are recycled, so a warmed up wheel doesn't allocate.
+    template <typename T>
+    class TimingWheel {
+    public:
+        /// Returned by schedule(), stays valid (for cancel()) until the timer fires or is
+        /// cancelled. Ids are never reused while they're valid.
+        using Id = u64;
+
+        static constexpr u32 k_level_bits = 8;
+        static constexpr u32 k_slots      = 1u << k_level_bits;
+        static constexpr u32 k_levels     = 4;
+
+        /// @param resolution_ns The width of a tick
+        /// @param start_ns The time the first advance() counts from
+        explicit TimingWheel(u64 resolution_ns, u64 start_ns = 0) :
+            resolution_ns_(resolution_ns), next_tick_(start_ns / resolution_ns + 1),
+            horizon_(next_tick_ - 1)
+        {
+            for (auto& level : heads_)
+                level.fill(k_null);
+        }
+
+        /// Schedule value to fire on the first advance() at or past deadline_ns.
+        /// Scheduling from inside an advance() callback never fires in that same
+        /// advance(), even if the deadline already passed.
+        Id schedule(u64 deadline_ns, T value)
+        {
+            u32 idx;
+            if (free_ != k_null)
+            {
+                idx   = free_;
+                free_ = nodes_[idx].next;
+            }
+            else
+            {
+                idx = static_cast<u32>(nodes_.size());
+                nodes_.emplace_back();
+            }
+
+            Node& node   = nodes_[idx];
+            node.value   = std::move(value);
+            node.expires = std::max(
+                (deadline_ns + resolution_ns_ - 1) / resolution_ns_, horizon_ + 1);
+            node.live = true;
+            link(idx);
+            size_++;
+            return (static_cast<u64>(node.generation) << 32) | idx;
+        }
+
+        /// Remove a timer before it fires. False if it already fired or was cancelled.
+        bool cancel(Id id)
+        {
+            const u32 idx = static_cast<u32>(id);
+            if (idx >= nodes_.size())
+                return false;
+
+            Node& node = nodes_[idx];
+            if (!node.live || node.generation != static_cast<u32>(id >> 32))
+                return false;
+
+            unlink(idx);
+            release(idx);
+            return true;
+        }
+
+        /// Fire every timer due at now_ns, calling fn(T&&) for each. Timers in the same
+        /// tick fire in no particular order. fn may schedule and cancel timers.
+        template <typename F>
+        void advance(u64 now_ns, F&& fn)
+        {
+            const u64 target = now_ns / resolution_ns_;
+            if (target < next_tick_)
+                return;
+
+            horizon_ = target;
+            while (next_tick_ <= target)
+            {
+                const u64 tick = next_busy_tick(next_tick_);
+                if (tick > target)
+                    break;
+                next_tick_ = tick;
+
+                // a new lap of a level pulls the next slot of the level above down
+                for (u32 level = 1; level < k_levels; ++level)
+                {
+                    if ((tick & ((u64{ 1 } << (k_level_bits * level)) - 1)) != 0)
+                        break;
+                    cascade(level, slot_of(tick, level));
+                }
+
+                u32& head = heads_[0][slot_of(tick, 0)];
+                while (head != k_null)
+                {
+                    const u32 idx = head;
+                    unlink(idx);
+                    T value = std::move(nodes_[idx].value);
+                    release(idx);
+                    fn(std::move(value));
+                }
+
+                next_tick_ = tick + 1;
+            }
+            next_tick_ = target + 1;
+        }
+
+        /// Timers waiting to fire
+        FORCEINLINE usize size() const { return size_; }
+
+        FORCEINLINE bool empty() const { return size_ == 0; }
+
+        FORCEINLINE u64 resolution_ns() const { return resolution_ns_; }
+
+    private:
+        static constexpr u32 k_null = std::numeric_limits<u32>::max();
+
+        struct Node {
+            T    value{};
+            /// Tick this fires on
+            u64  expires{ 0 };
+            u32  prev{ k_null };
+            u32  next{ k_null };
+            u32  generation{ 0 };
+            u8   level{ 0 };
+            u8   slot{ 0 };
+            bool live{ false };
+        };
+
+        static constexpr u32 k_words = k_slots / 64;
+
+        static FORCEINLINE u32 slot_of(u64 tick, u32 level)
+        {
+            return static_cast<u32>(tick >> (k_level_bits * level)) & (k_slots - 1);
+        }
+
+        /// How many slots past `start` the next non-empty slot of a level is, wrapping
+        /// around, or -1 if the level is empty
+        i32 next_occupied(u32 level, u32 start) const
+        {
+            const auto& words = occupied_[level];
+            for (u32 n = 0; n <= k_words; ++n)
+            {
+                const u32 word = (start / 64 + n) % k_words;
+                u64       bits = words[word];
+                if (n == 0)
+                    bits &= ~u64{ 0 } << (start % 64);
+                else if (n == k_words)
+                    bits &= (u64{ 1 } << (start % 64)) - 1;
+
+                if (bits != 0)
+                {
+                    const u32 slot = word * 64 + std::countr_zero(bits);
+                    return static_cast<i32>((slot - start) & (k_slots - 1));
+                }
+            }
+            return -1;
+        }
+
+        /// The first tick at or after `from` that fires a level 0 slot or cascades a
+        /// non-empty slot of a level above, every tick before it is a no-op
+        u64 next_busy_tick(u64 from) const
+        {
+            u64 best = std::numeric_limits<u64>::max();
+            for (u32 level = 0; level < k_levels; ++level)
+            {
+                const u32 shift = k_level_bits * level;
+                // the first slot boundary of this level at or after from, in slots
+                const u64 first = (from + (u64{ 1 } << shift) - 1) >> shift;
+                const i32 ahead =
+                    next_occupied(level, static_cast<u32>(first) & (k_slots - 1));
+                if (ahead >= 0)
+                    best = std::min(best, (first + static_cast<u64>(ahead)) << shift);
+            }
+            return best;
+        }
+
+        /// Puts a node in the slot its expiry falls in, measured from next_tick_
+        void link(u32 idx)
+        {
+            Node&     node  = nodes_[idx];
+            const u64 delta = node.expires - next_tick_;
+
+            u32 level = 0;
+            while (level + 1 < k_levels &&
+                   delta >= u64{ 1 } << (k_level_bits * (level + 1)))
+                level++;
+
+            // past the last level's range, park it in the furthest slot, it gets
+            // relinked from its real expiry when that slot cascades
+            u64 tick = node.expires;
+            if (delta >= u64{ 1 } << (k_level_bits * k_levels))
+                tick = next_tick_ + (u64{ 1 } << (k_level_bits * k_levels)) - 1;
+
+            node.level = static_cast<u8>(level);
+            node.slot  = static_cast<u8>(slot_of(tick, level));
+            node.prev  = k_null;
+
+            u32& head = heads_[level][node.slot];
+            node.next = head;
+            if (head != k_null)
+                nodes_[head].prev = idx;
+            head = idx;
+            occupied_[level][node.slot / 64] |= u64{ 1 } << (node.slot % 64);
+        }
+
+        void unlink(u32 idx)
+        {
+            Node& node = nodes_[idx];
+            if (node.prev != k_null)
+                nodes_[node.prev].next = node.next;
+            else if ((heads_[node.level][node.slot] = node.next) == k_null)
+                occupied_[node.level][node.slot / 64] &= ~(u64{ 1 } << (node.slot % 64));
+            if (node.next != k_null)
+                nodes_[node.next].prev = node.prev;
+        }
+
+        void release(u32 idx)
+        {
+            Node& node = nodes_[idx];
+            node.value = T{};
+            node.live  = false;
+            node.generation++;
+            node.next = free_;
+            free_     = idx;
+            size_--;
+        }
+
+        void cascade(u32 level, u32 slot)
+        {
+            u32 idx             = heads_[level][slot];
+            heads_[level][slot] = k_null;
+            occupied_[level][slot / 64] &= ~(u64{ 1 } << (slot % 64));
+            while (idx != k_null)
+            {
+                const u32 next = nodes_[idx].next;
+                link(idx);
+                idx = next;
+            }
+        }
+
+        u64 resolution_ns_;
+        /// The next tick advance() has to fire
+        u64 next_tick_;
+        /// New timers fire after this tick, it's the last tick fired or being fired
+        u64 horizon_;
+
+        std::array<std::array<u32, k_slots>, k_levels> heads_{};
+        std::array<std::array<u64, k_words>, k_levels> occupied_{};
+        std::vector<Node>                              nodes_{};
+        u32                                            free_{ k_null };
+        usize                                          size_{ 0 };
+    };
+} // namespace v
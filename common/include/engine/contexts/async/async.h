@@ -11,37 +11,34 @@
 #include <engine/contexts/async/future.h>
 #include <engine/contexts/async/scheduler.h>
 #include <engine/contexts/async/task.h>
+#include <functional>
+#include <mem/frame_pool.h>
+#include <memory>
 #include <optional>
+#include "taskflow/algorithm/for_each.hpp"
+#include "taskflow/algorithm/reduce.hpp"
+#include "taskflow/algorithm/scan.hpp"
+#include "taskflow/algorithm/sort.hpp"
 #include "taskflow/taskflow.hpp"
 
 namespace v {
-    // Extended CoroutineState that includes the lambda and interface storage
-    template <typename T>
-    struct ExtendedCoroutineState : public CoroutineState<T> {
-        std::shared_ptr<void> lambda; // The coroutine lambda
-        std::shared_ptr<CoroutineInterface>
-            iface; // The interface (scheduler/engine access)
+    /// What a spawned coroutine's frame points back into: the lambda it runs (the frame
+    /// only holds a reference to it) and the interface it was handed. Owned by the
+    /// frame, and pooled the same way.
+    template <typename F>
+    struct SpawnedFn {
+        F                  fn;
+        CoroutineInterface iface;
 
-        template <typename F>
-        ExtendedCoroutineState(F&& func, CoroutineScheduler& scheduler, Engine& engine) :
-            CoroutineState<T>(engine),
-            lambda(std::make_shared<std::decay_t<F>>(std::forward<F>(func))),
-            iface(std::make_shared<CoroutineInterface>(scheduler, engine))
-        {}
-    };
-
-    template <>
-    struct ExtendedCoroutineState<void> : public CoroutineState<void> {
-        std::shared_ptr<void> lambda; // The coroutine lambda
-        std::shared_ptr<CoroutineInterface>
-            iface; // The interface (scheduler/engine access)
+        static void* operator new(usize size)
+        {
+            return mem::FramePool::local().allocate(size);
+        }
 
-        template <typename F>
-        ExtendedCoroutineState(F&& func, CoroutineScheduler& scheduler, Engine& engine) :
-            CoroutineState<void>(engine),
-            lambda(std::make_shared<std::decay_t<F>>(std::forward<F>(func))),
-            iface(std::make_shared<CoroutineInterface>(scheduler, engine))
-        {}
+        static void operator delete(void* ptr, usize size)
+        {
+            mem::FramePool::local().deallocate(ptr, size);
+        }
     };
 
     class AsyncContext : public Context<AsyncContext> {
@@ -49,6 +46,8 @@ namespace v {
         AsyncContext(Engine& engine, u16 num_threads) :
             Context(engine), executor_(num_threads)
         {
+            scheduler_.set_executor(&executor_);
+
             // makes sure this runs first before any domains are destroyed, since it will
             // probably be running things for domains
             engine.on_destroy.connect(
@@ -73,91 +72,41 @@ namespace v {
         // Ticks the coroutine scheduler
         void update() { scheduler_.tick(v::time::ns()); }
 
+        /// Run func on a worker. The result comes back through .then() or get(), or
+        /// co_await the task from a coroutine.
         template <typename Ret>
         Task<Ret> task(std::function<Ret(void)> func)
         {
-            Task<Ret> ret{ engine_ };
-            auto      state = ret.state_;
-
-            auto f = executor_.async(
-                [func, state]()
-                {
-                    try
-                    {
-                        // if its void then dont store the ret value
-                        if constexpr (std::is_void_v<Ret>)
-                        {
-                            func();
-
-                            auto guard          = state->lock.write();
-                            state->is_completed = true;
-                            if (state->callback)
-                                state->engine.post_tick(state->callback);
-                        }
-                        else
-                        {
-                            Ret result = func();
-
-                            auto guard          = state->lock.write();
-                            state->is_completed = true;
-                            if (state->callback)
-                                state->engine.post_tick(
-                                    std::bind(state->callback, result));
-
-                            return result;
-                        }
-                    }
-                    catch (...)
-                    {
-                        {
-                            auto guard              = state->lock.write();
-                            state->is_completed     = true;
-                            state->stored_exception = std::current_exception();
-                            if (state->error_callback)
-                            {
-                                state->engine.post_tick(
-                                    std::bind(
-                                        state->error_callback, state->stored_exception));
-                            }
-                        }
-                        throw; // throw again to keep std::future exception semantics
-                    }
-                });
-            ret.set_future(std::move(f));
-
-            return std::move(ret);
+            return launch<Ret>(std::move(func));
         }
 
         // Template argument deduction helper
         template <typename F>
         auto task(F&& func) -> Task<std::invoke_result_t<F>>
         {
-            using Ret = std::invoke_result_t<F>;
-            return task<Ret>(std::function<Ret(void)>(std::forward<F>(func)));
+            return launch<std::invoke_result_t<F>>(std::forward<F>(func));
         }
 
-        /// Spawn a coroutine that runs on the main thread.
+        /// Spawn a coroutine. It starts on the main thread, and can move onto the
+        /// executor's workers with ci.on_worker().
+        /// @note Call from the main thread
         template <typename CoroRet, typename F>
         CoroRet spawn(F&& coro_fn)
         {
-            // Extract the inner type from CoroRet (e.g., void from Coroutine<void>)
-            using InnerRet = typename CoroRet::value_type;
-
-            // Create centralized state (heap-allocates lambda and interface)
-            auto state = std::make_shared<ExtendedCoroutineState<InnerRet>>(
-                std::forward<F>(coro_fn), scheduler_, engine_);
+            using Spawned = SpawnedFn<std::decay_t<F>>;
+            auto spawned  = std::unique_ptr<Spawned>(new Spawned{
+                std::forward<F>(coro_fn), CoroutineInterface{ scheduler_, engine_ } });
 
-            // Call from the stable heap locations
-            auto coro = (*std::static_pointer_cast<std::decay_t<F>>(state->lambda))(
-                *state->iface);
-
-            // Store the state to keep everything alive
-            scheduler_.store_heap_state(coro.handle(), state);
+            // called from where the frame can keep referring to it
+            CoroRet coro = spawned->fn(spawned->iface);
+            coro.own(spawned.release());
 
             return coro;
         }
 
-        /// Spawn a coroutine that runs on the main thread.
+        /// Spawn a coroutine. It starts on the main thread, and can move onto the
+        /// executor's workers with ci.on_worker().
+        /// @note Call from the main thread
         template <typename F>
         auto spawn(F&& coro_fn)
         {
@@ -169,7 +118,167 @@ namespace v {
         /// Get the coroutine scheduler
         CoroutineScheduler& scheduler() { return scheduler_; }
 
+        /// The worker pool behind task(), for domains that want to run their own
+        /// taskflows (e.g. splitting a pass over chunks across threads)
+        tf::Executor& executor() { return executor_; }
+
+        // Data-parallel algorithms on the executor's workers. They block until done and
+        // rethrow the first exception thrown by the callables. Called from a worker (a
+        // task, or a coroutine after on_worker()), the calling thread keeps running
+        // other work while it waits instead of sleeping, so nesting them is fine.
+        //
+        // `grain` is the smallest number of elements a worker takes at once, 0 lets
+        // taskflow pick. Raise it when the per element work is tiny.
+        //
+        // The _async variants return straight away, the caller keeps the ranges and
+        // callables alive until the task is done.
+
+        /// Calls fn(i) for every i in [begin, end)
+        template <typename I, typename F>
+        void parallel_for(I begin, I end, F&& fn, usize grain = 0)
+        {
+            run_algorithm(
+                tf::make_for_each_index_task(
+                    begin, end, I{ 1 }, std::forward<F>(fn),
+                    tf::GuidedPartitioner<>{ grain }));
+        }
+
+        /// Calls fn(first, last) on consecutive chunks covering [begin, end), for loops
+        /// with per chunk setup
+        template <typename I, typename F>
+        void parallel_for_chunks(I begin, I end, F&& fn, usize grain = 0)
+        {
+            run_algorithm(
+                tf::make_for_each_by_index_task(
+                    tf::IndexRange<I>{ begin, end, I{ 1 } },
+                    [fn = std::forward<F>(fn)](tf::IndexRange<I> r)
+                    { fn(r.begin(), r.end()); }, tf::GuidedPartitioner<>{ grain }));
+        }
+
+        /// Folds [first, last) into init with op, op must be associative
+        template <typename It, typename T, typename Op>
+        T parallel_reduce(It first, It last, T init, Op op, usize grain = 0)
+        {
+            run_algorithm(
+                tf::make_reduce_task(
+                    first, last, init, std::move(op), tf::GuidedPartitioner<>{ grain }));
+            return init;
+        }
+
+        /// Folds transform(x) for every x in [first, last) into init with op
+        template <typename It, typename T, typename Op, typename Transform>
+        T parallel_transform_reduce(
+            It first, It last, T init, Op op, Transform transform, usize grain = 0)
+        {
+            run_algorithm(
+                tf::make_transform_reduce_task(
+                    first, last, init, std::move(op), std::move(transform),
+                    tf::GuidedPartitioner<>{ grain }));
+            return init;
+        }
+
+        /// Writes the running op fold of [first, last) to out, element i included
+        template <typename It, typename Out, typename Op = std::plus<>>
+        void parallel_inclusive_scan(It first, It last, Out out, Op op = {})
+        {
+            run_algorithm(tf::make_inclusive_scan_task(first, last, out, std::move(op)));
+        }
+
+        /// Writes the running op fold of [first, last) starting from init to out,
+        /// element i excluded
+        template <typename It, typename Out, typename T, typename Op = std::plus<>>
+        void parallel_exclusive_scan(It first, It last, Out out, T init, Op op = {})
+        {
+            run_algorithm(
+                tf::make_exclusive_scan_task(first, last, out, init, std::move(op)));
+        }
+
+        template <typename It, typename Cmp = std::less<>>
+        void parallel_sort(It first, It last, Cmp cmp = {})
+        {
+            run_algorithm(tf::make_sort_task(first, last, std::move(cmp)));
+        }
+
+        template <typename I, typename F>
+        Task<void> parallel_for_async(I begin, I end, F&& fn, usize grain = 0)
+        {
+            return launch<void>(
+                [this, begin, end, fn = std::forward<F>(fn), grain]() mutable
+                { parallel_for(begin, end, std::move(fn), grain); });
+        }
+
+        template <typename It, typename T, typename Op>
+        Task<T> parallel_reduce_async(It first, It last, T init, Op op, usize grain = 0)
+        {
+            return launch<T>(
+                [this, first, last, init = std::move(init), op = std::move(op), grain]
+                { return parallel_reduce(first, last, init, op, grain); });
+        }
+
+        template <typename It, typename Out, typename Op = std::plus<>>
+        Task<void> parallel_inclusive_scan_async(It first, It last, Out out, Op op = {})
+        {
+            return launch<void>(
+                [this, first, last, out, op = std::move(op)]
+                { parallel_inclusive_scan(first, last, out, op); });
+        }
+
+        template <typename It, typename Cmp = std::less<>>
+        Task<void> parallel_sort_async(It first, It last, Cmp cmp = {})
+        {
+            return launch<void>(
+                [this, first, last, cmp = std::move(cmp)]
+                { parallel_sort(first, last, cmp); });
+        }
+
     private:
+        /// Runs one taskflow algorithm (a callable taking tf::Runtime&) to completion
+        template <typename Algo>
+        void run_algorithm(Algo&& algo)
+        {
+            tf::Taskflow flow;
+            flow.emplace(std::forward<Algo>(algo));
+            // a worker sleeping on the future would hold up the algorithm's own tasks
+            if (executor_.this_worker_id() >= 0)
+                executor_.corun(flow);
+            else
+                executor_.run(flow).get();
+        }
+
+        /// Runs func on a worker, the task's state gets the result or exception
+        template <typename Ret, typename F>
+        Task<Ret> launch(F&& func)
+        {
+            Task<Ret> ret{ engine_, scheduler_ };
+
+            executor_.silent_async(
+                [func = std::forward<F>(func), state = ret.state_]() mutable
+                {
+                    try
+                    {
+                        // if its void then dont store the ret value
+                        if constexpr (std::is_void_v<Ret>)
+                        {
+                            func();
+                            state->result.emplace();
+                        }
+                        else
+                        {
+                            state->result.emplace(func());
+                        }
+                    }
+                    catch (...)
+                    {
+                        state->exception = std::current_exception();
+                        TaskState<Ret>::complete(state, true);
+                        return;
+                    }
+                    TaskState<Ret>::complete(state, false);
+                });
+
+            return ret;
+        }
+
         tf::Executor       executor_;
         CoroutineScheduler scheduler_;
     };
@@ -26,6 +26,19 @@ namespace v {
         bool await_resume() const noexcept { return true; }
     };
 
+    /// Awaitable for moving a coroutine onto the executor's workers or back onto the
+    /// main thread. Doesn't suspend when already on the right kind of thread.
+    struct ResumeOnAwaitable {
+        CoroutineScheduler* scheduler;
+        bool                worker;
+
+        bool await_ready() const noexcept;
+
+        void await_suspend(std::coroutine_handle<> handle);
+
+        void await_resume() const noexcept {}
+    };
+
     /// Interface passed to coroutines for scheduler interaction
     class CoroutineInterface {
     public:
@@ -41,6 +54,16 @@ namespace v {
             return SleepAwaitable{ duration_ms, &scheduler_ };
         }
 
+        /// Continue on one of the executor's worker threads:
+        ///   co_await ci.on_worker(); /* heavy work */ co_await ci.on_main();
+        /// Anything the coroutine touches until it comes back must be safe to use off
+        /// the main thread. Returning (or throwing) from a worker is fine, completion
+        /// and .then() callbacks still happen on the main thread.
+        ResumeOnAwaitable on_worker() { return ResumeOnAwaitable{ &scheduler_, true }; }
+
+        /// Continue on the main thread, during the next AsyncContext::update()
+        ResumeOnAwaitable on_main() { return ResumeOnAwaitable{ &scheduler_, false }; }
+
         Engine& engine() { return engine_; }
 
         CoroutineScheduler& scheduler() { return scheduler_; }
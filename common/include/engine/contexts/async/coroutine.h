@@ -12,38 +12,13 @@
 #include <engine/contexts/async/future.h>
 #include <engine/contexts/async/scheduler.h>
 #include <engine/engine.h>
+#include <utility>
 
 namespace v {
 
-    // TODO! why not just merge these lol
-    template <typename Ret, typename Derived>
-    struct PromiseReturnBase {
-        void return_value(Ret value)
-        {
-            auto* derived                      = static_cast<Derived*>(this);
-            derived->coro_state_->is_completed = true;
-            derived->coro_state_->value        = value;
-            if (derived->coro_state_->callback)
-            {
-                derived->coro_state_->callback(value);
-            }
-        }
-    };
-
-    template <typename Derived>
-    struct PromiseReturnBase<void, Derived> {
-        void return_void()
-        {
-            auto* derived                      = static_cast<Derived*>(this);
-            derived->coro_state_->is_completed = true;
-            if (derived->coro_state_->callback)
-                derived->coro_state_->callback();
-        }
-    };
-
-    /// The final returned awaitable for the scheduler to destroy resources and stuff
+    /// The final returned awaitable, hands the finished coroutine to the scheduler
     struct FinalAwaitable {
-        CoroutineScheduler& scheduler;
+        CoroutineStateBase& state;
 
         bool await_ready() const noexcept { return false; }
 
@@ -57,58 +32,37 @@ namespace v {
     public:
         using value_type = Ret;
 
-        struct promise_type : PromiseReturnBase<Ret, promise_type> {
-            promise_type(CoroutineInterface& ci) :
-                engine_(ci.engine()), scheduler_(ci.scheduler())
-            {}
+        struct promise_type : CoroutineState<Ret> {
+            promise_type(CoroutineInterface& ci) : CoroutineState<Ret>(ci.scheduler()) {}
 
             Coroutine<Ret> get_return_object()
             {
-                auto handle = std::coroutine_handle<promise_type>::from_promise(*this);
-                return Coroutine<Ret>(handle, engine_, scheduler_);
+                auto handle  = std::coroutine_handle<promise_type>::from_promise(*this);
+                this->handle = handle;
+                return Coroutine<Ret>(handle);
             }
 
-            Engine&             engine_;
-            CoroutineScheduler& scheduler_;
-
             std::suspend_never initial_suspend() noexcept { return {}; }
 
-            FinalAwaitable final_suspend() noexcept
-            {
-                return { .scheduler = scheduler_ };
-            }
-
-            void unhandled_exception()
-            {
-                coro_state_->is_completed     = true;
-                coro_state_->stored_exception = std::current_exception();
-                if (coro_state_->error_callback)
-                    coro_state_->error_callback(coro_state_->stored_exception);
-            }
-
-            std::shared_ptr<CoroutineState<Ret>> coro_state_;
+            FinalAwaitable final_suspend() noexcept { return { .state = *this }; }
         };
 
         using handle_type = std::coroutine_handle<promise_type>;
 
-        explicit Coroutine(handle_type h, Engine& engine, CoroutineScheduler& scheduler) :
-            FutureBase<Coroutine<Ret>, Ret>(),
-            coro_state_(std::make_shared<CoroutineState<Ret>>(engine)), handle_(h),
-            scheduler_(scheduler)
+        explicit Coroutine(handle_type h) : FutureBase<Coroutine<Ret>, Ret>(), handle_(h)
         {
-            h.promise().coro_state_ = coro_state_;
-            scheduler.register_handle(h);
+            h.promise().refs++;
         }
 
-        /// TODO! actually should kill this on destroy, force raii
         ~Coroutine()
         {
-            // stop();
+            if (handle_)
+                handle_.promise().release();
         }
 
         /// If the coroutine has finished executing normally
         /// via a thrown exception or return
-        FORCEINLINE bool done() const { return coro_state_->is_completed; }
+        FORCEINLINE bool done() const { return handle_.promise().is_completed; }
 
         /// If the coroutine is still alive and running.
         /// This is different from done(), as done() will return false for
@@ -131,11 +85,22 @@ namespace v {
             return handle_;
         }
 
-        // Delete copy, default move
         Coroutine(const Coroutine&)            = delete;
         Coroutine& operator=(const Coroutine&) = delete;
-        Coroutine(Coroutine&&)                 = default;
-        Coroutine& operator=(Coroutine&&)      = default;
+
+        Coroutine(Coroutine&& other) noexcept : handle_(std::exchange(other.handle_, {}))
+        {}
+
+        Coroutine& operator=(Coroutine&& other) noexcept
+        {
+            if (this != &other)
+            {
+                if (handle_)
+                    handle_.promise().release();
+                handle_ = std::exchange(other.handle_, {});
+            }
+            return *this;
+        }
 
         // CRTP interface implementations
         template <typename Callback>
@@ -156,16 +121,17 @@ namespace v {
                     "argument: [](T value){ ... }");
             }
 
-            if (coro_state_->is_completed && !coro_state_->stored_exception)
+            promise_type& state = handle_.promise();
+            if (state.is_completed && !state.stored_exception)
             {
                 if constexpr (std::is_void_v<Ret>)
                     callback();
                 else
-                    callback(*coro_state_->value);
+                    callback(*state.value);
             }
             else
             {
-                coro_state_->callback = callback;
+                state.callback = callback;
             }
             return *this;
         }
@@ -178,26 +144,35 @@ namespace v {
                 "Callback for .or_else() must be callable with std::exception_ptr: "
                 "[](std::exception_ptr e){ ... }");
 
-            if (coro_state_->is_completed && coro_state_->stored_exception)
+            promise_type& state = handle_.promise();
+            if (state.is_completed && state.stored_exception)
                 // immediately execute error callback since this all happens on the main
                 // thread
-                callback(coro_state_->stored_exception);
+                callback(state.stored_exception);
             else
-                coro_state_->error_callback = callback;
+                state.error_callback = callback;
             return *this;
         }
 
         Ret get_impl()
         {
-            if (coro_state_->stored_exception)
-                std::rethrow_exception(coro_state_->stored_exception);
+            promise_type& state = handle_.promise();
+            if (state.stored_exception)
+                std::rethrow_exception(state.stored_exception);
             if constexpr (!std::is_void_v<Ret>)
-                return *coro_state_->value;
+                return *state.value;
         }
 
     private:
-        std::shared_ptr<CoroutineState<Ret>> coro_state_;
-        handle_type                          handle_;
-        CoroutineScheduler&                  scheduler_;
+        friend class AsyncContext;
+
+        /// Ties ptr's lifetime to the frame's
+        template <typename T>
+        void own(T* ptr)
+        {
+            handle_.promise().own(ptr);
+        }
+
+        handle_type handle_;
     };
 } // namespace v
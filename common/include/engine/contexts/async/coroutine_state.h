@@ -4,33 +4,140 @@
 
 #pragma once
 
-#include <engine/engine.h>
+#include <coroutine>
+#include <engine/contexts/async/scheduler.h>
 #include <exception>
 #include <functional>
+#include <mem/frame_pool.h>
 #include <optional>
 
 namespace v {
-    // CoroutineState for single-threaded coroutines (no synchronization needed)
-    template <typename T>
-    struct CoroutineState {
-        Engine&                                 engine;
+    /// A coroutine's state, kept in its promise so it lives in the frame. The frame
+    /// is freed once the coroutine finished and no Coroutine object refers to it.
+    /// Only touched on the main thread (no synchronization needed), a coroutine that
+    /// returns on a worker stores its result and the scheduler runs the callbacks once
+    /// the frame is handed back (see CoroutineScheduler::finish()).
+    struct CoroutineStateBase {
+        CoroutineScheduler&                     scheduler;
+        std::coroutine_handle<>                 handle{};
+        /// The scheduler's until the coroutine finishes, plus one per Coroutine object
+        u32                                     refs{ 1 };
         bool                                    is_completed{ false };
-        std::optional<T>                        value{};
-        std::function<void(T)>                  callback{};
-        std::function<void(std::exception_ptr)> error_callback{};
         std::exception_ptr                      stored_exception{};
+        std::function<void(std::exception_ptr)> error_callback{};
+
+        explicit CoroutineStateBase(CoroutineScheduler& sched) : scheduler(sched)
+        {
+            scheduler.track(*this);
+        }
+
+        virtual ~CoroutineStateBase()
+        {
+            if (owned_)
+                drop_owned_(owned_);
+        }
+
+        CoroutineStateBase(const CoroutineStateBase&)            = delete;
+        CoroutineStateBase& operator=(const CoroutineStateBase&) = delete;
+
+        /// Marks the coroutine completed and runs its .then() or .or_else() callback
+        virtual void complete() = 0;
+
+        /// Drops a reference, destroying the frame with the last one
+        FORCEINLINE void release()
+        {
+            if (--refs == 0)
+                handle.destroy();
+        }
+
+        /// Frees ptr with the frame, for things the frame refers to but doesn't hold
+        /// (the lambda a coroutine was spawned from)
+        template <typename T>
+        void own(T* ptr)
+        {
+            owned_      = ptr;
+            drop_owned_ = [](void* p) { delete static_cast<T*>(p); };
+        }
+
+        void unhandled_exception()
+        {
+            stored_exception = std::current_exception();
+            if (scheduler.on_main_thread())
+                complete();
+        }
+
+        // frames come out of the size class pool, so spawning doesn't touch the heap
+        // once warmed up
+        static void* operator new(usize size)
+        {
+            return mem::FramePool::local().allocate(size);
+        }
+
+        static void operator delete(void* ptr, usize size)
+        {
+            mem::FramePool::local().deallocate(ptr, size);
+        }
 
-        explicit CoroutineState(Engine& eng) : engine(eng) {}
+    private:
+        friend class CoroutineScheduler;
+
+        void* owned_{ nullptr };
+        void (*drop_owned_)(void*){ nullptr };
+        /// Unfinished coroutines are linked into their scheduler, which destroys them
+        /// if it goes away first
+        CoroutineStateBase* prev_{ nullptr };
+        CoroutineStateBase* next_{ nullptr };
+    };
+
+    template <typename T>
+    struct CoroutineState : CoroutineStateBase {
+        std::optional<T>       value{};
+        std::function<void(T)> callback{};
+
+        using CoroutineStateBase::CoroutineStateBase;
+
+        void return_value(T v)
+        {
+            value = std::move(v);
+            if (scheduler.on_main_thread())
+                complete();
+        }
+
+        void complete() override
+        {
+            is_completed = true;
+            if (stored_exception)
+            {
+                if (error_callback)
+                    error_callback(stored_exception);
+            }
+            else if (callback)
+                callback(*value);
+        }
     };
 
     template <>
-    struct CoroutineState<void> {
-        Engine&                                 engine;
-        bool                                    is_completed{ false };
-        std::function<void()>                   callback{};
-        std::function<void(std::exception_ptr)> error_callback{};
-        std::exception_ptr                      stored_exception{};
+    struct CoroutineState<void> : CoroutineStateBase {
+        std::function<void()> callback{};
+
+        using CoroutineStateBase::CoroutineStateBase;
+
+        void return_void()
+        {
+            if (scheduler.on_main_thread())
+                complete();
+        }
 
-        explicit CoroutineState(Engine& eng) : engine(eng) {}
+        void complete() override
+        {
+            is_completed = true;
+            if (stored_exception)
+            {
+                if (error_callback)
+                    error_callback(stored_exception);
+            }
+            else if (callback)
+                callback();
+        }
     };
 } // namespace v
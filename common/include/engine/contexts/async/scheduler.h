@@ -5,43 +5,84 @@
 #pragma once
 
 #include <any>
-#include <containers/ud_map.h>
+#include <containers/timing_wheel.h>
 #include <containers/ud_set.h>
 #include <coroutine>
 #include <defs.h>
 #include <memory>
-#include <queue>
+#include <thread>
+#include <time/time.h>
 #include <vector>
+#include "moodycamel/concurrentqueue.h"
 
+namespace tf {
+    class Executor;
+}
 
 namespace v {
 
-    template <typename T>
-    struct CoroutineState;
-    /// Scheduler for coroutines running on the main thread.
-    /// Manages sleeping coroutines via min-heap for efficient wake-up.
-    /// Owns all coroutine handles and destroys them when completed.
+    struct CoroutineStateBase;
+    /// Scheduler for coroutines, ticked on the main thread.
+    /// Manages sleeping coroutines in a timing wheel, waking them at tick granularity.
+    /// Holds a reference to every coroutine until it completes, see
+    /// CoroutineStateBase.
+    /// Coroutines may hop onto the executor's workers and back (see
+    /// CoroutineInterface::on_worker()), anything they hand the scheduler from a worker
+    /// goes through a queue that tick() drains.
     class CoroutineScheduler {
         friend struct FinalAwaitable;
+        friend struct CoroutineStateBase;
 
     public:
+        /// Width of a sleep bucket, sleeps wake up to this much late
+        static constexpr u64 k_sleep_resolution_ns = 1'000'000;
+
+        /// Must be created on the thread that will tick it
         CoroutineScheduler() = default;
 
-        /// Register a coroutine handle for lifetime management
-        void register_handle(std::coroutine_handle<> handle);
+        /// Drops its reference to every coroutine that hasn't finished, which frees
+        /// the ones nothing else holds (and the lambdas they were spawned from).
+        /// Coroutine objects that outlive the scheduler free theirs when destroyed.
+        /// @note Nothing may resume them anymore, wait for the executor first
+        ~CoroutineScheduler();
+
+        CoroutineScheduler(const CoroutineScheduler&)            = delete;
+        CoroutineScheduler& operator=(const CoroutineScheduler&) = delete;
 
-        /// Store heap-allocated coroutine state (including lambda and interface) to keep
-        /// it alive for the duration of the coroutine
-        template <typename T>
-        void store_heap_state(std::coroutine_handle<> handle, std::shared_ptr<T> state)
+        /// Worker resumptions go through this executor, see schedule_worker()
+        void set_executor(tf::Executor* executor) { executor_ = executor; }
+
+        /// True on the thread that ticks the scheduler
+        FORCEINLINE bool on_main_thread() const
         {
-            heap_state_storage_[handle] = std::static_pointer_cast<void>(state);
+            return std::this_thread::get_id() == main_thread_;
         }
 
-        /// Schedule a coroutine to sleep until the given wake time (nanoseconds)
+        /// True on one of the executor's worker threads
+        bool on_worker_thread() const;
+
+        /// Resume a coroutine on a worker. Posted into the executor's work stealing
+        /// queues (the calling worker's own queue when called from one), so whichever
+        /// worker is free picks it up. Resumes on the main thread without an executor.
+        void schedule_worker(std::coroutine_handle<> handle);
+
+        /// Resume a coroutine on the main thread during the next tick(). Safe to call
+        /// from any thread.
+        void schedule_main(std::coroutine_handle<> handle);
+
+        /// Schedule a coroutine to sleep until the given wake time (nanoseconds).
+        /// It wakes up on the main thread, whichever thread it went to sleep on.
         void schedule_sleep(std::coroutine_handle<> handle, u64 wake_time_ns);
 
-        /// Update scheduler and resume ready coroutines.
+        /// Coroutines asleep right now (not counting ones just put to sleep on a worker)
+        FORCEINLINE usize sleeping() const { return sleeping_.size(); }
+
+        /// Coroutines started and not finished yet
+        FORCEINLINE usize alive() const { return alive_; }
+
+        /// Update scheduler and resume ready coroutines. A coroutine is woken at most
+        /// once per tick, one that goes back to sleep wakes in a later tick at the
+        /// earliest, however short the sleep.
         /// Should be called once per frame from main thread.
         void tick(u64 current_time_ns);
 
@@ -49,26 +90,35 @@ namespace v {
         struct SleepEntry {
             u64                     wake_time_ns;
             std::coroutine_handle<> handle;
-
-            bool operator>(const SleepEntry& other) const
-            {
-                return wake_time_ns > other.wake_time_ns;
-            }
         };
 
+        /// Links a new coroutine into outstanding_
+        void track(CoroutineStateBase& state);
+
         /// Called when a coroutine exits via final_suspend (exception or co_return).
-        void schedule_finish(std::coroutine_handle<> handle);
+        void schedule_finish(CoroutineStateBase& state);
 
-        // Min-heap of sleeping coroutines, sorted by wake_time_ns
-        std::priority_queue<SleepEntry, std::vector<SleepEntry>, std::greater<>>
-            sleeping_;
+        /// Completes a finished coroutine if it returned on a worker, then drops the
+        /// scheduler's reference to it. Main thread only
+        void finish(CoroutineStateBase& state);
 
-        ud_set<std::coroutine_handle<>> to_kill_{};
+        std::thread::id main_thread_{ std::this_thread::get_id() };
+        tf::Executor*   executor_{ nullptr };
 
-        // All active coroutine handles owned by scheduler
-        v::ud_set<std::coroutine_handle<>> active_handles_;
+        /// Coroutines coming back to the main thread
+        moodycamel::ConcurrentQueue<std::coroutine_handle<>> main_queue_{};
+        /// Sleeps started and coroutines finished on workers, handed to the main thread
+        moodycamel::ConcurrentQueue<SleepEntry>              sleep_queue_{};
+        moodycamel::ConcurrentQueue<CoroutineStateBase*>     finish_queue_{};
+
+        // Sleeping coroutines, bucketed by the tick they wake on
+        TimingWheel<std::coroutine_handle<>> sleeping_{ k_sleep_resolution_ns,
+                                                        time::ns() };
+
+        ud_set<std::coroutine_handle<>> to_kill_{};
 
-        // We need to heap allocate stuff like lambdas and other temporary objects
-        v::ud_map<std::coroutine_handle<>, std::shared_ptr<void>> heap_state_storage_;
+        usize alive_{ 0 };
+        /// Intrusive list of the coroutines that haven't finished
+        CoroutineStateBase* outstanding_{ nullptr };
     };
 } // namespace v
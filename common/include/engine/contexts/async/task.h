@@ -5,23 +5,60 @@
 #pragma once
 
 #include <engine/contexts/async/future.h>
+#include <engine/contexts/async/scheduler.h>
 #include <engine/contexts/async/task_state.h>
-#include <future>
 
 namespace v {
+    /// Awaiter behind co_await on a Task, see Task::operator co_await()
+    template <typename T>
+    struct TaskAwaiter {
+        std::shared_ptr<TaskState<T>> state;
+
+        bool await_ready() const noexcept
+        {
+            return state->done() && state->scheduler.on_main_thread();
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            state->waiter = handle;
+            const u32 prev =
+                state->flags.fetch_or(TaskState<T>::k_awaited, std::memory_order_acq_rel);
+            // the worker finishing the task hands it to the main thread
+            if (!(prev & TaskState<T>::k_done))
+                return true;
+
+            // finished in the meantime
+            if (state->scheduler.on_main_thread())
+                return false;
+            state->scheduler.schedule_main(handle);
+            return true;
+        }
+
+        T await_resume() { return state->take(); }
+    };
+
     template <typename T>
     class Task : public FutureBase<Task<T>, T> {
         friend class AsyncContext;
 
     public:
-        Task(Engine& engine) : state_(std::make_shared<TaskState<T>>(engine)) {}
+        Task(Engine& engine, CoroutineScheduler& scheduler) :
+            state_(std::make_shared<TaskState<T>>(engine, scheduler))
+        {}
+
+        /// Inside a coroutine, suspends until the task is done and resumes on the main
+        /// thread with its result (or rethrows its exception), without blocking:
+        ///   Mesh mesh = co_await async.task([&] { return build_mesh(chunk); });
+        /// Use either this, then() or get() on a task, only one of them gets the result.
+        TaskAwaiter<T> operator co_await() const { return TaskAwaiter<T>{ state_ }; }
 
-        void wait() const { future_.wait(); }
+        void wait() const { state_->wait(); }
 
         template <typename Rep, typename Period>
         void wait_for(const std::chrono::duration<Rep, Period>& rel) const
         {
-            future_.wait_for(rel);
+            state_->wait_for(rel);
         }
 
         // CRTP interface implementations
@@ -34,6 +71,7 @@ namespace v {
                     std::is_invocable_v<Callback>,
                     "Callback for Task<void>.then() must be callable with no arguments: "
                     "[](){ ... }");
+                state_->then_fn = std::forward<Callback>(callback);
             }
             else
             {
@@ -41,25 +79,12 @@ namespace v {
                     std::is_invocable_v<Callback, T>,
                     "Callback for Task<T>.then() must be callable with T as argument: "
                     "[](T value){ ... }");
+                // the state owns then_fn, a raw pointer back avoids a cycle
+                state_->then_fn = [callback = std::forward<Callback>(callback),
+                                   state    = state_.get()]() mutable
+                { callback(std::move(*state->result)); };
             }
-
-            auto guard = state_->lock.write();
-            if (state_->is_completed && !state_->stored_exception)
-            {
-                // immediately queue
-                if constexpr (std::is_void_v<T>)
-                {
-                    state_->engine.post_tick(callback);
-                }
-                else
-                {
-                    state_->engine.post_tick(std::bind(callback, future_.get()));
-                }
-            }
-            else
-            {
-                state_->callback = callback;
-            }
+            TaskState<T>::install(state_, TaskState<T>::k_then);
             return *this;
         }
 
@@ -71,25 +96,20 @@ namespace v {
                 "Callback for .or_else() must be callable with std::exception_ptr: "
                 "[](std::exception_ptr e){ ... }");
 
-            auto guard = state_->lock.write();
-            if (state_->is_completed && state_->stored_exception)
-            {
-                // immediately queue
-                state_->engine.post_tick(std::bind(callback, state_->stored_exception));
-            }
-            else
-            {
-                state_->error_callback = callback;
-            }
+            state_->or_else_fn = [callback = std::forward<Callback>(callback),
+                                  state    = state_.get()]() mutable
+            { callback(state->exception); };
+            TaskState<T>::install(state_, TaskState<T>::k_or_else);
             return *this;
         }
 
-        T get_impl() { return future_.get(); }
-
-        void set_future(std::future<T>&& future) { future_ = std::move(future); }
+        T get_impl()
+        {
+            state_->wait();
+            return state_->take();
+        }
 
     private:
-        std::future<T>                future_;
         std::shared_ptr<TaskState<T>> state_;
     };
 } // namespace v
@@ -5,33 +5,111 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
+#include <containers/inline_fn.h>
+#include <coroutine>
+#include <engine/contexts/async/scheduler.h>
 #include <engine/engine.h>
-#include <engine/sync.h>
 #include <exception>
-#include <functional>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <variant>
 
 namespace v {
+    /// State shared between a Task and the worker running it. A single atomic word
+    /// tracks completion and which continuations (then(), or_else(), a co_await) are
+    /// installed. The worker finishing and the main thread installing a continuation
+    /// each set their bit with one fetch_or, and whichever comes second dispatches the
+    /// continuation, so neither side ever takes a lock.
     template <typename T>
     struct TaskState {
-        Engine&                                 engine;
-        std::atomic_bool                        is_completed{ false };
-        std::function<void(T)>                  callback{};
-        std::function<void(std::exception_ptr)> error_callback{};
-        std::exception_ptr                      stored_exception{};
-        RwLock<int>                             lock{};
-
-        explicit TaskState(Engine& eng) : engine(eng) {}
-    };
+        static constexpr u32 k_done    = 1 << 0;
+        static constexpr u32 k_failed  = 1 << 1;
+        static constexpr u32 k_then    = 1 << 2;
+        static constexpr u32 k_or_else = 1 << 3;
+        static constexpr u32 k_awaited = 1 << 4;
+
+        /// void tasks still get an (empty) result, so the code paths stay the same
+        using Value = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+        Engine&             engine;
+        CoroutineScheduler& scheduler;
+        std::atomic<u32>    flags{ 0 };
+        /// Written by the worker before k_done
+        std::optional<Value> result{};
+        std::exception_ptr   exception{};
+        /// Written by the main thread before their bits
+        InlineFn                then_fn{};
+        InlineFn                or_else_fn{};
+        std::coroutine_handle<> waiter{};
+
+        TaskState(Engine& eng, CoroutineScheduler& sched) : engine(eng), scheduler(sched)
+        {}
+
+        FORCEINLINE bool done() const
+        {
+            return flags.load(std::memory_order_acquire) & k_done;
+        }
+
+        /// Worker side, once result or exception is in place
+        static void complete(const std::shared_ptr<TaskState>& self, bool failed)
+        {
+            const u32 outcome = k_done | (failed ? k_failed : 0);
+            const u32 prev    = self->flags.fetch_or(outcome, std::memory_order_acq_rel);
+            dispatch(self, prev & (k_then | k_or_else | k_awaited), failed);
+            // get() and wait() callers
+            self->flags.notify_all();
+        }
+
+        /// Main thread side, once the continuation for `bit` is in place
+        static void install(const std::shared_ptr<TaskState>& self, u32 bit)
+        {
+            const u32 prev = self->flags.fetch_or(bit, std::memory_order_acq_rel);
+            if (prev & k_done)
+                dispatch(self, bit, prev & k_failed);
+        }
+
+        /// Blocks until the worker is done
+        void wait() const
+        {
+            u32 f = flags.load(std::memory_order_acquire);
+            while (!(f & k_done))
+            {
+                flags.wait(f, std::memory_order_acquire);
+                f = flags.load(std::memory_order_acquire);
+            }
+        }
+
+        /// Blocks until the worker is done or `rel` passed, whichever is first
+        template <typename Rep, typename Period>
+        void wait_for(const std::chrono::duration<Rep, Period>& rel) const
+        {
+            // no timed atomic wait, poll
+            const auto deadline = std::chrono::steady_clock::now() + rel;
+            while (!done() && std::chrono::steady_clock::now() < deadline)
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
 
-    template <>
-    struct TaskState<void> {
-        Engine&                                 engine;
-        std::atomic_bool                        is_completed{ false };
-        std::function<void()>                   callback{};
-        std::function<void(std::exception_ptr)> error_callback{};
-        std::exception_ptr                      stored_exception{};
-        RwLock<int>                             lock{};
+        /// The result for whoever's continuation it is, rethrows the task's exception
+        T take()
+        {
+            if (exception)
+                std::rethrow_exception(exception);
+            if constexpr (!std::is_void_v<T>)
+                return std::move(*result);
+        }
 
-        explicit TaskState(Engine& eng) : engine(eng) {}
+    private:
+        static void
+        dispatch(const std::shared_ptr<TaskState>& self, u32 continuations, bool failed)
+        {
+            if ((continuations & k_then) && !failed)
+                self->engine.post_tick([self] { self->then_fn(); });
+            if ((continuations & k_or_else) && failed)
+                self->engine.post_tick([self] { self->or_else_fn(); });
+            if (continuations & k_awaited)
+                self->scheduler.schedule_main(self->waiter);
+        }
     };
 } // namespace v
@@ -153,6 +153,7 @@ namespace v {
                 }
 
                 conn_->outgoing_packets_->enqueue(packet);
+                conn_->net_ctx_->count_sent(total_len);
                 return; // don't destroy packet, it will be sent later
             }
 
@@ -160,7 +161,9 @@ namespace v {
             {
                 LOG_ERROR("Failed to send packet on channel {}", Derived::unique_name());
                 enet_packet_destroy(packet);
+                return;
             }
+            conn_->net_ctx_->count_sent(total_len);
         }
 
     protected:
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <containers/ud_map.h>
 #include <defs.h>
 #include <engine/context.h>
@@ -50,6 +51,15 @@ namespace v {
         } created_channel;
     };
 
+    /// Traffic through a NetworkContext's channels. Bytes are packet payloads (channel
+    /// id included), ENet's own headers and acks aren't counted.
+    struct NetStats {
+        u64 packets_sent{ 0 };
+        u64 bytes_sent{ 0 };
+        u64 packets_received{ 0 };
+        u64 bytes_received{ 0 };
+    };
+
     /// A context that creates and manages network connections.
     class NetworkContext : public Context<NetworkContext> {
         friend NetConnection;
@@ -109,6 +119,15 @@ namespace v {
         /// Queue work to run on the IO thread.
         void enqueue_io(std::function<void()> fn);
 
+        /// Totals since the context was created, across every connection
+        FORCEINLINE NetStats stats() const
+        {
+            return { packets_sent_.load(std::memory_order_relaxed),
+                     bytes_sent_.load(std::memory_order_relaxed),
+                     packets_received_.load(std::memory_order_relaxed),
+                     bytes_received_.load(std::memory_order_relaxed) };
+        }
+
     private:
         // data is either a pointer to NetListener (for access to the callbacks)
         // or nothing.
@@ -120,6 +139,13 @@ namespace v {
         /// Links host server info to server_maps_ for bidirectional lookup
         void link_host_server_info(NetHost host, const std::string& addr, u16 port);
 
+        /// A packet was handed to ENet (or queued until the connection opens)
+        FORCEINLINE void count_sent(u64 bytes)
+        {
+            packets_sent_.fetch_add(1, std::memory_order_relaxed);
+            bytes_sent_.fetch_add(bytes, std::memory_order_relaxed);
+        }
+
         /// Cleanup internal tracking of a connection
         FORCEINLINE void cleanup_tracking(NetPeer peer)
         {
@@ -188,5 +214,11 @@ namespace v {
 
         /// Pending tasks the IO thread should execute in order
         moodycamel::ConcurrentQueue<std::function<void()>> io_commands_{};
+
+        /// See stats(). Sends come from the main thread, receives from the IO thread
+        std::atomic<u64> packets_sent_{ 0 };
+        std::atomic<u64> bytes_sent_{ 0 };
+        std::atomic<u64> packets_received_{ 0 };
+        std::atomic<u64> bytes_received_{ 0 };
     };
 } // namespace v
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <containers/inline_fn.h>
 #include <defs.h>
 #include <engine/traits.h>
 #include <entt/entt.hpp>
@@ -77,6 +78,13 @@ namespace v {
         FORCEINLINE entt::entity entity() const { return entity_; }
         FORCEINLINE std::string_view name() const { return name_; }
 
+        /// Called right before the engine destroys this domain through
+        /// Engine::queue_destroy_domain. Heavy resources (voxel stores) moved into
+        /// the returned callable are freed on a background thread instead of in the
+        /// middle of a tick. The callable must own everything it touches, the domain
+        /// is gone by the time it runs.
+        virtual InlineFn release_deferred() { return {}; }
+
         /// Check if the domain's entity has component T
         template <typename T>
         bool has() const;
@@ -134,6 +142,28 @@ namespace v {
         virtual void init() {}
     };
 
+    /// A domain that lives directly in the registry's component pool instead of behind
+    /// its own heap allocation, so views over it walk contiguous memory. Worth it for
+    /// domains that exist by the thousands and get iterated every tick (chunks).
+    /// The pool is paged and destroyed slots are left as tombstones rather than
+    /// filled by moving the last element in, so pointers stay as stable as with
+    /// Domain<>.
+    /// @note Views yield Derived& instead of an owned_ptr, so iterate with `.`
+    template <typename Derived>
+    class InlineDomain : public Domain<Derived> {
+    protected:
+        InlineDomain(std::string name = std::string{ type_name<Derived>() }) :
+            Domain<Derived>(std::move(name))
+        {}
+
+    public:
+        /// Stored as itself, hides Domain's owned_ptr
+        using query_type = Derived;
+
+        /// Read by entt, delete in place and never relocate instances
+        static constexpr bool in_place_delete = true;
+    };
+
     /// A singleton domain which does not permit the creation of multiple
     /// instances of itself in the same Engine container.
     template <typename Derived>
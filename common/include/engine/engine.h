@@ -4,17 +4,24 @@
 
 #pragma once
 
+#include <containers/inline_fn.h>
+#include <containers/ud_map.h>
 #include <defs.h>
 #include <engine/context.h>
 #include <engine/domain.h>
+#include <engine/releaser.h>
 #include <entt/entt.hpp>
 #include <functional>
 #include <moodycamel/concurrentqueue.h>
+#include <optional>
+#include <span>
+#include <time/fixed_step.h>
 #include <time/stopwatch.h>
 #include <unordered_dense.h>
 
 #include "entt/entity/fwd.hpp"
 #include "sink.h"
+#include "systems.h"
 #include "traits.h"
 
 template <typename T>
@@ -36,7 +43,8 @@ namespace v {
         Engine();
         ~Engine();
 
-        /// Processes queued actions and updates deltatime.
+        /// Processes queued actions and updates deltatime. Ends the frame for every
+        /// thread's mem::FrameArena on the way out.
         /// @note Should be called first in a main loop
         void tick();
 
@@ -49,6 +57,46 @@ namespace v {
         /// Returns the internally stored tick counter
         FORCEINLINE u64 current_tick() const { return current_tick_; };
 
+        /// Runs on_fixed_tick at a fixed rate from within tick(): every tick runs it
+        /// as many times as the real time since the previous tick covers, the rest
+        /// carries over.
+        /// @param hz Steps per second, 0 turns fixed steps off again
+        /// @param max_catch_up Most steps a single tick runs, after a long stall the
+        /// simulation slows down instead of spiraling
+        void set_fixed_rate(f64 hz, u32 max_catch_up = 8);
+
+        /// Seconds per fixed step, the dt on_fixed_tick tasks should use. 0 without
+        /// a fixed rate.
+        FORCEINLINE f64 fixed_delta_time() const
+        {
+            return fixed_step_ ? fixed_step_->step() : 0;
+        }
+
+        /// How far this tick is into the next fixed step, 0 to 1. Rendering
+        /// interpolates between the previous and current simulated state with it.
+        FORCEINLINE f64 alpha() const { return fixed_step_ ? fixed_step_->alpha() : 0; }
+
+        /// Fixed steps run so far
+        FORCEINLINE u64 current_fixed_tick() const { return current_fixed_tick_; }
+
+        /// Fixed steps skipped because ticks fell too far behind
+        FORCEINLINE u64 dropped_fixed_ticks() const
+        {
+            return fixed_step_ ? fixed_step_->dropped() : 0;
+        }
+
+        /// Blocks until the next fixed step is due, sleeping and then spinning the
+        /// last stretch for sub millisecond precision. For loops with nothing else to
+        /// do between steps (the server), called after tick(). Returns right away
+        /// without a fixed rate.
+        void wait_for_next_step();
+
+        /// Rolling durations of every on_fixed_tick and on_tick task, then the
+        /// systems ("systems"), the post_tick drain ("post_tick") and the whole tick
+        /// ("tick"). Safe to call from any thread.
+        /// @note Tasks are timed by default, on_tick.set_timing(false) turns that off
+        std::vector<TaskTiming> tick_timings() const;
+
         /// Return's the engine's reserved entity in the main registry (cannot query
         /// contexts from this registry)
         FORCEINLINE entt::entity entity() const { return engine_entity_; };
@@ -59,10 +107,8 @@ namespace v {
         /// Enqueue a callback to run right after this frame's on_tick callbacks.
         /// Multiple threads may call post_tick; execution happens
         /// on the main thread within Engine::tick().
-        void post_tick(std::function<void()> fn)
-        {
-            post_tick_queue_.enqueue(std::move(fn));
-        }
+        /// @note Callables up to InlineFn::inline_size bytes don't allocate
+        void post_tick(InlineFn fn) { post_tick_queue_.enqueue(std::move(fn)); }
 
 
         /// Get the first domain of type T, returns nullptr if none exist
@@ -70,9 +116,11 @@ namespace v {
         T* get_domain()
         {
             auto view = registry_.view<query_transform_t<T>>();
-            if (view.empty())
+            // not view.empty(), inline domains can leave tombstones behind
+            auto it = view.begin();
+            if (it == view.end())
                 return nullptr;
-            return view.template get<query_transform_t<T>>(*view.begin()).get();
+            return to_return_ptr<T>(&view.template get<query_transform_t<T>>(*it));
         }
 
         /// Directly query the entt registry
@@ -195,7 +243,8 @@ namespace v {
         /// Create a domain with it's own lifetime, retrievable using
         /// domain convenience methods.
         /// e.g. engine.view<T>() or engine.get_domain<T>().
-        /// @note Pointers to Domains may be stored, as they are heap allocated.
+        /// @note Pointers to Domains may be stored, as they are heap allocated (or sit
+        /// in a pool that never moves them, see InlineDomain).
         /// Pointer stability is guaranteed UNTIL Engine::queue_destroy_domain
         /// has been called on it. After that, pointers are no longer guaranteed to exist.
         template <DerivedFromDomain T, typename... Args>
@@ -216,19 +265,32 @@ namespace v {
             return _init_domain<T>(std::nullopt, std::forward<Args>(args)...);
         }
 
+        /// Destroys a domain's entity (and with it the domain and every other
+        /// component on it) at the end of the current tick. Everything queued in a
+        /// tick is destroyed together in one pass over the registry, and whatever the
+        /// domains hand back from DomainBase::release_deferred() is freed on a
+        /// background thread. Safe to call from any thread, invalid or repeated ids
+        /// are ignored.
         FORCEINLINE void queue_destroy_domain(const entt::entity domain_id)
         {
-            post_tick(
-                [this, domain_id]()
-                {
-                    if (registry_.valid(domain_id))
-                        registry_.destroy(domain_id);
-                });
+            destroy_queue_.enqueue(domain_id);
         }
 
+        /// Blocks until the resources released by destroyed domains so far have
+        /// actually been freed
+        FORCEINLINE void wait_for_releases() { releaser_.wait_idle(); }
+
         /// Runs every time Engine::tick is called
         DependentSink on_tick;
 
+        /// Component systems over the domain registry, run every tick right after
+        /// on_tick. Serial unless given an executor (systems.set_executor()).
+        SystemScheduler systems{ registry_ };
+
+        /// Runs at the rate given to set_fixed_rate(), before on_tick, zero or more
+        /// times per tick
+        DependentSink on_fixed_tick;
+
         /// Runs within the Engine's destructor, before domains and contexts are destroyed
         DependentSink on_destroy;
 
@@ -245,7 +307,21 @@ namespace v {
         entt::registry registry_{};
 
         /// A queue for deferred work to run after each tick()
-        moodycamel::ConcurrentQueue<std::function<void()>> post_tick_queue_{};
+        moodycamel::ConcurrentQueue<InlineFn> post_tick_queue_{};
+
+        /// Entities from queue_destroy_domain, destroyed after post_tick
+        moodycamel::ConcurrentQueue<entt::entity> destroy_queue_{};
+
+        using CollectReleases = void (*)(
+            entt::registry&, std::span<const entt::entity>, std::vector<InlineFn>&);
+        /// One per domain type ever added, keyed by its storage id
+        ud_map<entt::id_type, CollectReleases> release_hooks_{};
+
+        /// Reused between flushes
+        std::vector<entt::entity> destroy_batch_{};
+        std::vector<InlineFn>     release_batch_{};
+
+        Releaser releaser_{};
 
         /// The engine's private entity for storing contexts. This allows us to have
         /// 'contexts' (essentially singleton components) that we can fetch
@@ -263,6 +339,39 @@ namespace v {
         f64 prev_tick_span_{ 0 };
         u64 current_tick_{ 0 };
 
+        std::optional<FixedStep> fixed_step_;
+        Pacer                    pacer_;
+        u64                      current_fixed_tick_{ 0 };
+
+        /// Runs everything in post_tick_queue_, including callbacks queued meanwhile
+        void drain_post_tick();
+
+        /// Destroys everything in destroy_queue_, including entities queued by the
+        /// destructors of the ones being destroyed
+        void flush_destroys();
+
+        /// Collects release_deferred() from every T among `ids`
+        template <DerivedFromDomain T>
+        static void collect_releases(
+            entt::registry& registry, std::span<const entt::entity> ids,
+            std::vector<InlineFn>& out)
+        {
+            auto view = registry.view<query_transform_t<T>>();
+            for (const entt::entity id : ids)
+            {
+                if (!view.contains(id))
+                    continue;
+                T* domain =
+                    to_return_ptr<T>(&view.template get<query_transform_t<T>>(id));
+                if (auto fn = domain->release_deferred())
+                    out.push_back(std::move(fn));
+            }
+        }
+
+        TimingRing tick_timing_{ "tick" };
+        TimingRing systems_timing_{ "systems" };
+        TimingRing post_tick_timing_{ "post_tick" };
+
         /// Helper to create and initialize a domain, called
         /// every time on domain creation
         /// If entity is provided, domain is owned by that entity (add_component behavior)
@@ -270,15 +379,35 @@ namespace v {
         template <DerivedFromDomain T, typename... Args>
         T& _init_domain(std::optional<entt::entity> owner, Args&&... args)
         {
-            mem::owned_ptr<T> domain(std::forward<Args>(args)...);
-            T*                ptr = domain.get();
+            release_hooks_.try_emplace(
+                entt::type_hash<query_transform_t<T>>::value(), &collect_releases<T>);
 
-            ptr->init_first(*this, owner);
-            ptr->init();
+            if constexpr (std::is_same_v<query_transform_t<T>, T>)
+            {
+                // constructed inside the pool, so the entity has to come first. pinned
+                // types can't be replaced, only removed and emplaced again
+                const entt::entity entity = owner ? *owner : registry_.create();
+                registry_.remove<T>(entity);
+                T& domain = registry_.emplace<T>(entity, std::forward<Args>(args)...);
 
-            registry_.emplace_or_replace<query_transform_t<T>>(ptr->entity(), std::move(domain));
+                domain.init_first(*this, entity);
+                domain.init();
 
-            return *ptr;
+                return domain;
+            }
+            else
+            {
+                mem::owned_ptr<T> domain(std::forward<Args>(args)...);
+                T*                ptr = domain.get();
+
+                ptr->init_first(*this, owner);
+                ptr->init();
+
+                registry_.emplace_or_replace<query_transform_t<T>>(
+                    ptr->entity(), std::move(domain));
+
+                return *ptr;
+            }
         }
 
         template <typename T, typename... Args>
@@ -0,0 +1,52 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <containers/inline_fn.h>
+#include <defs.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace v {
+    /// Runs and destroys callables on a background thread. Meant for freeing big
+    /// resources (voxel stores of evicted chunks) without stalling the tick that let
+    /// go of them. The thread is only started once something is pushed.
+    class Releaser {
+    public:
+        Releaser() = default;
+        /// Releases everything still pending, then joins the thread
+        ~Releaser();
+
+        Releaser(const Releaser&)            = delete;
+        Releaser& operator=(const Releaser&) = delete;
+
+        /// Moves every callable out of `fns`, leaving it empty (capacity is kept)
+        void push(std::vector<InlineFn>& fns);
+
+        /// Blocks until everything pushed so far has been released
+        void wait_idle();
+
+        /// Callables released so far
+        FORCEINLINE u64 released() const
+        {
+            std::lock_guard lock{ mutex_ };
+            return released_;
+        }
+
+    private:
+        void run();
+
+        mutable std::mutex      mutex_;
+        std::condition_variable wake_;
+        std::condition_variable idle_;
+        std::vector<InlineFn>   pending_;
+        bool                    busy_{ false };
+        bool                    stop_{ false };
+        u64                     released_{ 0 };
+        std::thread             thread_;
+    };
+} // namespace v
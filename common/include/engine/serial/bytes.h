@@ -0,0 +1,139 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+// Small helpers for hand rolled binary formats (chunk data and other bulk payloads
+// where CBOR would be wasteful). Everything is little endian.
+
+#pragma once
+
+#include <cstring>
+#include <defs.h>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace v {
+    /// Appends little endian values to a byte buffer
+    class ByteWriter {
+    public:
+        explicit ByteWriter(std::vector<std::byte>& out) : out_(out) {}
+
+        FORCEINLINE void write_u8(u8 v) { out_.push_back(static_cast<std::byte>(v)); }
+
+        FORCEINLINE void write_u16(u16 v)
+        {
+            write_u8(static_cast<u8>(v));
+            write_u8(static_cast<u8>(v >> 8));
+        }
+
+        FORCEINLINE void write_u32(u32 v)
+        {
+            write_u16(static_cast<u16>(v));
+            write_u16(static_cast<u16>(v >> 16));
+        }
+
+        FORCEINLINE void write_u64(u64 v)
+        {
+            write_u32(static_cast<u32>(v));
+            write_u32(static_cast<u32>(v >> 32));
+        }
+
+        FORCEINLINE void write_i32(i32 v) { write_u32(static_cast<u32>(v)); }
+
+        /// LEB128 style variable length integer
+        FORCEINLINE void write_varint(u64 v)
+        {
+            while (v >= 0x80)
+            {
+                write_u8(static_cast<u8>(v) | 0x80);
+                v >>= 7;
+            }
+            write_u8(static_cast<u8>(v));
+        }
+
+        void write_bytes(const void* data, usize len)
+        {
+            const usize at = out_.size();
+            out_.resize(at + len);
+            std::memcpy(out_.data() + at, data, len);
+        }
+
+        FORCEINLINE usize size() const { return out_.size(); }
+
+    private:
+        std::vector<std::byte>& out_;
+    };
+
+    /// Reads little endian values from a byte span, throws std::runtime_error when
+    /// reading past the end (so malformed packets are caught by the channel parse path)
+    class ByteReader {
+    public:
+        ByteReader(const u8* data, u64 len) : data_(data), len_(len) {}
+
+        FORCEINLINE u8 read_u8()
+        {
+            need(1);
+            return data_[pos_++];
+        }
+
+        FORCEINLINE u16 read_u16()
+        {
+            const u16 lo = read_u8();
+            return static_cast<u16>(lo | (static_cast<u16>(read_u8()) << 8));
+        }
+
+        FORCEINLINE u32 read_u32()
+        {
+            const u32 lo = read_u16();
+            return lo | (static_cast<u32>(read_u16()) << 16);
+        }
+
+        FORCEINLINE u64 read_u64()
+        {
+            const u64 lo = read_u32();
+            return lo | (static_cast<u64>(read_u32()) << 32);
+        }
+
+        FORCEINLINE i32 read_i32() { return static_cast<i32>(read_u32()); }
+
+        FORCEINLINE u64 read_varint()
+        {
+            u64 v     = 0;
+            u32 shift = 0;
+            while (true)
+            {
+                const u8 b = read_u8();
+                v |= static_cast<u64>(b & 0x7f) << shift;
+                if (!(b & 0x80))
+                    return v;
+                shift += 7;
+                if (shift >= 64)
+                    throw std::runtime_error("ByteReader: varint too long");
+            }
+        }
+
+        /// Returns a view of the next len bytes and skips past them
+        std::span<const u8> read_bytes(u64 len)
+        {
+            need(len);
+            std::span<const u8> s{ data_ + pos_, len };
+            pos_ += len;
+            return s;
+        }
+
+        FORCEINLINE u64  remaining() const { return len_ - pos_; }
+        FORCEINLINE bool empty() const { return pos_ == len_; }
+
+    private:
+        FORCEINLINE void need(u64 n) const
+        {
+            if (UNLIKELY(n > len_ - pos_))
+                throw std::runtime_error("ByteReader: read past end of buffer");
+        }
+
+        const u8* data_;
+        u64       len_;
+        u64       pos_{ 0 };
+    };
+} // namespace v
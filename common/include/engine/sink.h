@@ -4,58 +4,174 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <containers/ud_map.h>
 #include <defs.h>
+#include <engine/timing.h>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
-struct TaskDefinition {
-    std::string              name;
-    std::function<void()>    func;
-    std::vector<std::string> after; // Tasks this one should run AFTER
-    std::vector<std::string> before; // Tasks this one should run BEFORE
+namespace tf {
+    class Executor;
+    class Taskflow;
+} // namespace tf
+
+/// Where a task is allowed to run when the sink executes in parallel
+enum class TaskAffinity : u8 {
+    /// Any worker thread of the executor
+    any,
+    /// The thread that called DependentSink::execute(), for things like SDL and
+    /// rendering that must stay on the main thread
+    main_thread,
 };
 
 /// Task dependency manager
 /// HORRIBLE NAME BTW
+///
+/// Task names are interned to integer ids and the dependency order is kept up to
+/// date incrementally as tasks come and go, so connecting a task only reorders the
+/// tasks it actually conflicts with. execute() walks a flat vector of functions and
+/// allocates nothing.
+///
+/// Runs tasks in dependency order, one after another by default. With an executor
+/// set (set_executor()), the graph is compiled to a taskflow once per change and
+/// independent tasks run concurrently, except main thread tasks, which are handed
+/// back to the thread that called execute().
+///
+/// Tasks may connect and disconnect tasks while the sink is executing, the change
+/// applies from the next execute().
+///
+/// With timing on (set_timing()), every task's duration goes into its own
+/// v::TimingRing and, under tracy, into a zone and plot named after the task.
 class DependentSink {
 public:
-    /// Connect a task with dependency specifications
+    DependentSink();
+    ~DependentSink();
+
+    DependentSink(const DependentSink&)            = delete;
+    DependentSink& operator=(const DependentSink&) = delete;
+
+    /// Connect a task with dependency specifications, replacing any task with the
+    /// same name. Tasks named in after/before don't have to exist yet.
     /// @param after Tasks that this task should run AFTER
     /// @param before Tasks that this task should run BEFORE
     /// @param name Unique name for this task
     /// @param func Function to execute
-    /// @note ALL tasks should be thread-safe
-    FORCEINLINE void connect(
+    /// @param affinity Where the task may run in parallel mode
+    /// @return False (and logs the cycle) if the task's dependencies would form a
+    /// cycle with the connected tasks, the task is not connected then
+    /// @note ALL tasks with TaskAffinity::any should be thread-safe
+    bool connect(
         const std::vector<std::string>& after, const std::vector<std::string>& before,
-        const std::string& name, std::function<void()> func)
-    {
-        TaskDefinition task_def;
-        task_def.name   = name;
-        task_def.func   = std::move(func);
-        task_def.after  = after;
-        task_def.before = before;
-
-        registered_tasks_[name] = std::move(task_def);
-        rebuild_graph();
-    }
+        const std::string& name, std::function<void()> func,
+        TaskAffinity affinity = TaskAffinity::any);
 
     /// Disconnect a task by name
     /// @param name Name of the task to remove
-    FORCEINLINE void disconnect(const std::string& name)
-    {
-        registered_tasks_.erase(name);
-        rebuild_graph();
-    }
+    void disconnect(const std::string& name);
 
     /// Execute the task graph
     void execute();
 
+    /// Runs independent tasks on the executor from now on, nullptr to go back to
+    /// running everything on the calling thread
+    void set_executor(tf::Executor* executor);
+
+    FORCEINLINE tf::Executor* executor() const { return executor_; }
+
+    /// Connected tasks
+    FORCEINLINE usize size() const { return order_.size(); }
+
+    /// Names of the connected tasks in the order a serial execute() runs them
+    std::vector<std::string> sorted() const;
+
+    /// Records how long every task takes from the next execute() on
+    void set_timing(bool enabled);
+
+    /// Rolling durations of the connected tasks, in sorted() order. Safe to call
+    /// from any thread, also while executing.
+    std::vector<v::TaskTiming> timings() const;
+
 private:
-    /// Rebuild the topological order when tasks are added or removed
-    void rebuild_graph();
+    using TaskId = u32;
+
+    struct Task {
+        std::string           name;
+        std::function<void()> func;
+        TaskAffinity          affinity{ TaskAffinity::any };
+        bool                  connected{ false };
+        /// Position in order_ while connected
+        u32 rank{ 0 };
+
+        /// Ids of the names from connect(), connected or not
+        std::vector<TaskId> after, before;
+        /// Tasks whose after/before name this one, to pick up their edges once this
+        /// task connects
+        std::vector<TaskId> mentioned_by;
+        /// Edges between connected tasks
+        std::vector<TaskId> succ, pred;
+    };
+
+    TaskId intern(const std::string& name);
+
+    /// Makes `from` run before `to`, reordering whatever lies between them.
+    /// Returns false and leaves the order alone if `to` already reaches `from`.
+    bool add_edge(TaskId from, TaskId to);
+    void remove_task(TaskId id);
+    /// Logs the path through which `from` already depends on `to`
+    void report_cycle(TaskId from, TaskId to);
+
+    /// Re-snapshots the order into the flat vectors and taskflow, or defers it to the
+    /// end of execute(). With tasks_mutex_ held.
+    void mark_dirty();
+    void refresh();
+    /// Compiles the snapshot into taskflow_
+    void compile();
+
+    void execute_parallel();
+    /// Runs the task at `index` of the snapshot, timed if timing is on
+    void run_task(u32 index);
+    /// Called from a worker, queues a main thread task and waits for it to run
+    void run_on_main(u32 index);
+
+    /// Tasks running in parallel may (dis)connect tasks
+    mutable std::mutex          tasks_mutex_;
+    std::vector<Task>           tasks_;
+    v::ud_map<std::string, u32> ids_;
+    /// Connected tasks in dependency order
+    std::vector<TaskId> order_;
+
+    /// Scratch for add_edge
+    std::vector<u32>    visit_mark_;
+    u32                 visit_epoch_{ 0 };
+    std::vector<TaskId> forward_, backward_, stack_;
+    std::vector<u32>    ranks_;
+
+    bool timing_{ false };
+    /// By task id, created the first time a task is timed and kept for good so
+    /// tracy's name pointers stay valid
+    std::vector<std::unique_ptr<v::TimingRing>> rings_;
+
+    // what execute() runs, a snapshot of order_ taken when it changes
+    std::vector<std::function<void()>>   fns_;
+    std::vector<TaskAffinity>            affinity_;
+    /// Empty when timing is off
+    std::vector<v::TimingRing*>          ring_of_;
+    std::unique_ptr<std::atomic<bool>[]> done_;
+    std::vector<std::pair<u32, u32>>     edges_;
+    bool                                 executing_{ false };
+    bool                                 dirty_{ false };
+
+    tf::Executor*                 executor_{ nullptr };
+    std::unique_ptr<tf::Taskflow> taskflow_;
+    bool                          has_main_tasks_{ false };
 
-    v::ud_map<std::string, TaskDefinition> registered_tasks_;
-    std::vector<std::string>               sorted_tasks_;
+    std::mutex              main_mutex_;
+    std::condition_variable main_cv_;
+    std::vector<u32>        main_queue_;
+    bool                    finished_{ false };
 };
@@ -0,0 +1,232 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <containers/ud_map.h>
+#include <defs.h>
+#include <engine/domain.h>
+#include <glm/glm.hpp>
+#include <limits>
+#include <vector>
+#include <vox/aabb.h>
+
+namespace v {
+    /// Points keyed by entity, bucketed into a hash of uniform cells so box, radius and
+    /// nearest neighbour queries only touch the cells around them.
+    ///
+    /// Queries that would cover more cells than there are occupied ones walk the
+    /// occupied cells instead, so huge or far reaching queries fall back to a scan of
+    /// the cells rather than of empty space.
+    class SpatialHash {
+    public:
+        /// @param cell_size Side of a cell in world units, roughly the radius most
+        /// queries are made with
+        explicit SpatialHash(f32 cell_size = 16);
+
+        /// Inserts the entity, or moves it if it is already in the hash
+        void insert(entt::entity entity, const glm::vec3& pos);
+        /// Returns false if the entity wasn't in the hash
+        bool erase(entt::entity entity);
+        void clear();
+
+        FORCEINLINE usize size() const { return slots_.size(); }
+        FORCEINLINE bool  contains(entt::entity entity) const
+        {
+            return slots_.contains(entity);
+        }
+        FORCEINLINE f32 cell_size() const { return cell_size_; }
+        /// Cells holding at least one entity
+        FORCEINLINE usize cell_count() const { return cells_.size(); }
+
+        /// Calls fn(entity, pos) for every entity inside the box (bounds inclusive)
+        template <typename F>
+        void for_each_in_box(const AABB& box, F&& fn) const
+        {
+            for_each_cell(
+                cell_of(box.min), cell_of(box.max),
+                [&](const std::vector<Entry>& entries)
+                {
+                    for (const Entry& e : entries)
+                    {
+                        if (e.pos.x >= box.min.x && e.pos.y >= box.min.y &&
+                            e.pos.z >= box.min.z && e.pos.x <= box.max.x &&
+                            e.pos.y <= box.max.y && e.pos.z <= box.max.z)
+                            fn(e.entity, e.pos);
+                    }
+                });
+        }
+
+        /// Calls fn(entity, pos) for every entity within radius of center
+        template <typename F>
+        void for_each_in_radius(const glm::vec3& center, f32 radius, F&& fn) const
+        {
+            const f32 r2 = radius * radius;
+            for_each_cell(
+                cell_of(center - radius), cell_of(center + radius),
+                [&](const std::vector<Entry>& entries)
+                {
+                    for (const Entry& e : entries)
+                    {
+                        const glm::vec3 d = e.pos - center;
+                        if (glm::dot(d, d) <= r2)
+                            fn(e.entity, e.pos);
+                    }
+                });
+        }
+
+        /// Appends the entities inside the box to out
+        void query_box(const AABB& box, std::vector<entt::entity>& out) const;
+        /// Appends the entities within radius of center to out
+        void query_radius(
+            const glm::vec3& center, f32 radius, std::vector<entt::entity>& out) const;
+
+        /// Replaces out with up to k entities closest to pos, nearest first
+        /// @param max_distance Entities further away than this are never returned
+        void nearest(
+            const glm::vec3& pos, usize k, std::vector<entt::entity>& out,
+            f32 max_distance = std::numeric_limits<f32>::infinity()) const;
+
+    private:
+        struct Entry {
+            glm::vec3    pos;
+            entt::entity entity;
+        };
+
+        struct Slot {
+            u64 cell;
+            u32 index;
+        };
+
+        struct CellPos {
+            i32 x, y, z;
+        };
+
+        /// Cell coordinates are packed 21 bits each
+        static constexpr i32 k_cell_bits = 21;
+        static constexpr i32 k_cell_max  = (1 << (k_cell_bits - 1)) - 1;
+
+        FORCEINLINE CellPos cell_of(const glm::vec3& p) const
+        {
+            const auto axis = [&](f32 v)
+            {
+                const f32 c = std::floor(v * inv_cell_size_);
+                return static_cast<i32>(std::clamp<f32>(c, -k_cell_max, k_cell_max));
+            };
+            return { axis(p.x), axis(p.y), axis(p.z) };
+        }
+
+        static FORCEINLINE u64 key_of(i32 x, i32 y, i32 z)
+        {
+            constexpr u64 mask = (1ull << k_cell_bits) - 1;
+            return (static_cast<u64>(x) & mask) |
+                (static_cast<u64>(y) & mask) << k_cell_bits |
+                (static_cast<u64>(z) & mask) << (k_cell_bits * 2);
+        }
+
+        static CellPos pos_of(u64 key);
+
+        /// Calls fn(entries) for every occupied cell in [lo, hi]
+        template <typename F>
+        void for_each_cell(const CellPos& lo, const CellPos& hi, F&& fn) const
+        {
+            const u64 span = static_cast<u64>(hi.x - lo.x + 1) *
+                static_cast<u64>(hi.y - lo.y + 1) * static_cast<u64>(hi.z - lo.z + 1);
+            if (span > cells_.size())
+            {
+                for (const auto& [key, entries] : cells_)
+                {
+                    const CellPos c = pos_of(key);
+                    if (c.x >= lo.x && c.y >= lo.y && c.z >= lo.z && c.x <= hi.x &&
+                        c.y <= hi.y && c.z <= hi.z)
+                        fn(entries);
+                }
+                return;
+            }
+
+            for (i32 z = lo.z; z <= hi.z; ++z)
+                for (i32 y = lo.y; y <= hi.y; ++y)
+                    for (i32 x = lo.x; x <= hi.x; ++x)
+                        if (auto it = cells_.find(key_of(x, y, z)); it != cells_.end())
+                            fn(it->second);
+        }
+
+        void remove_from_cell(const Slot& slot);
+
+        f32 cell_size_;
+        f32 inv_cell_size_;
+
+        ud_map<u64, std::vector<Entry>> cells_{};
+        ud_map<entt::entity, Slot>      slots_{};
+    };
+
+    struct SpatialConfig {
+        /// See SpatialHash
+        f32 cell_size{ 16 };
+    };
+
+    /// Keeps a SpatialHash of every entity with a Pos3d, so "what is near here" stops
+    /// being a scan over the whole Pos3d pool.
+    ///
+    /// The index follows the registry's construct, update and destroy signals for
+    /// Pos3d. Those only fire through the registry, so code that writes Pos3d::val
+    /// through a reference has to go through registry().patch<Pos3d>() (or call
+    /// refresh()) for the index to see the move.
+    class SpatialIndex : public SDomain<SpatialIndex> {
+    public:
+        explicit SpatialIndex(
+            const SpatialConfig& config = {}, const std::string& name = "Spatial Index");
+        ~SpatialIndex() override;
+
+        void init() override;
+
+        /// Re-reads the entity's Pos3d, for positions written without patch()
+        void refresh(entt::entity entity);
+        /// Rebuilds the whole index from the Pos3d pool
+        void rebuild();
+
+        FORCEINLINE const SpatialHash& hash() const { return hash_; }
+
+        template <typename F>
+        FORCEINLINE void for_each_in_box(const AABB& box, F&& fn) const
+        {
+            hash_.for_each_in_box(box, std::forward<F>(fn));
+        }
+
+        template <typename F>
+        FORCEINLINE void
+        for_each_in_radius(const glm::vec3& center, f32 radius, F&& fn) const
+        {
+            hash_.for_each_in_radius(center, radius, std::forward<F>(fn));
+        }
+
+        FORCEINLINE void query_box(const AABB& box, std::vector<entt::entity>& out) const
+        {
+            hash_.query_box(box, out);
+        }
+
+        FORCEINLINE void query_radius(
+            const glm::vec3& center, f32 radius, std::vector<entt::entity>& out) const
+        {
+            hash_.query_radius(center, radius, out);
+        }
+
+        FORCEINLINE void nearest(
+            const glm::vec3& pos, usize k, std::vector<entt::entity>& out,
+            f32 max_distance = std::numeric_limits<f32>::infinity()) const
+        {
+            hash_.nearest(pos, k, out, max_distance);
+        }
+
+    private:
+        void on_set(entt::registry& registry, entt::entity entity);
+        void on_erase(entt::registry& registry, entt::entity entity);
+        void disconnect();
+
+        SpatialHash hash_;
+        bool        connected_{ false };
+    };
+} // namespace v
@@ -0,0 +1,193 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#pragma once
+
+#include <defs.h>
+#include <engine/traits.h>
+#include <entt/entt.hpp>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tf {
+    class Executor;
+    class Taskflow;
+} // namespace tf
+
+namespace v {
+    /// A component (or domain) a system only reads, its view yields const references
+    template <typename T>
+    struct Read {};
+
+    /// A component (or domain) a system modifies
+    template <typename T>
+    struct Write {};
+
+    /// What a system touches, e.g. System<Read<Pos3d>, Write<Rotation>>. The system
+    /// is handed a view over exactly those types and may not touch anything else.
+    template <typename... Access>
+    struct System {};
+
+    namespace detail {
+        template <typename A>
+        struct system_access;
+
+        template <typename T>
+        struct system_access<Read<T>> {
+            using component              = query_transform_t<T>;
+            using view_type              = const component;
+            static constexpr bool writes = false;
+        };
+
+        template <typename T>
+        struct system_access<Write<T>> {
+            using component              = query_transform_t<T>;
+            using view_type              = component;
+            static constexpr bool writes = true;
+        };
+
+        template <typename S>
+        struct system_traits {
+            static_assert(
+                false, "Systems are declared as System<Read<A>, Write<B>, ...>");
+        };
+
+        template <typename... Access>
+        struct system_traits<System<Access...>> {
+            static_assert(sizeof...(Access) > 0, "A system has to access something");
+
+            static auto view(entt::registry& registry)
+            {
+                return registry.view<typename system_access<Access>::view_type...>();
+            }
+
+            /// Creates the storages up front, the registry may not grow them while
+            /// systems run in parallel
+            static void assure(entt::registry& registry)
+            {
+                (registry.storage<typename system_access<Access>::component>(), ...);
+            }
+
+            /// If anything listens for updates to a component the system writes.
+            /// Writes through a view don't emit on_update, and patching from parallel
+            /// systems would race the listeners
+            static bool writes_observed(entt::registry& registry)
+            {
+                return (
+                    (system_access<Access>::writes &&
+                     !registry.on_update<typename system_access<Access>::component>()
+                          .empty()) ||
+                    ...);
+            }
+
+            static void declare(
+                std::vector<entt::id_type>& reads, std::vector<entt::id_type>& writes)
+            {
+                (
+                    (system_access<Access>::writes ? writes : reads)
+                        .push_back(entt::type_hash<
+                                   typename system_access<Access>::component>::value()),
+                    ...);
+            }
+        };
+    } // namespace detail
+
+    /// Runs systems over the registry every tick. Each system declares the components
+    /// it reads and writes, and two systems conflict if one writes something the other
+    /// touches. Conflicting systems always run in the order they were added, anything
+    /// else may run at the same time, so a parallel run ends in exactly the same state
+    /// as a serial one.
+    ///
+    /// Ex.
+    /// engine.systems.add<System<Read<Spin>, Write<Rotation>>>(
+    ///     "spin", [](auto view) {
+    ///         for (auto [e, spin, rot] : view.each())
+    ///             rot.val = spin.val * rot.val;
+    ///     });
+    ///
+    /// @note Systems may modify the components they write, but not create or destroy
+    /// entities or add component types the registry hasn't seen, defer those with
+    /// Engine::post_tick. Adding and removing systems is main thread only, and not
+    /// from within a system.
+    /// @note Components with on_update listeners (e.g. Pos3d, which SpatialIndex
+    /// follows) can't be written by systems. Writing through the view skips the
+    /// listeners, and patching would call them from several threads at once. add()
+    /// rejects such systems, and listeners connected later aren't caught, so write
+    /// those components with registry.patch on the main thread instead.
+    class SystemScheduler {
+    public:
+        explicit SystemScheduler(entt::registry& registry);
+        ~SystemScheduler();
+
+        SystemScheduler(const SystemScheduler&)            = delete;
+        SystemScheduler& operator=(const SystemScheduler&) = delete;
+
+        /// Adds a system after the ones already added, replacing any with the same name.
+        /// Systems writing a component something listens to updates of are rejected
+        /// @param fn Called with registry.view<...>() over the declared types, Read<T>
+        /// as const T
+        template <typename S, typename F>
+        void add(const std::string& name, F&& fn)
+        {
+            using traits = detail::system_traits<S>;
+            if (traits::writes_observed(registry_))
+            {
+                LOG_ERROR(
+                    "System '{}' writes a component with on_update listeners, not adding "
+                    "it",
+                    name);
+                return;
+            }
+            traits::assure(registry_);
+
+            Entry entry{ name };
+            traits::declare(entry.reads, entry.writes);
+            entry.func = [&registry = registry_, fn = std::forward<F>(fn)]() mutable
+            { fn(traits::view(registry)); };
+            add_entry(std::move(entry));
+        }
+
+        /// Removes a system by name, returns false if there was none
+        bool remove(const std::string& name);
+
+        /// Runs every system once, in batches on the executor if one is set
+        void execute();
+
+        /// Runs systems on the executor from now on, nullptr to go back to running
+        /// them one after another on the calling thread
+        void set_executor(tf::Executor* executor);
+
+        FORCEINLINE tf::Executor* executor() const { return executor_; }
+
+        FORCEINLINE usize size() const { return systems_.size(); }
+
+        /// System names grouped into batches. Nothing in a batch conflicts, and each
+        /// system runs after every earlier system it conflicts with (which sits in an
+        /// earlier batch).
+        std::vector<std::vector<std::string>> batches();
+
+    private:
+        struct Entry {
+            std::string                name;
+            std::vector<entt::id_type> reads, writes;
+            std::function<void()>      func;
+            /// Earlier systems this one has to wait for
+            std::vector<u32> after;
+            u32              batch{ 0 };
+        };
+
+        void add_entry(Entry entry);
+        /// Recomputes dependencies and batches, and the taskflow if parallel
+        void rebuild();
+
+        entt::registry&    registry_;
+        std::vector<Entry> systems_;
+        bool               dirty_{ false };
+
+        tf::Executor*                 executor_{ nullptr };
+        std::unique_ptr<tf::Taskflow> taskflow_;
+    };
+} // namespace v
@@ -0,0 +1,68 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <defs.h>
+#include <limits>
+#include <profile.h>
+#include <string>
+
+namespace v {
+    /// Rolling durations of one recurring task, see TimingRing::summarize()
+    struct TaskTiming {
+        std::string name;
+        /// Runs recorded in total, the percentiles only cover the last
+        /// TimingRing::capacity of them
+        u64 runs{ 0 };
+        u64 p50_ns{ 0 };
+        u64 p99_ns{ 0 };
+        u64 max_ns{ 0 };
+    };
+
+    /// Last few durations of a task. One thread pushes at a time (whichever runs the
+    /// task), any thread may summarize without locking, a summary racing a push may
+    /// see a sample from the next run.
+    class TimingRing {
+    public:
+        static constexpr u32 capacity = 256;
+
+        explicit TimingRing(std::string name);
+
+        TimingRing(const TimingRing&)            = delete;
+        TimingRing& operator=(const TimingRing&) = delete;
+
+        FORCEINLINE void push(u64 ns)
+        {
+            const u64 head = head_.load(std::memory_order_relaxed);
+            const u32 clamped =
+                ns > std::numeric_limits<u32>::max() ? std::numeric_limits<u32>::max()
+                                                     : static_cast<u32>(ns);
+            samples_[head & (capacity - 1)].store(clamped, std::memory_order_relaxed);
+            head_.store(head + 1, std::memory_order_release);
+            V_PROFILE_PLOT(plot_name_.c_str(), static_cast<f64>(ns) * 1e-3);
+        }
+
+        /// Percentiles over the samples currently in the ring
+        TaskTiming summarize() const;
+
+        FORCEINLINE const std::string& name() const { return name_; }
+
+#ifdef TRACY_ENABLE
+        /// Gives every task its own zone name, tracy keeps the pointer so the ring
+        /// must outlive the profiling session
+        tracy::SourceLocationData zone_location{};
+#endif
+
+    private:
+        std::string name_;
+        /// "<name> (us)", tracy identifies plots by the name pointer
+        std::string plot_name_;
+
+        std::atomic<u64>                        head_{ 0 };
+        std::array<std::atomic<u32>, capacity> samples_{};
+    };
+} // namespace v
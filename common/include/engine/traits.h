@@ -49,11 +49,12 @@ namespace v {
 
     /// Utility to convert a pointer to a type's storage type (from query_transform_t)
     /// to a raw pointer.
-    /// Automatically handles owned_ptr, unique_ptr, raw pointers, etc.
+    /// Automatically handles owned_ptr, unique_ptr, raw pointers, etc. Types stored
+    /// as themselves (InlineDomain) pass straight through.
     template <typename T>
     auto to_return_ptr(query_transform_t<T>* storage_ptr)
     {
-        if constexpr (InheritsFromQueryBy<T>)
+        if constexpr (InheritsFromQueryBy<T> && !std::is_same_v<query_transform_t<T>, T>)
         {
             if constexpr (HasGetMethod<query_transform_t<T>>)
             {
@@ -84,7 +85,7 @@ namespace v {
     template <typename T>
     auto to_return_ptr(const query_transform_t<T>* storage_ptr)
     {
-        if constexpr (InheritsFromQueryBy<T>)
+        if constexpr (InheritsFromQueryBy<T> && !std::is_same_v<query_transform_t<T>, T>)
         {
             if constexpr (HasGetMethod<query_transform_t<T>>)
             {
@@ -0,0 +1,153 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <defs.h>
+#include <memory_resource>
+#include <vector>
+
+namespace v::mem {
+    class FrameArena;
+
+    /// std::pmr adapter over a FrameArena, so pmr containers can opt in:
+    /// std::pmr::vector<u32> ids{ FrameArena::local().resource() };
+    /// Deallocation does nothing, memory comes back when the arena resets or rewinds.
+    class FrameResource final : public std::pmr::memory_resource {
+    public:
+        explicit FrameResource(FrameArena& arena) : arena_(arena) {}
+
+    private:
+        void* do_allocate(usize bytes, usize align) override;
+        void  do_deallocate(void*, usize, usize) override {}
+        bool  do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+
+        FrameArena& arena_;
+    };
+
+    /// Bump allocator for temporaries that don't outlive the tick. Every thread gets
+    /// its own (local()), and Engine::tick() ends the frame for all of them, after
+    /// which everything they handed out is invalid. Blocks are kept between frames, so
+    /// once warmed up a frame allocates nothing from the heap.
+    ///
+    /// Outside of release builds, memory is filled with 0xDD when it's reset or
+    /// rewound, so reading it afterwards shows up as garbage instead of stale data
+    /// that happens to look right.
+    ///
+    /// @note Nothing allocated here may be kept past the end of the tick, or handed to
+    /// another thread that could hold on to it that long
+    class FrameArena {
+    public:
+        static constexpr usize k_block_size = 64 * 1024;
+        static constexpr u8    k_poison     = 0xDD;
+
+        FrameArena() : resource_(*this) {}
+        ~FrameArena();
+
+        FrameArena(const FrameArena&)            = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        /// The calling thread's arena. Threads other than the one calling end_frame()
+        /// reset theirs here, the first time they use it in a new frame.
+        static FrameArena& local();
+
+        /// Ends the frame for every thread's arena, resetting the caller's right away.
+        /// Called by Engine::tick().
+        static void end_frame();
+
+        FORCEINLINE void* allocate(usize bytes, usize align = alignof(std::max_align_t))
+        {
+            allocations_++;
+            if (void* ptr = bump(bytes, align))
+                return ptr;
+            return allocate_slow(bytes, align);
+        }
+
+        template <typename T>
+        FORCEINLINE T* allocate_array(usize count)
+        {
+            return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        /// Frees everything at once, keeping the blocks for the next frame
+        void reset();
+
+        struct Marker {
+            u32   block;
+            usize offset;
+        };
+
+        FORCEINLINE Marker mark() const { return { current_, offset_ }; }
+
+        /// Frees everything allocated since `marker` was taken
+        void rewind(Marker marker);
+
+        /// Rewinds the arena when it goes out of scope, for temporaries that only live
+        /// as long as a function call. Makes the arena safe to use from code that may
+        /// also run outside of a tick (tools, tests), since nothing piles up.
+        class Scope {
+        public:
+            explicit Scope(FrameArena& arena) : arena_(arena), marker_(arena.mark()) {}
+            ~Scope() { arena_.rewind(marker_); }
+
+            Scope(const Scope&)            = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            FrameArena& arena_;
+            Marker      marker_;
+        };
+
+        FORCEINLINE std::pmr::memory_resource* resource() { return &resource_; }
+
+        /// Allocations since the last reset
+        FORCEINLINE u64 allocations() const { return allocations_; }
+
+        /// Bytes held across all blocks
+        usize capacity() const;
+
+    private:
+        struct Block {
+            std::byte* data;
+            usize      size;
+        };
+
+        /// From the current block, nullptr if it doesn't fit
+        FORCEINLINE void* bump(usize bytes, usize align)
+        {
+            if (blocks_.empty())
+                return nullptr;
+            // aligned by address, blocks only guarantee max_align_t
+            const Block&    block = blocks_[current_];
+            const uintptr_t base  = reinterpret_cast<uintptr_t>(block.data);
+            const usize     start = ((base + offset_ + align - 1) & ~(align - 1)) - base;
+            if (start + bytes > block.size)
+                return nullptr;
+            offset_ = start + bytes;
+            return block.data + start;
+        }
+
+        void* allocate_slow(usize bytes, usize align);
+        /// Fills [from, to) with k_poison, outside of release builds
+        void poison(Marker from, Marker to);
+
+        std::vector<Block> blocks_;
+        u32                current_{ 0 };
+        usize              offset_{ 0 };
+        u64                allocations_{ 0 };
+        /// The frame this arena was last reset in, see local()
+        u64                frame_{ 0 };
+        FrameResource      resource_;
+    };
+
+    inline void* FrameResource::do_allocate(usize bytes, usize align)
+    {
+        return arena_.allocate(bytes, align);
+    }
+} // namespace v::mem
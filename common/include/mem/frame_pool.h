@@ -0,0 +1,90 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#pragma once
+
+#include <array>
+#include <defs.h>
+#include <new>
+
+namespace v::mem {
+    /// Free lists of fixed size classes, for objects that come and go all the time in
+    /// a handful of sizes (coroutine frames). Every thread has its own (local()), and a
+    /// block may be freed on a different thread than the one it came from.
+    ///
+    /// Freed blocks stay in the pool for the next allocation of their class instead of
+    /// going back to the heap, so once warmed up allocating is a pop off a list. The
+    /// pool holds on to the most it ever had out at once, until its thread exits.
+    /// Sizes past k_max_size go straight to the heap.
+    class FramePool {
+    public:
+        static constexpr usize k_granularity = 64;
+        static constexpr usize k_max_size    = 2048;
+        static constexpr usize k_classes     = k_max_size / k_granularity;
+
+        FramePool() = default;
+        ~FramePool();
+
+        FramePool(const FramePool&)            = delete;
+        FramePool& operator=(const FramePool&) = delete;
+
+        /// The calling thread's pool
+        static FramePool& local();
+
+        FORCEINLINE void* allocate(usize bytes)
+        {
+            if (UNLIKELY(bytes > k_max_size))
+                return ::operator new(bytes);
+
+            FreeBlock*& head = free_[class_of(bytes)];
+            if (FreeBlock* block = head)
+            {
+                head = block->next;
+                cached_--;
+                return block;
+            }
+            return ::operator new(class_size(bytes));
+        }
+
+        /// `bytes` is what the block was allocated with
+        FORCEINLINE void deallocate(void* ptr, usize bytes)
+        {
+            if (UNLIKELY(bytes > k_max_size))
+            {
+                ::operator delete(ptr);
+                return;
+            }
+
+            FreeBlock*& head  = free_[class_of(bytes)];
+            auto*       block = static_cast<FreeBlock*>(ptr);
+            block->next       = head;
+            head              = block;
+            cached_++;
+        }
+
+        /// Freed blocks waiting for reuse
+        FORCEINLINE usize cached() const { return cached_; }
+
+        /// Gives every cached block back to the heap
+        void trim();
+
+    private:
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+
+        static FORCEINLINE usize class_of(usize bytes)
+        {
+            return bytes == 0 ? 0 : (bytes - 1) / k_granularity;
+        }
+
+        static FORCEINLINE usize class_size(usize bytes)
+        {
+            return (class_of(bytes) + 1) * k_granularity;
+        }
+
+        std::array<FreeBlock*, k_classes> free_{};
+        usize                             cached_{ 0 };
+    };
+} // namespace v::mem
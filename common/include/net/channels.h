@@ -12,7 +12,10 @@
 
 #include <engine/contexts/net/channel.h>
 #include <engine/contexts/net/ctx.h>
+#include <engine/serial/bytes.h>
 #include <engine/serial/serde.h>
+#include <world/edit_codec.h>
+#include <world/world.h>
 
 namespace v {
     struct ConnectionRequest {
@@ -33,4 +36,141 @@ namespace v {
     };
 
     class ChatChannel : public NetChannel<ChatChannel, ChatMessage> {};
+
+    struct ChunkVersion {
+        i32 x;
+        i32 y;
+        i32 z;
+        u64 version;
+    };
+
+    /// Client -> server, describes which chunks the client wants streamed
+    struct ChunkInterest {
+        /// The chunk the client is centered on
+        i32 x;
+        i32 y;
+        i32 z;
+        /// Radius in chunks
+        i32 view_distance;
+        /// Chunks the client already holds, so the server can send deltas instead of
+        /// whole chunks. Usually only filled on the first message after connecting, or
+        /// to ask for a resync (version 0).
+        std::vector<ChunkVersion> known;
+
+        SERDE_IMPL(ChunkInterest);
+    };
+
+    class ChunkInterestChannel : public NetChannel<ChunkInterestChannel, ChunkInterest> {};
+
+    enum class ChunkPacketKind : u8 { Full = 0, Delta = 1, Unload = 2 };
+
+    /// Server -> client chunk data.
+    /// Hand rolled instead of SERDE_IMPL, since the body is already a compact binary
+    /// encoding and CBOR would only get in the way.
+    struct ChunkPacket {
+        /// kind + pos + version + base_version
+        static constexpr usize header_size = 1 + 3 * sizeof(i32) + 2 * sizeof(u64);
+
+        ChunkPacketKind kind{};
+        ChunkPos        pos{};
+        /// The chunk version after applying this packet
+        u64 version{ 0 };
+        /// (Delta) the version the edits apply on top of
+        u64 base_version{ 0 };
+        /// Full: SparseVoxelOctree128::serialize() output
+        /// Delta: edits written with write_edits()
+        std::vector<u8> body{};
+
+        /// Writes the header of a packet, the body is appended by the caller
+        static void write_header(
+            ByteWriter& w, ChunkPacketKind kind, ChunkPos pos, u64 version,
+            u64 base_version)
+        {
+            w.write_u8(static_cast<u8>(kind));
+            w.write_i32(pos.x);
+            w.write_i32(pos.y);
+            w.write_i32(pos.z);
+            w.write_u64(version);
+            w.write_u64(base_version);
+        }
+
+        /// @note edits must be normalized, see VoxelEditCodec
+        static void write_edits(ByteWriter& w, std::span<const ChunkEdit> edits)
+        {
+            VoxelEditCodec::encode(w, edits);
+        }
+
+        /// Decodes a Delta body
+        std::vector<ChunkEdit> read_edits() const
+        {
+            ByteReader             r{ body.data(), body.size() };
+            std::vector<ChunkEdit> edits;
+            VoxelEditCodec::decode(r, edits);
+            return edits;
+        }
+
+        static ChunkPacket parse(const u8* bytes, u64 len)
+        {
+            ByteReader  r{ bytes, len };
+            ChunkPacket p{};
+            const u8    kind = r.read_u8();
+            if (kind > static_cast<u8>(ChunkPacketKind::Unload))
+                throw std::runtime_error("ChunkPacket: bad kind");
+            p.kind         = static_cast<ChunkPacketKind>(kind);
+            p.pos.x        = r.read_i32();
+            p.pos.y        = r.read_i32();
+            p.pos.z        = r.read_i32();
+            p.version      = r.read_u64();
+            p.base_version = r.read_u64();
+            auto rest      = r.read_bytes(r.remaining());
+            p.body.assign(rest.begin(), rest.end());
+            return p;
+        }
+
+        std::vector<std::byte> serialize() const
+        {
+            std::vector<std::byte> out;
+            ByteWriter             w{ out };
+            write_header(w, kind, pos, version, base_version);
+            w.write_bytes(body.data(), body.size());
+            return out;
+        }
+    };
+
+    class ChunkStreamChannel : public NetChannel<ChunkStreamChannel, ChunkPacket> {};
+
+    /// A tick's worth of edits to one chunk, see VoxelEditCodec for the encoding
+    struct VoxelEditBatch {
+        /// Most edits a batch may decode to, bigger ones fail to parse
+        static constexpr u32 k_max_edits = 32u << 10;
+
+        ChunkPos pos{};
+        /// Normalized (sorted by index, no duplicates)
+        std::vector<ChunkEdit> edits{};
+
+        static VoxelEditBatch parse(const u8* bytes, u64 len)
+        {
+            ByteReader     r{ bytes, len };
+            VoxelEditBatch b{};
+            b.pos.x = r.read_i32();
+            b.pos.y = r.read_i32();
+            b.pos.z = r.read_i32();
+            VoxelEditCodec::decode(r, b.edits, k_max_edits);
+            return b;
+        }
+
+        std::vector<std::byte> serialize() const
+        {
+            std::vector<std::byte> out;
+            ByteWriter             w{ out };
+            w.write_i32(pos.x);
+            w.write_i32(pos.y);
+            w.write_i32(pos.z);
+            VoxelEditCodec::encode(w, edits);
+            return out;
+        }
+    };
+
+    /// Client -> server voxel edits, batched per chunk per tick
+    class VoxelEditChannel : public NetChannel<VoxelEditChannel, VoxelEditBatch> {};
 } // namespace v
@@ -14,6 +14,9 @@
     #define V_PROFILE_ZONE_NAMED(name)              ZoneScopedN(name)
     #define V_PROFILE_ZONE_COLOR(color)             ZoneScopedC(color)
     #define V_PROFILE_ZONE_NAMED_COLOR(name, color) ZoneScopedNC(name, color)
+    // a zone from a tracy::SourceLocationData that lives elsewhere, for runtime names
+    #define V_PROFILE_ZONE_LOCATION(location) \
+        tracy::ScopedZone ___v_location_zone(location)
 
     // Frame marking - marks frame boundaries for frame-based profiling
     #define V_PROFILE_FRAME_MARK             FrameMark
@@ -47,6 +50,7 @@
     #define V_PROFILE_ZONE_NAMED(name)
     #define V_PROFILE_ZONE_COLOR(color)
     #define V_PROFILE_ZONE_NAMED_COLOR(name, color)
+    #define V_PROFILE_ZONE_LOCATION(location)
 
     #define V_PROFILE_FRAME_MARK
     #define V_PROFILE_FRAME_MARK_NAMED(name)
@@ -0,0 +1,63 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#pragma once
+
+#include <defs.h>
+
+namespace v {
+    /// Accumulator for fixed timestep loops. Real time goes in through advance(), whole
+    /// steps come out, the remainder carries over to the next call.
+    class FixedStep {
+    public:
+        /// @param step Seconds per step
+        /// @param max_catch_up Most steps a single advance() may return, the backlog
+        /// beyond that is dropped so a long stall doesn't snowball into more stalls
+        explicit FixedStep(f64 step, u32 max_catch_up = 8);
+
+        /// Adds elapsed seconds and returns how many steps to run now
+        u32 advance(f64 elapsed);
+
+        /// How far the accumulator is into the next step, 0 to 1. Render code
+        /// interpolates between the last two simulated states with it.
+        FORCEINLINE f64 alpha() const { return accumulator_ / step_; }
+
+        FORCEINLINE f64 step() const { return step_; }
+
+        /// Seconds until the next step is due
+        FORCEINLINE f64 until_next() const { return step_ - accumulator_; }
+
+        /// Steps dropped by the catch-up limit so far
+        FORCEINLINE u64 dropped() const { return dropped_; }
+
+    private:
+        f64 step_;
+        u32 max_catch_up_;
+        f64 accumulator_{ 0 };
+        u64 dropped_{ 0 };
+    };
+
+    /// Waits for deadlines more precisely than the OS sleep alone: it sleeps while the
+    /// deadline is far off and spins through the last stretch. The stretch follows how
+    /// much the OS has been oversleeping, so a precise scheduler spins very little.
+    class Pacer {
+    public:
+        /// @param spin False to only sleep, for loops that care more about the CPU
+        /// than about precision (io threads)
+        explicit Pacer(bool spin = true) : spin_(spin) {}
+
+        /// Blocks until time::ns() reaches `deadline_ns`
+        void wait_until(u64 deadline_ns);
+
+        /// How early the pacer stops sleeping and starts spinning
+        FORCEINLINE u64 spin_ns() const { return spin_ns_; }
+
+    private:
+        static constexpr u64 k_min_spin = 50'000;
+        static constexpr u64 k_max_spin = 2'000'000;
+
+        bool spin_;
+        u64  spin_ns_{ 250'000 };
+    };
+} // namespace v
@@ -49,7 +49,8 @@ namespace v {
 
                     camera_->add_yaw(-delta.x * look_sensitivity);
                     camera_->add_pitch(delta.y * look_sensitivity);
-                });
+                },
+                TaskAffinity::main_thread);
         }
 
         ~DevCamera() { engine().on_tick.disconnect("dev_cam_upd"); }
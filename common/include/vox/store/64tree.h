@@ -164,6 +164,13 @@ namespace v {
             dirty_ = true;
         }
 
+        /// Returns the approximate heap footprint of the tree in bytes.
+        /// @note Walks the whole tree, cache the result if called often
+        usize memory_usage() const;
+
+        /// Number of allocated nodes, walks the whole tree
+        usize node_count() const;
+
     private:
         S64Node_UP root_{ nullptr };
         AABB       bounds_;
@@ -177,6 +184,9 @@ namespace v {
         /// Recursively destroys nodes
         void clear_node(S64Node_UP& node);
 
+        /// Bytes held by node and everything under it, counting nodes on the way
+        static usize node_usage(const S64Node& node, usize& nodes);
+
         /// Fills an entire node with a single type. Very fast.
         void fill_node(S64Node_UP& node, VoxelType t);
 
@@ -8,6 +8,7 @@
 #include <array>
 #include <cstddef>
 #include <defs.h>
+#include <engine/serial/bytes.h>
 #include <memory>
 #include <utility>
 
@@ -26,6 +27,24 @@ namespace v {
         SparseVoxelOctree128() = default;
         ~SparseVoxelOctree128() { clear(); }
 
+        // owns raw nodes, so copying would double free
+        SparseVoxelOctree128(const SparseVoxelOctree128&)            = delete;
+        SparseVoxelOctree128& operator=(const SparseVoxelOctree128&) = delete;
+
+        SparseVoxelOctree128(SparseVoxelOctree128&& other) noexcept :
+            root_(std::exchange(other.root_, nullptr))
+        {}
+
+        SparseVoxelOctree128& operator=(SparseVoxelOctree128&& other) noexcept
+        {
+            if (this != &other)
+            {
+                clear();
+                root_ = std::exchange(other.root_, nullptr);
+            }
+            return *this;
+        }
+
         /// Returns the voxel value at local coordinates [0,127]^3
         voxel_t get(i32 x, i32 y, i32 z) const
         {
@@ -54,9 +73,70 @@ namespace v {
             root_ = nullptr;
         }
 
+        /// Sets every voxel to v, leaving a single leaf
+        void fill(voxel_t v)
+        {
+            clear();
+            if (v != 0)
+                root_ = new_leaf(v);
+        }
+
         /// Returns approximate node count (for debugging)
         size_t node_count() const { return count_nodes(root_); }
 
+        /// Returns the approximate heap footprint of the tree in bytes.
+        /// @note Walks the whole tree, cache the result if called often
+        size_t memory_usage() const { return sizeof(*this) + node_count() * sizeof(Node); }
+
+        /// Appends a compact pre-order encoding of the tree to out.
+        /// Leaves are a tag + value, internal nodes a tag + child mask followed by the
+        /// present children, so cost scales with node count rather than volume.
+        void serialize(std::vector<std::byte>& out) const
+        {
+            ByteWriter w{ out };
+            w.write_u8(root_ ? 1 : 0);
+            if (root_)
+                write_node(w, root_);
+        }
+
+        /// Replaces the contents of the tree with the output of serialize().
+        /// Throws std::runtime_error on malformed input, leaving the tree empty.
+        void deserialize(const u8* data, u64 len)
+        {
+            clear();
+            ByteReader r{ data, len };
+            if (r.read_u8() == 0)
+                return;
+            try
+            {
+                root_ = read_node(r, max_depth);
+            }
+            catch (...)
+            {
+                clear();
+                throw;
+            }
+        }
+
+        /// Calls fn(x, y, z, size, value) for every non-empty leaf, where (x, y, z) is
+        /// the min corner of the size^3 cube the leaf covers. Much cheaper than calling
+        /// get() for every voxel when a pass only cares about solid regions.
+        template <typename F>
+        void for_each_leaf(F&& fn) const
+        {
+            for_each_leaf_in(0, 0, 0, size, size, size, fn);
+        }
+
+        /// Like for_each_leaf(), but skips subtrees that don't overlap the box
+        /// [x0, x1) x [y0, y1) x [z0, z1). Leaves are passed whole, clip them if needed.
+        template <typename F>
+        void
+        for_each_leaf_in(i32 x0, i32 y0, i32 z0, i32 x1, i32 y1, i32 z1, F&& fn) const
+        {
+            if (root_)
+                visit_leaves(root_, max_depth, 0, 0, 0, { x0, y0, z0, x1, y1, z1 }, fn);
+        }
+
         /// Returns true if tree is empty or entirely empty voxels
         bool is_empty() const
         {
@@ -134,6 +214,85 @@ namespace v {
             return c;
         }
 
+        struct Box {
+            i32 x0, y0, z0, x1, y1, z1;
+        };
+
+        template <typename F>
+        static void
+        visit_leaves(const Node* n, i32 depth, i32 x, i32 y, i32 z, const Box& box, F& fn)
+        {
+            const i32 len = 1 << depth;
+            if (x >= box.x1 || y >= box.y1 || z >= box.z1 || x + len <= box.x0 ||
+                y + len <= box.y0 || z + len <= box.z0)
+                return;
+
+            if (n->is_leaf || depth == 0)
+            {
+                if (n->leaf() != 0)
+                    fn(x, y, z, len, n->leaf());
+                return;
+            }
+            // matches child_index: bit 0 is x, bit 1 is y, bit 2 is z
+            const i32 half = 1 << (depth - 1);
+            for (int i = 0; i < 8; ++i)
+            {
+                if (const Node* c = n->kids()[i])
+                {
+                    visit_leaves(
+                        c, depth - 1, x + (i & 1) * half, y + ((i >> 1) & 1) * half,
+                        z + ((i >> 2) & 1) * half, box, fn);
+                }
+            }
+        }
+
+        static void write_node(ByteWriter& w, const Node* n)
+        {
+            if (n->is_leaf)
+            {
+                w.write_u8(0);
+                w.write_u16(n->leaf());
+                return;
+            }
+            w.write_u8(1);
+            w.write_u8(n->mask());
+            for (int i = 0; i < 8; ++i)
+            {
+                if (n->kids()[i])
+                    write_node(w, n->kids()[i]);
+            }
+        }
+
+        // builds children into the node as they're read, so a throw midway through
+        // still leaves a tree clear() can free
+        static Node* read_node(ByteReader& r, i32 depth)
+        {
+            const u8 tag = r.read_u8();
+            if (tag == 0)
+                return new_leaf(r.read_u16());
+            if (tag != 1 || depth == 0)
+                throw std::runtime_error("SparseVoxelOctree128: bad node tag");
+
+            const u8 mask = r.read_u8();
+            Node*    n    = new_internal();
+            try
+            {
+                for (int i = 0; i < 8; ++i)
+                {
+                    if (!(mask & (1u << i)))
+                        continue;
+                    n->kids()[i] = read_node(r, depth - 1);
+                    n->mask() |= static_cast<u8>(1u << i);
+                }
+            }
+            catch (...)
+            {
+                destroy_node(n);
+                throw;
+            }
+            return n;
+        }
+
         static FORCEINLINE i32 child_index(i32 x, i32 y, i32 z, i32 depth)
         {
             const i32 bit = 1 << (depth - 1);
@@ -0,0 +1,135 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <defs.h>
+#include <engine/serial/bytes.h>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#include <world/world.h>
+
+namespace v {
+    /// Compact encoding for a batch of edits within one chunk.
+    /// - Positions are the 21 bit chunk-relative ChunkEdit::index, sorted and delta
+    ///   coded against the end of the previous run
+    /// - Consecutive indices (runs along x) with the same value are run length encoded
+    /// - A value is only written when it differs from the previous run's value
+    ///
+    /// Layout: varint run_count, then per run
+    ///   varint gap, varint ((length - 1) << 1 | has_value), [varint value]
+    struct VoxelEditCodec {
+        static constexpr u32 k_index_limit = 1u << 21;
+
+        /// Sorts edits by index and drops overwritten ones (the last write wins), which
+        /// is what encode() expects. Applying the result gives the same chunk as
+        /// applying the edits in their original order.
+        static void normalize(std::vector<ChunkEdit>& edits)
+        {
+            std::stable_sort(
+                edits.begin(), edits.end(),
+                [](const ChunkEdit& a, const ChunkEdit& b) { return a.index < b.index; });
+
+            usize out = 0;
+            for (usize i = 0; i < edits.size(); ++i)
+            {
+                if (i + 1 < edits.size() && edits[i + 1].index == edits[i].index)
+                    continue;
+                edits[out++] = edits[i];
+            }
+            edits.resize(out);
+        }
+
+        /// @note edits must be normalized
+        static void encode(ByteWriter& w, std::span<const ChunkEdit> edits)
+        {
+            // count runs first so the decoder can size its output up front
+            u64 runs = 0;
+            for (usize i = 0; i < edits.size(); ++i)
+            {
+                if (i == 0 || !continues_run(edits[i - 1], edits[i]))
+                    runs++;
+            }
+            w.write_varint(runs);
+
+            u32 prev_end   = 0;
+            u32 prev_value = 0;
+            for (usize i = 0; i < edits.size();)
+            {
+                usize j = i + 1;
+                while (j < edits.size() && continues_run(edits[j - 1], edits[j]))
+                    j++;
+
+                const u32  len       = static_cast<u32>(j - i);
+                const bool has_value = i == 0 || edits[i].value != prev_value;
+
+                w.write_varint(edits[i].index - prev_end);
+                w.write_varint((static_cast<u64>(len - 1) << 1) | (has_value ? 1 : 0));
+                if (has_value)
+                    w.write_varint(edits[i].value);
+
+                prev_end   = edits[i].index + len;
+                prev_value = edits[i].value;
+                i          = j;
+            }
+        }
+
+        /// Appends the decoded edits to out (normalized, in index order).
+        /// Throws std::runtime_error on malformed input, or before decoding more than
+        /// max_edits edits (runs are expanded, so a few bytes can stand for a lot).
+        static void
+        decode(ByteReader& r, std::vector<ChunkEdit>& out, u64 max_edits = k_index_limit)
+        {
+            const u64 runs = r.read_varint();
+            // every run is at least two bytes, don't trust the count beyond that
+            if (runs > r.remaining() / 2 + 1)
+                throw std::runtime_error("VoxelEditCodec: bad run count");
+
+            u64 prev_end   = 0;
+            u16 prev_value = 0;
+            u64 decoded    = 0;
+            for (u64 run = 0; run < runs; ++run)
+            {
+                // checked by subtracting, the varints can be anything up to 2^64
+                const u64 gap = r.read_varint();
+                if (gap >= k_index_limit - prev_end)
+                    throw std::runtime_error("VoxelEditCodec: index out of range");
+                const u64 start = prev_end + gap;
+
+                const u64  header    = r.read_varint();
+                const u64  len       = (header >> 1) + 1;
+                const bool has_value = header & 1;
+
+                if (has_value)
+                {
+                    const u64 v = r.read_varint();
+                    if (v > 0xffff)
+                        throw std::runtime_error("VoxelEditCodec: value out of range");
+                    prev_value = static_cast<u16>(v);
+                }
+                else if (run == 0)
+                    throw std::runtime_error("VoxelEditCodec: first run has no value");
+
+                if (len > k_index_limit - start)
+                    throw std::runtime_error("VoxelEditCodec: index out of range");
+                if (len > max_edits - decoded)
+                    throw std::runtime_error("VoxelEditCodec: too many edits");
+                decoded += len;
+
+                for (u64 i = 0; i < len; ++i)
+                    out.push_back({ static_cast<u32>(start + i), prev_value });
+
+                prev_end = start + len;
+            }
+        }
+
+    private:
+        static FORCEINLINE bool continues_run(const ChunkEdit& prev, const ChunkEdit& e)
+        {
+            return e.index == prev.index + 1 && e.value == prev.value;
+        }
+    };
+} // namespace v
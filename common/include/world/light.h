@@ -0,0 +1,235 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <containers/ud_map.h>
+#include <defs.h>
+#include <engine/domain.h>
+#include <memory>
+#include <span>
+#include <vector>
+#include <world/world.h>
+
+namespace tf {
+    class Executor;
+}
+
+namespace v {
+    enum class LightChannel : u8 {
+        /// Light from above. Travels straight down without losing strength.
+        Sky = 0,
+        /// Light from emitting voxels (torches, lava, etc.)
+        Block = 1,
+    };
+
+    /// Light levels for one chunk, 4 bits of sky and 4 bits of block light per voxel,
+    /// indexed like ChunkEdit::index (x | y << 7 | z << 14).
+    /// Also keeps a bitmask of which voxels block light, mirrored from the chunk
+    /// so propagation never has to walk the octree.
+    class ChunkLight {
+    public:
+        static constexpr i32 k_size      = ChunkDomain::k_size;
+        static constexpr u32 k_volume    = k_size * k_size * k_size;
+        static constexpr u8  k_max_level = 15;
+
+        explicit ChunkLight(ChunkPos pos);
+
+        FORCEINLINE const ChunkPos& pos() const { return pos_; }
+
+        FORCEINLINE u8 get(LightChannel ch, u32 index) const
+        {
+            const u8 packed = levels_[index];
+            return ch == LightChannel::Sky ? packed >> 4 : packed & 0xf;
+        }
+
+        FORCEINLINE u8 sky(VoxelPos lp) const
+        {
+            return get(LightChannel::Sky, ChunkEdit::pack(lp));
+        }
+        FORCEINLINE u8 block(VoxelPos lp) const
+        {
+            return get(LightChannel::Block, ChunkEdit::pack(lp));
+        }
+
+        FORCEINLINE bool is_opaque(u32 index) const
+        {
+            return (opaque_[index >> 6] >> (index & 63)) & 1;
+        }
+
+        /// Raw packed levels (sky in the high nibble), k_volume bytes
+        FORCEINLINE const u8* data() const { return levels_.get(); }
+
+        usize memory_usage() const;
+
+    private:
+        friend class LightEngine;
+
+        /// A voxel that lost its light during removal, with the level it had
+        struct Removal {
+            u32 index;
+            u8  level;
+        };
+
+        /// Light crossing into this chunk from a neighbour, in this chunk's indices
+        struct Incoming {
+            u32  index;
+            u8   level;
+            bool remove;
+        };
+
+        FORCEINLINE void set(LightChannel ch, u32 index, u8 level)
+        {
+            u8& packed = levels_[index];
+            if (ch == LightChannel::Sky)
+                packed = static_cast<u8>((packed & 0x0f) | (level << 4));
+            else
+                packed = static_cast<u8>((packed & 0xf0) | level);
+        }
+
+        FORCEINLINE void set_opaque(u32 index, bool opaque)
+        {
+            const u64 bit = 1ull << (index & 63);
+            if (opaque)
+                opaque_[index >> 6] |= bit;
+            else
+                opaque_[index >> 6] &= ~bit;
+        }
+
+        bool has_work() const;
+
+        ChunkPos               pos_;
+        std::unique_ptr<u8[]>  levels_;
+        std::unique_ptr<u64[]> opaque_;
+        const ChunkDomain*     chunk_{};
+        u32                    generation_{ 0 };
+        bool                   needs_relight_{ true };
+
+        /// Neighbour light per face (-x, +x, -y, +y, -z, +z), resolved on the main
+        /// thread before every update
+        std::array<ChunkLight*, 6> neighbors_{};
+
+        // per channel work queues, indexed by LightChannel
+        std::array<std::vector<u32>, 2>     add_{};
+        std::array<std::vector<Removal>, 2> remove_{};
+        /// Emitters that need to be relit once removal is done
+        std::vector<u32> emitters_{};
+
+        /// Written by the neighbour on each face while it is processed. Every face has
+        /// exactly one writer, so no locking is needed.
+        std::array<std::array<std::vector<Incoming>, 6>, 2> incoming_{};
+    };
+
+    struct LightConfig {
+        /// Spread work over the AsyncContext executor when there is one
+        bool parallel{ true };
+        /// Upper bound on propagation rounds per update, leftover work carries over to
+        /// the next tick
+        u32 max_rounds{ 64 };
+    };
+
+    struct LightStats {
+        /// Chunks processed (one chunk running its queues once)
+        u64 chunk_passes{ 0 };
+        u64 relights{ 0 };
+        u64 rounds{ 0 };
+        f64 last_update_secs{ 0 };
+        f64 total_update_secs{ 0 };
+    };
+
+    /// CPU flood fill lighting for chunks in the WorldDomain.
+    /// - Sky light enters from above at full strength and travels straight down
+    ///   unchanged, every other step loses one level
+    /// - Block light starts at emitting voxels, see set_emission()
+    /// - Edits are incremental: a removal BFS clears light that depended on the
+    ///   changed voxel, then an add BFS refills from whatever is still lit
+    /// - Light crossing a chunk border is queued on the neighbour and picked up on
+    ///   its next pass
+    ///
+    /// Chunks are processed in 8 parity classes (by the low bit of each chunk
+    /// coordinate), so chunks that run at the same time are never adjacent and
+    /// only ever write their own light. Each class is spread over the AsyncContext
+    /// executor if the engine has one.
+    ///
+    /// Chunks have to be registered with queue_relight() (e.g. once loaded or
+    /// generated), and edits reported through voxel_changed() or chunk_edited().
+    /// @note Missing chunks above are treated as open sky, so load columns top down
+    /// @note queue_relight() on a chunk that was already lit doesn't clear light it
+    /// previously gave its neighbours
+    class LightEngine : public SDomain<LightEngine> {
+    public:
+        LightEngine(
+            const LightConfig& config = {}, const std::string& name = "Light Engine");
+        ~LightEngine() override;
+
+        void init() override;
+
+        /// Light voxel type `type` at `level` [0, 15]
+        void set_emission(u16 type, u8 level);
+        /// Whether voxels of `type` block light. Every non-zero type does by default,
+        /// 0 is always empty.
+        void set_opaque(u16 type, bool opaque);
+
+        /// Light a chunk from scratch on the next update. Registers it if needed
+        void queue_relight(const ChunkPos& cp);
+
+        /// A voxel was changed in the world (through any path)
+        void voxel_changed(WorldPos wp);
+        /// A batch of edits was applied to a chunk
+        void chunk_edited(const ChunkPos& cp, std::span<const ChunkEdit> edits);
+        /// Convenience, sets the voxel in the WorldDomain then calls voxel_changed
+        void set_voxel(WorldPos wp, u16 value);
+
+        /// Runs queued light work until everything settled (or max_rounds).
+        /// Runs every tick.
+        /// @return The number of rounds
+        u32 update();
+
+        const ChunkLight* try_get(const ChunkPos& cp) const;
+        u8                sky_light(WorldPos wp) const;
+        u8                block_light(WorldPos wp) const;
+
+        FORCEINLINE const LightStats& stats() const { return stats_; }
+        FORCEINLINE usize             chunk_count() const { return lights_.size(); }
+
+    private:
+        ChunkLight* find(const ChunkPos& cp);
+        /// Drops light for unloaded chunks and relinks neighbours
+        void sync(const WorldDomain& world);
+        void run_class(std::vector<ChunkLight*>& batch);
+
+        // these run on worker threads and only write the given chunk (plus the
+        // incoming queues it owns on its neighbours)
+        void process(ChunkLight& c) const;
+        void seed_relight(ChunkLight& c) const;
+        void drain_incoming(ChunkLight& c, LightChannel ch, bool removals) const;
+        void propagate_removal(ChunkLight& c, LightChannel ch) const;
+        void propagate(ChunkLight& c, LightChannel ch) const;
+        void unlight(ChunkLight& c, LightChannel ch, u32 index, u8 level, u8 dir) const;
+
+        /// Marks a voxel for relighting after its contents changed
+        void invalidate(ChunkLight& c, const ChunkDomain& chunk, VoxelPos lp);
+
+        FORCEINLINE bool blocks_light(u16 type) const
+        {
+            return type != 0 && !clear_[type];
+        }
+
+        LightConfig config_;
+        LightStats  stats_{};
+
+        std::array<u8, 65536> emission_{};
+        std::bitset<65536>    clear_{};
+        bool                  has_emitters_{ false };
+
+        ud_map<ChunkPos, std::unique_ptr<ChunkLight>, ChunkPosHash, ChunkPosEq> lights_{};
+        bool links_stale_{ true };
+        /// Something was queued since the last update settled
+        bool work_queued_{ false };
+
+        tf::Executor* executor_{};
+    };
+} // namespace v
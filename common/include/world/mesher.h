@@ -0,0 +1,192 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#pragma once
+
+#include <array>
+#include <defs.h>
+#include <memory>
+#include <vector>
+#include <world/world.h>
+
+namespace v {
+    class LightEngine;
+
+    struct ChunkVertex {
+        /// Chunk local corner position [0, 128]
+        u8 x, y, z;
+        /// Face in the low 3 bits (-x, +x, -y, +y, -z, +z), ambient occlusion
+        /// (0 darkest, 3 unoccluded) in bits 3-4
+        u8  face_ao;
+        u16 type;
+        /// Light of the voxel the face looks into, sky in the high nibble
+        u8 light;
+        u8 pad_{ 0 };
+
+        FORCEINLINE u8 face() const { return face_ao & 7; }
+        FORCEINLINE u8 ao() const { return face_ao >> 3; }
+    };
+    static_assert(sizeof(ChunkVertex) == 8);
+
+    struct ChunkMesh {
+        /// Four per quad
+        std::vector<ChunkVertex> vertices{};
+        /// Six per quad, counter clockwise seen from outside
+        std::vector<u32> indices{};
+
+        FORCEINLINE usize quad_count() const { return vertices.size() / 4; }
+        FORCEINLINE void  clear()
+        {
+            vertices.clear();
+            indices.clear();
+        }
+    };
+
+    /// Per vertex ambient occlusion from the 3x3 neighbourhood in front of a face.
+    ///
+    /// A face looks into the voxel at (0, 0) of a plane spanned by two axes u and v.
+    /// Bit (v + 1) * 3 + (u + 1) of a neighbourhood mask is set if the voxel at (u, v)
+    /// in that plane is solid, so one table lookup gives the AO of all four corners
+    /// instead of three voxel fetches per vertex.
+    struct VoxelAO {
+        /// 0 when both sides are solid (the corner is fully enclosed), else 3 minus
+        /// the number of solid neighbours
+        static constexpr u8 vertex(bool side1, bool side2, bool corner)
+        {
+            if (side1 && side2)
+                return 0;
+            return static_cast<u8>(3 - side1 - side2 - corner);
+        }
+
+        /// Corner i of a quad is at (k_corner_u[i], k_corner_v[i])
+        static constexpr std::array<i32, 4> k_corner_u{ -1, 1, 1, -1 };
+        static constexpr std::array<i32, 4> k_corner_v{ -1, -1, 1, 1 };
+
+        /// The AO of the four corners packed 2 bits each (corner 0 in the low bits),
+        /// for every 9 bit neighbourhood mask
+        static const std::array<u8, 512> k_lut;
+
+        static FORCEINLINE u8 corner(u8 packed, u32 i) { return (packed >> (i * 2)) & 3; }
+
+        static constexpr std::array<u8, 512> make_lut()
+        {
+            std::array<u8, 512> lut{};
+            for (u32 mask = 0; mask < 512; ++mask)
+            {
+                const auto solid = [&](i32 u, i32 v)
+                { return (mask >> ((v + 1) * 3 + u + 1)) & 1; };
+
+                u8 packed = 0;
+                for (u32 i = 0; i < 4; ++i)
+                {
+                    const i32 u  = k_corner_u[i];
+                    const i32 v  = k_corner_v[i];
+                    const u8  ao = vertex(solid(u, 0), solid(0, v), solid(u, v));
+                    packed |= static_cast<u8>(ao << (i * 2));
+                }
+                lut[mask] = packed;
+            }
+            return lut;
+        }
+    };
+
+    inline constexpr std::array<u8, 512> VoxelAO::k_lut = VoxelAO::make_lut();
+
+    /// Dense copy of a chunk plus a one voxel border taken from its neighbours, so
+    /// meshing never has to look outside of it or walk an octree.
+    /// Alongside the voxels it keeps solid bitmasks in rows along x and along y, which
+    /// is what face culling and the AO neighbourhoods are read from.
+    class PaddedChunk {
+    public:
+        static constexpr i32 k_size   = ChunkDomain::k_size + 2; // 130
+        static constexpr i32 k_volume = k_size * k_size * k_size;
+        /// 64 bit words per bit row
+        static constexpr i32 k_words = 3;
+
+        PaddedChunk();
+
+        /// Copies the chunk and the border from neighbours loaded in world. Without a
+        /// world (or where a neighbour isn't loaded) the border is empty.
+        void fill(const ChunkDomain& chunk, const WorldDomain* world = nullptr);
+
+        FORCEINLINE const ChunkPos& pos() const { return pos_; }
+
+        /// Padded coordinates in [0, 129], local voxel (x, y, z) is at (x+1, y+1, z+1)
+        FORCEINLINE u16 get(i32 px, i32 py, i32 pz) const
+        {
+            return voxels_[px + py * k_size + pz * k_size * k_size];
+        }
+
+        FORCEINLINE bool solid(i32 px, i32 py, i32 pz) const
+        {
+            return (x_row(py, pz)[px >> 6] >> (px & 63)) & 1;
+        }
+
+        /// Solid bits of the row along x at (py, pz), bit px is voxel px
+        FORCEINLINE const u64* x_row(i32 py, i32 pz) const
+        {
+            return x_rows_.get() + (py + pz * k_size) * k_words;
+        }
+
+        /// Solid bits of the row along y at (px, pz), bit py is voxel py
+        FORCEINLINE const u64* y_row(i32 px, i32 pz) const
+        {
+            return y_rows_.get() + (px + pz * k_size) * k_words;
+        }
+
+        /// Bits first, first + 1 and first + 2 of a row, first must be <= 127
+        static FORCEINLINE u32 bits3(const u64* row, i32 first)
+        {
+            const i32 word  = first >> 6;
+            const i32 shift = first & 63;
+            u64       bits  = row[word] >> shift;
+            if (shift > 61)
+                bits |= row[word + 1] << (64 - shift);
+            return static_cast<u32>(bits & 7);
+        }
+
+    private:
+        /// Writes value into the padded box [p0, p1)
+        void write_box(std::array<i32, 3> p0, std::array<i32, 3> p1, u16 value);
+
+        ChunkPos               pos_{};
+        std::unique_ptr<u16[]> voxels_;
+        std::unique_ptr<u64[]> x_rows_;
+        std::unique_ptr<u64[]> y_rows_;
+    };
+
+    struct MeshOptions {
+        bool ambient_occlusion{ true };
+        /// Store the light of the voxel in front of every face in its vertices
+        bool bake_light{ true };
+    };
+
+    /// CPU chunk mesher. Emits one quad per visible voxel face (every non-zero voxel
+    /// is solid), with per vertex ambient occlusion and per face light baked in.
+    /// Quads are split along the diagonal with more light so AO interpolates evenly.
+    ///
+    /// Keeps its padded buffer around, so reuse a mesher instead of making one per
+    /// chunk. Not thread safe, use one per thread.
+    class ChunkMesher {
+    public:
+        explicit ChunkMesher(const MeshOptions& options = {});
+
+        /// Meshes a chunk into out (cleared first). Neighbours loaded in world fill the
+        /// border so faces against them are culled, light comes from `light` if given.
+        void mesh(
+            const ChunkDomain& chunk, ChunkMesh& out, const WorldDomain* world = nullptr,
+            const LightEngine* light = nullptr);
+
+        /// Meshes an already filled padded chunk into out (cleared first)
+        void mesh(
+            const PaddedChunk& padded, ChunkMesh& out,
+            const LightEngine* light = nullptr) const;
+
+        FORCEINLINE const MeshOptions& options() const { return options_; }
+
+    private:
+        MeshOptions                  options_;
+        std::unique_ptr<PaddedChunk> padded_;
+    };
+} // namespace v
@@ -0,0 +1,151 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#pragma once
+
+#include <defs.h>
+#include <engine/domain.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+#include <vox/aabb.h>
+#include <world/world.h>
+
+namespace tf {
+    class Executor;
+}
+
+namespace v {
+    /// Moves an entity's box through the voxel world every tick. The entity also needs
+    /// a Pos3d (center of the box, in voxel units) and a Size3d (full extents).
+    struct VoxelBody {
+        /// Voxels per second
+        glm::vec3 velocity{ 0 };
+        /// Set if the last step was stopped moving down
+        bool on_ground{ false };
+    };
+
+    /// A box of whole voxels [min, max), in world coordinates
+    struct VoxelBox {
+        i32 min[3];
+        i32 max[3];
+    };
+
+    struct SweepResult {
+        /// How far the box actually moved
+        glm::vec3 moved{ 0 };
+        /// Bit per axis (x, y, z) that was cut short by a voxel
+        u8 blocked{ 0 };
+    };
+
+    /// Swept box vs voxel collision against a WorldDomain. Every non-zero voxel is
+    /// solid.
+    ///
+    /// A sweep first collects the solid octree leaves overlapping the whole swept
+    /// volume (empty subtrees and missing chunks are skipped without looking at a
+    /// voxel, a solid 32^3 leaf is one candidate), then moves the box one axis at a
+    /// time (y, x, z) against that list, so boxes slide along walls and floors.
+    /// Voxels the box already overlaps are ignored, so a box stuck inside terrain can
+    /// still move out of it.
+    ///
+    /// Only reads the world, one collider per thread is safe as long as nothing writes
+    /// to the world at the same time.
+    class VoxelCollider {
+    public:
+        /// @param solid_unloaded Treat chunks that aren't loaded as solid (for the
+        /// server, so nothing falls through the world while it streams in)
+        explicit VoxelCollider(const WorldDomain& world, bool solid_unloaded = false);
+
+        /// Looks up the chunks overlapping region once, later queries inside it skip
+        /// the world's chunk map. Queries outside of it still work, just slower.
+        void prepare(const VoxelBox& region);
+
+        /// Moves box by delta, stopping at solid voxels
+        SweepResult sweep(const AABB& box, const glm::vec3& delta);
+
+        /// True if any solid voxel overlaps box
+        bool overlaps(const AABB& box);
+
+        /// The voxels a box touches, clamped so it's never empty
+        static VoxelBox voxels_of(const AABB& box);
+
+    private:
+        /// Appends the solid parts of region to candidates_, clipped to it
+        void gather(const VoxelBox& region);
+        const ChunkDomain* chunk_at(const ChunkPos& cp) const;
+
+        const WorldDomain* world_;
+        bool               solid_unloaded_;
+
+        /// Chunk range resolved by prepare(), x fastest. Starts out empty
+        ChunkPos                        cache_min_{ 0, 0, 0 };
+        ChunkPos                        cache_max_{ -1, -1, -1 };
+        std::vector<const ChunkDomain*> cache_{};
+
+        std::vector<VoxelBox> candidates_{};
+    };
+
+    struct PhysicsConfig {
+        /// Voxels per second squared, applied to every body
+        glm::vec3 gravity{ 0, -32, 0 };
+        /// Spread bodies over the AsyncContext executor when there is one
+        bool parallel{ true };
+        /// Bodies per task. Bodies are sorted by chunk first, so a batch mostly shares
+        /// its chunks.
+        u32 batch_size{ 256 };
+        /// See VoxelCollider
+        bool solid_unloaded{ false };
+    };
+
+    struct PhysicsStats {
+        /// Bodies that moved in the last step
+        u64 moving_bodies{ 0 };
+        u64 batches{ 0 };
+        /// Bodies stopped by a voxel in the last step
+        u64 collisions{ 0 };
+        f64 last_step_secs{ 0 };
+        f64 total_step_secs{ 0 };
+    };
+
+    /// Steps every entity with Pos3d, Size3d and VoxelBody against the WorldDomain.
+    ///
+    /// Each step gathers all moving bodies, sorts them by the chunk they're in and
+    /// cuts them into batches. Every batch resolves the chunks its swept boxes cover
+    /// once, then sweeps its bodies, with batches running in parallel on the
+    /// AsyncContext executor if the engine has one. Results are written back on the
+    /// calling thread.
+    class VoxelPhysics : public SDomain<VoxelPhysics> {
+    public:
+        VoxelPhysics(
+            const PhysicsConfig& config = {}, const std::string& name = "Voxel Physics");
+        ~VoxelPhysics() override;
+
+        void init() override;
+
+        /// Moves every body by dt seconds. Runs every fixed step with
+        /// fixed_delta_time() if the engine has a fixed rate, otherwise every tick with
+        /// its delta time
+        void step(f64 dt);
+
+        FORCEINLINE const PhysicsConfig& config() const { return config_; }
+        FORCEINLINE const PhysicsStats&  stats() const { return stats_; }
+
+    private:
+        struct Body {
+            entt::entity entity;
+            u64          chunk_key;
+            AABB         box;
+            glm::vec3    delta;
+            SweepResult  result;
+        };
+
+        void run_batch(const WorldDomain& world, usize first, usize last);
+
+        PhysicsConfig config_;
+        PhysicsStats  stats_{};
+
+        std::vector<Body> bodies_{};
+        tf::Executor*     executor_{};
+    };
+} // namespace v
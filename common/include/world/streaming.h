@@ -0,0 +1,158 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#pragma once
+
+#include <containers/ud_map.h>
+#include <defs.h>
+#include <engine/domain.h>
+#include <memory>
+#include <net/channels.h>
+#include <world/world.h>
+
+namespace v {
+    struct ChunkStreamConfig {
+        /// Per connection send budget
+        u32 bytes_per_sec{ 4u << 20 };
+        /// If set, the budget refills as if every tick took this many seconds instead
+        /// of the engine's real delta time, so what gets sent doesn't depend on how
+        /// fast the host runs (benchmarks and tests)
+        f64 fixed_tick_secs{ 0 };
+        /// How many bytes of budget a connection can bank while it has nothing to send
+        u32 burst_bytes{ 512u << 10 };
+        /// Upper bound on the view distance a client may request
+        i32 max_view_distance{ 16 };
+        /// Most known chunks taken from one interest message, the rest are ignored
+        u32 max_known_per_interest{ 32u << 10 };
+        /// Edit batches with more edits than this are dropped whole. Batches never
+        /// decode past VoxelEditBatch::k_max_edits, so only lower limits matter
+        u32 max_edits_per_batch{ VoxelEditBatch::k_max_edits };
+    };
+
+    struct ChunkStreamStats {
+        u64 full_sent{ 0 };
+        u64 deltas_sent{ 0 };
+        u64 unloads_sent{ 0 };
+        u64 bytes_sent{ 0 };
+        /// Voxel edits received from clients
+        u64 edits_received{ 0 };
+        /// Voxel edits in batches that were dropped (too big, or for a chunk that
+        /// isn't loaded or is out of the client's view)
+        u64 edits_dropped{ 0 };
+    };
+
+    /// Server side. Streams chunks from the WorldDomain to connected clients based on
+    /// the interest (center + view distance) they send over ChunkInterestChannel.
+    /// - Nearest chunks first
+    /// - Each connection has its own token bucket bandwidth budget
+    /// - Chunks the client already has are only resent as deltas when they change
+    /// - Edits from a client are only applied to loaded chunks within its view
+    class ChunkStreamer : public SDomain<ChunkStreamer> {
+    public:
+        ChunkStreamer(
+            const ChunkStreamConfig& config = {},
+            const std::string&       name   = "Chunk Streamer") :
+            SDomain(name), config_(config)
+        {}
+        ~ChunkStreamer() override;
+
+        void init() override;
+
+        /// Start streaming to a connection. Creates the stream and interest channels.
+        void add_connection(const std::shared_ptr<NetConnection>& con);
+
+        /// Stop streaming to a connection. Must be called before the connection's
+        /// channels are destroyed (e.g. from NetListener::disconnected)
+        void remove_connection(const std::shared_ptr<NetConnection>& con);
+
+        /// Sends chunks within budget to every connection, runs every tick
+        void update();
+
+        FORCEINLINE const ChunkStreamStats& stats() const { return stats_; }
+        FORCEINLINE usize connection_count() const { return clients_.size(); }
+
+    private:
+        struct Client {
+            std::shared_ptr<NetConnection>               con;
+            NetChannel<ChunkStreamChannel, ChunkPacket>* stream{};
+            ChunkPos                                     center{};
+            i32                                          view_distance{ 0 };
+            bool                                         has_interest{ false };
+            /// Version of every chunk the client holds
+            ud_map<ChunkPos, u64, ChunkPosHash, ChunkPosEq> known{};
+            /// Bytes the connection may still send, refilled every tick
+            f64 budget{ 0 };
+        };
+
+        void handle_interest(NetConnection* key, const ChunkInterest& interest);
+        void handle_edits(NetConnection* key, const VoxelEditBatch& batch);
+        void stream_to(Client& client, const WorldDomain& world);
+        /// Chunk offsets within view_distance of the center, nearest first
+        const std::vector<ChunkPos>& view_offsets(i32 view_distance);
+        /// Sends a full chunk or a delta, returns the bytes sent
+        usize send_chunk(Client& client, const ChunkDomain& chunk);
+        usize send_unload(Client& client, ChunkPos cp);
+
+        ChunkStreamConfig              config_;
+        ChunkStreamStats               stats_{};
+        ud_map<NetConnection*, Client> clients_{};
+        /// Reused packet buffers
+        std::vector<std::byte> scratch_{};
+        std::vector<ChunkEdit> edit_scratch_{};
+        /// view_offsets() per view distance, filled in on first use
+        std::vector<std::vector<ChunkPos>> view_offsets_{};
+    };
+
+    struct ChunkReceiveStats {
+        u64 full_received{ 0 };
+        u64 deltas_received{ 0 };
+        u64 unloads_received{ 0 };
+        u64 bytes_received{ 0 };
+        u64 resyncs{ 0 };
+        u64 edits_sent{ 0 };
+        u64 edit_bytes_sent{ 0 };
+    };
+
+    /// Client side. Applies chunks streamed by a ChunkStreamer into the local
+    /// WorldDomain, tells the server what the client is interested in, and sends
+    /// the client's voxel edits.
+    class ChunkReceiver : public SDomain<ChunkReceiver> {
+    public:
+        ChunkReceiver(const std::string& name = "Chunk Receiver") : SDomain(name) {}
+        ~ChunkReceiver() override;
+
+        void init() override;
+
+        /// Start receiving chunks over a connection to the server.
+        /// Chunks already in the local world are advertised to the server so it only
+        /// sends what changed.
+        void attach(const std::shared_ptr<NetConnection>& con);
+
+        /// Tell the server where we are. Only sends when something changed.
+        void set_interest(ChunkPos center, i32 view_distance);
+
+        /// Queue a voxel edit for the server. Edits are sent once per tick as one
+        /// VoxelEditBatch per chunk. The local world is updated when the server
+        /// streams the change back.
+        void queue_edit(WorldPos wp, u16 value);
+
+        FORCEINLINE const ChunkReceiveStats& stats() const { return stats_; }
+
+    private:
+        void handle_packet(const ChunkPacket& packet);
+        void flush_edits();
+        void send_interest(std::vector<ChunkVersion> known = {});
+
+        std::shared_ptr<NetConnection>                   con_{};
+        NetChannel<ChunkInterestChannel, ChunkInterest>* interest_{};
+        NetChannel<VoxelEditChannel, VoxelEditBatch>*    edits_{};
+        ChunkPos                                         center_{};
+        i32                                              view_distance_{ -1 };
+        std::vector<ChunkVersion>                        pending_known_{};
+        ChunkReceiveStats                                stats_{};
+
+        ud_map<ChunkPos, std::vector<ChunkEdit>, ChunkPosHash, ChunkPosEq>
+            pending_edits_{};
+    };
+} // namespace v
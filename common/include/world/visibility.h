@@ -0,0 +1,152 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#pragma once
+
+#include <array>
+#include <containers/ud_map.h>
+#include <defs.h>
+#include <glm/glm.hpp>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vox/aabb.h>
+#include <world/world.h>
+
+namespace v {
+    /// View frustum as six planes (left, right, bottom, top, near, far) pointing
+    /// inwards, so a point p is inside if dot(n, p) + d >= 0 for every plane.
+    struct Frustum {
+        /// Plane coefficients, one array per component so 8 boxes can be tested at once
+        std::array<f32, 6> nx{}, ny{}, nz{}, d{};
+
+        /// Extracts the planes from a view projection matrix (e.g. Camera::matrix()).
+        /// The near plane is taken for a [-1, 1] depth range, which only makes it a
+        /// bit more conservative for [0, 1] projections.
+        /// @param origin Planes are made relative to this point, test boxes relative to
+        /// it too to keep precision far away from the world origin
+        static Frustum from_matrix(const glm::mat4& view_proj, const glm::dvec3& origin);
+
+        /// True if the box is at least partially inside
+        bool intersects(const AABB& box) const;
+
+        /// Tests boxes of the same half extent given by their centers. Writes 1 to
+        /// visible[i] for boxes at least partially inside, else 0. Does 8 boxes per pass
+        /// with AVX2.
+        void cull(
+            std::span<const f32> cx, std::span<const f32> cy, std::span<const f32> cz,
+            f32 half_extent, u8* visible) const;
+    };
+
+    /// Which faces of a chunk can see each other through it, one bit per pair of faces
+    /// (-x, +x, -y, +y, -z, +z).
+    ///
+    /// Built from a grid of 4^3 voxel cells where a cell is open if any voxel in it is
+    /// empty. This can only claim faces are connected when they aren't (a thin wall
+    /// inside a cell is ignored), never the other way around, so culling with it is
+    /// conservative.
+    struct ChunkConnectivity {
+        static constexpr u16 k_all  = 0x7fff;
+        static constexpr i32 k_cell = 4;
+
+        static u16 compute(const ChunkDomain& chunk);
+
+        static constexpr u32 pair(u8 a, u8 b)
+        {
+            if (a > b)
+                std::swap(a, b);
+            // pairs (0, 1), (0, 2) ... (0, 5), (1, 2) ... (4, 5)
+            return a * 5 - a * (a - 1) / 2 + (b - a - 1);
+        }
+
+        static FORCEINLINE bool connected(u16 mask, u8 a, u8 b)
+        {
+            return (mask >> pair(a, b)) & 1;
+        }
+    };
+
+    struct CullConfig {
+        /// In chunks, horizontally
+        i32 view_distance{ 32 };
+        /// In chunks, up and down
+        i32 vertical_distance{ 8 };
+        /// Disable to only frustum cull
+        bool occlusion{ true };
+    };
+
+    struct CullStats {
+        /// Loaded chunks within the view distance
+        u32 in_range{ 0 };
+        u32 frustum_culled{ 0 };
+        /// In the frustum but not reachable from the camera
+        u32 occlusion_culled{ 0 };
+        u32 visible{ 0 };
+        /// Chunks whose connectivity had to be recomputed this frame
+        u32 connectivity_rebuilds{ 0 };
+        f64 frustum_us{ 0 };
+        f64 occlusion_us{ 0 };
+        f64 total_us{ 0 };
+    };
+
+    /// Decides which loaded chunks are worth drawing from a camera, without a GPU.
+    ///
+    /// Every chunk position in the view distance is frustum tested first. Then a BFS
+    /// walks chunks outwards from the camera's chunk through the frustum, only
+    /// leaving a chunk through a face that is connected to the face it was entered by
+    /// and never stepping back against a direction it already moved in. Chunks
+    /// underground or behind solid terrain are never reached. Missing chunks count as
+    /// open air.
+    ///
+    /// Connectivity is cached per chunk and rebuilt when its version changes
+    /// (writes through ChunkDomain::svo() aren't versioned, call invalidate()).
+    class ChunkCuller {
+    public:
+        explicit ChunkCuller(const CullConfig& config = {});
+
+        /// Returns the visible chunks, valid until the next call
+        /// @param view_proj The camera's view projection matrix
+        /// @param camera_pos The camera's position in voxels
+        const std::vector<const ChunkDomain*>& cull(
+            const WorldDomain& world, const glm::mat4& view_proj,
+            const glm::vec3& camera_pos);
+
+        /// Drops cached connectivity, for one chunk or everything
+        void invalidate(const ChunkPos& cp);
+        void invalidate();
+
+        FORCEINLINE const CullConfig& config() const { return config_; }
+        FORCEINLINE const CullStats&  stats() const { return stats_; }
+
+    private:
+        struct Connectivity {
+            u64 version;
+            u16 mask;
+        };
+
+        struct Visit {
+            u32 cell;
+            /// Face the chunk was entered through, 6 for the camera's chunk
+            u8 from;
+            /// Directions moved so far
+            u8 dirs;
+        };
+
+        /// Lays out the chunk centers for the view distance
+        void build_grid();
+        u16  connectivity(const ChunkDomain& chunk);
+
+        CullConfig config_;
+        CullStats  stats_{};
+
+        i32 width_{ 0 }, height_{ 0 };
+        /// Chunk centers relative to the camera's chunk, x fastest then y then z
+        std::vector<f32>   cx_{}, cy_{}, cz_{};
+        std::vector<u8>    in_frustum_{};
+        std::vector<u8>    reached_{};
+        std::vector<Visit> queue_{};
+
+        ud_map<ChunkPos, Connectivity, ChunkPosHash, ChunkPosEq> connectivity_{};
+        std::vector<const ChunkDomain*>                          visible_{};
+    };
+} // namespace v
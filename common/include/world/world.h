@@ -8,6 +8,10 @@
 #include <cstdint>
 #include <defs.h>
 #include <engine/domain.h>
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
 #include <vox/store/svo.h>
 
 namespace v {
@@ -30,6 +34,13 @@ namespace v {
             mix(static_cast<u64>(static_cast<u32>(p.x)));
             mix(static_cast<u64>(static_cast<u32>(p.y)));
             mix(static_cast<u64>(static_cast<u32>(p.z)));
+            // the combine alone leaves nearby positions in nearby buckets, finish with
+            // splitmix64 so the map can trust the bits (is_avalanching)
+            h ^= h >> 30;
+            h *= 0xbf58476d1ce4e5b9ull;
+            h ^= h >> 27;
+            h *= 0x94d049bb133111ebull;
+            h ^= h >> 31;
             return h;
         }
     };
@@ -55,33 +66,216 @@ namespace v {
         i32 z;
     };
 
+    /// A single voxel write within a chunk
+    struct ChunkEdit {
+        /// Local position packed into 21 bits, x | y << 7 | z << 14
+        u32 index;
+        u16 value;
+
+        static FORCEINLINE u32 pack(VoxelPos lp)
+        {
+            return static_cast<u32>(lp.x) | (static_cast<u32>(lp.y) << 7) |
+                (static_cast<u32>(lp.z) << 14);
+        }
+
+        FORCEINLINE VoxelPos pos() const
+        {
+            return { static_cast<i32>(index & 127), static_cast<i32>((index >> 7) & 127),
+                     static_cast<i32>((index >> 14) & 127) };
+        }
+    };
+
     /// Chunk domain, queryable from the engine
-    class ChunkDomain : public Domain<ChunkDomain> {
+    /// Stored inline, thousands of these get walked by per-tick systems
+    class ChunkDomain : public InlineDomain<ChunkDomain> {
     public:
         static constexpr i32 k_size = SparseVoxelOctree128::size; // 128
+        /// Edits kept around for building deltas, older ones are dropped in bulk
+        static constexpr usize k_edit_log_size = 1024;
 
-        ChunkDomain(ChunkPos pos, const std::string& name = "Chunk") :
-            Domain(name), pos_(pos)
+        /// @param generation Identifies this instance of the chunk, so a version from
+        /// a previous load (before eviction) never matches a fresh one.
+        ChunkDomain(ChunkPos pos, std::string name = "Chunk", u32 generation = 0) :
+            InlineDomain(std::move(name)), pos_(pos),
+            version_(static_cast<u64>(generation) << 32),
+            log_base_(version_)
         {}
 
-        FORCEINLINE const ChunkPos&             pos() const { return pos_; }
-        FORCEINLINE SparseVoxelOctree128&       svo() { return svo_; }
+        FORCEINLINE const ChunkPos& pos() const { return pos_; }
+        /// Mutable access to the store, assumes the caller will modify it.
+        /// @note Writes through here are not versioned, prefer set()
+        FORCEINLINE SparseVoxelOctree128& svo()
+        {
+            mem_stale_ = true;
+            return svo_;
+        }
         FORCEINLINE const SparseVoxelOctree128& svo() const { return svo_; }
 
         u16  get(VoxelPos lp) const { return svo_.get(lp.x, lp.y, lp.z); }
         void set(VoxelPos lp, u16 v)
         {
             svo_.set(lp.x, lp.y, lp.z, v);
-            dirty_ = true;
+            dirty_     = true;
+            mem_stale_ = true;
+            log_edit({ ChunkEdit::pack(lp), v });
+        }
+
+        /// Batched write path, equivalent to calling set() for every edit in order.
+        /// Edits that don't change anything are skipped (and not versioned).
+        void apply_edits(std::span<const ChunkEdit> edits)
+        {
+            const usize logged_before = edit_log_.size();
+            for (const auto& e : edits)
+            {
+                const VoxelPos lp = e.pos();
+                if (svo_.get(lp.x, lp.y, lp.z) == e.value)
+                    continue;
+                svo_.set(lp.x, lp.y, lp.z, e.value);
+                edit_log_.push_back(e);
+            }
+
+            const usize logged = edit_log_.size() - logged_before;
+            if (logged == 0)
+                return;
+
+            version_ += logged;
+            dirty_     = true;
+            mem_stale_ = true;
+            trim_edit_log();
+        }
+
+        /// Revision of the chunk contents. The high 32 bits are the generation, the low
+        /// bits count edits made through set().
+        FORCEINLINE u64 version() const { return version_; }
+
+        /// The edits that bring a copy of this chunk at version `since` up to date,
+        /// or nullopt if the log doesn't reach back that far (send the whole chunk).
+        std::optional<std::span<const ChunkEdit>> edits_since(u64 since) const
+        {
+            if ((since >> 32) != (version_ >> 32) || since < log_base_ || since > version_)
+                return std::nullopt;
+            return std::span<const ChunkEdit>{ edit_log_.data() + (since - log_base_),
+                                               static_cast<usize>(version_ - since) };
+        }
+
+        /// Replace the contents with authoritative data (e.g. from the server) and
+        /// adopt its version. Does not mark the chunk dirty.
+        void load(SparseVoxelOctree128&& svo, u64 version)
+        {
+            svo_       = std::move(svo);
+            mem_stale_ = true;
+            reset_version(version);
+        }
+
+        /// Apply edits made elsewhere (e.g. a delta from the server) and adopt the
+        /// resulting version. Does not mark the chunk dirty.
+        void apply_remote(std::span<const ChunkEdit> edits, u64 version)
+        {
+            for (const auto& e : edits)
+            {
+                const VoxelPos lp = e.pos();
+                svo_.set(lp.x, lp.y, lp.z, e.value);
+            }
+            mem_stale_ = true;
+            reset_version(version);
         }
 
         FORCEINLINE bool dirty() const { return dirty_; }
         FORCEINLINE void clear_dirty() { dirty_ = false; }
 
+        /// The engine tick this chunk was last accessed through the WorldDomain
+        FORCEINLINE u64  last_access() const { return last_access_; }
+        FORCEINLINE void touch(u64 tick) const { last_access_ = tick; }
+
+        /// Approximate bytes held by the voxel store. Cached, and only
+        /// recomputed after the chunk has been modified.
+        usize memory_usage() const
+        {
+            if (mem_stale_)
+            {
+                mem_bytes_ = svo_.memory_usage();
+                mem_stale_ = false;
+            }
+            return mem_bytes_ + edit_log_.capacity() * sizeof(ChunkEdit);
+        }
+
+        /// Evicting thousands of chunks in one tick would otherwise spend the tick
+        /// freeing octree nodes, so the store and the edit log go to the background
+        InlineFn release_deferred() override
+        {
+            mem_stale_ = true;
+            return [svo = std::move(svo_), log = std::move(edit_log_)] {};
+        }
+
     private:
+        FORCEINLINE void log_edit(ChunkEdit e)
+        {
+            version_++;
+            edit_log_.push_back(e);
+            trim_edit_log();
+        }
+
+        FORCEINLINE void trim_edit_log()
+        {
+            if (edit_log_.size() < 2 * k_edit_log_size)
+                return;
+            // keep the newest k_edit_log_size edits
+            const usize drop = edit_log_.size() - k_edit_log_size;
+            edit_log_.erase(edit_log_.begin(), edit_log_.begin() + drop);
+            log_base_ += drop;
+        }
+
+        FORCEINLINE void reset_version(u64 version)
+        {
+            version_  = version;
+            log_base_ = version;
+            edit_log_.clear();
+        }
+
         ChunkPos             pos_{};
         SparseVoxelOctree128 svo_{};
         bool                 dirty_{ false };
+
+        // invariant: version_ == log_base_ + edit_log_.size()
+        u64                    version_;
+        u64                    log_base_;
+        std::vector<ChunkEdit> edit_log_{};
+
+        mutable u64   last_access_{ 0 };
+        mutable usize mem_bytes_{ 0 };
+        mutable bool  mem_stale_{ true };
+    };
+
+    /// Keeps the chunks around an entity loaded. The entity must also have a
+    /// Pos3d component (in voxel units), which is usually a player.
+    struct ChunkAnchor {
+        /// Chunks within this many chunks (on every axis) are never evicted
+        i32 radius{ 4 };
+    };
+
+    struct ChunkCacheConfig {
+        /// Soft limit on voxel memory held by loaded chunks. 0 disables eviction
+        usize memory_budget{ 512ull << 20 };
+        /// Once over budget, evict down to this fraction of the budget so we don't
+        /// evict a chunk or two every single pass
+        f32 low_watermark{ 0.9f };
+        /// How many ticks between eviction passes
+        u32 check_interval{ 20 };
+    };
+
+    struct ChunkCacheStats {
+        /// Voxel memory held by loaded chunks as of the last eviction pass
+        usize memory_bytes{ 0 };
+        usize peak_memory_bytes{ 0 };
+        /// Chunk lookups that found / didn't find a loaded chunk
+        u64 hits{ 0 };
+        u64 misses{ 0 };
+        u64 evictions{ 0 };
+        /// Dirty chunks handed to the saver before being evicted
+        u64 saves{ 0 };
+        u64 evict_passes{ 0 };
+        /// Total time spent in eviction passes, in seconds
+        f64 evict_secs{ 0 };
     };
 
     /// World state shared by client and server (no server-only logic here)
@@ -92,10 +286,15 @@ namespace v {
     public:
         static constexpr i32 k_chunk_size = ChunkDomain::k_size; // 128
 
+        /// Called with a dirty chunk right before it is evicted
+        using ChunkSaver = std::function<void(const ChunkDomain&)>;
+
         WorldDomain(const std::string& name = "World") :
             SDomain(name)
         {}
-        ~WorldDomain() override = default;
+        ~WorldDomain() override;
+
+        void init() override;
 
         /// Convert world-space voxel coordinate to chunk position and local position
         static std::pair<ChunkPos, VoxelPos> world_to_chunk(WorldPos wp);
@@ -104,6 +303,10 @@ namespace v {
         ChunkDomain*       try_get_chunk(const ChunkPos& cp);
         const ChunkDomain* try_get_chunk(const ChunkPos& cp) const;
 
+        /// Like try_get_chunk, but not counted as an access. For bookkeeping passes
+        /// (lighting, meshing) that shouldn't keep chunks from being evicted.
+        const ChunkDomain* find_chunk(const ChunkPos& cp) const;
+
         /// Get or create a chunk at position
         ChunkDomain& get_or_create_chunk(const ChunkPos& cp);
 
@@ -119,11 +322,55 @@ namespace v {
         /// Set voxel at world coordinate
         void set_voxel(WorldPos wp, u16 value);
 
+        /// Apply a batch of edits to one chunk, creating it if needed
+        void apply_edits(const ChunkPos& cp, std::span<const ChunkEdit> edits);
+
         /// Iterate loaded chunks count
         size_t chunk_count() const { return chunks_.size(); }
 
+        /// Calls fn(ChunkDomain&) for every loaded chunk, without counting as an access
+        template <typename F>
+        void for_each_chunk(F&& fn)
+        {
+            for (auto& [cp, chunk] : chunks_)
+                fn(*chunk);
+        }
+
+        template <typename F>
+        void for_each_chunk(F&& fn) const
+        {
+            for (const auto& [cp, chunk] : chunks_)
+                fn(static_cast<const ChunkDomain&>(*chunk));
+        }
+
+        FORCEINLINE const ChunkCacheConfig& cache_config() const { return cache_config_; }
+        FORCEINLINE void set_cache_config(const ChunkCacheConfig& config)
+        {
+            cache_config_ = config;
+        }
+
+        FORCEINLINE const ChunkCacheStats& cache_stats() const { return cache_stats_; }
+
+        /// Set the callback used to persist dirty chunks before they are evicted.
+        /// Without a saver, dirty chunks are never evicted so edits aren't lost.
+        FORCEINLINE void set_chunk_saver(ChunkSaver saver) { saver_ = std::move(saver); }
+
+        /// Evict least recently used chunks until loaded chunk memory is back under
+        /// the budget. Chunks near a ChunkAnchor are kept.
+        /// Runs automatically every ChunkCacheConfig::check_interval ticks.
+        /// @note Pointers to evicted chunks are invalid after the current tick.
+        /// @return The number of chunks evicted
+        usize evict_chunks();
+
     private:
         using ChunkMap = ud_map<ChunkPos, ChunkDomain*, ChunkPosHash, ChunkPosEq>;
         ChunkMap chunks_{};
+
+        /// Handed out to new chunks, see ChunkDomain::version()
+        u32 next_generation_{ 1 };
+
+        ChunkCacheConfig        cache_config_{};
+        mutable ChunkCacheStats cache_stats_{};
+        ChunkSaver              saver_{};
     };
 } // namespace v
@@ -11,4 +11,17 @@ namespace v {
         u64 wake_time_ns = time::ns() + (duration_ms * 1'000'000);
         scheduler->schedule_sleep(handle, wake_time_ns);
     }
+
+    bool ResumeOnAwaitable::await_ready() const noexcept
+    {
+        return worker ? scheduler->on_worker_thread() : scheduler->on_main_thread();
+    }
+
+    void ResumeOnAwaitable::await_suspend(std::coroutine_handle<> handle)
+    {
+        if (worker)
+            scheduler->schedule_worker(handle);
+        else
+            scheduler->schedule_main(handle);
+    }
 } // namespace v
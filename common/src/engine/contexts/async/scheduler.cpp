@@ -2,41 +2,113 @@
 // Created by niooi on 10/10/2025.
 //
 
+#include <engine/contexts/async/coroutine_state.h>
 #include <engine/contexts/async/scheduler.h>
+#include "taskflow/taskflow.hpp"
 
 namespace v {
-    void CoroutineScheduler::register_handle(std::coroutine_handle<> handle)
+    CoroutineScheduler::~CoroutineScheduler()
     {
-        active_handles_.insert(handle);
+        // still suspended somewhere (asleep, queued, waiting on a task), they'll never
+        // resume now. coroutines that finished on a worker but weren't handed back yet
+        // are dropped here too, without running their callbacks
+        while (CoroutineStateBase* state = outstanding_)
+        {
+            outstanding_ = state->next_;
+            state->prev_ = state->next_ = nullptr;
+            state->release();
+        }
+        alive_ = 0;
+    }
+
+    void CoroutineScheduler::track(CoroutineStateBase& state)
+    {
+        state.next_ = outstanding_;
+        if (outstanding_)
+            outstanding_->prev_ = &state;
+        outstanding_ = &state;
+        alive_++;
+    }
+
+    bool CoroutineScheduler::on_worker_thread() const
+    {
+        return executor_ && executor_->this_worker_id() >= 0;
     }
 
+    void CoroutineScheduler::schedule_worker(std::coroutine_handle<> handle)
+    {
+        if (!executor_)
+        {
+            schedule_main(handle);
+            return;
+        }
+        executor_->silent_async([handle] { handle.resume(); });
+    }
+
+    void CoroutineScheduler::schedule_main(std::coroutine_handle<> handle)
+    {
+        main_queue_.enqueue(handle);
+    }
 
     void
     CoroutineScheduler::schedule_sleep(std::coroutine_handle<> handle, u64 wake_time_ns)
     {
-        sleeping_.push(SleepEntry{ wake_time_ns, handle });
+        if (!on_main_thread())
+        {
+            sleep_queue_.enqueue(SleepEntry{ wake_time_ns, handle });
+            return;
+        }
+        sleeping_.schedule(wake_time_ns, handle);
+    }
+
+    void CoroutineScheduler::schedule_finish(CoroutineStateBase& state)
+    {
+        // the frame is already suspended, the main thread may destroy it right away
+        if (!on_main_thread())
+        {
+            finish_queue_.enqueue(&state);
+            return;
+        }
+        finish(state);
     }
 
-    void CoroutineScheduler::schedule_finish(std::coroutine_handle<> handle)
+    void CoroutineScheduler::finish(CoroutineStateBase& state)
     {
-        handle.destroy();
-        // TODO! set some more state here?
-        active_handles_.erase(handle);
-        heap_state_storage_.erase(handle);
+        if (state.prev_)
+            state.prev_->next_ = state.next_;
+        else
+            outstanding_ = state.next_;
+        if (state.next_)
+            state.next_->prev_ = state.prev_;
+        state.prev_ = state.next_ = nullptr;
+        alive_--;
+
+        // returned or threw on a worker, its callbacks were left for here
+        if (!state.is_completed)
+            state.complete();
+        state.release();
     }
 
     void CoroutineScheduler::tick(u64 current_time_ns)
     {
-        // Resume sleeping coroutines that are ready
-        while (!sleeping_.empty() && sleeping_.top().wake_time_ns <= current_time_ns)
-        {
-            auto entry = sleeping_.top();
-            sleeping_.pop();
-            entry.handle.resume();
-            // TODO! make it so that the same coroutine can't be woken twice
-            // in a single tick (key by tuple<wake_time, tick_slept> but
-            // still sort by wake_time, just check if tick_slept == tick(), if not dont
-            // resume that task and keep going up SO MAYBE need diff data structure?)
-        }
+        SleepEntry slept;
+        while (sleep_queue_.try_dequeue(slept))
+            sleeping_.schedule(slept.wake_time_ns, slept.handle);
+
+        // Resume sleeping coroutines that are ready. One that goes back to sleep while
+        // being woken lands past this tick in the wheel, so it can't wake twice
+        sleeping_.advance(
+            current_time_ns, [](std::coroutine_handle<> handle) { handle.resume(); });
+
+        // only what was queued when the tick started, a coroutine bouncing off a
+        // worker and straight back waits for the next tick instead of starving it
+        std::coroutine_handle<> handle;
+        usize                   queued = main_queue_.size_approx();
+        while (queued-- > 0 && main_queue_.try_dequeue(handle))
+            handle.resume();
+
+        CoroutineStateBase* finished;
+        while (finish_queue_.try_dequeue(finished))
+            finish(*finished);
     }
 } // namespace v
@@ -9,7 +9,7 @@
 #include <engine/contexts/net/ctx.h>
 #include <memory>
 #include <stdexcept>
-#include <time/stopwatch.h>
+#include <time/fixed_step.h>
 #include <utility>
 #include "enet.h"
 #include "engine/contexts/net/connection.h"
@@ -47,7 +47,10 @@ namespace v {
         io_thread_ = std::thread(
             [this]()
             {
-                Stopwatch stopwatch{};
+                // plain sleeps, the io thread doesn't need sub millisecond precision
+                Pacer     pacer{ false };
+                const u64 step_ns = static_cast<u64>(update_rate_ * 1e9);
+                u64       next    = time::ns();
                 auto      run_io_task = [](std::function<void()>& fn)
                 {
                     if (!fn)
@@ -77,7 +80,7 @@ namespace v {
 
                 while (is_alive_)
                 {
-                    stopwatch.reset();
+                    next += step_ns;
 
                     drain_commands();
 
@@ -95,13 +98,19 @@ namespace v {
 
                     drain_commands();
 
-                    f64 sleep_time = stopwatch.until(update_rate_);
-                    if (sleep_time > 0)
-                        v::time::sleep_ns(static_cast<u64>(sleep_time * 1e9));
+                    // deadlines instead of sleeping a whole interval, so the time
+                    // spent updating doesn't add up into drift
+                    if (const u64 now = time::ns(); now < next)
+                    {
+                        pacer.wait_until(next);
+                    }
                     else
+                    {
                         LOG_WARN(
-                            "Network I/O thread fell behind by {}ms.",
-                            static_cast<u32>(sleep_time * -1, 000));
+                            "Network I/O thread fell behind by {:.3f}ms.",
+                            static_cast<f64>(now - next) / 1e6);
+                        next = now;
+                    }
                 }
 
                 drain_commands();
@@ -242,6 +251,9 @@ namespace v {
                 {
                     NetPeer peer = event.peer;
                     auto    con  = (NetConnection*)(peer->data);
+                    packets_received_.fetch_add(1, std::memory_order_relaxed);
+                    bytes_received_.fetch_add(
+                        event.packet->dataLength, std::memory_order_relaxed);
                     con->handle_raw_packet(event.packet);
                 }
                 break;
@@ -307,13 +319,7 @@ namespace v {
                         delete b;
 
                     // remove all the channel components we connected to it post-tick
-                    const entt::entity id = event.connection->entity_;
-                    engine_.post_tick(
-                        [this, id]()
-                        {
-                            if (engine_.registry().valid(id))
-                                engine_.registry().destroy(id);
-                        });
+                    engine_.queue_destroy_domain(event.connection->entity_);
 
                     event.connection->c_insts_.clear();
                     event.connection->recv_c_ids_.clear();
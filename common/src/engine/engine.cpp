@@ -2,43 +2,32 @@
 // Created by niooi on 7/28/2025.
 //
 
+#include <algorithm>
 #include <engine/engine.h>
 #include <engine/sink.h>
+#include <mem/frame_arena.h>
 #include <prelude.h>
 
 namespace v {
     Engine::Engine() :
         ctx_entity_{ ctx_registry_.create() }, engine_entity_{ registry_.create() }
-    {}
+    {
+        on_tick.set_timing(true);
+        on_fixed_tick.set_timing(true);
+    }
 
     Engine::~Engine()
     {
         on_destroy.execute();
 
         // run deferred post-tick tasks
-        {
-            std::function<void()> fn;
-            while (post_tick_queue_.try_dequeue(fn))
-            {
-                try
-                {
-                    if (fn)
-                        fn();
-                }
-                catch (const std::exception& ex)
-                {
-                    LOG_ERROR("post_tick callback threw: {}", ex.what());
-                }
-                catch (...)
-                {
-                    LOG_ERROR("post_tick callback threw unknown exception");
-                }
-            }
-        }
+        drain_post_tick();
+        flush_destroys();
     }
 
     void Engine::tick()
     {
+        const u64 tick_start = time::ns();
         prev_tick_span_ = tick_time_stopwatch_.reset();
 
         // if this was the first frame, the deltatime value would probably be kind of
@@ -48,34 +37,145 @@ namespace v {
 
         current_tick_++;
 
+        // simulation first, so on_tick sees the latest state and a fresh alpha()
+        if (fixed_step_)
+        {
+            for (u32 steps = fixed_step_->advance(prev_tick_span_); steps > 0; --steps)
+            {
+                current_fixed_tick_++;
+                on_fixed_tick.execute();
+            }
+        }
+
         // run tick callbacks with dependency management
         on_tick.execute();
 
+        const u64 systems_start = time::ns();
+        if (systems.size() > 0)
+        {
+            V_PROFILE_ZONE_NAMED("systems");
+            systems.execute();
+        }
+
         // run deferred post-tick tasks
+        const u64 post_tick_start = time::ns();
+        systems_timing_.push(post_tick_start - systems_start);
         {
-            std::function<void()> fn;
-            while (post_tick_queue_.try_dequeue(fn))
+            V_PROFILE_ZONE_NAMED("post_tick");
+            drain_post_tick();
+        }
+        {
+            V_PROFILE_ZONE_NAMED("destroy_domains");
+            flush_destroys();
+        }
+        // per tick temporaries are dead from here on
+        mem::FrameArena::end_frame();
+        const u64 tick_end = time::ns();
+        post_tick_timing_.push(tick_end - post_tick_start);
+        tick_timing_.push(tick_end - tick_start);
+        V_PROFILE_FRAME_MARK;
+
+        // LOG_TRACE("Finished tick {} ", current_tick_);
+
+        // flush default logger
+        spd::default_logger()->flush();
+    }
+
+    void Engine::drain_post_tick()
+    {
+        // in batches, with one try block per batch rather than per callback
+        std::array<InlineFn, 64> batch;
+        while (const usize count =
+                   post_tick_queue_.try_dequeue_bulk(batch.begin(), batch.size()))
+        {
+            usize i = 0;
+            while (i < count)
             {
                 try
                 {
-                    if (fn)
-                        fn();
+                    for (; i < count; ++i)
+                    {
+                        if (batch[i])
+                            batch[i]();
+                        // captures go now, not whenever the slot is reused
+                        batch[i].reset();
+                    }
                 }
                 catch (const std::exception& ex)
                 {
                     LOG_ERROR("post_tick callback threw: {}", ex.what());
+                    batch[i++].reset();
                 }
                 catch (...)
                 {
                     LOG_ERROR("post_tick callback threw unknown exception");
+                    batch[i++].reset();
                 }
             }
         }
+    }
 
-        // LOG_TRACE("Finished tick {} ", current_tick_);
+    void Engine::flush_destroys()
+    {
+        std::array<entt::entity, 256> ids;
+        while (true)
+        {
+            destroy_batch_.clear();
+            while (const usize count =
+                       destroy_queue_.try_dequeue_bulk(ids.begin(), ids.size()))
+                destroy_batch_.insert(
+                    destroy_batch_.end(), ids.begin(), ids.begin() + count);
+            if (destroy_batch_.empty())
+                return;
 
-        // flush default logger
-        spd::default_logger()->flush();
+            // the range destroy wants every entity valid and there only once. sorted
+            // so the sparse lookups walk forward instead of jumping around
+            std::erase_if(
+                destroy_batch_, [this](entt::entity e) { return !registry_.valid(e); });
+            std::ranges::sort(destroy_batch_);
+            const auto dupes = std::ranges::unique(destroy_batch_);
+            destroy_batch_.erase(dupes.begin(), dupes.end());
+
+            for (const auto& [id, collect] : release_hooks_)
+                collect(registry_, destroy_batch_, release_batch_);
+
+            // entt moves the whole batch to the back of the entity storage and then
+            // erases it from each component storage in one go, rather than visiting
+            // every storage once per entity
+            registry_.destroy(destroy_batch_.begin(), destroy_batch_.end());
+
+            releaser_.push(release_batch_);
+        }
+    }
+
+    void Engine::set_fixed_rate(f64 hz, u32 max_catch_up)
+    {
+        if (hz <= 0)
+            fixed_step_.reset();
+        else
+            fixed_step_.emplace(1.0 / hz, max_catch_up);
+    }
+
+    void Engine::wait_for_next_step()
+    {
+        if (!fixed_step_)
+            return;
+
+        // until_next() counts from the start of the last tick
+        const f64 remaining = fixed_step_->until_next() - tick_time_stopwatch_.elapsed();
+        if (remaining > 0)
+            pacer_.wait_until(time::ns() + static_cast<u64>(remaining * 1e9));
+    }
+
+    std::vector<TaskTiming> Engine::tick_timings() const
+    {
+        std::vector<TaskTiming> timings = on_fixed_tick.timings();
+        for (auto& timing : on_tick.timings())
+            timings.push_back(std::move(timing));
+        timings.push_back(systems_timing_.summarize());
+        timings.push_back(post_tick_timing_.summarize());
+        timings.push_back(tick_timing_.summarize());
+        return timings;
     }
 
 } // namespace v
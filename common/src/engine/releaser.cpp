@@ -0,0 +1,87 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#include <engine/releaser.h>
+#include <prelude.h>
+
+namespace v {
+    Releaser::~Releaser()
+    {
+        {
+            std::lock_guard lock{ mutex_ };
+            stop_ = true;
+        }
+        wake_.notify_one();
+        if (thread_.joinable())
+            thread_.join();
+    }
+
+    void Releaser::push(std::vector<InlineFn>& fns)
+    {
+        if (fns.empty())
+            return;
+
+        {
+            std::lock_guard lock{ mutex_ };
+            if (pending_.empty())
+                pending_.swap(fns);
+            else
+                for (auto& fn : fns)
+                    pending_.push_back(std::move(fn));
+
+            if (!thread_.joinable())
+                thread_ = std::thread([this] { run(); });
+        }
+        fns.clear();
+        wake_.notify_one();
+    }
+
+    void Releaser::wait_idle()
+    {
+        std::unique_lock lock{ mutex_ };
+        idle_.wait(lock, [this] { return pending_.empty() && !busy_; });
+    }
+
+    void Releaser::run()
+    {
+        std::vector<InlineFn> batch;
+        std::unique_lock      lock{ mutex_ };
+        while (true)
+        {
+            wake_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+            if (pending_.empty())
+                break;
+
+            batch.swap(pending_);
+            busy_ = true;
+            lock.unlock();
+
+            for (auto& fn : batch)
+            {
+                try
+                {
+                    fn();
+                }
+                catch (const std::exception& ex)
+                {
+                    LOG_ERROR("Releaser callback threw: {}", ex.what());
+                }
+                catch (...)
+                {
+                    LOG_ERROR("Releaser callback threw unknown exception");
+                }
+                // this is where the captures (the actual resources) go
+                fn.reset();
+            }
+            const usize count = batch.size();
+            batch.clear();
+
+            lock.lock();
+            busy_ = false;
+            released_ += count;
+            if (pending_.empty())
+                idle_.notify_all();
+        }
+    }
+} // namespace v
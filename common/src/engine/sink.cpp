@@ -5,94 +5,489 @@
 #include <engine/sink.h>
 #include <prelude.h>
 
-#include <queue>
+#include <algorithm>
+#include <taskflow/taskflow.hpp>
+#include <time/time.h>
 
-void DependentSink::rebuild_graph()
+namespace {
+    FORCEINLINE void erase_one(std::vector<u32>& v, u32 value)
+    {
+        if (const auto it = std::ranges::find(v, value); it != v.end())
+        {
+            *it = v.back();
+            v.pop_back();
+        }
+    }
+} // namespace
+
+DependentSink::DependentSink() = default;
+
+DependentSink::~DependentSink() = default;
+
+DependentSink::TaskId DependentSink::intern(const std::string& name)
 {
-    sorted_tasks_.clear();
+    auto [it, inserted] = ids_.try_emplace(name, static_cast<TaskId>(tasks_.size()));
+    if (inserted)
+    {
+        tasks_.emplace_back().name = name;
+        visit_mark_.push_back(0);
+    }
+    return it->second;
+}
+
+bool DependentSink::connect(
+    const std::vector<std::string>& after, const std::vector<std::string>& before,
+    const std::string& name, std::function<void()> func, TaskAffinity affinity)
+{
+    std::lock_guard lock(tasks_mutex_);
+
+    const TaskId id = intern(name);
+    if (tasks_[id].connected)
+        remove_task(id);
+
+    // intern everything first, tasks_ may grow
+    const auto mention = [&](const std::string& other, std::vector<TaskId> Task::* list)
+    {
+        const TaskId other_id = intern(other);
+        (tasks_[id].*list).push_back(other_id);
+
+        auto& mentioned_by = tasks_[other_id].mentioned_by;
+        if (std::ranges::find(mentioned_by, id) == mentioned_by.end())
+            mentioned_by.push_back(id);
+    };
+    for (const std::string& dep : after)
+        mention(dep, &Task::after);
+    for (const std::string& succ : before)
+        mention(succ, &Task::before);
+
+    Task& task     = tasks_[id];
+    task.func      = std::move(func);
+    task.affinity  = affinity;
+    task.connected = true;
+    task.rank      = static_cast<u32>(order_.size());
+    order_.push_back(id);
 
-    if (registered_tasks_.empty())
+    // edges from this task's lists, then from connected tasks that named it
+    const auto link = [&](TaskId from, TaskId to)
     {
+        if (!tasks_[from].connected || !tasks_[to].connected || add_edge(from, to))
+            return true;
+        report_cycle(from, to);
+        return false;
+    };
+
+    bool ok = true;
+    for (usize i = 0; ok && i < task.after.size(); ++i)
+        ok = link(task.after[i], id);
+    for (usize i = 0; ok && i < task.before.size(); ++i)
+        ok = link(id, task.before[i]);
+    for (usize i = 0; ok && i < task.mentioned_by.size(); ++i)
+    {
+        const TaskId other = task.mentioned_by[i];
+        if (other == id)
+            continue;
+        const Task& o = tasks_[other];
+        if (std::ranges::find(o.after, id) != o.after.end())
+            ok = link(id, other);
+        if (ok && std::ranges::find(o.before, id) != o.before.end())
+            ok = link(other, id);
+    }
+
+    if (!ok)
+        remove_task(id);
+    mark_dirty();
+    return ok;
+}
+
+void DependentSink::disconnect(const std::string& name)
+{
+    std::lock_guard lock(tasks_mutex_);
+    const auto      it = ids_.find(name);
+    if (it == ids_.end() || !tasks_[it->second].connected)
         return;
+    remove_task(it->second);
+    mark_dirty();
+}
+
+void DependentSink::remove_task(TaskId id)
+{
+    Task& task = tasks_[id];
+    for (const TaskId s : task.succ)
+        erase_one(tasks_[s].pred, id);
+    for (const TaskId p : task.pred)
+        erase_one(tasks_[p].succ, id);
+    for (const TaskId d : task.after)
+        erase_one(tasks_[d].mentioned_by, id);
+    for (const TaskId d : task.before)
+        erase_one(tasks_[d].mentioned_by, id);
+
+    task.succ.clear();
+    task.pred.clear();
+    task.after.clear();
+    task.before.clear();
+    task.func = nullptr;
+
+    if (task.connected)
+    {
+        // removing a task never breaks the order of the others, just close the gap
+        order_.erase(order_.begin() + task.rank);
+        for (u32 r = task.rank; r < order_.size(); ++r)
+            tasks_[order_[r]].rank = r;
+        task.connected = false;
     }
+}
+
+bool DependentSink::add_edge(TaskId from, TaskId to)
+{
+    if (from == to)
+        return false;
 
-    // Build adjacency list and in-degree counts
-    v::ud_map<std::string, std::vector<std::string>> graph;
-    v::ud_map<std::string, u32>                      in_degree;
+    Task& f = tasks_[from];
+    if (std::ranges::find(f.succ, to) != f.succ.end())
+        return true;
 
-    // Initialize all tasks
-    for (const auto& [name, def] : registered_tasks_)
+    // already in order, nothing moves
+    const u32 lb = tasks_[to].rank;
+    const u32 ub = f.rank;
+    if (ub < lb)
     {
-        graph[name]; // Ensure node exists
-        in_degree[name]; // Initialize in-degree to 0
+        f.succ.push_back(to);
+        tasks_[to].pred.push_back(from);
+        return true;
     }
 
-    // Build edges from dependencies
-    for (const auto& [name, def] : registered_tasks_)
+    // Pearce-Kelly: everything `to` reaches that sits before `from`, and everything
+    // reaching `from` that sits after `to`, swap places within the ranks they hold
+    ++visit_epoch_;
+    forward_.clear();
+    stack_.assign(1, to);
+    visit_mark_[to] = visit_epoch_;
+    while (!stack_.empty())
     {
-        // "after" means dependencies -> this task depends on them
-        for (const std::string& dep_name : def.after)
+        const TaskId n = stack_.back();
+        stack_.pop_back();
+        forward_.push_back(n);
+        for (const TaskId s : tasks_[n].succ)
         {
-            if (registered_tasks_.contains(dep_name))
+            if (s == from)
+                return false;
+            if (tasks_[s].rank < ub && visit_mark_[s] != visit_epoch_)
             {
-                graph[dep_name].push_back(name);
-                in_degree[name]++;
+                visit_mark_[s] = visit_epoch_;
+                stack_.push_back(s);
             }
         }
+    }
+
+    backward_.clear();
+    stack_.assign(1, from);
+    visit_mark_[from] = visit_epoch_;
+    while (!stack_.empty())
+    {
+        const TaskId n = stack_.back();
+        stack_.pop_back();
+        backward_.push_back(n);
+        for (const TaskId p : tasks_[n].pred)
+        {
+            if (tasks_[p].rank > lb && visit_mark_[p] != visit_epoch_)
+            {
+                visit_mark_[p] = visit_epoch_;
+                stack_.push_back(p);
+            }
+        }
+    }
+
+    const auto by_rank = [&](TaskId a, TaskId b)
+    { return tasks_[a].rank < tasks_[b].rank; };
+    std::ranges::sort(forward_, by_rank);
+    std::ranges::sort(backward_, by_rank);
+
+    ranks_.clear();
+    for (const TaskId n : backward_)
+        ranks_.push_back(tasks_[n].rank);
+    for (const TaskId n : forward_)
+        ranks_.push_back(tasks_[n].rank);
+    std::ranges::sort(ranks_);
+
+    usize i = 0;
+    for (const TaskId n : backward_)
+    {
+        tasks_[n].rank        = ranks_[i++];
+        order_[tasks_[n].rank] = n;
+    }
+    for (const TaskId n : forward_)
+    {
+        tasks_[n].rank        = ranks_[i++];
+        order_[tasks_[n].rank] = n;
+    }
+
+    f.succ.push_back(to);
+    tasks_[to].pred.push_back(from);
+    return true;
+}
+
+void DependentSink::report_cycle(TaskId from, TaskId to)
+{
+    // find how `to` already reaches `from`
+    std::vector<TaskId> parent(tasks_.size(), static_cast<TaskId>(-1));
+    std::vector<TaskId> stack{ to };
+    parent[to] = to;
+    while (!stack.empty() && parent[from] == static_cast<TaskId>(-1))
+    {
+        const TaskId n = stack.back();
+        stack.pop_back();
+        for (const TaskId s : tasks_[n].succ)
+        {
+            if (parent[s] == static_cast<TaskId>(-1))
+            {
+                parent[s] = n;
+                stack.push_back(s);
+            }
+        }
+    }
+
+    std::string path = tasks_[from].name;
+    if (from != to && parent[from] != static_cast<TaskId>(-1))
+    {
+        for (TaskId n = parent[from]; n != to; n = parent[n])
+            path = tasks_[n].name + " -> " + path;
+        path = tasks_[to].name + " -> " + path;
+    }
+    LOG_ERROR(
+        "DependentSink: '{}' can't run before '{}', that would close the cycle {} -> {}",
+        tasks_[from].name, tasks_[to].name, path, tasks_[to].name);
+}
+
+std::vector<std::string> DependentSink::sorted() const
+{
+    std::lock_guard          lock(tasks_mutex_);
+    std::vector<std::string> names;
+    names.reserve(order_.size());
+    for (const TaskId id : order_)
+        names.push_back(tasks_[id].name);
+    return names;
+}
+
+void DependentSink::set_timing(bool enabled)
+{
+    std::lock_guard lock(tasks_mutex_);
+    timing_ = enabled;
+    mark_dirty();
+}
+
+std::vector<v::TaskTiming> DependentSink::timings() const
+{
+    std::lock_guard            lock(tasks_mutex_);
+    std::vector<v::TaskTiming> out;
+    out.reserve(order_.size());
+    for (const TaskId id : order_)
+    {
+        if (id < rings_.size() && rings_[id])
+            out.push_back(rings_[id]->summarize());
+        else
+            out.push_back({ .name = tasks_[id].name });
+    }
+    return out;
+}
+
+void DependentSink::set_executor(tf::Executor* executor)
+{
+    std::lock_guard lock(tasks_mutex_);
+    executor_ = executor;
+    mark_dirty();
+}
+
+void DependentSink::mark_dirty()
+{
+    // the running snapshot stays as is, execute() refreshes once it's done
+    if (executing_)
+        dirty_ = true;
+    else
+        refresh();
+}
+
+void DependentSink::refresh()
+{
+    const usize count = order_.size();
+    fns_.clear();
+    affinity_.clear();
+    ring_of_.clear();
+    edges_.clear();
+    if (timing_)
+        rings_.resize(tasks_.size());
+    for (const TaskId id : order_)
+    {
+        fns_.push_back(tasks_[id].func);
+        affinity_.push_back(tasks_[id].affinity);
+        if (timing_)
+        {
+            if (!rings_[id])
+                rings_[id] = std::make_unique<v::TimingRing>(tasks_[id].name);
+            ring_of_.push_back(rings_[id].get());
+        }
+        for (const TaskId s : tasks_[id].succ)
+            edges_.emplace_back(tasks_[id].rank, tasks_[s].rank);
+    }
+    done_ = std::make_unique<std::atomic<bool>[]>(count);
+
+    compile();
+}
+
+void DependentSink::compile()
+{
+    taskflow_.reset();
+    has_main_tasks_ = false;
+    if (!executor_ || fns_.empty())
+        return;
 
-        // "before" means this task should run before these tasks
-        for (const std::string& succ_name : def.before)
+    taskflow_ = std::make_unique<tf::Taskflow>();
+    std::vector<tf::Task> tasks;
+    tasks.reserve(fns_.size());
+    for (u32 i = 0; i < fns_.size(); ++i)
+    {
+        if (affinity_[i] == TaskAffinity::main_thread)
+        {
+            has_main_tasks_ = true;
+            tasks.push_back(taskflow_->emplace([this, i] { run_on_main(i); }));
+        }
+        else
         {
-            if (registered_tasks_.contains(succ_name))
+            tasks.push_back(taskflow_->emplace([this, i] { run_task(i); }));
+        }
+    }
+
+    for (const auto& [from, to] : edges_)
+        tasks[from].precede(tasks[to]);
+}
+
+void DependentSink::execute()
+{
+    {
+        std::lock_guard lock(tasks_mutex_);
+        executing_ = true;
+    }
+
+    // pick up changes made while running, even if a task throws
+    struct Finish {
+        DependentSink& sink;
+        ~Finish()
+        {
+            std::lock_guard lock(sink.tasks_mutex_);
+            sink.executing_ = false;
+            if (sink.dirty_)
             {
-                graph[name].push_back(succ_name);
-                in_degree[succ_name]++;
+                sink.dirty_ = false;
+                sink.refresh();
             }
         }
+    } finish{ *this };
+
+    // executing from one of the executor's own workers would have it wait on itself
+    if (taskflow_ && executor_->this_worker_id() < 0)
+    {
+        execute_parallel();
+        return;
     }
 
-    // Kahn's algo for topological sort
-    std::queue<std::string> queue;
+    if (ring_of_.empty())
+    {
+        for (const auto& fn : fns_)
+            fn();
+        return;
+    }
 
-    // Start with nodes that have no dependencies
-    for (const auto& [name, degree] : in_degree)
+    // one clock read per task, each one ends where the next starts
+    u64 last = v::time::ns();
+    for (usize i = 0; i < fns_.size(); ++i)
     {
-        if (degree == 0)
         {
-            queue.push(name);
+            V_PROFILE_ZONE_LOCATION(&ring_of_[i]->zone_location);
+            fns_[i]();
         }
+        const u64 now = v::time::ns();
+        ring_of_[i]->push(now - last);
+        last = now;
+    }
+}
+
+void DependentSink::execute_parallel()
+{
+    if (!has_main_tasks_)
+    {
+        executor_->run(*taskflow_).get();
+        return;
     }
 
-    while (!queue.empty())
+    for (usize i = 0; i < fns_.size(); ++i)
+        done_[i].store(false, std::memory_order_relaxed);
+    finished_ = false;
+
+    auto future = executor_->run(
+        *taskflow_,
+        [this]
+        {
+            std::lock_guard lock(main_mutex_);
+            finished_ = true;
+            main_cv_.notify_one();
+        });
+
+    // serve main thread tasks until the whole graph is done
+    std::exception_ptr error;
+    std::vector<u32>   ready;
+    for (;;)
     {
-        std::string current = queue.front();
-        queue.pop();
-        sorted_tasks_.push_back(current);
+        {
+            std::unique_lock lock(main_mutex_);
+            main_cv_.wait(lock, [&] { return finished_ || !main_queue_.empty(); });
+            if (main_queue_.empty())
+                break;
+            ready.swap(main_queue_);
+        }
 
-        // Reduce in-degree for neighbors
-        for (const std::string& neighbor : graph[current])
+        for (const u32 i : ready)
         {
-            in_degree[neighbor]--;
-            if (in_degree[neighbor] == 0)
+            try
+            {
+                if (!error)
+                    run_task(i);
+            }
+            catch (...)
             {
-                queue.push(neighbor);
+                error = std::current_exception();
             }
+            done_[i].store(true, std::memory_order_release);
+            done_[i].notify_one();
         }
+        ready.clear();
     }
 
-    // If sorted_tasks_ doesn't contain all tasks, there's a cycle
-    if (sorted_tasks_.size() != registered_tasks_.size())
+    future.get();
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void DependentSink::run_task(u32 index)
+{
+    if (ring_of_.empty())
     {
-        // Handle cycle: clear sorted tasks to prevent execution
-        sorted_tasks_.clear();
+        fns_[index]();
+        return;
     }
+
+    V_PROFILE_ZONE_LOCATION(&ring_of_[index]->zone_location);
+    const u64 start = v::time::ns();
+    fns_[index]();
+    ring_of_[index]->push(v::time::ns() - start);
 }
 
-void DependentSink::execute()
+void DependentSink::run_on_main(u32 index)
 {
-    for (const std::string& task_name : sorted_tasks_)
     {
-        const auto& task_def = registered_tasks_.at(task_name);
-        task_def.func();
+        std::lock_guard lock(main_mutex_);
+        main_queue_.push_back(index);
     }
+    main_cv_.notify_one();
+
+    // blocks this worker, main thread tasks are expected to be few
+    done_[index].wait(false, std::memory_order_acquire);
 }
@@ -0,0 +1,239 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#include <engine/components.h>
+#include <engine/engine.h>
+#include <engine/spatial.h>
+
+namespace v {
+    SpatialHash::SpatialHash(f32 cell_size) :
+        cell_size_(cell_size), inv_cell_size_(1.f / cell_size)
+    {}
+
+    SpatialHash::CellPos SpatialHash::pos_of(u64 key)
+    {
+        constexpr u64 mask = (1ull << k_cell_bits) - 1;
+        // sign extend each packed coordinate
+        const auto axis = [](u64 v)
+        {
+            constexpr u64 sign = 1ull << (k_cell_bits - 1);
+            return static_cast<i32>(static_cast<i64>((v ^ sign) - sign));
+        };
+        return { axis(key & mask), axis(key >> k_cell_bits & mask),
+                 axis(key >> (k_cell_bits * 2) & mask) };
+    }
+
+    void SpatialHash::insert(entt::entity entity, const glm::vec3& pos)
+    {
+        const CellPos c   = cell_of(pos);
+        const u64     key = key_of(c.x, c.y, c.z);
+
+        auto [it, inserted] = slots_.try_emplace(entity, Slot{});
+        if (!inserted)
+        {
+            Slot& slot = it->second;
+            if (slot.cell == key)
+            {
+                cells_.find(key)->second[slot.index].pos = pos;
+                return;
+            }
+            remove_from_cell(slot);
+        }
+
+        auto& entries   = cells_[key];
+        it->second      = { key, static_cast<u32>(entries.size()) };
+        entries.push_back({ pos, entity });
+    }
+
+    bool SpatialHash::erase(entt::entity entity)
+    {
+        const auto it = slots_.find(entity);
+        if (it == slots_.end())
+            return false;
+        remove_from_cell(it->second);
+        slots_.erase(it);
+        return true;
+    }
+
+    void SpatialHash::clear()
+    {
+        cells_.clear();
+        slots_.clear();
+    }
+
+    void SpatialHash::remove_from_cell(const Slot& slot)
+    {
+        const auto cell    = cells_.find(slot.cell);
+        auto&      entries = cell->second;
+
+        // swap the last entry into the hole
+        if (slot.index + 1 != entries.size())
+        {
+            entries[slot.index] = entries.back();
+            slots_.find(entries[slot.index].entity)->second.index = slot.index;
+        }
+        entries.pop_back();
+
+        if (entries.empty())
+            cells_.erase(cell);
+    }
+
+    void SpatialHash::query_box(const AABB& box, std::vector<entt::entity>& out) const
+    {
+        for_each_in_box(box, [&](entt::entity e, const glm::vec3&) { out.push_back(e); });
+    }
+
+    void SpatialHash::query_radius(
+        const glm::vec3& center, f32 radius, std::vector<entt::entity>& out) const
+    {
+        for_each_in_radius(
+            center, radius, [&](entt::entity e, const glm::vec3&) { out.push_back(e); });
+    }
+
+    void SpatialHash::nearest(
+        const glm::vec3& pos, usize k, std::vector<entt::entity>& out,
+        f32 max_distance) const
+    {
+        out.clear();
+        if (k == 0 || slots_.empty())
+            return;
+
+        // max heap on distance, the worst of the best k on top
+        using Ranked = std::pair<f32, entt::entity>;
+        std::vector<Ranked> best;
+        best.reserve(k + 1);
+        const f32  max_d2 = max_distance * max_distance;
+        const auto offer  = [&](const std::vector<Entry>& entries)
+        {
+            for (const Entry& e : entries)
+            {
+                const glm::vec3 d  = e.pos - pos;
+                const f32       d2 = glm::dot(d, d);
+                if (d2 > max_d2 || (best.size() == k && d2 >= best.front().first))
+                    continue;
+                best.emplace_back(d2, e.entity);
+                std::ranges::push_heap(best, {}, &Ranked::first);
+                if (best.size() > k)
+                {
+                    std::ranges::pop_heap(best, {}, &Ranked::first);
+                    best.pop_back();
+                }
+            }
+        };
+
+        // grow a cube of cells shell by shell. everything in shell r + 1 is at least
+        // r cells away from pos, so stop once the k-th best is closer than that
+        const CellPos c    = cell_of(pos);
+        usize         seen = 0;
+        for (i32 r = 0;; ++r)
+        {
+            const u64 side  = 2 * static_cast<u64>(r) + 1;
+            const u64 inner = r == 0 ? 0 : side - 2;
+            const u64 shell = side * side * side - inner * inner * inner;
+
+            if (shell > cells_.size())
+            {
+                // cheaper to look at every occupied cell outside the cube walked so far
+                for (const auto& [key, entries] : cells_)
+                {
+                    const CellPos p = pos_of(key);
+                    const i32     d = std::max({ std::abs(p.x - c.x), std::abs(p.y - c.y),
+                                                 std::abs(p.z - c.z) });
+                    if (d >= r)
+                        offer(entries);
+                }
+                break;
+            }
+
+            for (i32 z = c.z - r; z <= c.z + r; ++z)
+            {
+                for (i32 y = c.y - r; y <= c.y + r; ++y)
+                {
+                    // rows through the inside of the cube only touch its two x faces
+                    const bool edge = z == c.z - r || z == c.z + r || y == c.y - r ||
+                        y == c.y + r;
+                    const i32 step = edge || r == 0 ? 1 : 2 * r;
+                    for (i32 x = c.x - r; x <= c.x + r; x += step)
+                    {
+                        if (auto it = cells_.find(key_of(x, y, z)); it != cells_.end())
+                        {
+                            offer(it->second);
+                            seen += it->second.size();
+                        }
+                    }
+                }
+            }
+
+            const f32 reach = static_cast<f32>(r) * cell_size_;
+            if (seen == slots_.size() || reach > max_distance ||
+                (best.size() == k && best.front().first <= reach * reach))
+                break;
+        }
+
+        std::ranges::sort_heap(best, {}, &Ranked::first);
+        out.reserve(best.size());
+        for (const auto& [d2, e] : best)
+            out.push_back(e);
+    }
+
+    SpatialIndex::SpatialIndex(const SpatialConfig& config, const std::string& name) :
+        SDomain(name), hash_(config.cell_size)
+    {}
+
+    SpatialIndex::~SpatialIndex()
+    {
+        disconnect();
+        engine().on_destroy.disconnect("spatial_index");
+    }
+
+    void SpatialIndex::init()
+    {
+        auto& registry = engine().registry();
+        registry.on_construct<Pos3d>().connect<&SpatialIndex::on_set>(*this);
+        registry.on_update<Pos3d>().connect<&SpatialIndex::on_set>(*this);
+        registry.on_destroy<Pos3d>().connect<&SpatialIndex::on_erase>(*this);
+        connected_ = true;
+
+        // domains are torn down with the registry, let go of its signals before that
+        engine().on_destroy.connect({}, {}, "spatial_index", [this] { disconnect(); });
+
+        rebuild();
+    }
+
+    void SpatialIndex::disconnect()
+    {
+        if (!connected_)
+            return;
+        auto& registry = engine().registry();
+        registry.on_construct<Pos3d>().disconnect<&SpatialIndex::on_set>(*this);
+        registry.on_update<Pos3d>().disconnect<&SpatialIndex::on_set>(*this);
+        registry.on_destroy<Pos3d>().disconnect<&SpatialIndex::on_erase>(*this);
+        connected_ = false;
+    }
+
+    void SpatialIndex::refresh(entt::entity entity)
+    {
+        if (auto pos = engine().registry().try_get<Pos3d>(entity))
+            hash_.insert(entity, pos->val);
+        else
+            hash_.erase(entity);
+    }
+
+    void SpatialIndex::rebuild()
+    {
+        hash_.clear();
+        for (auto [entity, pos] : engine().registry().view<Pos3d>().each())
+            hash_.insert(entity, pos.val);
+    }
+
+    void SpatialIndex::on_set(entt::registry& registry, entt::entity entity)
+    {
+        hash_.insert(entity, registry.get<Pos3d>(entity).val);
+    }
+
+    void SpatialIndex::on_erase(entt::registry&, entt::entity entity)
+    {
+        hash_.erase(entity);
+    }
+} // namespace v
@@ -0,0 +1,142 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#include <engine/systems.h>
+#include <prelude.h>
+
+#include <algorithm>
+#include <containers/ud_map.h>
+#include <optional>
+#include <taskflow/taskflow.hpp>
+
+namespace v {
+    SystemScheduler::SystemScheduler(entt::registry& registry) : registry_(registry) {}
+
+    SystemScheduler::~SystemScheduler() = default;
+
+    void SystemScheduler::add_entry(Entry entry)
+    {
+        // a replaced system keeps its place
+        const auto it = std::ranges::find(systems_, entry.name, &Entry::name);
+        if (it != systems_.end())
+            *it = std::move(entry);
+        else
+            systems_.push_back(std::move(entry));
+        dirty_ = true;
+    }
+
+    bool SystemScheduler::remove(const std::string& name)
+    {
+        const auto it = std::ranges::find(systems_, name, &Entry::name);
+        if (it == systems_.end())
+            return false;
+        systems_.erase(it);
+        dirty_ = true;
+        return true;
+    }
+
+    void SystemScheduler::set_executor(tf::Executor* executor)
+    {
+        executor_ = executor;
+        dirty_    = true;
+    }
+
+    void SystemScheduler::rebuild()
+    {
+        dirty_ = false;
+
+        // per component, who wrote it last and who has read it since. a system waits
+        // for the last writer of everything it touches, and a writer also waits for
+        // the readers in between
+        struct Touched {
+            std::optional<u32> writer;
+            std::vector<u32>   readers;
+        };
+        ud_map<entt::id_type, Touched> touched;
+
+        for (u32 i = 0; i < systems_.size(); ++i)
+        {
+            Entry& system = systems_[i];
+            system.after.clear();
+            for (const entt::id_type id : system.reads)
+            {
+                if (const auto& t = touched[id]; t.writer)
+                    system.after.push_back(*t.writer);
+            }
+            for (const entt::id_type id : system.writes)
+            {
+                const auto& t = touched[id];
+                if (t.writer)
+                    system.after.push_back(*t.writer);
+                system.after.insert(
+                    system.after.end(), t.readers.begin(), t.readers.end());
+            }
+
+            std::ranges::sort(system.after);
+            const auto dupes = std::ranges::unique(system.after);
+            system.after.erase(dupes.begin(), dupes.end());
+            // a system that reads and writes the same thing doesn't wait for itself
+            std::erase(system.after, i);
+
+            system.batch = 0;
+            for (const u32 dep : system.after)
+                system.batch = std::max(system.batch, systems_[dep].batch + 1);
+
+            for (const entt::id_type id : system.reads)
+                touched[id].readers.push_back(i);
+            for (const entt::id_type id : system.writes)
+            {
+                auto& t  = touched[id];
+                t.writer = i;
+                t.readers.clear();
+            }
+        }
+
+        taskflow_.reset();
+        if (!executor_ || systems_.size() < 2)
+            return;
+
+        taskflow_ = std::make_unique<tf::Taskflow>();
+        std::vector<tf::Task> tasks;
+        tasks.reserve(systems_.size());
+        for (u32 i = 0; i < systems_.size(); ++i)
+        {
+            tasks.push_back(taskflow_->emplace([this, i] { systems_[i].func(); })
+                                .name(systems_[i].name));
+            for (const u32 dep : systems_[i].after)
+                tasks[dep].precede(tasks[i]);
+        }
+    }
+
+    void SystemScheduler::execute()
+    {
+        if (dirty_)
+            rebuild();
+
+        if (taskflow_)
+        {
+            executor_->run(*taskflow_).get();
+            return;
+        }
+
+        // registration order already respects every conflict
+        for (auto& system : systems_)
+            system.func();
+    }
+
+    std::vector<std::vector<std::string>> SystemScheduler::batches()
+    {
+        if (dirty_)
+            rebuild();
+
+        std::vector<std::vector<std::string>> out;
+        for (const auto& system : systems_)
+        {
+            if (system.batch >= out.size())
+                out.resize(system.batch + 1);
+            out[system.batch].push_back(system.name);
+        }
+        return out;
+    }
+} // namespace v
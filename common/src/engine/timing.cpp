@@ -0,0 +1,42 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#include <engine/timing.h>
+
+#include <algorithm>
+
+namespace v {
+    TimingRing::TimingRing(std::string name) :
+        name_{ std::move(name) }, plot_name_{ name_ + " (us)" }
+    {
+#ifdef TRACY_ENABLE
+        zone_location = { name_.c_str(), name_.c_str(), __FILE__, __LINE__, 0 };
+#endif
+    }
+
+    TaskTiming TimingRing::summarize() const
+    {
+        TaskTiming timing{ .name = name_ };
+        timing.runs = head_.load(std::memory_order_acquire);
+
+        const u32 count = static_cast<u32>(std::min<u64>(timing.runs, capacity));
+        if (count == 0)
+            return timing;
+
+        std::array<u32, capacity> sorted;
+        for (u32 i = 0; i < count; ++i)
+            sorted[i] = samples_[i].load(std::memory_order_relaxed);
+
+        const auto end = sorted.begin() + count;
+        const auto at  = [&](u32 rank)
+        {
+            std::nth_element(sorted.begin(), sorted.begin() + rank, end);
+            return static_cast<u64>(sorted[rank]);
+        };
+        timing.max_ns = *std::max_element(sorted.begin(), end);
+        timing.p99_ns = at(std::min(count - 1, count * 99 / 100));
+        timing.p50_ns = at(count / 2);
+        return timing;
+    }
+} // namespace v
@@ -0,0 +1,102 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#include <mem/frame_arena.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <new>
+
+namespace {
+    std::atomic<u64> g_frame{ 0 };
+} // namespace
+
+namespace v::mem {
+    FrameArena::~FrameArena()
+    {
+        for (const Block& block : blocks_)
+            ::operator delete(block.data, std::align_val_t{ alignof(std::max_align_t) });
+    }
+
+    FrameArena& FrameArena::local()
+    {
+        thread_local FrameArena arena;
+        const u64 frame = g_frame.load(std::memory_order_relaxed);
+        if (UNLIKELY(arena.frame_ != frame))
+        {
+            arena.reset();
+            arena.frame_ = frame;
+        }
+        return arena;
+    }
+
+    void FrameArena::end_frame()
+    {
+        g_frame.fetch_add(1, std::memory_order_relaxed);
+        // resets the caller's arena
+        local();
+    }
+
+    void* FrameArena::allocate_slow(usize bytes, usize align)
+    {
+        // blocks kept from earlier frames come first, everything after the current
+        // block is free
+        while (current_ + 1 < blocks_.size())
+        {
+            current_++;
+            offset_ = 0;
+            if (void* ptr = bump(bytes, align))
+                return ptr;
+        }
+
+        const usize last = blocks_.empty() ? 0 : blocks_.back().size;
+        const usize size = std::max({ k_block_size, bytes + align, last * 2 });
+        auto*       data = static_cast<std::byte*>(
+            ::operator new(size, std::align_val_t{ alignof(std::max_align_t) }));
+        blocks_.push_back({ data, size });
+
+        current_ = static_cast<u32>(blocks_.size() - 1);
+        offset_  = 0;
+        return bump(bytes, align);
+    }
+
+    void FrameArena::reset()
+    {
+        poison({ 0, 0 }, mark());
+        current_     = 0;
+        offset_      = 0;
+        allocations_ = 0;
+    }
+
+    void FrameArena::rewind(Marker marker)
+    {
+        poison(marker, mark());
+        current_ = marker.block;
+        offset_  = marker.offset;
+    }
+
+    usize FrameArena::capacity() const
+    {
+        usize total = 0;
+        for (const Block& block : blocks_)
+            total += block.size;
+        return total;
+    }
+
+    void FrameArena::poison(Marker from, Marker to)
+    {
+#if !defined(V_RELEASE)
+        if (blocks_.empty())
+            return;
+        for (u32 b = from.block; b <= to.block; ++b)
+        {
+            const usize begin = b == from.block ? from.offset : 0;
+            const usize end   = b == to.block ? to.offset : blocks_[b].size;
+            if (end > begin)
+                std::memset(blocks_[b].data + begin, k_poison, end - begin);
+        }
+#endif
+    }
+} // namespace v::mem
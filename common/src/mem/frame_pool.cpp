@@ -0,0 +1,28 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#include <mem/frame_pool.h>
+
+namespace v::mem {
+    FramePool::~FramePool() { trim(); }
+
+    FramePool& FramePool::local()
+    {
+        thread_local FramePool pool;
+        return pool;
+    }
+
+    void FramePool::trim()
+    {
+        for (FreeBlock*& head : free_)
+        {
+            while (FreeBlock* block = head)
+            {
+                head = block->next;
+                ::operator delete(block);
+            }
+        }
+        cached_ = 0;
+    }
+} // namespace v::mem
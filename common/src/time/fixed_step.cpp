@@ -0,0 +1,87 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#include <time/fixed_step.h>
+#include <time/time.h>
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+namespace {
+    FORCEINLINE void cpu_relax()
+    {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+} // namespace
+
+namespace v {
+    FixedStep::FixedStep(f64 step, u32 max_catch_up) :
+        step_(step), max_catch_up_(std::max(1u, max_catch_up))
+    {}
+
+    u32 FixedStep::advance(f64 elapsed)
+    {
+        accumulator_ += std::max(0.0, elapsed);
+
+        // a hair of slack so a step that's due up to rounding isn't pushed to the
+        // next call
+        const f64 due   = (accumulator_ + step_ * 1e-6) / step_;
+        u64       steps = static_cast<u64>(due);
+        if (steps > max_catch_up_)
+        {
+            dropped_ += steps - max_catch_up_;
+            steps = max_catch_up_;
+            // keep the phase, forget the backlog
+            accumulator_ = std::fmod(accumulator_, step_) + steps * step_;
+        }
+
+        accumulator_ = std::max(0.0, accumulator_ - steps * step_);
+        return static_cast<u32>(steps);
+    }
+
+    void Pacer::wait_until(u64 deadline_ns)
+    {
+        u64 now = time::ns();
+        if (!spin_)
+        {
+            if (now < deadline_ns)
+                time::sleep_ns(deadline_ns - now);
+            return;
+        }
+
+        // sleep in chunks so one oversleep can't eat the whole spin window
+        while (now + spin_ns_ < deadline_ns)
+        {
+            const u64 request = std::min<u64>(deadline_ns - now - spin_ns_, 1'000'000);
+            std::this_thread::sleep_for(std::chrono::nanoseconds(request));
+            const u64 after = time::ns();
+
+            // spin at least as long as the OS tends to oversleep, decaying slowly
+            // back down when it behaves
+            const u64 over   = after - now > request ? after - now - request : 0;
+            const u64 wanted = std::max(over + over / 4, spin_ns_ - spin_ns_ / 64);
+            spin_ns_         = std::clamp(wanted, k_min_spin, k_max_spin);
+            now = after;
+        }
+
+        // no yield here, on a busy core the scheduler may not hand the thread back
+        // for a whole timeslice
+        while (now < deadline_ns)
+        {
+            cpu_relax();
+            now = time::ns();
+        }
+    }
+} // namespace v
@@ -2,6 +2,7 @@
 // Created by niooi on 10/7/2025.
 //
 
+#include <mem/frame_arena.h>
 #include <vox/store/64tree.h>
 
 namespace v {
@@ -9,16 +10,52 @@ namespace v {
 
     void Sparse64Tree::clear_node(S64Node_UP& node)
     {
-        u64 m = node->child_mask;
+        if (!node)
+            return;
 
-        for (auto i : node->child_indices())
+        // a leaf's mask is for its voxels, it has no children
+        if (node->type == Type::Regular)
         {
-            clear_node(node->children[i]);
+            for (auto i : node->child_indices())
+            {
+                clear_node(node->children[i]);
+            }
         }
 
         node.reset();
     }
 
+    usize Sparse64Tree::node_usage(const S64Node& node, usize& nodes)
+    {
+        nodes++;
+        usize bytes = sizeof(S64Node) + node.children.capacity() * sizeof(S64Node_UP) +
+            node.voxels.capacity() * sizeof(VoxelType);
+        if (node.type == Type::Regular)
+        {
+            for (const auto& child : node.children)
+            {
+                if (child)
+                    bytes += node_usage(*child, nodes);
+            }
+        }
+        return bytes;
+    }
+
+    usize Sparse64Tree::memory_usage() const
+    {
+        usize nodes = 0;
+        return sizeof(*this) + g_nodes_.capacity() * sizeof(GS64Node) +
+            (root_ ? node_usage(*root_, nodes) : 0);
+    }
+
+    usize Sparse64Tree::node_count() const
+    {
+        usize nodes = 0;
+        if (root_)
+            node_usage(*root_, nodes);
+        return nodes;
+    }
+
     void Sparse64Tree::fill_node(S64Node_UP& node, VoxelType t)
     {
         node->type = Type::SingleTypeLeaf;
@@ -167,9 +204,14 @@ namespace v {
             root_->children.resize(64);
         }
 
-        S64Node_P              curr = root_.get();
-        std::vector<S64Node_P> path;
-        std::vector<u8>        indices;
+        // the walk down is only needed for this call, so it comes off the frame arena
+        mem::FrameArena&            arena = mem::FrameArena::local();
+        mem::FrameArena::Scope      scope{ arena };
+        S64Node_P                   curr = root_.get();
+        std::pmr::vector<S64Node_P> path{ arena.resource() };
+        std::pmr::vector<u8>        indices{ arena.resource() };
+        path.reserve(depth_);
+        indices.reserve(depth_);
 
         while (1)
         {
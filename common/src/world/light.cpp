@@ -0,0 +1,698 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#include <algorithm>
+#include <engine/contexts/async/async.h>
+#include <engine/engine.h>
+#include <world/light.h>
+#include "taskflow/algorithm/for_each.hpp"
+
+namespace v {
+    namespace {
+        // faces/directions are -x, +x, -y, +y, -z, +z, so the opposite face is f ^ 1
+        constexpr u8  k_down     = 2;
+        constexpr u8  k_up       = 3;
+        constexpr i32 k_step[6]  = { -1, 1, -128, 128, -16384, 16384 };
+        constexpr u32 k_last     = ChunkLight::k_size - 1;
+        constexpr u8  k_channels = 2;
+
+        FORCEINLINE bool at_border(u32 index, u8 dir)
+        {
+            const u32 c = (index >> (7 * (dir >> 1))) & k_last;
+            return (dir & 1) ? c == k_last : c == 0;
+        }
+
+        /// The voxel across the chunk border in direction dir, in the neighbour's indices
+        FORCEINLINE u32 across(u32 index, u8 dir)
+        {
+            return static_cast<u32>(
+                static_cast<i32>(index) - k_step[dir] * static_cast<i32>(k_last));
+        }
+
+        /// A voxel on the given face of the chunk, a and b walk the other two axes
+        FORCEINLINE u32 face_index(u8 face, i32 a, i32 b)
+        {
+            const i32 fixed = (face & 1) ? k_last : 0;
+            switch (face >> 1)
+            {
+            case 0:
+                return ChunkEdit::pack({ fixed, a, b });
+            case 1:
+                return ChunkEdit::pack({ a, fixed, b });
+            default:
+                return ChunkEdit::pack({ a, b, fixed });
+            }
+        }
+
+        FORCEINLINE ChunkPos neighbor_pos(const ChunkPos& cp, u8 dir)
+        {
+            ChunkPos  n = cp;
+            const i32 d = (dir & 1) ? 1 : -1;
+            switch (dir >> 1)
+            {
+            case 0:
+                n.x += d;
+                break;
+            case 1:
+                n.y += d;
+                break;
+            default:
+                n.z += d;
+                break;
+            }
+            return n;
+        }
+
+        /// Adjacent chunks never share a class
+        FORCEINLINE u8 parity_class(const ChunkPos& cp)
+        {
+            return static_cast<u8>((cp.x & 1) | ((cp.y & 1) << 1) | ((cp.z & 1) << 2));
+        }
+
+        /// Level a voxel gets from a neighbour at `level`, travelling in direction dir
+        FORCEINLINE u8 spread(LightChannel ch, u8 level, u8 dir)
+        {
+            const bool falling = ch == LightChannel::Sky && dir == k_down;
+            if (falling && level == ChunkLight::k_max_level)
+                return level;
+            return level - 1;
+        }
+
+        /// Sets len bits starting at bit first
+        FORCEINLINE void fill_bits(u64* bits, u32 first, u32 len)
+        {
+            while (len > 0)
+            {
+                const u32 word = first >> 6;
+                const u32 bit  = first & 63;
+                const u32 n    = std::min(64 - bit, len);
+                bits[word] |= n == 64 ? ~0ull : ((1ull << n) - 1) << bit;
+                first += n;
+                len -= n;
+            }
+        }
+
+        constexpr std::array<LightChannel, 2> k_all_channels{ LightChannel::Sky,
+                                                              LightChannel::Block };
+    } // namespace
+
+    ChunkLight::ChunkLight(ChunkPos pos) :
+        pos_(pos), levels_(std::make_unique<u8[]>(k_volume)),
+        opaque_(std::make_unique<u64[]>(k_volume / 64))
+    {}
+
+    usize ChunkLight::memory_usage() const
+    {
+        usize queued = emitters_.capacity() * sizeof(u32);
+        for (u8 ch = 0; ch < k_channels; ++ch)
+        {
+            queued += add_[ch].capacity() * sizeof(u32);
+            queued += remove_[ch].capacity() * sizeof(Removal);
+            for (const auto& in : incoming_[ch])
+                queued += in.capacity() * sizeof(Incoming);
+        }
+        return sizeof(*this) + k_volume + k_volume / 8 + queued;
+    }
+
+    bool ChunkLight::has_work() const
+    {
+        if (needs_relight_ || !emitters_.empty())
+            return true;
+        for (u8 ch = 0; ch < k_channels; ++ch)
+        {
+            if (!add_[ch].empty() || !remove_[ch].empty())
+                return true;
+            for (const auto& in : incoming_[ch])
+            {
+                if (!in.empty())
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    LightEngine::LightEngine(const LightConfig& config, const std::string& name) :
+        SDomain(name), config_(config)
+    {}
+
+    LightEngine::~LightEngine() { engine().on_tick.disconnect("light_update"); }
+
+    void LightEngine::init()
+    {
+        engine().on_tick.connect({}, {}, "light_update", [this] { update(); });
+    }
+
+    void LightEngine::set_emission(u16 type, u8 level)
+    {
+        emission_[type] = std::min(level, ChunkLight::k_max_level);
+        has_emitters_   = has_emitters_ || level > 0;
+    }
+
+    void LightEngine::set_opaque(u16 type, bool opaque)
+    {
+        if (type == 0)
+            return;
+        clear_[type] = !opaque;
+    }
+
+    ChunkLight* LightEngine::find(const ChunkPos& cp)
+    {
+        auto it = lights_.find(cp);
+        return it == lights_.end() ? nullptr : it->second.get();
+    }
+
+    const ChunkLight* LightEngine::try_get(const ChunkPos& cp) const
+    {
+        auto it = lights_.find(cp);
+        return it == lights_.end() ? nullptr : it->second.get();
+    }
+
+    u8 LightEngine::sky_light(WorldPos wp) const
+    {
+        auto [cp, lp] = WorldDomain::world_to_chunk(wp);
+        if (auto light = try_get(cp))
+            return light->sky(lp);
+        // nothing lit there yet, but unlit chunks are treated as open sky
+        return ChunkLight::k_max_level;
+    }
+
+    u8 LightEngine::block_light(WorldPos wp) const
+    {
+        auto [cp, lp] = WorldDomain::world_to_chunk(wp);
+        if (auto light = try_get(cp))
+            return light->block(lp);
+        return 0;
+    }
+
+    void LightEngine::queue_relight(const ChunkPos& cp)
+    {
+        auto               world = engine().get_domain<WorldDomain>();
+        const ChunkDomain* chunk = world ? world->find_chunk(cp) : nullptr;
+        if (!chunk)
+        {
+            LOG_WARN("Can't light chunk ({},{},{}), it isn't loaded", cp.x, cp.y, cp.z);
+            return;
+        }
+
+        auto& slot = lights_[cp];
+        if (!slot)
+        {
+            slot         = std::make_unique<ChunkLight>(cp);
+            links_stale_ = true;
+        }
+        slot->chunk_         = chunk;
+        slot->generation_    = static_cast<u32>(chunk->version() >> 32);
+        slot->needs_relight_ = true;
+        work_queued_         = true;
+    }
+
+    void LightEngine::voxel_changed(WorldPos wp)
+    {
+        auto [cp, lp] = WorldDomain::world_to_chunk(wp);
+        ChunkLight* light = find(cp);
+        if (!light)
+            return;
+
+        auto world = engine().get_domain<WorldDomain>();
+        if (const ChunkDomain* chunk = world ? world->find_chunk(cp) : nullptr)
+            invalidate(*light, *chunk, lp);
+    }
+
+    void LightEngine::chunk_edited(const ChunkPos& cp, std::span<const ChunkEdit> edits)
+    {
+        ChunkLight* light = find(cp);
+        if (!light || edits.empty())
+            return;
+
+        auto               world = engine().get_domain<WorldDomain>();
+        const ChunkDomain* chunk = world ? world->find_chunk(cp) : nullptr;
+        if (!chunk)
+            return;
+
+        for (const auto& e : edits)
+            invalidate(*light, *chunk, e.pos());
+    }
+
+    void LightEngine::set_voxel(WorldPos wp, u16 value)
+    {
+        auto world = engine().get_domain<WorldDomain>();
+        if (!world)
+        {
+            LOG_WARN("LightEngine::set_voxel without a WorldDomain");
+            return;
+        }
+        world->set_voxel(wp, value);
+        voxel_changed(wp);
+    }
+
+    void LightEngine::invalidate(ChunkLight& c, const ChunkDomain& chunk, VoxelPos lp)
+    {
+        const u32  index  = ChunkEdit::pack(lp);
+        const u16  type   = chunk.get(lp);
+        const bool opaque = blocks_light(type);
+        c.set_opaque(index, opaque);
+        work_queued_ = true;
+
+        // a relight is going to rebuild everything anyways
+        if (c.needs_relight_)
+            return;
+
+        for (auto ch : k_all_channels)
+        {
+            const u8 i     = static_cast<u8>(ch);
+            const u8 level = c.get(ch, index);
+            if (level > 0)
+            {
+                c.set(ch, index, 0);
+                c.remove_[i].push_back({ index, level });
+            }
+        }
+
+        if (emission_[type] > 0)
+            c.emitters_.push_back(index);
+
+        if (opaque)
+            return;
+
+        // let light from the surroundings flow back in
+        for (u8 dir = 0; dir < 6; ++dir)
+        {
+            if (at_border(index, dir))
+            {
+                ChunkLight* nb = find(neighbor_pos(c.pos_, dir));
+                if (!nb)
+                {
+                    if (dir == k_up)
+                    {
+                        c.set(LightChannel::Sky, index, ChunkLight::k_max_level);
+                        c.add_[static_cast<u8>(LightChannel::Sky)].push_back(index);
+                    }
+                    continue;
+                }
+                const u32 from = across(index, dir);
+                for (auto ch : k_all_channels)
+                {
+                    if (nb->get(ch, from) > 0)
+                        nb->add_[static_cast<u8>(ch)].push_back(from);
+                }
+                continue;
+            }
+
+            const u32 n = index + k_step[dir];
+            for (auto ch : k_all_channels)
+            {
+                if (c.get(ch, n) > 0)
+                    c.add_[static_cast<u8>(ch)].push_back(n);
+            }
+        }
+    }
+
+    void LightEngine::sync(const WorldDomain& world)
+    {
+        for (auto it = lights_.begin(); it != lights_.end();)
+        {
+            const ChunkDomain* chunk = world.find_chunk(it->first);
+            if (!chunk)
+            {
+                it           = lights_.erase(it);
+                links_stale_ = true;
+                continue;
+            }
+
+            // evicted and loaded again, whatever we had is stale
+            ChunkLight& c          = *it->second;
+            const u32   generation = static_cast<u32>(chunk->version() >> 32);
+            if (c.chunk_ != chunk || c.generation_ != generation)
+            {
+                c.chunk_         = chunk;
+                c.generation_    = generation;
+                c.needs_relight_ = true;
+                work_queued_     = true;
+            }
+            ++it;
+        }
+
+        if (!links_stale_)
+            return;
+
+        for (auto& [cp, light] : lights_)
+        {
+            for (u8 dir = 0; dir < 6; ++dir)
+                light->neighbors_[dir] = find(neighbor_pos(cp, dir));
+        }
+        links_stale_ = false;
+    }
+
+    u32 LightEngine::update()
+    {
+        if (!work_queued_)
+            return 0;
+
+        auto world = engine().get_domain<WorldDomain>();
+        if (!world)
+            return 0;
+
+        Stopwatch sw{};
+        sync(*world);
+
+        if (config_.parallel && !executor_)
+        {
+            if (auto async = engine().get_ctx<AsyncContext>())
+                executor_ = &async->executor();
+        }
+
+        std::vector<ChunkLight*> batch;
+        bool                     settled = false;
+        u32                      rounds  = 0;
+        while (rounds < config_.max_rounds)
+        {
+            bool any = false;
+            for (u8 cls = 0; cls < 8; ++cls)
+            {
+                batch.clear();
+                for (auto& [cp, light] : lights_)
+                {
+                    if (parity_class(cp) == cls && light->has_work())
+                    {
+                        batch.push_back(light.get());
+                        stats_.relights += light->needs_relight_;
+                    }
+                }
+                if (batch.empty())
+                    continue;
+
+                any = true;
+                run_class(batch);
+                stats_.chunk_passes += batch.size();
+            }
+
+            if (!any)
+            {
+                settled = true;
+                break;
+            }
+            rounds++;
+        }
+
+        if (!settled)
+            LOG_DEBUG("Light work left after {} rounds, continuing next tick", rounds);
+
+        work_queued_ = !settled;
+
+        stats_.rounds += rounds;
+        stats_.last_update_secs = sw.elapsed();
+        stats_.total_update_secs += stats_.last_update_secs;
+        return rounds;
+    }
+
+    void LightEngine::run_class(std::vector<ChunkLight*>& batch)
+    {
+        if (batch.size() == 1 || !executor_)
+        {
+            for (auto light : batch)
+                process(*light);
+            return;
+        }
+
+        tf::Taskflow taskflow;
+        taskflow.for_each(
+            batch.begin(), batch.end(), [this](ChunkLight* light) { process(*light); });
+        // on_tick may already be running on a worker (parallel sinks), which mustn't
+        // block on the pool it belongs to
+        if (executor_->this_worker_id() >= 0)
+            executor_->corun(taskflow);
+        else
+            executor_->run(taskflow).wait();
+    }
+
+    void LightEngine::process(ChunkLight& c) const
+    {
+        if (c.needs_relight_)
+            seed_relight(c);
+
+        for (auto ch : k_all_channels)
+        {
+            // everything that went dark has to be cleared before refilling, otherwise
+            // stale light gets spread around again
+            drain_incoming(c, ch, true);
+            propagate_removal(c, ch);
+            drain_incoming(c, ch, false);
+
+            if (ch == LightChannel::Block)
+            {
+                for (u32 index : c.emitters_)
+                {
+                    const u16 type  = c.chunk_->get(ChunkEdit{ index, 0 }.pos());
+                    const u8  level = emission_[type];
+                    if (level > c.get(ch, index))
+                    {
+                        c.set(ch, index, level);
+                        c.add_[static_cast<u8>(ch)].push_back(index);
+                    }
+                }
+                c.emitters_.clear();
+            }
+
+            propagate(c, ch);
+        }
+    }
+
+    void LightEngine::seed_relight(ChunkLight& c) const
+    {
+        constexpr i32 size = ChunkLight::k_size;
+
+        c.needs_relight_ = false;
+        std::fill_n(c.levels_.get(), ChunkLight::k_volume, 0);
+        std::fill_n(c.opaque_.get(), ChunkLight::k_volume / 64, 0);
+        c.emitters_.clear();
+        for (u8 ch = 0; ch < k_channels; ++ch)
+        {
+            c.add_[ch].clear();
+            c.remove_[ch].clear();
+            // whatever neighbours sent is read off their borders below
+            for (auto& in : c.incoming_[ch])
+                in.clear();
+        }
+
+        auto& block_queue = c.add_[static_cast<u8>(LightChannel::Block)];
+        auto& sky_queue   = c.add_[static_cast<u8>(LightChannel::Sky)];
+
+        // opacity and emitters, straight from the octree leaves
+        c.chunk_->svo().for_each_leaf(
+            [&](i32 x, i32 y, i32 z, i32 len, u16 type)
+            {
+                const bool opaque = blocks_light(type);
+                const u8   emit   = emission_[type];
+                if (!opaque && emit == 0)
+                    return;
+
+                for (i32 dz = 0; dz < len; ++dz)
+                {
+                    for (i32 dy = 0; dy < len; ++dy)
+                    {
+                        const u32 row = ChunkEdit::pack({ x, y + dy, z + dz });
+                        if (opaque)
+                            fill_bits(c.opaque_.get(), row, len);
+                        if (emit == 0)
+                            continue;
+                        for (i32 dx = 0; dx < len; ++dx)
+                        {
+                            c.set(LightChannel::Block, row + dx, emit);
+                            block_queue.push_back(row + dx);
+                        }
+                    }
+                }
+            });
+
+        // sky: a column lit at full strength from above stays lit down to the first
+        // opaque voxel. bottom holds the lowest lit y per column, size if unlit
+        const ChunkLight*           above = c.neighbors_[k_up];
+        std::array<u8, size * size> bottom;
+        for (i32 z = 0; z < size; ++z)
+        {
+            for (i32 x = 0; x < size; ++x)
+            {
+                // an above chunk that isn't lit yet sends its light down once it is
+                bool lit = true;
+                if (above)
+                {
+                    lit = !above->needs_relight_ &&
+                        above->get(LightChannel::Sky, ChunkEdit::pack({ x, 0, z })) ==
+                            ChunkLight::k_max_level;
+                }
+
+                i32 y = size;
+                if (lit)
+                {
+                    while (y > 0 && !c.is_opaque(ChunkEdit::pack({ x, y - 1, z })))
+                        y--;
+                }
+                bottom[x + z * size] = static_cast<u8>(y);
+            }
+        }
+
+        // only voxels next to something darker need to spread, which skips the
+        // inside of big open areas
+        const auto darker_next_to = [&](i32 x, i32 y, i32 z)
+        {
+            return x == 0 || z == 0 || x == k_last || z == k_last ||
+                bottom[(x - 1) + z * size] > y || bottom[(x + 1) + z * size] > y ||
+                bottom[x + (z - 1) * size] > y || bottom[x + (z + 1) * size] > y;
+        };
+
+        for (i32 z = 0; z < size; ++z)
+        {
+            for (i32 x = 0; x < size; ++x)
+            {
+                const i32 b = bottom[x + z * size];
+                for (i32 y = size - 1; y >= b; --y)
+                {
+                    const u32 index = ChunkEdit::pack({ x, y, z });
+                    c.set(LightChannel::Sky, index, ChunkLight::k_max_level);
+                    if (y == b || darker_next_to(x, y, z))
+                        sky_queue.push_back(index);
+                }
+            }
+        }
+
+        // light already in the neighbours flows in across the borders
+        for (u8 face = 0; face < 6; ++face)
+        {
+            const ChunkLight* nb = c.neighbors_[face];
+            if (!nb || nb->needs_relight_)
+                continue;
+
+            // travelling away from the neighbour
+            const u8 dir = face ^ 1;
+            for (i32 a = 0; a < size; ++a)
+            {
+                for (i32 b = 0; b < size; ++b)
+                {
+                    const u32 index = face_index(face, a, b);
+                    if (c.is_opaque(index))
+                        continue;
+
+                    const u32 from = across(index, face);
+                    for (auto ch : k_all_channels)
+                    {
+                        const u8 level = nb->get(ch, from);
+                        if (level == 0)
+                            continue;
+                        const u8 next = spread(ch, level, dir);
+                        if (next > c.get(ch, index))
+                        {
+                            c.set(ch, index, next);
+                            c.add_[static_cast<u8>(ch)].push_back(index);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void LightEngine::drain_incoming(ChunkLight& c, LightChannel ch, bool removals) const
+    {
+        const u8 i = static_cast<u8>(ch);
+        for (u8 face = 0; face < 6; ++face)
+        {
+            auto&    in  = c.incoming_[i][face];
+            const u8 dir = face ^ 1;
+            for (const auto& e : in)
+            {
+                if (e.remove != removals)
+                    continue;
+
+                if (removals)
+                    unlight(c, ch, e.index, e.level, dir);
+                else if (!c.is_opaque(e.index) && c.get(ch, e.index) < e.level)
+                {
+                    c.set(ch, e.index, e.level);
+                    c.add_[i].push_back(e.index);
+                }
+            }
+            if (!removals)
+                in.clear();
+        }
+    }
+
+    void LightEngine::propagate_removal(ChunkLight& c, LightChannel ch) const
+    {
+        const u8 i     = static_cast<u8>(ch);
+        auto&    queue = c.remove_[i];
+        for (usize head = 0; head < queue.size(); ++head)
+        {
+            const ChunkLight::Removal node = queue[head];
+            for (u8 dir = 0; dir < 6; ++dir)
+            {
+                if (at_border(node.index, dir))
+                {
+                    ChunkLight* nb = c.neighbors_[dir];
+                    const u32   to = across(node.index, dir);
+                    if (nb && nb->get(ch, to) != 0)
+                        nb->incoming_[i][dir ^ 1].push_back({ to, node.level, true });
+                    continue;
+                }
+                unlight(c, ch, node.index + k_step[dir], node.level, dir);
+            }
+        }
+        queue.clear();
+    }
+
+    void LightEngine::unlight(
+        ChunkLight& c, LightChannel ch, u32 index, u8 level, u8 dir) const
+    {
+        const u8 cur = c.get(ch, index);
+        if (cur == 0)
+            return;
+
+        // dimmer than the voxel that went dark (or sky light straight below it), so it
+        // may have been lit by it. otherwise it's lit by something else and has to
+        // spread back into the gap
+        if (cur < level || (cur == level && spread(ch, level, dir) == level))
+        {
+            c.set(ch, index, 0);
+            c.remove_[static_cast<u8>(ch)].push_back({ index, cur });
+            if (ch == LightChannel::Block && has_emitters_ &&
+                emission_[c.chunk_->get(ChunkEdit{ index, 0 }.pos())] > 0)
+                c.emitters_.push_back(index);
+        }
+        else
+            c.add_[static_cast<u8>(ch)].push_back(index);
+    }
+
+    void LightEngine::propagate(ChunkLight& c, LightChannel ch) const
+    {
+        const u8 i     = static_cast<u8>(ch);
+        auto&    queue = c.add_[i];
+        for (usize head = 0; head < queue.size(); ++head)
+        {
+            const u32 index = queue[head];
+            const u8  level = c.get(ch, index);
+            if (level <= 1)
+                continue;
+
+            for (u8 dir = 0; dir < 6; ++dir)
+            {
+                const u8 next = spread(ch, level, dir);
+                if (at_border(index, dir))
+                {
+                    ChunkLight* nb = c.neighbors_[dir];
+                    const u32   to = across(index, dir);
+                    // reading a neighbour is fine, it's in another class so it isn't
+                    // running right now
+                    if (nb && !nb->is_opaque(to) && nb->get(ch, to) < next)
+                        nb->incoming_[i][dir ^ 1].push_back({ to, next, false });
+                    continue;
+                }
+
+                const u32 n = index + k_step[dir];
+                if (c.is_opaque(n) || c.get(ch, n) >= next)
+                    continue;
+                c.set(ch, n, next);
+                queue.push_back(n);
+            }
+        }
+        queue.clear();
+    }
+} // namespace v
@@ -0,0 +1,277 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#include <algorithm>
+#include <bit>
+#include <world/light.h>
+#include <world/mesher.h>
+
+namespace v {
+    namespace {
+        constexpr i32 k_chunk = ChunkDomain::k_size;
+
+        // faces are -x, +x, -y, +y, -z, +z like the light engine
+        constexpr i32 k_normal[6][3] = {
+            { -1, 0, 0 }, { 1, 0, 0 },  { 0, -1, 0 },
+            { 0, 1, 0 },  { 0, 0, -1 }, { 0, 0, 1 },
+        };
+        /// Axes spanning each face's plane. x faces use (y, z), y faces (x, z) and
+        /// z faces (x, y), which is how the neighbourhood rows are laid out
+        constexpr i32 k_u_axis[6] = { 1, 1, 0, 0, 0, 0 };
+        constexpr i32 k_v_axis[6] = { 2, 2, 2, 2, 1, 1 };
+        /// Corner emit order so quads wind counter clockwise from outside. Flipped where
+        /// u x v points against the normal (-x, +y, -z)
+        constexpr u32 k_corner_order[6][4] = {
+            { 0, 3, 2, 1 }, { 0, 1, 2, 3 }, { 0, 1, 2, 3 },
+            { 0, 3, 2, 1 }, { 0, 3, 2, 1 }, { 0, 1, 2, 3 },
+        };
+
+        /// Sets len bits starting at bit first
+        FORCEINLINE void fill_bits(u64* bits, u32 first, u32 len)
+        {
+            while (len > 0)
+            {
+                const u32 word = first >> 6;
+                const u32 bit  = first & 63;
+                const u32 n    = std::min(64 - bit, len);
+                bits[word] |= n == 64 ? ~0ull : ((1ull << n) - 1) << bit;
+                first += n;
+                len -= n;
+            }
+        }
+
+        /// The 3x3 solid neighbourhood in front of face f of padded voxel p, see VoxelAO
+        FORCEINLINE u32 neighbourhood(const PaddedChunk& c, i32 px, i32 py, i32 pz, u8 f)
+        {
+            const i32 ax = px + k_normal[f][0];
+            const i32 ay = py + k_normal[f][1];
+            const i32 az = pz + k_normal[f][2];
+            switch (f >> 1)
+            {
+            case 0: // u = y, v = z
+                return PaddedChunk::bits3(c.y_row(ax, az - 1), ay - 1) |
+                    PaddedChunk::bits3(c.y_row(ax, az), ay - 1) << 3 |
+                    PaddedChunk::bits3(c.y_row(ax, az + 1), ay - 1) << 6;
+            case 1: // u = x, v = z
+                return PaddedChunk::bits3(c.x_row(ay, az - 1), ax - 1) |
+                    PaddedChunk::bits3(c.x_row(ay, az), ax - 1) << 3 |
+                    PaddedChunk::bits3(c.x_row(ay, az + 1), ax - 1) << 6;
+            default: // u = x, v = y
+                return PaddedChunk::bits3(c.x_row(ay - 1, az), ax - 1) |
+                    PaddedChunk::bits3(c.x_row(ay, az), ax - 1) << 3 |
+                    PaddedChunk::bits3(c.x_row(ay + 1, az), ax - 1) << 6;
+            }
+        }
+        void emit_quad(
+            ChunkMesh& out, const std::array<i32, 3>& local, u8 f, u8 ao, u16 type,
+            u8 lit)
+        {
+            const i32 axis = f >> 1;
+            const i32 ua   = k_u_axis[f];
+            const i32 va   = k_v_axis[f];
+            const u32 base = static_cast<u32>(out.vertices.size());
+
+            std::array<u8, 4> corner_ao;
+            for (u32 i = 0; i < 4; ++i)
+            {
+                const u32 corner = k_corner_order[f][i];
+                corner_ao[i]     = VoxelAO::corner(ao, corner);
+
+                std::array<i32, 3> pos = local;
+                pos[axis] += f & 1;
+                pos[ua] += VoxelAO::k_corner_u[corner] > 0;
+                pos[va] += VoxelAO::k_corner_v[corner] > 0;
+
+                out.vertices.push_back(
+                    { static_cast<u8>(pos[0]), static_cast<u8>(pos[1]),
+                      static_cast<u8>(pos[2]), static_cast<u8>(f | (corner_ao[i] << 3)),
+                      type, lit });
+            }
+
+            // split along the brighter diagonal, otherwise a single dark corner bleeds
+            // over half the quad
+            if (corner_ao[0] + corner_ao[2] >= corner_ao[1] + corner_ao[3])
+            {
+                out.indices.insert(
+                    out.indices.end(),
+                    { base, base + 1, base + 2, base, base + 2, base + 3 });
+            }
+            else
+            {
+                out.indices.insert(
+                    out.indices.end(),
+                    { base + 1, base + 2, base + 3, base + 1, base + 3, base });
+            }
+        }
+    } // namespace
+
+    PaddedChunk::PaddedChunk() :
+        voxels_(std::make_unique<u16[]>(k_volume)),
+        x_rows_(std::make_unique<u64[]>(k_size * k_size * k_words)),
+        y_rows_(std::make_unique<u64[]>(k_size * k_size * k_words))
+    {}
+
+    void PaddedChunk::write_box(std::array<i32, 3> p0, std::array<i32, 3> p1, u16 value)
+    {
+        const u32 len_x = static_cast<u32>(p1[0] - p0[0]);
+        const u32 len_y = static_cast<u32>(p1[1] - p0[1]);
+        for (i32 pz = p0[2]; pz < p1[2]; ++pz)
+        {
+            for (i32 py = p0[1]; py < p1[1]; ++py)
+            {
+                u16* row = voxels_.get() + p0[0] + py * k_size + pz * k_size * k_size;
+                std::fill_n(row, len_x, value);
+                fill_bits(x_rows_.get() + (py + pz * k_size) * k_words, p0[0], len_x);
+            }
+            for (i32 px = p0[0]; px < p1[0]; ++px)
+                fill_bits(y_rows_.get() + (px + pz * k_size) * k_words, p0[1], len_y);
+        }
+    }
+
+    void PaddedChunk::fill(const ChunkDomain& chunk, const WorldDomain* world)
+    {
+        pos_ = chunk.pos();
+        std::fill_n(voxels_.get(), k_volume, 0);
+        std::fill_n(x_rows_.get(), k_size * k_size * k_words, 0);
+        std::fill_n(y_rows_.get(), k_size * k_size * k_words, 0);
+
+        // copies the part of src that lands in the padded volume, offset is src's
+        // position relative to this chunk in chunks
+        const auto copy = [&](const ChunkDomain& src, const std::array<i32, 3>& offset)
+        {
+            std::array<i32, 3> lo, hi;
+            for (i32 a = 0; a < 3; ++a)
+            {
+                lo[a] = offset[a] < 0 ? k_chunk - 1 : 0;
+                hi[a] = offset[a] > 0 ? 1 : k_chunk;
+            }
+
+            src.svo().for_each_leaf_in(
+                lo[0], lo[1], lo[2], hi[0], hi[1], hi[2],
+                [&](i32 x, i32 y, i32 z, i32 len, u16 value)
+                {
+                    const std::array<i32, 3> min{ x, y, z };
+                    std::array<i32, 3>       p0, p1;
+                    for (i32 a = 0; a < 3; ++a)
+                    {
+                        const i32 shift = offset[a] * k_chunk + 1;
+                        p0[a]           = std::max(min[a], lo[a]) + shift;
+                        p1[a]           = std::min(min[a] + len, hi[a]) + shift;
+                    }
+                    write_box(p0, p1, value);
+                });
+        };
+
+        copy(chunk, { 0, 0, 0 });
+        if (!world)
+            return;
+
+        for (i32 dz = -1; dz <= 1; ++dz)
+        {
+            for (i32 dy = -1; dy <= 1; ++dy)
+            {
+                for (i32 dx = -1; dx <= 1; ++dx)
+                {
+                    if (dx == 0 && dy == 0 && dz == 0)
+                        continue;
+                    const ChunkPos cp{ pos_.x + dx, pos_.y + dy, pos_.z + dz };
+                    if (auto nb = world->find_chunk(cp))
+                        copy(*nb, { dx, dy, dz });
+                }
+            }
+        }
+    }
+
+    ChunkMesher::ChunkMesher(const MeshOptions& options) :
+        options_(options), padded_(std::make_unique<PaddedChunk>())
+    {}
+
+    void ChunkMesher::mesh(
+        const ChunkDomain& chunk, ChunkMesh& out, const WorldDomain* world,
+        const LightEngine* light)
+    {
+        padded_->fill(chunk, world);
+        mesh(*padded_, out, light);
+    }
+
+    void ChunkMesher::mesh(
+        const PaddedChunk& c, ChunkMesh& out, const LightEngine* light) const
+    {
+        out.clear();
+
+        // light of this chunk and the six face neighbours (same order as faces), faces
+        // on the border look into the neighbour
+        std::array<const ChunkLight*, 7> lights{};
+        if (light && options_.bake_light)
+        {
+            const ChunkPos& cp = c.pos();
+            lights[6]          = light->try_get(cp);
+            for (u8 f = 0; f < 6; ++f)
+            {
+                const i32* n = k_normal[f];
+                lights[f]    = light->try_get({ cp.x + n[0], cp.y + n[1], cp.z + n[2] });
+            }
+        }
+
+        const auto light_at = [&](const std::array<i32, 3>& p) -> u8
+        {
+            // unlit (or no light engine) is full sky light, like LightEngine::sky_light
+            constexpr u8 k_unlit = ChunkLight::k_max_level << 4;
+
+            u8                 src = 6;
+            std::array<i32, 3> lp  = p;
+            for (i32 a = 0; a < 3; ++a)
+            {
+                if (lp[a] < 0)
+                {
+                    src = static_cast<u8>(a * 2);
+                    lp[a] += k_chunk;
+                }
+                else if (lp[a] >= k_chunk)
+                {
+                    src = static_cast<u8>(a * 2 + 1);
+                    lp[a] -= k_chunk;
+                }
+            }
+            const ChunkLight* l = lights[src];
+            return l ? l->data()[ChunkEdit::pack({ lp[0], lp[1], lp[2] })] : k_unlit;
+        };
+
+        constexpr u8 k_unoccluded = 0xff; // AO 3 on every corner
+
+        for (i32 pz = 1; pz <= k_chunk; ++pz)
+        {
+            for (i32 py = 1; py <= k_chunk; ++py)
+            {
+                const u64* row = c.x_row(py, pz);
+                for (i32 w = 0; w < PaddedChunk::k_words; ++w)
+                {
+                    for (u64 bits = row[w]; bits; bits &= bits - 1)
+                    {
+                        const i32 px = w * 64 + std::countr_zero(bits);
+                        // border voxels are only there to be looked at
+                        if (px < 1 || px > k_chunk)
+                            continue;
+
+                        const u16                type = c.get(px, py, pz);
+                        const std::array<i32, 3> local{ px - 1, py - 1, pz - 1 };
+                        for (u8 f = 0; f < 6; ++f)
+                        {
+                            const i32* n = k_normal[f];
+                            if (c.solid(px + n[0], py + n[1], pz + n[2]))
+                                continue;
+
+                            const u8 ao = options_.ambient_occlusion
+                                ? VoxelAO::k_lut[neighbourhood(c, px, py, pz, f)]
+                                : k_unoccluded;
+                            const u8 lit = light_at(
+                                { local[0] + n[0], local[1] + n[1], local[2] + n[2] });
+                            emit_quad(out, local, f, ao, type, lit);
+                        }
+                    }
+                }
+            }
+        }
+    }
+} // namespace v
@@ -0,0 +1,339 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <engine/components.h>
+#include <engine/contexts/async/async.h>
+#include <engine/engine.h>
+#include <taskflow/algorithm/for_each.hpp>
+#include <world/physics.h>
+
+namespace v {
+    namespace {
+        constexpr i32 k_chunk = WorldDomain::k_chunk_size;
+        /// Slack for float error, a box within this of a voxel face is touching it
+        constexpr f32 k_skin = 1e-3f;
+        /// prepare() gives up past this many chunks and leaves lookups to the world
+        constexpr i32 k_max_cached = 64;
+        /// y first so a falling box lands before it slides
+        constexpr i32 k_axis_order[3] = { 1, 0, 2 };
+
+        FORCEINLINE i32 chunk_of(i32 v)
+        {
+            return (v >= 0 ? v : v - (k_chunk - 1)) / k_chunk;
+        }
+
+        /// Sort key keeping bodies in the same chunk next to each other
+        FORCEINLINE u64 chunk_key(const glm::vec3& p)
+        {
+            const auto bits = [](f32 v)
+            {
+                const i32 c = chunk_of(static_cast<i32>(std::floor(v)));
+                return static_cast<u64>(static_cast<u32>(c + (1 << 20)) & 0x1fffff);
+            };
+            return bits(p.z) << 42 | bits(p.y) << 21 | bits(p.x);
+        }
+    } // namespace
+
+    VoxelCollider::VoxelCollider(const WorldDomain& world, bool solid_unloaded) :
+        world_(&world), solid_unloaded_(solid_unloaded)
+    {}
+
+    VoxelBox VoxelCollider::voxels_of(const AABB& box)
+    {
+        VoxelBox out;
+        for (i32 a = 0; a < 3; ++a)
+        {
+            out.min[a] = static_cast<i32>(std::floor(box.min[a] + k_skin));
+            out.max[a] = static_cast<i32>(std::ceil(box.max[a] - k_skin));
+            out.max[a] = std::max(out.max[a], out.min[a] + 1);
+        }
+        return out;
+    }
+
+    void VoxelCollider::prepare(const VoxelBox& region)
+    {
+        cache_.clear();
+        cache_min_ = { chunk_of(region.min[0]), chunk_of(region.min[1]),
+                       chunk_of(region.min[2]) };
+        cache_max_ = { chunk_of(region.max[0] - 1), chunk_of(region.max[1] - 1),
+                       chunk_of(region.max[2] - 1) };
+
+        const i32 count = (cache_max_.x - cache_min_.x + 1) *
+            (cache_max_.y - cache_min_.y + 1) * (cache_max_.z - cache_min_.z + 1);
+        if (count > k_max_cached)
+        {
+            cache_max_ = { cache_min_.x - 1, cache_min_.y - 1, cache_min_.z - 1 };
+            return;
+        }
+
+        cache_.reserve(count);
+        for (i32 cz = cache_min_.z; cz <= cache_max_.z; ++cz)
+            for (i32 cy = cache_min_.y; cy <= cache_max_.y; ++cy)
+                for (i32 cx = cache_min_.x; cx <= cache_max_.x; ++cx)
+                    cache_.push_back(world_->find_chunk({ cx, cy, cz }));
+    }
+
+    const ChunkDomain* VoxelCollider::chunk_at(const ChunkPos& cp) const
+    {
+        if (cp.x < cache_min_.x || cp.y < cache_min_.y || cp.z < cache_min_.z ||
+            cp.x > cache_max_.x || cp.y > cache_max_.y || cp.z > cache_max_.z)
+            return world_->find_chunk(cp);
+
+        const i32 w = cache_max_.x - cache_min_.x + 1;
+        const i32 h = cache_max_.y - cache_min_.y + 1;
+        return cache_[(cp.x - cache_min_.x) +
+                      ((cp.y - cache_min_.y) + (cp.z - cache_min_.z) * h) * w];
+    }
+
+    void VoxelCollider::gather(const VoxelBox& region)
+    {
+        const ChunkPos c0{ chunk_of(region.min[0]), chunk_of(region.min[1]),
+                           chunk_of(region.min[2]) };
+        const ChunkPos c1{ chunk_of(region.max[0] - 1), chunk_of(region.max[1] - 1),
+                           chunk_of(region.max[2] - 1) };
+
+        for (i32 cz = c0.z; cz <= c1.z; ++cz)
+        {
+            for (i32 cy = c0.y; cy <= c1.y; ++cy)
+            {
+                for (i32 cx = c0.x; cx <= c1.x; ++cx)
+                {
+                    const i32 origin[3] = { cx * k_chunk, cy * k_chunk, cz * k_chunk };
+                    i32       lo[3], hi[3];
+                    for (i32 a = 0; a < 3; ++a)
+                    {
+                        lo[a] = std::max(region.min[a] - origin[a], 0);
+                        hi[a] = std::min(region.max[a] - origin[a], k_chunk);
+                    }
+
+                    const ChunkDomain* chunk = chunk_at({ cx, cy, cz });
+                    if (!chunk)
+                    {
+                        if (solid_unloaded_)
+                        {
+                            VoxelBox box;
+                            for (i32 a = 0; a < 3; ++a)
+                            {
+                                box.min[a] = lo[a] + origin[a];
+                                box.max[a] = hi[a] + origin[a];
+                            }
+                            candidates_.push_back(box);
+                        }
+                        continue;
+                    }
+
+                    chunk->svo().for_each_leaf_in(
+                        lo[0], lo[1], lo[2], hi[0], hi[1], hi[2],
+                        [&](i32 x, i32 y, i32 z, i32 len, u16)
+                        {
+                            const i32 min[3] = { x, y, z };
+                            VoxelBox  box;
+                            for (i32 a = 0; a < 3; ++a)
+                            {
+                                box.min[a] = std::max(min[a], lo[a]) + origin[a];
+                                box.max[a] = std::min(min[a] + len, hi[a]) + origin[a];
+                            }
+                            candidates_.push_back(box);
+                        });
+                }
+            }
+        }
+    }
+
+    SweepResult VoxelCollider::sweep(const AABB& box, const glm::vec3& delta)
+    {
+        SweepResult result{};
+        if (delta == glm::vec3(0))
+            return result;
+
+        // everything the box can touch on the way, whichever axis goes first
+        const AABB hull{ glm::min(box.min, box.min + delta),
+                         glm::max(box.max, box.max + delta) };
+        candidates_.clear();
+        gather(voxels_of(hull));
+        if (candidates_.empty())
+        {
+            result.moved = delta;
+            return result;
+        }
+
+        AABB moving = box;
+        for (i32 axis : k_axis_order)
+        {
+            f32 move = delta[axis];
+            if (move == 0)
+                continue;
+
+            const i32 o1 = (axis + 1) % 3;
+            const i32 o2 = (axis + 2) % 3;
+
+            // only voxels in front of the face we move, ones we're already in are
+            // ignored so a stuck box can get out
+            const f32 face  = move > 0 ? moving.max[axis] : moving.min[axis];
+            const i32 front = move > 0 ? static_cast<i32>(std::ceil(face - k_skin))
+                                       : static_cast<i32>(std::floor(face + k_skin));
+            for (const VoxelBox& c : candidates_)
+            {
+                if (c.min[o1] >= moving.max[o1] - k_skin ||
+                    c.max[o1] <= moving.min[o1] + k_skin ||
+                    c.min[o2] >= moving.max[o2] - k_skin ||
+                    c.max[o2] <= moving.min[o2] + k_skin)
+                    continue;
+
+                if (move > 0)
+                {
+                    const i32 hit = std::max(c.min[axis], front);
+                    if (hit < c.max[axis])
+                        move = std::min(move, std::max(hit - face, 0.f));
+                }
+                else
+                {
+                    const i32 hit = std::min(c.max[axis], front);
+                    if (hit > c.min[axis])
+                        move = std::max(move, std::min(hit - face, 0.f));
+                }
+            }
+
+            if (move != delta[axis])
+                result.blocked |= static_cast<u8>(1u << axis);
+
+            moving.min[axis] += move;
+            moving.max[axis] += move;
+            result.moved[axis] = move;
+        }
+        return result;
+    }
+
+    bool VoxelCollider::overlaps(const AABB& box)
+    {
+        candidates_.clear();
+        gather(voxels_of(box));
+        return !candidates_.empty();
+    }
+
+    VoxelPhysics::VoxelPhysics(const PhysicsConfig& config, const std::string& name) :
+        SDomain(name), config_(config)
+    {}
+
+    VoxelPhysics::~VoxelPhysics()
+    {
+        engine().on_fixed_tick.disconnect("voxel_physics");
+        engine().on_tick.disconnect("voxel_physics");
+    }
+
+    void VoxelPhysics::init()
+    {
+        engine().on_fixed_tick.connect(
+            {}, {}, "voxel_physics", [this] { step(engine().fixed_delta_time()); });
+        // engines without a fixed rate never run on_fixed_tick
+        engine().on_tick.connect(
+            {}, {}, "voxel_physics",
+            [this]
+            {
+                if (engine().fixed_delta_time() == 0)
+                    step(engine().delta_time());
+            });
+    }
+
+    void VoxelPhysics::step(f64 dt)
+    {
+        auto world = engine().get_domain<WorldDomain>();
+        if (!world || dt <= 0)
+            return;
+
+        Stopwatch sw{};
+
+        if (config_.parallel && !executor_)
+        {
+            if (auto async = engine().get_ctx<AsyncContext>())
+                executor_ = &async->executor();
+        }
+
+        const f32  fdt  = static_cast<f32>(dt);
+        const auto view = engine().raw_view<Pos3d, Size3d, VoxelBody>();
+
+        bodies_.clear();
+        for (auto [entity, pos, size, body] : view.each())
+        {
+            body.velocity += config_.gravity * fdt;
+            const glm::vec3 delta = body.velocity * fdt;
+            if (delta == glm::vec3(0))
+                continue;
+
+            const glm::vec3 half = size.val * 0.5f;
+            const AABB      box{ pos.val - half, pos.val + half };
+            bodies_.push_back({ entity, chunk_key(pos.val), box, delta, {} });
+        }
+
+        std::sort(
+            bodies_.begin(), bodies_.end(),
+            [](const Body& a, const Body& b) { return a.chunk_key < b.chunk_key; });
+
+        const usize batch   = std::max<usize>(config_.batch_size, 1);
+        const usize batches = (bodies_.size() + batch - 1) / batch;
+        const auto  run     = [&](usize i)
+        { run_batch(*world, i * batch, std::min(bodies_.size(), (i + 1) * batch)); };
+
+        if (batches > 1 && executor_)
+        {
+            tf::Taskflow taskflow;
+            taskflow.for_each_index(usize{ 0 }, batches, usize{ 1 }, run);
+            // a worker running the tick task helps out instead of blocking on the pool
+            if (executor_->this_worker_id() >= 0)
+                executor_->corun(taskflow);
+            else
+                executor_->run(taskflow).wait();
+        }
+        else
+        {
+            for (usize i = 0; i < batches; ++i)
+                run(i);
+        }
+
+        usize collisions = 0;
+        for (const Body& b : bodies_)
+        {
+            // patch so observers of Pos3d (e.g. SpatialIndex) see the move
+            engine().registry().patch<Pos3d>(
+                b.entity, [&](Pos3d& pos) { pos.val += b.result.moved; });
+
+            auto& body = view.get<VoxelBody>(b.entity);
+            for (i32 a = 0; a < 3; ++a)
+            {
+                if (b.result.blocked & (1u << a))
+                    body.velocity[a] = 0;
+            }
+            body.on_ground = (b.result.blocked & 2) && b.delta.y < 0;
+            collisions += b.result.blocked != 0;
+        }
+
+        stats_.moving_bodies  = bodies_.size();
+        stats_.batches        = batches;
+        stats_.collisions     = collisions;
+        stats_.last_step_secs = sw.elapsed();
+        stats_.total_step_secs += stats_.last_step_secs;
+    }
+
+    void VoxelPhysics::run_batch(const WorldDomain& world, usize first, usize last)
+    {
+        // bodies are sorted by chunk, so the batch's swept boxes are usually a
+        // chunk or two across
+        glm::vec3 lo = bodies_[first].box.min;
+        glm::vec3 hi = bodies_[first].box.max;
+        for (usize i = first; i < last; ++i)
+        {
+            const Body& b = bodies_[i];
+            lo            = glm::min(lo, glm::min(b.box.min, b.box.min + b.delta));
+            hi            = glm::max(hi, glm::max(b.box.max, b.box.max + b.delta));
+        }
+
+        VoxelCollider collider{ world, config_.solid_unloaded };
+        collider.prepare(VoxelCollider::voxels_of(AABB{ lo, hi }));
+
+        for (usize i = first; i < last; ++i)
+            bodies_[i].result = collider.sweep(bodies_[i].box, bodies_[i].delta);
+    }
+} // namespace v
@@ -0,0 +1,413 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#include <algorithm>
+#include <engine/contexts/net/connection.h>
+#include <engine/engine.h>
+#include <world/light.h>
+#include <world/streaming.h>
+
+namespace v {
+    static FORCEINLINE i64 chunk_dist2(const ChunkPos& a, const ChunkPos& b)
+    {
+        const i64 dx = a.x - b.x;
+        const i64 dy = a.y - b.y;
+        const i64 dz = a.z - b.z;
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    ChunkStreamer::~ChunkStreamer() { engine().on_tick.disconnect("chunk_stream"); }
+
+    void ChunkStreamer::init()
+    {
+        engine().on_tick.connect({}, {}, "chunk_stream", [this] { update(); });
+    }
+
+    void ChunkStreamer::add_connection(const std::shared_ptr<NetConnection>& con)
+    {
+        NetConnection* key = con.get();
+        if (clients_.contains(key))
+        {
+            LOG_WARN("Connection is already being streamed to");
+            return;
+        }
+
+        Client client{};
+        client.con    = con;
+        client.stream = &con->create_channel<ChunkStreamChannel>();
+        client.budget = config_.burst_bytes;
+
+        // unknown keys are ignored, so these are fine to outlive remove_connection
+        auto& interest = con->create_channel<ChunkInterestChannel>();
+        interest.received().connect([this, key](const ChunkInterest& msg)
+                                    { handle_interest(key, msg); });
+
+        auto& edits = con->create_channel<VoxelEditChannel>();
+        edits.received().connect([this, key](const VoxelEditBatch& batch)
+                                 { handle_edits(key, batch); });
+
+        clients_.emplace(key, std::move(client));
+    }
+
+    void ChunkStreamer::remove_connection(const std::shared_ptr<NetConnection>& con)
+    {
+        clients_.erase(con.get());
+    }
+
+    void ChunkStreamer::handle_interest(NetConnection* key, const ChunkInterest& msg)
+    {
+        auto it = clients_.find(key);
+        if (it == clients_.end())
+            return;
+
+        Client& client       = it->second;
+        client.center        = { msg.x, msg.y, msg.z };
+        client.view_distance = std::clamp(msg.view_distance, 0, config_.max_view_distance);
+        client.has_interest  = true;
+
+        // known is the client's word, so it's only taken for chunks that would be
+        // streamed anyway, and only so many per message
+        const usize count =
+            std::min<usize>(msg.known.size(), config_.max_known_per_interest);
+        if (count < msg.known.size())
+            LOG_DEBUG("Ignoring {} known chunks past the limit", msg.known.size() - count);
+
+        const i64 keep2 =
+            static_cast<i64>(client.view_distance + 1) * (client.view_distance + 1);
+        for (usize i = 0; i < count; ++i)
+        {
+            const ChunkVersion& k = msg.known[i];
+            const ChunkPos      cp{ k.x, k.y, k.z };
+            // version 0 means the client lost it and wants it again
+            if (k.version == 0)
+                client.known.erase(cp);
+            else if (chunk_dist2(cp, client.center) <= keep2)
+                client.known[cp] = k.version;
+        }
+    }
+
+    void ChunkStreamer::handle_edits(NetConnection* key, const VoxelEditBatch& batch)
+    {
+        auto it = clients_.find(key);
+        if (it == clients_.end())
+            return;
+
+        auto world = engine().get_domain<WorldDomain>();
+        if (!world)
+            return;
+
+        const Client& client = it->second;
+        stats_.edits_received += batch.edits.size();
+
+        // clients may only edit chunks the server has and streams to them, so they
+        // can't make the server create chunks or edit ungenerated ones
+        const ChunkPos& cp      = batch.pos;
+        const i32       view    = client.view_distance;
+        const bool      in_view = client.has_interest &&
+            chunk_dist2(cp, client.center) <= static_cast<i64>(view) * view;
+        if (batch.edits.size() > config_.max_edits_per_batch || !in_view ||
+            !world->find_chunk(cp))
+        {
+            LOG_DEBUG(
+                "Dropping {} edits for chunk ({},{},{})", batch.edits.size(), cp.x, cp.y,
+                cp.z);
+            stats_.edits_dropped += batch.edits.size();
+            return;
+        }
+
+        world->apply_edits(cp, batch.edits);
+    }
+
+    void ChunkStreamer::update()
+    {
+        auto world = engine().get_domain<WorldDomain>();
+        if (!world)
+            return;
+
+        const f64 dt =
+            config_.fixed_tick_secs > 0 ? config_.fixed_tick_secs : engine().delta_time();
+        for (auto& [key, client] : clients_)
+        {
+            client.budget = std::min<f64>(
+                client.budget + config_.bytes_per_sec * dt, config_.burst_bytes);
+
+            if (client.has_interest)
+                stream_to(client, *world);
+        }
+    }
+
+    void ChunkStreamer::stream_to(Client& client, const WorldDomain& world)
+    {
+        // one chunk of slack before unloading, so walking along a chunk border
+        // doesn't keep unloading and resending the same chunks
+        const i64 keep2 =
+            static_cast<i64>(client.view_distance + 1) * (client.view_distance + 1);
+
+        std::vector<ChunkPos> unload;
+        for (const auto& [cp, version] : client.known)
+        {
+            if (chunk_dist2(cp, client.center) > keep2)
+                unload.push_back(cp);
+        }
+        // unloads are paid for like chunks, the rest go out in later ticks
+        for (const auto& cp : unload)
+        {
+            if (client.budget <= 0)
+                return;
+            client.budget -= static_cast<f64>(send_unload(client, cp));
+            client.known.erase(cp);
+        }
+
+        if (client.budget <= 0)
+            return;
+
+        // walks the chunks in view nearest first, so this scales with the view
+        // distance instead of the world. the budget may dip below zero by one packet,
+        // it's paid back next tick
+        for (const ChunkPos& offset : view_offsets(client.view_distance))
+        {
+            if (client.budget <= 0)
+                break;
+
+            const ChunkPos     cp{ client.center.x + offset.x, client.center.y + offset.y,
+                                   client.center.z + offset.z };
+            const ChunkDomain* chunk = world.find_chunk(cp);
+            if (!chunk)
+                continue;
+            auto it = client.known.find(cp);
+            if (it != client.known.end() && it->second == chunk->version())
+                continue;
+            client.budget -= static_cast<f64>(send_chunk(client, *chunk));
+        }
+    }
+
+    const std::vector<ChunkPos>& ChunkStreamer::view_offsets(i32 view_distance)
+    {
+        if (view_offsets_.size() <= static_cast<usize>(view_distance))
+            view_offsets_.resize(view_distance + 1);
+
+        std::vector<ChunkPos>& offsets = view_offsets_[view_distance];
+        if (!offsets.empty())
+            return offsets;
+
+        const ChunkPos origin{};
+        const i64      view2 = static_cast<i64>(view_distance) * view_distance;
+        for (i32 x = -view_distance; x <= view_distance; ++x)
+            for (i32 y = -view_distance; y <= view_distance; ++y)
+                for (i32 z = -view_distance; z <= view_distance; ++z)
+                {
+                    if (chunk_dist2({ x, y, z }, origin) <= view2)
+                        offsets.push_back({ x, y, z });
+                }
+
+        std::ranges::stable_sort(
+            offsets, {}, [&](const ChunkPos& cp) { return chunk_dist2(cp, origin); });
+        return offsets;
+    }
+
+    usize ChunkStreamer::send_chunk(Client& client, const ChunkDomain& chunk)
+    {
+        scratch_.clear();
+        ByteWriter w{ scratch_ };
+
+        const ChunkPos cp    = chunk.pos();
+        auto           known = client.known.find(cp);
+
+        std::optional<std::span<const ChunkEdit>> edits{};
+        if (known != client.known.end())
+            edits = chunk.edits_since(known->second);
+
+        if (edits)
+        {
+            edit_scratch_.assign(edits->begin(), edits->end());
+            VoxelEditCodec::normalize(edit_scratch_);
+
+            ChunkPacket::write_header(
+                w, ChunkPacketKind::Delta, cp, chunk.version(), known->second);
+            ChunkPacket::write_edits(w, edit_scratch_);
+            stats_.deltas_sent++;
+        }
+        else
+        {
+            ChunkPacket::write_header(w, ChunkPacketKind::Full, cp, chunk.version(), 0);
+            chunk.svo().serialize(scratch_);
+            stats_.full_sent++;
+        }
+
+        client.stream->send_raw(reinterpret_cast<char*>(scratch_.data()), scratch_.size());
+        client.known[cp] = chunk.version();
+        chunk.touch(engine().current_tick());
+
+        stats_.bytes_sent += scratch_.size();
+        return scratch_.size();
+    }
+
+    usize ChunkStreamer::send_unload(Client& client, ChunkPos cp)
+    {
+        scratch_.clear();
+        ByteWriter w{ scratch_ };
+        ChunkPacket::write_header(w, ChunkPacketKind::Unload, cp, 0, 0);
+
+        client.stream->send_raw(reinterpret_cast<char*>(scratch_.data()), scratch_.size());
+
+        stats_.unloads_sent++;
+        stats_.bytes_sent += scratch_.size();
+        return scratch_.size();
+    }
+
+    ChunkReceiver::~ChunkReceiver() { engine().on_tick.disconnect("chunk_edit_flush"); }
+
+    void ChunkReceiver::init()
+    {
+        engine().on_tick.connect({}, {}, "chunk_edit_flush", [this] { flush_edits(); });
+    }
+
+    void ChunkReceiver::attach(const std::shared_ptr<NetConnection>& con)
+    {
+        con_   = con;
+        edits_ = &con->create_channel<VoxelEditChannel>();
+
+        auto& stream = con->create_channel<ChunkStreamChannel>();
+        stream.received().connect([this](const ChunkPacket& packet)
+                                  { handle_packet(packet); });
+
+        interest_ = &con->create_channel<ChunkInterestChannel>();
+
+        // whatever we still have from a previous session can be updated with deltas
+        pending_known_.clear();
+        if (auto world = engine().get_domain<WorldDomain>())
+        {
+            world->for_each_chunk(
+                [this](const ChunkDomain& chunk)
+                {
+                    const ChunkPos cp = chunk.pos();
+                    pending_known_.push_back({ cp.x, cp.y, cp.z, chunk.version() });
+                });
+        }
+
+        // force the next set_interest to send
+        view_distance_ = -1;
+    }
+
+    void ChunkReceiver::set_interest(ChunkPos center, i32 view_distance)
+    {
+        if (view_distance == view_distance_ && ChunkPosEq{}(center, center_))
+            return;
+
+        center_        = center;
+        view_distance_ = view_distance;
+        send_interest(std::move(pending_known_));
+        pending_known_.clear();
+    }
+
+    void ChunkReceiver::queue_edit(WorldPos wp, u16 value)
+    {
+        auto [cp, lp] = WorldDomain::world_to_chunk(wp);
+        pending_edits_[cp].push_back({ ChunkEdit::pack(lp), value });
+    }
+
+    void ChunkReceiver::flush_edits()
+    {
+        if (pending_edits_.empty())
+            return;
+
+        if (!edits_)
+        {
+            LOG_WARN("ChunkReceiver has no connection, dropping queued edits");
+            pending_edits_.clear();
+            return;
+        }
+
+        for (auto& [cp, edits] : pending_edits_)
+        {
+            VoxelEditBatch batch{ cp, std::move(edits) };
+            VoxelEditCodec::normalize(batch.edits);
+
+            auto bytes = batch.serialize();
+            edits_->send_raw(reinterpret_cast<char*>(bytes.data()), bytes.size());
+
+            stats_.edits_sent += batch.edits.size();
+            stats_.edit_bytes_sent += bytes.size();
+        }
+        pending_edits_.clear();
+    }
+
+    void ChunkReceiver::send_interest(std::vector<ChunkVersion> known)
+    {
+        if (!interest_)
+        {
+            LOG_WARN("ChunkReceiver has no connection, call attach() first");
+            return;
+        }
+
+        ChunkInterest msg{
+            .x             = center_.x,
+            .y             = center_.y,
+            .z             = center_.z,
+            .view_distance = view_distance_,
+            .known         = std::move(known),
+        };
+        interest_->send(msg);
+    }
+
+    void ChunkReceiver::handle_packet(const ChunkPacket& packet)
+    {
+        auto world = engine().get_domain<WorldDomain>();
+        if (!world)
+        {
+            LOG_WARN("Received a chunk without a WorldDomain to put it in");
+            return;
+        }
+
+        stats_.bytes_received += ChunkPacket::header_size + packet.body.size();
+        const ChunkPos cp = packet.pos;
+
+        try
+        {
+            switch (packet.kind)
+            {
+            case ChunkPacketKind::Full:
+                {
+                    SparseVoxelOctree128 svo{};
+                    svo.deserialize(packet.body.data(), packet.body.size());
+                    world->get_or_create_chunk(cp).load(std::move(svo), packet.version);
+                    stats_.full_received++;
+                    if (auto light = engine().get_domain<LightEngine>())
+                        light->queue_relight(cp);
+                }
+                break;
+            case ChunkPacketKind::Delta:
+                {
+                    ChunkDomain* chunk = world->try_get_chunk(cp);
+                    if (!chunk || chunk->version() != packet.base_version)
+                    {
+                        // we dropped or diverged from this chunk, ask for all of it
+                        LOG_DEBUG(
+                            "Chunk ({},{},{}) out of sync, requesting resync", cp.x, cp.y,
+                            cp.z);
+                        stats_.resyncs++;
+                        send_interest({ { cp.x, cp.y, cp.z, 0 } });
+                        return;
+                    }
+                    const auto edits = packet.read_edits();
+                    chunk->apply_remote(edits, packet.version);
+                    stats_.deltas_received++;
+                    if (auto light = engine().get_domain<LightEngine>())
+                        light->chunk_edited(cp, edits);
+                }
+                break;
+            case ChunkPacketKind::Unload:
+                world->remove_chunk(cp);
+                stats_.unloads_received++;
+                break;
+            }
+        }
+        catch (const std::exception& ex)
+        {
+            LOG_ERROR("Bad chunk packet for ({},{},{}): {}", cp.x, cp.y, cp.z, ex.what());
+            stats_.resyncs++;
+            send_interest({ { cp.x, cp.y, cp.z, 0 } });
+        }
+    }
+} // namespace v
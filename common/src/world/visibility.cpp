@@ -0,0 +1,390 @@
+//
+// Created by niooi on 10/18/2026.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <time/stopwatch.h>
+#include <world/visibility.h>
+
+#ifdef __AVX2__
+    #include <immintrin.h>
+#endif
+
+namespace v {
+    namespace {
+        constexpr i32 k_chunk = ChunkDomain::k_size;
+        /// Cells per chunk side in the connectivity grid
+        constexpr i32 k_cell        = ChunkConnectivity::k_cell;
+        constexpr i32 k_cells       = k_chunk / k_cell;
+        constexpr i32 k_cell_volume = k_cell * k_cell * k_cell;
+
+        /// Which faces (-x, +x, -y, +y, -z, +z) a cell on the grid border touches
+        FORCEINLINE u8 border_faces(i32 x, i32 y, i32 z)
+        {
+            constexpr i32 last = k_cells - 1;
+            return static_cast<u8>(
+                (x == 0) | (x == last) << 1 | (y == 0) << 2 | (y == last) << 3 |
+                (z == 0) << 4 | (z == last) << 5);
+        }
+
+        FORCEINLINE i32 chunk_of(f32 v)
+        {
+            const i32 i = static_cast<i32>(std::floor(v));
+            return (i >= 0 ? i : i - (k_chunk - 1)) / k_chunk;
+        }
+    } // namespace
+
+    Frustum Frustum::from_matrix(const glm::mat4& view_proj, const glm::dvec3& origin)
+    {
+        // rows of the matrix, glm is column major
+        const auto row = [&](i32 r)
+        {
+            return glm::dvec4{ view_proj[0][r], view_proj[1][r], view_proj[2][r],
+                               view_proj[3][r] };
+        };
+        const glm::dvec4 planes[6] = {
+            row(3) + row(0), row(3) - row(0), row(3) + row(1),
+            row(3) - row(1), row(3) + row(2), row(3) - row(2),
+        };
+
+        Frustum f{};
+        for (i32 i = 0; i < 6; ++i)
+        {
+            const glm::dvec3 n   = glm::dvec3{ planes[i] };
+            const f64        len = glm::length(n);
+            const f64        inv = len > 0 ? 1.0 / len : 0.0;
+            f.nx[i]              = static_cast<f32>(n.x * inv);
+            f.ny[i]              = static_cast<f32>(n.y * inv);
+            f.nz[i]              = static_cast<f32>(n.z * inv);
+            f.d[i] = static_cast<f32>((planes[i].w + glm::dot(n, origin)) * inv);
+        }
+        return f;
+    }
+
+    bool Frustum::intersects(const AABB& box) const
+    {
+        const glm::vec3 c = (box.min + box.max) * 0.5f;
+        const glm::vec3 e = (box.max - box.min) * 0.5f;
+        for (i32 i = 0; i < 6; ++i)
+        {
+            // distance of the center, plus how far the box reaches towards the plane
+            const f32 reach =
+                std::abs(nx[i]) * e.x + std::abs(ny[i]) * e.y + std::abs(nz[i]) * e.z;
+            if (nx[i] * c.x + ny[i] * c.y + nz[i] * c.z + d[i] + reach < 0)
+                return false;
+        }
+        return true;
+    }
+
+    void Frustum::cull(
+        std::span<const f32> cx, std::span<const f32> cy, std::span<const f32> cz,
+        f32 half_extent, u8* visible) const
+    {
+        std::array<f32, 6> reach;
+        for (i32 i = 0; i < 6; ++i)
+        {
+            const f32 n = std::abs(nx[i]) + std::abs(ny[i]) + std::abs(nz[i]);
+            reach[i]    = n * half_extent;
+        }
+
+        const usize count = cx.size();
+        usize       i     = 0;
+#ifdef __AVX2__
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256 x    = _mm256_loadu_ps(cx.data() + i);
+            const __m256 y    = _mm256_loadu_ps(cy.data() + i);
+            const __m256 z    = _mm256_loadu_ps(cz.data() + i);
+            __m256       keep = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (i32 p = 0; p < 6; ++p)
+            {
+                const __m256 a    = _mm256_mul_ps(_mm256_set1_ps(nx[p]), x);
+                const __m256 b    = _mm256_mul_ps(_mm256_set1_ps(ny[p]), y);
+                const __m256 c    = _mm256_mul_ps(_mm256_set1_ps(nz[p]), z);
+                const __m256 bias = _mm256_set1_ps(d[p] + reach[p]);
+                const __m256 dist =
+                    _mm256_add_ps(_mm256_add_ps(a, b), _mm256_add_ps(c, bias));
+                keep              = _mm256_and_ps(
+                    keep, _mm256_cmp_ps(dist, _mm256_setzero_ps(), _CMP_GE_OQ));
+            }
+
+            const u32 mask = static_cast<u32>(_mm256_movemask_ps(keep));
+            for (u32 lane = 0; lane < 8; ++lane)
+                visible[i + lane] = (mask >> lane) & 1;
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            bool keep = true;
+            for (i32 p = 0; p < 6; ++p)
+            {
+                const f32 dist = nx[p] * cx[i] + ny[p] * cy[i] + nz[p] * cz[i];
+                keep           = keep && dist + (d[p] + reach[p]) >= 0;
+            }
+            visible[i] = keep;
+        }
+    }
+
+    u16 ChunkConnectivity::compute(const ChunkDomain& chunk)
+    {
+        const auto& svo = chunk.svo();
+        if (svo.is_empty())
+            return k_all;
+
+        // solid voxels per cell, a cell with any empty voxel is open
+        std::vector<u8> solid(k_cells * k_cells * k_cells, 0);
+        const auto      cell_index = [](i32 x, i32 y, i32 z)
+        { return x + (y + z * k_cells) * k_cells; };
+
+        bool any_closed = false;
+        svo.for_each_leaf(
+            [&](i32 x, i32 y, i32 z, i32 len, u16)
+            {
+                any_closed |= len >= k_cell;
+                if (len < k_cell)
+                {
+                    u8& cell = solid[cell_index(x / k_cell, y / k_cell, z / k_cell)];
+                    cell += static_cast<u8>(len * len * len);
+                    any_closed |= cell == k_cell_volume;
+                    return;
+                }
+                const i32 n = len / k_cell;
+                for (i32 cz = z / k_cell; cz < z / k_cell + n; ++cz)
+                    for (i32 cy = y / k_cell; cy < y / k_cell + n; ++cy)
+                        for (i32 cx = x / k_cell; cx < x / k_cell + n; ++cx)
+                            solid[cell_index(cx, cy, cz)] = k_cell_volume;
+            });
+
+        // sparse chunks (grass, pillars, single blocks) never close a whole cell
+        if (!any_closed)
+            return k_all;
+        if (std::ranges::all_of(solid, [](u8 c) { return c == k_cell_volume; }))
+            return 0;
+
+        // flood every open region that touches the border, faces it touches can see
+        // each other
+        std::vector<u8>  seen(solid.size(), 0);
+        std::vector<u16> queue;
+        queue.reserve(solid.size());
+
+        u16 mask = 0;
+        for (i32 start = 0; start < static_cast<i32>(solid.size()); ++start)
+        {
+            const i32 sx = start % k_cells;
+            const i32 sy = start / k_cells % k_cells;
+            const i32 sz = start / (k_cells * k_cells);
+            if (seen[start] || solid[start] == k_cell_volume || !border_faces(sx, sy, sz))
+                continue;
+
+            u8 faces = 0;
+            queue.clear();
+            queue.push_back(static_cast<u16>(start));
+            seen[start] = 1;
+            for (usize head = 0; head < queue.size(); ++head)
+            {
+                const i32 c = queue[head];
+                const i32 x = c % k_cells;
+                const i32 y = c / k_cells % k_cells;
+                const i32 z = c / (k_cells * k_cells);
+                faces |= border_faces(x, y, z);
+
+                const auto visit = [&](i32 nx, i32 ny, i32 nz)
+                {
+                    if (nx < 0 || ny < 0 || nz < 0 || nx >= k_cells || ny >= k_cells ||
+                        nz >= k_cells)
+                        return;
+                    const i32 n = cell_index(nx, ny, nz);
+                    if (seen[n] || solid[n] == k_cell_volume)
+                        return;
+                    seen[n] = 1;
+                    queue.push_back(static_cast<u16>(n));
+                };
+                visit(x - 1, y, z);
+                visit(x + 1, y, z);
+                visit(x, y - 1, z);
+                visit(x, y + 1, z);
+                visit(x, y, z - 1);
+                visit(x, y, z + 1);
+            }
+
+            for (u8 a = 0; a < 6; ++a)
+                for (u8 b = a + 1; b < 6; ++b)
+                    if ((faces >> a & 1) && (faces >> b & 1))
+                        mask |= static_cast<u16>(1u << pair(a, b));
+
+            if (mask == k_all)
+                break;
+        }
+        return mask;
+    }
+
+    ChunkCuller::ChunkCuller(const CullConfig& config) : config_(config) { build_grid(); }
+
+    void ChunkCuller::build_grid()
+    {
+        const i32 vd = config_.view_distance;
+        const i32 vv = config_.vertical_distance;
+        width_       = vd * 2 + 1;
+        height_      = vv * 2 + 1;
+
+        const usize cells = static_cast<usize>(width_) * width_ * height_;
+        cx_.resize(cells);
+        cy_.resize(cells);
+        cz_.resize(cells);
+        in_frustum_.resize(cells);
+        reached_.resize(cells);
+
+        constexpr f32 half = k_chunk * 0.5f;
+        usize         i    = 0;
+        for (i32 z = 0; z < width_; ++z)
+        {
+            for (i32 y = 0; y < height_; ++y)
+            {
+                for (i32 x = 0; x < width_; ++x, ++i)
+                {
+                    cx_[i] = static_cast<f32>((x - vd) * k_chunk) + half;
+                    cy_[i] = static_cast<f32>((y - vv) * k_chunk) + half;
+                    cz_[i] = static_cast<f32>((z - vd) * k_chunk) + half;
+                }
+            }
+        }
+    }
+
+    void ChunkCuller::invalidate(const ChunkPos& cp) { connectivity_.erase(cp); }
+
+    void ChunkCuller::invalidate() { connectivity_.clear(); }
+
+    u16 ChunkCuller::connectivity(const ChunkDomain& chunk)
+    {
+        auto [it, inserted] = connectivity_.try_emplace(chunk.pos(), Connectivity{});
+        if (inserted || it->second.version != chunk.version())
+        {
+            it->second = { chunk.version(), ChunkConnectivity::compute(chunk) };
+            stats_.connectivity_rebuilds++;
+        }
+        return it->second.mask;
+    }
+
+    const std::vector<const ChunkDomain*>& ChunkCuller::cull(
+        const WorldDomain& world, const glm::mat4& view_proj, const glm::vec3& camera_pos)
+    {
+        Stopwatch total{};
+        stats_ = {};
+        visible_.clear();
+
+        const i32      vd = config_.view_distance;
+        const i32      vv = config_.vertical_distance;
+        const ChunkPos cam{ chunk_of(camera_pos.x), chunk_of(camera_pos.y),
+                            chunk_of(camera_pos.z) };
+        const glm::dvec3 origin{ static_cast<f64>(cam.x) * k_chunk,
+                                 static_cast<f64>(cam.y) * k_chunk,
+                                 static_cast<f64>(cam.z) * k_chunk };
+
+        // frustum, every chunk position in range at once
+        Stopwatch sw{};
+        const Frustum frustum = Frustum::from_matrix(view_proj, origin);
+        frustum.cull(cx_, cy_, cz_, k_chunk * 0.5f, in_frustum_.data());
+        stats_.frustum_us = sw.elapsed() * 1e6;
+
+        const auto cell_pos = [&](u32 cell) -> ChunkPos
+        {
+            const i32 x = static_cast<i32>(cell % width_);
+            const i32 y = static_cast<i32>(cell / width_ % height_);
+            const i32 z = static_cast<i32>(cell / (width_ * height_));
+            return { cam.x + x - vd, cam.y + y - vv, cam.z + z - vd };
+        };
+
+        sw.reset();
+        std::fill(reached_.begin(), reached_.end(), 0);
+        if (!config_.occlusion)
+        {
+            for (u32 cell = 0; cell < in_frustum_.size(); ++cell)
+            {
+                if (!in_frustum_[cell])
+                    continue;
+                reached_[cell] = 1;
+                if (auto chunk = world.find_chunk(cell_pos(cell)))
+                    visible_.push_back(chunk);
+            }
+        }
+        else
+        {
+            // walk outwards from the camera's chunk, see the class docs
+            const i32 strides[3] = { 1, width_, width_ * height_ };
+            const i32 limits[3]  = { width_, height_, width_ };
+
+            const u32 start = static_cast<u32>(vd + (vv + vd * height_) * width_);
+            queue_.clear();
+            queue_.push_back({ start, 6, 0 });
+            reached_[start] = 1;
+
+            for (usize head = 0; head < queue_.size(); ++head)
+            {
+                const Visit    v  = queue_[head];
+                const ChunkPos cp = cell_pos(v.cell);
+
+                u16 mask = ChunkConnectivity::k_all;
+                if (auto chunk = world.find_chunk(cp))
+                {
+                    visible_.push_back(chunk);
+                    mask = connectivity(*chunk);
+                }
+
+                const i32 coords[3] = { cp.x - cam.x + vd, cp.y - cam.y + vv,
+                                        cp.z - cam.z + vd };
+                for (u8 f = 0; f < 6; ++f)
+                {
+                    // never step back against a direction already taken
+                    if ((v.dirs >> (f ^ 1)) & 1)
+                        continue;
+                    if (v.from != 6 && !ChunkConnectivity::connected(mask, v.from, f))
+                        continue;
+
+                    const i32 axis = f >> 1;
+                    const i32 step = f & 1 ? 1 : -1;
+                    const i32 next = coords[axis] + step;
+                    if (next < 0 || next >= limits[axis])
+                        continue;
+
+                    const u32 n = static_cast<u32>(v.cell + step * strides[axis]);
+                    if (reached_[n] || !in_frustum_[n])
+                        continue;
+                    reached_[n]   = 1;
+                    const u8 dirs = static_cast<u8>(v.dirs | (1u << f));
+                    queue_.push_back({ n, static_cast<u8>(f ^ 1), dirs });
+                }
+            }
+        }
+        stats_.occlusion_us = sw.elapsed() * 1e6;
+
+        // stats over the grid only, reached cells were already looked up above and
+        // every loaded one among them is in visible_
+        for (u32 cell = 0; cell < reached_.size(); ++cell)
+        {
+            if (reached_[cell] || !world.find_chunk(cell_pos(cell)))
+                continue;
+            if (!in_frustum_[cell])
+                stats_.frustum_culled++;
+            else
+                stats_.occlusion_culled++;
+        }
+        stats_.in_range = static_cast<u32>(
+            visible_.size() + stats_.frustum_culled + stats_.occlusion_culled);
+        stats_.visible = static_cast<u32>(visible_.size());
+
+        // forget chunks that were unloaded
+        if (connectivity_.size() > world.chunk_count() * 2 + 256)
+        {
+            std::vector<ChunkPos> gone;
+            for (const auto& [cp, c] : connectivity_)
+                if (!world.find_chunk(cp))
+                    gone.push_back(cp);
+            for (const auto& cp : gone)
+                connectivity_.erase(cp);
+        }
+
+        stats_.total_us = total.elapsed() * 1e6;
+        return visible_;
+    }
+} // namespace v
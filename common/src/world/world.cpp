@@ -2,7 +2,12 @@
 // Created by niooi on 9/24/2025.
 //
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <engine/components.h>
 #include <engine/engine.h>
+#include <format>
 #include <world/world.h>
 
 namespace v {
@@ -24,6 +29,20 @@ namespace v {
         return r;
     }
 
+    WorldDomain::~WorldDomain() { engine().on_tick.disconnect("world_chunk_cache"); }
+
+    void WorldDomain::init()
+    {
+        engine().on_tick.connect(
+            {}, {}, "world_chunk_cache",
+            [this]
+            {
+                const u32 interval = std::max(cache_config_.check_interval, 1u);
+                if (engine().current_tick() % interval == 0)
+                    evict_chunks();
+            });
+    }
+
     std::pair<ChunkPos, VoxelPos> WorldDomain::world_to_chunk(WorldPos wp)
     {
         const i32 cs = k_chunk_size;
@@ -39,29 +58,42 @@ namespace v {
 
     ChunkDomain* WorldDomain::try_get_chunk(const ChunkPos& cp)
     {
-        auto it = chunks_.find(cp);
-        if (it == chunks_.end())
-            return nullptr;
-        return it->second;
+        return const_cast<ChunkDomain*>(std::as_const(*this).try_get_chunk(cp));
     }
 
     const ChunkDomain* WorldDomain::try_get_chunk(const ChunkPos& cp) const
     {
         auto it = chunks_.find(cp);
         if (it == chunks_.end())
+        {
+            cache_stats_.misses++;
             return nullptr;
+        }
+        cache_stats_.hits++;
+        it->second->touch(engine().current_tick());
         return it->second;
     }
 
-    ChunkDomain& WorldDomain::get_or_create_chunk(const ChunkPos& cp)
+    const ChunkDomain* WorldDomain::find_chunk(const ChunkPos& cp) const
     {
         auto it = chunks_.find(cp);
-        if (it != chunks_.end())
-            return *it->second;
+        return it == chunks_.end() ? nullptr : it->second;
+    }
 
-        std::string name = "Chunk(" + std::to_string(cp.x) + "," + std::to_string(cp.y) +
-            "," + std::to_string(cp.z) + ")";
-        auto& chunk = engine().add_domain<ChunkDomain>(cp, name);
+    ChunkDomain& WorldDomain::get_or_create_chunk(const ChunkPos& cp)
+    {
+        if (auto chunk = try_get_chunk(cp))
+            return *chunk;
+
+        // formatted on the stack, the domain's own copy of the name is the only
+        // allocation
+        std::array<char, 64> buf;
+        const auto           end =
+            std::format_to_n(buf.data(), buf.size(), "Chunk({},{},{})", cp.x, cp.y, cp.z)
+                .out;
+        auto& chunk = engine().add_domain<ChunkDomain>(
+            cp, std::string(buf.data(), end), next_generation_++);
+        chunk.touch(engine().current_tick());
         chunks_.emplace(cp, &chunk);
         return chunk;
     }
@@ -72,15 +104,7 @@ namespace v {
         if (it == chunks_.end())
             return false;
         if (it->second)
-        {
-            entt::entity id = it->second->entity();
-            engine().post_tick(
-                [this, id]()
-                {
-                    if (engine().registry().valid(id))
-                        engine().registry().destroy(id);
-                });
-        }
+            engine().queue_destroy_domain(it->second->entity());
         chunks_.erase(it);
         return true;
     }
@@ -90,10 +114,8 @@ namespace v {
     u16 WorldDomain::get_voxel(WorldPos wp) const
     {
         auto [cp, lp] = world_to_chunk(wp);
-        if (auto it = chunks_.find(cp); it != chunks_.end())
-        {
-            return it->second->get(lp);
-        }
+        if (auto chunk = try_get_chunk(cp))
+            return chunk->get(lp);
         return 0;
     }
 
@@ -103,4 +125,101 @@ namespace v {
         auto& chunk   = const_cast<WorldDomain*>(this)->get_or_create_chunk(cp);
         chunk.set(lp, value);
     }
+
+    void WorldDomain::apply_edits(const ChunkPos& cp, std::span<const ChunkEdit> edits)
+    {
+        if (edits.empty())
+            return;
+        get_or_create_chunk(cp).apply_edits(edits);
+    }
+
+    usize WorldDomain::evict_chunks()
+    {
+        Stopwatch sw{};
+
+        usize total = 0;
+        for (const auto& [cp, chunk] : chunks_)
+            total += chunk->memory_usage();
+
+        cache_stats_.memory_bytes      = total;
+        cache_stats_.peak_memory_bytes = std::max(cache_stats_.peak_memory_bytes, total);
+
+        const usize budget = cache_config_.memory_budget;
+        if (budget == 0 || total <= budget)
+            return 0;
+
+        struct Anchor {
+            ChunkPos cp;
+            i32      radius;
+        };
+        std::vector<Anchor> anchors;
+        for (auto [entity, pos, anchor] : engine().raw_view<Pos3d, ChunkAnchor>().each())
+        {
+            const WorldPos wp{
+                static_cast<i32>(std::floor(pos.val.x)),
+                static_cast<i32>(std::floor(pos.val.y)),
+                static_cast<i32>(std::floor(pos.val.z)),
+            };
+            anchors.push_back({ world_to_chunk(wp).first, anchor.radius });
+        }
+
+        const auto is_anchored = [&](const ChunkPos& cp)
+        {
+            for (const auto& a : anchors)
+            {
+                if (std::abs(cp.x - a.cp.x) <= a.radius &&
+                    std::abs(cp.y - a.cp.y) <= a.radius &&
+                    std::abs(cp.z - a.cp.z) <= a.radius)
+                    return true;
+            }
+            return false;
+        };
+
+        std::vector<ChunkDomain*> candidates;
+        candidates.reserve(chunks_.size());
+        for (const auto& [cp, chunk] : chunks_)
+        {
+            // dirty chunks can't go anywhere if we can't save them
+            if (chunk->dirty() && !saver_)
+                continue;
+            if (!is_anchored(cp))
+                candidates.push_back(chunk);
+        }
+
+        std::sort(
+            candidates.begin(), candidates.end(), [](const ChunkDomain* a, const ChunkDomain* b)
+            { return a->last_access() < b->last_access(); });
+
+        const usize target  = static_cast<usize>(budget * cache_config_.low_watermark);
+        usize       evicted = 0;
+        for (ChunkDomain* chunk : candidates)
+        {
+            if (total <= target)
+                break;
+
+            if (chunk->dirty())
+            {
+                saver_(*chunk);
+                chunk->clear_dirty();
+                cache_stats_.saves++;
+            }
+
+            total -= chunk->memory_usage();
+            remove_chunk(chunk->pos());
+            evicted++;
+        }
+
+        if (total > budget)
+            LOG_DEBUG(
+                "World is over its chunk memory budget ({} / {} bytes) after eviction, "
+                "everything left is anchored or unsaveable",
+                total, budget);
+
+        cache_stats_.memory_bytes = total;
+        cache_stats_.evictions += evicted;
+        cache_stats_.evict_passes++;
+        cache_stats_.evict_secs += sw.elapsed();
+
+        return evicted;
+    }
 } // namespace v
@@ -1,14 +1,17 @@
+#include <containers/ud_map.h>
 #include <engine/contexts/net/ctx.h>
 #include <net/channels.h>
 #include <prelude.h>
 #include <stdexcept>
+#include <world/streaming.h>
 #include "engine/contexts/net/listener.h"
 #include "engine/domain.h"
 
 namespace v {
     struct ServerConfig {
-        std::string host;
-        u16         port;
+        std::string       host;
+        u16               port;
+        ChunkStreamConfig stream{};
     };
 
     /// A singleton server domain
@@ -31,10 +34,22 @@ namespace v {
 
             listener_ = net_ctx->listen_on(conf_.host, conf_.port);
 
+            engine().add_domain<ChunkStreamer>(conf_.stream);
+
+            listener_->disconnected().connect([this](std::shared_ptr<NetConnection> con)
+            {
+                chats_.erase(con.get());
+                if (auto streamer = engine().get_domain<ChunkStreamer>())
+                    streamer->remove_connection(con);
+            });
+
             listener_->connected().connect([this](std::shared_ptr<NetConnection> con)
             {
                 LOG_INFO("Client connected successfully!");
 
+                if (auto streamer = engine().get_domain<ChunkStreamer>())
+                    streamer->add_connection(con);
+
                 auto& connection_channel = con->create_channel<ConnectServerChannel>();
 
                 connection_channel.received().connect([](const ConnectServerChannel::PayloadT& req)
@@ -42,22 +57,18 @@ namespace v {
 
                 // test some quick channel stuff via chat channel
                 auto& cc = con->create_channel<ChatChannel>();
+                chats_[con.get()] = &cc;
 
                 cc.received().connect([this](const ChatMessage& msg)
                 {
                     LOG_INFO("Got message {} from client", msg.msg);
                     // bounce to the other open channels (TODO! include exlcuding the
                     // current one somehow)
-                    auto& net_ctx = engine().get_ctx<NetworkContext>();
-                    if (net_ctx) {
-                        auto connections = net_ctx->connections_.read();
-                        for (auto& [peer, con] : *connections) {
-                            if (auto channel = con->get_channel<ChatChannel>()) {
-                                ChatMessage payload = { .msg = msg.msg };
-                                channel->send(payload);
-                                LOG_TRACE("Echoed message to channel!");
-                            }
-                        }
+                    for (auto& [key, channel] : chats_)
+                    {
+                        ChatMessage payload = { .msg = msg.msg };
+                        channel->send(payload);
+                        LOG_TRACE("Echoed message to channel!");
                     }
                 });
             });
@@ -70,5 +81,7 @@ namespace v {
     private:
         ServerConfig                 conf_;
         std::shared_ptr<NetListener> listener_;
+        /// Every connection's chat channel, for echoing
+        ud_map<NetConnection*, NetChannel<ChatChannel, ChatMessage>*> chats_;
     };
 } // namespace v
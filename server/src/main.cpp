@@ -8,8 +8,7 @@
 #include <net/channels.h>
 #include <prelude.h>
 #include <server.h>
-#include <time/stopwatch.h>
-#include <time/time.h>
+#include <world/physics.h>
 #include <world/world.h>
 #include "engine/contexts/async/async.h"
 #include "engine/contexts/async/coro_interface.h"
@@ -17,7 +16,7 @@
 
 using namespace v;
 
-constexpr f64 SERVER_UPDATE_RATE = 1.0 / 144.0; // 60 FPS
+constexpr f64 SERVER_TICK_RATE = 144.0;
 
 int main(int argc, char** argv)
 {
@@ -29,6 +28,8 @@ int main(int argc, char** argv)
 
     // TODO! world iis useless rn its just here for fun
     auto& world = engine.add_domain<WorldDomain>();
+    // players shouldn't fall through chunks that haven't streamed in yet
+    engine.add_domain<VoxelPhysics>(PhysicsConfig{ .solid_unloaded = true });
 
     // attempts to update every 1ms
     auto net_ctx = engine.add_ctx<NetworkContext>(1.0 / 1000.0);
@@ -48,23 +49,23 @@ int main(int argc, char** argv)
     ServerConfig config{ "127.0.0.1", 25566 };
     engine.add_domain<ServerDomain>(config);
 
-    Stopwatch        stopwatch{};
+    // simulation (VoxelPhysics) runs on on_fixed_tick at this rate, catching up after
+    // a stall in whole steps. on_tick is left to networking and chunk streaming
+    engine.set_fixed_rate(SERVER_TICK_RATE);
+
     std::atomic_bool running{ true };
 
     LOG_INFO("Server ready, waiting for connections...");
 
     while (running)
     {
-        stopwatch.reset();
-
         net_ctx->update();
 
         async->update();
 
         engine.tick();
 
-        if (const auto sleep_time = stopwatch.until(SERVER_UPDATE_RATE); sleep_time > 0)
-            time::sleep_ms(sleep_time * 1000);
+        engine.wait_for_next_step();
     }
 
     LOG_INFO("Server shutting down");
@@ -29,6 +29,29 @@ int main()
         tctx.assert_now(tree.get_voxel(5, 6, 7) == 0, "clearing voxel works");
     }
 
+    // clear() used to dereference a null root, and to recurse into a leaf root's
+    // voxel mask as if it were children
+    {
+        Sparse64Tree tree(3);
+        tree.clear();
+        tctx.assert_now(tree.node_count() == 0, "clearing an empty tree works");
+
+        Sparse64Tree leaf(1);
+        leaf.set_voxel(1, 2, 3, 42);
+        leaf.set_voxel(0, 0, 0, 7);
+        tctx.assert_now(leaf.node_count() == 1, "depth 1 tree is a single leaf");
+        leaf.clear();
+        tctx.assert_now(
+            leaf.node_count() == 0 && leaf.get_voxel(1, 2, 3) == 0,
+            "clearing a single leaf tree works");
+
+        leaf.fill_aabb(AABB(glm::vec3(0), glm::vec3(4)), 9);
+        leaf.clear();
+        tctx.assert_now(
+            leaf.node_count() == 0 && leaf.get_voxel(0, 0, 0) == 0,
+            "clearing a single type leaf tree works");
+    }
+
     {
         Sparse64Tree tree(3);
         tree.set_voxel(5, 6, 7, 42);
@@ -520,6 +520,327 @@ int main()
         tctx.assert_now(tick_count == 3, "While loop with co_await executed 3 times");
     }
 
+    // Awaiting tasks from a coroutine
+    {
+        const std::thread::id main_id = std::this_thread::get_id();
+        bool                  done    = false;
+        bool                  on_main = true;
+        bool                  ran     = false;
+        bool                  caught  = false;
+        i32                   value   = 0;
+        i32                   ready_v = 0;
+        std::string           str;
+
+        auto ready = async_ctx->task([]() { return 7; });
+        ready.wait();
+
+        async_ctx->spawn(
+            [&](CoroutineInterface& ci) -> Coroutine<void>
+            {
+                const i32 slow = co_await async_ctx->task(
+                    []()
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                        return 21;
+                    });
+                value = slow * 2;
+                on_main = on_main && std::this_thread::get_id() == main_id;
+
+                str = co_await async_ctx->task([]() { return std::string("awaited"); });
+                co_await async_ctx->task([&ran]() { ran = true; });
+
+                try
+                {
+                    co_await async_ctx->task(
+                        []() -> i32 { throw std::runtime_error("task failed"); });
+                }
+                catch (const std::runtime_error&)
+                {
+                    caught = true;
+                }
+
+                // already done
+                ready_v = co_await ready;
+
+                // awaited from a worker, still comes back on the main thread
+                co_await ci.on_worker();
+                value += co_await async_ctx->task([]() { return 1; });
+                on_main = on_main && std::this_thread::get_id() == main_id;
+
+                done = true;
+            });
+
+        Stopwatch sw{};
+        while (!done && sw.elapsed() < 10)
+            engine->tick();
+
+        tctx.assert_now(done, "coroutine awaiting tasks finished");
+        tctx.assert_now(value == 43, "awaited task results");
+        tctx.assert_now(str == "awaited", "awaited task moved its result out");
+        tctx.assert_now(ran, "awaited void task ran");
+        tctx.assert_now(caught, "awaited task rethrew its exception");
+        tctx.assert_now(ready_v == 7, "awaiting a finished task");
+        tctx.assert_now(on_main, "awaiting coroutines resumed on the main thread");
+    }
+
+    // Parallel algorithms
+    {
+        constexpr i32    n = 100'003;
+        std::vector<i64> data(n);
+        async_ctx->parallel_for(0, n, [&](i32 i) { data[i] = i; }, 64);
+        bool filled = true;
+        for (i32 i = 0; i < n; ++i)
+            filled = filled && data[i] == i;
+        tctx.assert_now(filled, "parallel_for visited every index");
+
+        std::atomic<i64> chunked{ 0 };
+        std::atomic<i32> small_chunks{ 0 };
+        async_ctx->parallel_for_chunks(
+            0, n,
+            [&](i32 first, i32 last)
+            {
+                if (last - first < 1000 && last != n)
+                    small_chunks++;
+                i64 local = 0;
+                for (i32 i = first; i < last; ++i)
+                    local += data[i];
+                chunked += local;
+            },
+            1000);
+        const i64 expected = static_cast<i64>(n) * (n - 1) / 2;
+        tctx.assert_now(chunked == expected, "parallel_for_chunks covered the range");
+        tctx.assert_now(small_chunks == 0, "chunks respect the grain");
+
+        tctx.assert_now(
+            async_ctx->parallel_reduce(data.begin(), data.end(), i64{ 0 }, std::plus<>{})
+                == expected,
+            "parallel_reduce");
+        tctx.assert_now(
+            async_ctx->parallel_transform_reduce(
+                data.begin(), data.end(), i64{ 0 }, std::plus<>{},
+                [](i64 x) { return x % 2; }) == n / 2,
+            "parallel_transform_reduce");
+
+        std::vector<i64> inclusive(n), exclusive(n);
+        async_ctx->parallel_inclusive_scan(data.begin(), data.end(), inclusive.begin());
+        async_ctx->parallel_exclusive_scan(
+            data.begin(), data.end(), exclusive.begin(), i64{ 0 });
+        bool scanned = true;
+        for (i32 i = 0; i < n; ++i)
+        {
+            const i64 before = static_cast<i64>(i) * (i - 1) / 2;
+            scanned = scanned && exclusive[i] == before && inclusive[i] == before + i;
+        }
+        tctx.assert_now(scanned, "parallel prefix scans");
+
+        rand::seed(3);
+        std::vector<u32> keys(n);
+        for (u32& k : keys)
+            k = static_cast<u32>(rand::urange(0, 1'000'000));
+        async_ctx->parallel_sort(keys.begin(), keys.end());
+        tctx.assert_now(std::is_sorted(keys.begin(), keys.end()), "parallel_sort");
+        async_ctx->parallel_sort(keys.begin(), keys.end(), std::greater<>{});
+        tctx.assert_now(
+            std::is_sorted(keys.begin(), keys.end(), std::greater<>{}),
+            "parallel_sort with a comparator");
+
+        bool threw = false;
+        try
+        {
+            async_ctx->parallel_for(
+                0, n,
+                [](i32 i)
+                {
+                    if (i == n / 2)
+                        throw std::runtime_error("parallel_for failed");
+                });
+        }
+        catch (const std::runtime_error&)
+        {
+            threw = true;
+        }
+        tctx.assert_now(threw, "parallel_for rethrew");
+
+        // from a task the worker helps out instead of blocking, so this can't deadlock
+        // even with every worker nested
+        std::vector<Task<i64>> nested;
+        for (i32 t = 0; t < 8; ++t)
+            nested.push_back(async_ctx->task(
+                [&]
+                {
+                    return async_ctx->parallel_reduce(
+                        data.begin(), data.end(), i64{ 0 }, std::plus<>{});
+                }));
+        bool nested_ok = true;
+        for (Task<i64>& t : nested)
+            nested_ok = nested_ok && t.get() == expected;
+        tctx.assert_now(nested_ok, "parallel algorithms nested in tasks");
+
+        // non-blocking, awaited from a coroutine
+        bool done = false;
+        i64  sum  = 0;
+        async_ctx->spawn(
+            [&](CoroutineInterface&) -> Coroutine<void>
+            {
+                co_await async_ctx->parallel_for_async(
+                    0, n, [&](i32 i) { data[i] *= 2; });
+                sum = co_await async_ctx->parallel_reduce_async(
+                    data.begin(), data.end(), i64{ 0 }, std::plus<>{});
+                co_await async_ctx->parallel_sort_async(keys.begin(), keys.end());
+                co_await async_ctx->parallel_inclusive_scan_async(
+                    data.begin(), data.end(), inclusive.begin());
+                done = true;
+            });
+
+        Stopwatch sw{};
+        while (!done && sw.elapsed() < 10)
+            engine->tick();
+        tctx.assert_now(done && sum == expected * 2, "awaited parallel algorithms");
+        tctx.assert_now(std::is_sorted(keys.begin(), keys.end()), "awaited sort");
+        tctx.assert_now(inclusive[n - 1] == expected * 2, "awaited scan");
+    }
+
+    // Coroutine frames: kept alive by Coroutine objects past finishing, freed with
+    // the lambda they were spawned from, and reused through the frame pool
+    {
+        const usize alive_before = async_ctx->scheduler().alive();
+        auto        token        = std::make_shared<i32>(5);
+
+        auto kept = async_ctx->spawn(
+            [token](CoroutineInterface& ci) -> Coroutine<i32>
+            {
+                co_await ci.on_worker();
+                co_return *token * 2;
+            });
+        async_ctx->spawn(
+            [token](CoroutineInterface& ci) -> Coroutine<void>
+            { co_await ci.sleep(1); });
+
+        Stopwatch sw{};
+        while (async_ctx->scheduler().alive() > alive_before && sw.elapsed() < 10)
+            engine->tick();
+
+        tctx.assert_now(
+            async_ctx->scheduler().alive() == alive_before,
+            "spawned coroutines finished");
+        tctx.assert_now(kept.done() && kept.get() == 10, "finished frame kept by handle");
+        tctx.assert_now(token.use_count() == 2, "released frame freed its lambda");
+
+        kept = async_ctx->spawn(
+            [](CoroutineInterface&) -> Coroutine<i32> { co_return 1; });
+        tctx.assert_now(token.use_count() == 1, "reassigned handle freed its frame");
+        tctx.assert_now(kept.get() == 1, "coroutine finished synchronously");
+
+        // same lambda type, same frame size, so the freed frame comes back
+        const auto spawn_one = [&]
+        {
+            return async_ctx->spawn(
+                [](CoroutineInterface&) -> Coroutine<void> { co_return; });
+        };
+        spawn_one();
+        const usize cached = mem::FramePool::local().cached();
+        spawn_one();
+        tctx.assert_now(
+            cached > 0 && mem::FramePool::local().cached() == cached,
+            "frames are reused from the pool");
+    }
+
+    // Coroutines still suspended when their engine goes away are freed with it,
+    // lambda captures included
+    {
+        auto token = std::make_shared<i32>(0);
+        {
+            auto  other       = std::make_unique<Engine>();
+            auto* other_async = other->add_ctx<AsyncContext>(1);
+            other_async->spawn(
+                [token](CoroutineInterface& ci) -> Coroutine<void>
+                {
+                    while (co_await ci.sleep(100))
+                        (*token)++;
+                });
+            other_async->spawn(
+                [token](CoroutineInterface& ci) -> Coroutine<void>
+                {
+                    co_await ci.on_worker();
+                    co_await ci.on_main();
+                });
+            tctx.assert_now(token.use_count() == 3, "suspended coroutines hold captures");
+        }
+        tctx.assert_now(
+            token.use_count() == 1, "outstanding coroutines freed at shutdown");
+    }
+
+    // Coroutines bouncing between the main thread and the workers, with how long each
+    // hop takes from suspending to resuming on the other side
+    {
+        constexpr i32         num_coros = 100'000;
+        const std::thread::id main_id   = std::this_thread::get_id();
+        tf::Executor&         executor  = async_ctx->executor();
+
+        std::vector<u64> to_worker_ns(num_coros), to_main_ns(num_coros);
+        std::atomic<i32> wrong_thread{ 0 };
+        i32              completed = 0;
+        i64              sum       = 0;
+
+        for (i32 i = 0; i < num_coros; ++i)
+        {
+            async_ctx
+                ->spawn(
+                    [&, i](CoroutineInterface& ci) -> Coroutine<i32>
+                    {
+                        u64 start = v::time::ns();
+                        co_await ci.on_worker();
+                        to_worker_ns[i] = v::time::ns() - start;
+                        if (executor.this_worker_id() < 0)
+                            wrong_thread++;
+
+                        start = v::time::ns();
+                        co_await ci.on_main();
+                        to_main_ns[i] = v::time::ns() - start;
+                        if (std::this_thread::get_id() != main_id)
+                            wrong_thread++;
+
+                        // finish on a worker, completion still lands on the main thread
+                        co_await ci.on_worker();
+                        co_return i;
+                    })
+                .then(
+                    [&](i32 val)
+                    {
+                        if (std::this_thread::get_id() != main_id)
+                            wrong_thread++;
+                        completed++;
+                        sum += val;
+                    });
+        }
+
+        Stopwatch sw{};
+        while (completed < num_coros && sw.elapsed() < 60)
+            engine->tick();
+
+        tctx.assert_now(
+            completed == num_coros, "{} of {} bouncing coroutines completed", completed,
+            num_coros);
+        tctx.assert_now(
+            sum == static_cast<i64>(num_coros) * (num_coros - 1) / 2,
+            "bouncing coroutines returned their values");
+        tctx.assert_now(
+            wrong_thread.load() == 0, "coroutines resumed on the thread they asked for");
+
+        const auto percentile = [](std::vector<u64>& ns, f64 p)
+        {
+            const usize idx = static_cast<usize>(p * static_cast<f64>(ns.size() - 1));
+            std::nth_element(ns.begin(), ns.begin() + idx, ns.end());
+            return static_cast<f64>(ns[idx]) / 1e3;
+        };
+        LOG_INFO(
+            "[async] {} coroutines in {:.3f}s, to worker p50 {:.1f}us p99 {:.1f}us, "
+            "to main p50 {:.1f}us p99 {:.1f}us",
+            num_coros, sw.elapsed(), percentile(to_worker_ns, 0.5),
+            percentile(to_worker_ns, 0.99), percentile(to_main_ns, 0.5),
+            percentile(to_main_ns, 0.99));
+    }
+
     // Multiple concurrent coroutines
     // {
     //     std::atomic<int> counter{ 0 };
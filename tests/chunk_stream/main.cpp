@@ -0,0 +1,143 @@
+// Chunk streaming over loopback: a server engine streams generated terrain to a
+// client engine, then edits are sent as deltas and far chunks are unloaded
+
+#include <engine/contexts/net/connection.h>
+#include <engine/contexts/net/ctx.h>
+#include <engine/contexts/net/listener.h>
+#include <test.h>
+#include <time/time.h>
+#include <world/streaming.h>
+
+using namespace v;
+
+namespace {
+    constexpr i32 k_radius = 2; // server generates (2r+1)^2 chunks around the origin
+
+    void generate_chunk(ChunkDomain& chunk)
+    {
+        const ChunkPos cp = chunk.pos();
+        for (i32 x = 0; x < ChunkDomain::k_size; ++x)
+        {
+            for (i32 z = 0; z < ChunkDomain::k_size; ++z)
+            {
+                const i32 h = 40 + ((x * 7 + z * 3 + cp.x * 11 + cp.z * 5) % 24);
+                chunk.set({ x, h, z }, static_cast<u16>(1 + (x + z) % 3));
+            }
+        }
+    }
+
+    bool chunks_match(const ChunkDomain& a, const ChunkDomain& b)
+    {
+        for (i32 x = 0; x < ChunkDomain::k_size; x += 3)
+            for (i32 y = 0; y < ChunkDomain::k_size; y += 3)
+                for (i32 z = 0; z < ChunkDomain::k_size; z += 3)
+                    if (a.get({ x, y, z }) != b.get({ x, y, z }))
+                        return false;
+        return true;
+    }
+} // namespace
+
+int main()
+{
+    auto [server, tctx] = testing::init_test("chunk_stream");
+    auto client         = std::make_unique<Engine>();
+
+    const std::string host = "127.0.0.1";
+    const u16         port = 28556;
+
+    // server side
+    auto* server_net   = server->add_ctx<NetworkContext>(1.0 / 1000.0);
+    auto& server_world = server->add_domain<WorldDomain>();
+    auto& streamer     = server->add_domain<ChunkStreamer>();
+
+    for (i32 x = -k_radius; x <= k_radius; ++x)
+        for (i32 z = -k_radius; z <= k_radius; ++z)
+            generate_chunk(server_world.get_or_create_chunk({ x, 0, z }));
+
+    const usize total_chunks = server_world.chunk_count();
+
+    auto listener = server_net->listen_on(host, port);
+    listener->connected().connect([&](std::shared_ptr<NetConnection> con)
+                                  { streamer.add_connection(con); });
+    listener->disconnected().connect([&](std::shared_ptr<NetConnection> con)
+                                     { streamer.remove_connection(con); });
+
+    // client side
+    auto* client_net   = client->add_ctx<NetworkContext>(1.0 / 1000.0);
+    auto& client_world = client->add_domain<WorldDomain>();
+    auto& receiver     = client->add_domain<ChunkReceiver>();
+
+    auto con = client_net->create_connection(host, port);
+    receiver.attach(con);
+    receiver.set_interest({ 0, 0, 0 }, k_radius * 2);
+
+    const auto step = [&]
+    {
+        server_net->update();
+        server->tick();
+        client_net->update();
+        client->tick();
+        v::time::sleep_ms(1);
+    };
+
+    // phase 1: initial stream
+    Stopwatch sw{};
+    f64       stream_secs = 0;
+    for (u64 i = 0; i < 4000 && client_world.chunk_count() < total_chunks; ++i)
+    {
+        step();
+        stream_secs = sw.elapsed();
+    }
+
+    tctx.assert_now(
+        client_world.chunk_count() == total_chunks, "client received all {} chunks (got {})",
+        total_chunks, client_world.chunk_count());
+
+    bool all_match = true;
+    server_world.for_each_chunk(
+        [&](const ChunkDomain& chunk)
+        {
+            auto other = client_world.try_get_chunk(chunk.pos());
+            all_match  = all_match && other && chunks_match(chunk, *other) &&
+                other->version() == chunk.version();
+        });
+    tctx.assert_now(all_match, "client chunks match the server");
+
+    const auto& sstats = streamer.stats();
+    LOG_INFO(
+        "[chunk_stream] {} chunks in {:.3f}s ({:.1f} chunks/sec), {:.1f} bytes/chunk",
+        sstats.full_sent, stream_secs, sstats.full_sent / std::max(stream_secs, 1e-9),
+        static_cast<f64>(sstats.bytes_sent) / std::max<u64>(sstats.full_sent, 1));
+
+    // phase 2: edits go out as deltas
+    const u64 bytes_before = sstats.bytes_sent;
+    server_world.set_voxel({ 5, 100, 5 }, 9);
+    server_world.set_voxel({ 6, 100, 5 }, 9);
+
+    for (u64 i = 0; i < 2000 && client_world.get_voxel({ 6, 100, 5 }) != 9; ++i)
+        step();
+
+    tctx.assert_now(client_world.get_voxel({ 5, 100, 5 }) == 9, "first edit arrived");
+    tctx.assert_now(client_world.get_voxel({ 6, 100, 5 }) == 9, "second edit arrived");
+    tctx.assert_now(sstats.deltas_sent >= 1, "edit sent as a delta");
+    tctx.assert_now(
+        sstats.full_sent == total_chunks, "no chunk was resent whole ({})",
+        sstats.full_sent);
+    LOG_INFO("[chunk_stream] delta for 2 edits: {} bytes", sstats.bytes_sent - bytes_before);
+
+    // phase 3: moving away unloads everything out of range
+    receiver.set_interest({ 100, 0, 100 }, k_radius * 2);
+    for (u64 i = 0; i < 2000 && client_world.chunk_count() > 0; ++i)
+        step();
+
+    tctx.assert_now(client_world.chunk_count() == 0, "chunks unloaded after moving away");
+    tctx.assert_now(
+        sstats.unloads_sent == total_chunks, "one unload per chunk ({})",
+        sstats.unloads_sent);
+
+    con->request_close();
+    for (u64 i = 0; i < 50; ++i)
+        step();
+
+    return tctx.is_failure();
+}
@@ -18,14 +18,6 @@ namespace v {
         }
 
         if (counter_ > 10)
-        {
-            const entt::entity id = entity_;
-            engine().post_tick(
-                [this, id]()
-                {
-                    if (engine().registry().valid(id))
-                        engine().registry().destroy(id);
-                });
-        }
+            engine().queue_destroy_domain(entity_);
     }
 } // namespace v
\ No newline at end of file
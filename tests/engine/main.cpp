@@ -4,6 +4,7 @@
 #include <engine/domain.h>
 #include <engine/engine.h>
 #include <test.h>
+#include <thread>
 #include <time/time.h>
 
 using namespace v;
@@ -35,6 +36,45 @@ public:
     std::string data = "singleton";
 };
 
+// Test domain stored directly in the registry's pool
+class InlineTestDomain : public InlineDomain<InlineTestDomain> {
+public:
+    InlineTestDomain(i32 value) : InlineDomain("InlineTestDomain"), value(value) {}
+    i32 value;
+};
+
+// Test domain holding something heavy that it hands to the background releaser
+class HeavyDomain : public Domain<HeavyDomain> {
+public:
+    HeavyDomain(std::shared_ptr<i32> heavy, std::atomic<u32>& released_off_main) :
+        Domain("HeavyDomain"), heavy_(std::move(heavy)),
+        released_off_main_(released_off_main)
+    {}
+
+    ~HeavyDomain() override
+    {
+        if (child != entt::null)
+            engine().queue_destroy_domain(child);
+    }
+
+    InlineFn release_deferred() override
+    {
+        return [heavy = std::move(heavy_), &off_main = released_off_main_,
+                main = std::this_thread::get_id()]
+        {
+            if (std::this_thread::get_id() != main)
+                off_main.fetch_add(1);
+        };
+    }
+
+    /// Destroyed along with this domain
+    entt::entity child{ entt::null };
+
+private:
+    std::shared_ptr<i32> heavy_;
+    std::atomic<u32>&    released_off_main_;
+};
+
 int main()
 {
     auto [engine, tctx] = testing::init_test("engine");
@@ -186,6 +226,42 @@ int main()
         tctx.assert_now(post_tick_executed, "Post tick callback executed after tick");
     }
 
+    // Test post_tick ordering across batches, throwing callbacks and big captures
+    {
+        std::vector<i32> order;
+        for (i32 i = 0; i < 200; ++i)
+        {
+            if (i == 70)
+                engine->post_tick([] { throw std::runtime_error("post_tick test"); });
+            engine->post_tick([&order, i] { order.push_back(i); });
+        }
+
+        // too big to store inline, and holding something that has to be released
+        auto                  held = std::make_shared<i32>(7);
+        std::array<i64, 16>   big{};
+        std::function<void()> empty;
+        bool                  big_ran = false;
+        auto big_fn = [&big_ran, big, held] { big_ran = big[0] == 0 && *held == 7; };
+        tctx.assert_now(
+            InlineFn::fits_inline<std::function<void()>> &&
+                !InlineFn::fits_inline<decltype(big_fn)>,
+            "std::function fits inline, big captures don't");
+        engine->post_tick(std::move(big_fn));
+        engine->post_tick(empty);
+        engine->post_tick(
+            [&] { engine->post_tick([&order] { order.push_back(-1); }); });
+
+        engine->tick();
+        bool in_order = order.size() == 201;
+        for (i32 i = 0; in_order && i < 200; ++i)
+            in_order = order[i] == i;
+        tctx.assert_now(in_order, "Post tick runs in order past a throwing callback");
+        tctx.assert_now(
+            !order.empty() && order.back() == -1, "Callbacks queued while draining run");
+        tctx.assert_now(big_ran, "Big captures run from the heap");
+        tctx.assert_now(held.use_count() == 1, "Captures released after running");
+    }
+
     // Test on_tick callbacks
     {
         int tick_count = 0;
@@ -220,5 +296,89 @@ int main()
             "Domain entity destroyed after tick");
     }
 
+    // Test batched destroys and releasing resources in the background
+    {
+        auto                      heavy = std::make_shared<i32>(1);
+        std::atomic<u32>          released_off_main{ 0 };
+        std::vector<entt::entity> ids;
+        entt::entity              child = entt::null;
+        for (i32 i = 0; i < 100; ++i)
+        {
+            auto& domain = engine->add_domain<HeavyDomain>(heavy, released_off_main);
+            ids.push_back(domain.entity());
+            if (i == 10)
+                child = domain.child = engine->add_domain<TestDomain>("Child").entity();
+        }
+
+        auto gone = engine->registry().create();
+        engine->registry().destroy(gone);
+        engine->queue_destroy_domain(gone);
+        for (auto id : ids)
+            engine->queue_destroy_domain(id);
+        engine->queue_destroy_domain(ids[0]);
+
+        tctx.assert_now(
+            engine->is_valid_entity(ids[0]), "Batched domains live until the tick ends");
+        engine->tick();
+
+        bool all_gone = !engine->is_valid_entity(child);
+        for (auto id : ids)
+            all_gone = all_gone && !engine->is_valid_entity(id);
+        tctx.assert_now(all_gone, "Batch and destroys queued by destructors are done");
+
+        engine->wait_for_releases();
+        tctx.assert_now(heavy.use_count() == 1, "Released resources are freed");
+        tctx.assert_now(
+            released_off_main.load() == 100, "Resources released off the main thread");
+    }
+
+    // Test inline domains keep their addresses while the pool churns
+    {
+        std::vector<InlineTestDomain*> domains;
+        for (i32 i = 0; i < 3000; ++i)
+            domains.push_back(&engine->add_domain<InlineTestDomain>(i));
+        for (i32 i = 0; i < 3000; i += 2)
+            engine->queue_destroy_domain(domains[i]->entity());
+        engine->tick();
+        for (i32 i = 0; i < 3000; ++i)
+            engine->add_domain<InlineTestDomain>(-1);
+
+        bool stable = true;
+        for (i32 i = 1; i < 3000; i += 2)
+        {
+            stable = stable && domains[i]->value == i &&
+                &engine->get_component<InlineTestDomain>(domains[i]->entity()) ==
+                    domains[i];
+        }
+        tctx.assert_now(stable, "Inline domains don't move when others come and go");
+
+        usize seen = 0;
+        i64   sum  = 0;
+        for (auto [entity, domain] : engine->view<InlineTestDomain>().each())
+        {
+            seen++;
+            sum += domain.value;
+        }
+        tctx.assert_now(
+            seen == 4500 && sum == 1500ll * 1500 - 3000,
+            "Views over inline domains skip destroyed slots");
+        tctx.assert_now(
+            engine->get_domain<InlineTestDomain>() != nullptr,
+            "Inline domains are found by get_domain");
+    }
+
+    // an inline domain added to an existing entity doesn't create one of its own
+    {
+        Engine      fresh{};
+        auto&       registry = fresh.registry();
+        const auto  owner    = registry.create();
+        const auto& domain   = fresh.add_component<InlineTestDomain>(owner, 7);
+        const auto  next     = registry.create();
+        tctx.assert_now(
+            domain.entity() == owner &&
+                entt::to_entity(next) == entt::to_entity(owner) + 1,
+            "Inline domains added to an entity don't leak a new one");
+    }
+
     return tctx.is_failure();
 }
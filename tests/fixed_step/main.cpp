@@ -0,0 +1,125 @@
+// Fixed timestep: the accumulator hands out whole steps and keeps the remainder, caps
+// catch-up after a stall, and Engine paced with wait_for_next_step() runs its fixed
+// ticks at 144 Hz and 1000 Hz. How evenly spaced they land depends on the machine, so
+// the jitter is logged rather than asserted
+
+#include <algorithm>
+#include <cmath>
+#include <test.h>
+#include <time/fixed_step.h>
+#include <time/time.h>
+
+using namespace v;
+
+namespace {
+    struct Jitter {
+        f64 mean_ms{ 0 };
+        f64 p50_ms{ 0 };
+        f64 p99_ms{ 0 };
+        f64 max_ms{ 0 };
+        u64 dropped{ 0 };
+        /// Fixed ticks the engine counted while measuring, and the ones that ran
+        u64 counted{ 0 };
+        u64 ran{ 0 };
+    };
+
+    /// Runs `steps` fixed ticks paced by the engine, how far apart they landed
+    Jitter measure(Engine& engine, f64 hz, i32 steps)
+    {
+        std::vector<u64> stamps;
+        stamps.reserve(steps + 1);
+        // tick first so the accumulator starts from now, not from the last tick
+        engine.tick();
+        engine.set_fixed_rate(hz);
+        const u64 before = engine.current_fixed_tick();
+        engine.on_fixed_tick.connect(
+            {}, {}, "jitter", [&] { stamps.push_back(time::ns()); });
+
+        while (stamps.size() < static_cast<usize>(steps) + 1)
+        {
+            engine.tick();
+            engine.wait_for_next_step();
+        }
+        engine.on_fixed_tick.disconnect("jitter");
+        const u64 counted = engine.current_fixed_tick() - before;
+
+        const f64        step_ms = 1e3 / hz;
+        std::vector<f64> off;
+        Jitter           jitter;
+        for (usize i = 1; i < stamps.size(); ++i)
+        {
+            const f64 interval = static_cast<f64>(stamps[i] - stamps[i - 1]) / 1e6;
+            jitter.mean_ms += interval / steps;
+            off.push_back(std::abs(interval - step_ms));
+        }
+        std::ranges::sort(off);
+        jitter.p50_ms  = off[off.size() / 2];
+        jitter.p99_ms  = off[off.size() * 99 / 100];
+        jitter.max_ms  = off.back();
+        jitter.dropped = engine.dropped_fixed_ticks();
+        jitter.counted = counted;
+        jitter.ran     = stamps.size();
+        engine.set_fixed_rate(0);
+        return jitter;
+    }
+} // namespace
+
+int main()
+{
+    auto [engine, tctx] = testing::init_test("fixed_step");
+
+    // accumulator
+    {
+        FixedStep step{ 0.01, 4 };
+        tctx.assert_now(step.advance(0.025) == 2, "2.5 steps of time run 2");
+        tctx.assert_now(std::abs(step.alpha() - 0.5) < 1e-9, "alpha is the half left");
+        tctx.assert_now(step.advance(0.005) == 1, "the remainder counts next time");
+        tctx.assert_now(step.alpha() < 1e-6, "nothing left over");
+        tctx.assert_now(step.advance(-1) == 0, "time doesn't run backwards");
+
+        step.advance(0.003);
+        tctx.assert_now(step.advance(1.0) == 4, "a stall only catches up 4 steps");
+        tctx.assert_now(step.dropped() == 96, "the other 96 are dropped");
+        tctx.assert_now(
+            std::abs(step.alpha() - 0.3) < 1e-6, "phase kept through the drop ({})",
+            step.alpha());
+    }
+
+    // engine ticks
+    {
+        engine->tick();
+        engine->set_fixed_rate(100);
+        const u64 before = engine->current_fixed_tick();
+        time::sleep_ms(35);
+        engine->tick();
+        const u64 ran = engine->current_fixed_tick() - before;
+        // sleeps may overshoot on a loaded machine, never undershoot
+        tctx.assert_now(
+            ran >= 3, "35ms between ticks run at least 3 fixed steps ({})", ran);
+        tctx.assert_now(
+            engine->alpha() >= 0 && engine->alpha() < 1, "alpha {} is within a step",
+            engine->alpha());
+        engine->set_fixed_rate(0);
+    }
+
+    // paced ticks. every step that ran is counted, and the mean interval is only
+    // checked loosely: a busy or virtualized machine preempts for whole milliseconds
+    // (the step after that catches up, or is dropped past the catch-up cap)
+    for (const f64 hz : { 144.0, 1000.0 })
+    {
+        const i32    steps  = static_cast<i32>(hz);
+        const Jitter jitter = measure(*engine, hz, steps);
+        tctx.assert_now(
+            jitter.counted == jitter.ran && jitter.ran >= static_cast<u64>(steps) + 1,
+            "{} Hz ran {} fixed steps, counted {}", hz, jitter.ran, jitter.counted);
+        tctx.assert_now(
+            std::abs(jitter.mean_ms - 1e3 / hz) < 0.5 * 1e3 / hz,
+            "{} Hz mean interval {:.4f} ms", hz, jitter.mean_ms);
+        LOG_INFO(
+            "[fixed_step] {} Hz jitter p50 {:.4f} ms p99 {:.4f} ms max {:.4f} ms, {} "
+            "steps dropped",
+            hz, jitter.p50_ms, jitter.p99_ms, jitter.max_ms, jitter.dropped);
+    }
+
+    return tctx.is_failure();
+}
@@ -0,0 +1,130 @@
+// FrameArena: allocations are aligned and don't overlap, scopes and rewinds hand the
+// same memory back out, freed memory is poisoned outside of release builds, pmr
+// containers grow through it, a warmed up arena stops growing, and an engine tick
+// resets every thread's arena
+
+#include <atomic>
+#include <cstring>
+#include <engine/engine.h>
+#include <mem/frame_arena.h>
+#include <test.h>
+#include <thread>
+
+using namespace v;
+
+int main()
+{
+    auto [engine, tctx] = testing::init_test("frame_arena");
+
+    // alignment
+    {
+        mem::FrameArena arena;
+        bool            aligned = true;
+        for (usize align : { 1, 2, 4, 8, 16, 32, 64, 128 })
+        {
+            arena.allocate(3);
+            const auto ptr = reinterpret_cast<uintptr_t>(arena.allocate(24, align));
+            aligned        = aligned && ptr % align == 0;
+        }
+        tctx.assert_now(aligned, "allocations are aligned");
+
+        // spilling into a new block, and bigger than a block
+        auto* a = arena.allocate_array<u8>(mem::FrameArena::k_block_size - 16);
+        auto* b = arena.allocate_array<u8>(mem::FrameArena::k_block_size * 3);
+        std::memset(a, 1, mem::FrameArena::k_block_size - 16);
+        std::memset(b, 2, mem::FrameArena::k_block_size * 3);
+        tctx.assert_now(
+            a[mem::FrameArena::k_block_size - 17] == 1 && b[0] == 2,
+            "allocations past a block don't overlap");
+        tctx.assert_now(arena.allocations() == 18, "allocations counted");
+    }
+
+    // scopes and rewinds
+    {
+        mem::FrameArena arena;
+        arena.allocate(100);
+        void* first;
+        {
+            mem::FrameArena::Scope scope{ arena };
+            first = arena.allocate(256);
+        }
+        void* second;
+        {
+            mem::FrameArena::Scope scope{ arena };
+            second = arena.allocate(256);
+        }
+        tctx.assert_now(first == second, "scope hands its memory back");
+
+        const auto marker = arena.mark();
+        void*      third  = arena.allocate(256);
+        arena.rewind(marker);
+        tctx.assert_now(arena.allocate(256) == third, "rewind hands its memory back");
+    }
+
+#if !defined(V_RELEASE)
+    // poisoning
+    {
+        mem::FrameArena arena;
+        auto*           ids = arena.allocate_array<u32>(64);
+        for (u32 i = 0; i < 64; ++i)
+            ids[i] = i;
+        arena.reset();
+
+        bool poisoned = true;
+        for (usize i = 0; i < 64 * sizeof(u32); ++i)
+            poisoned = poisoned &&
+                reinterpret_cast<u8*>(ids)[i] == mem::FrameArena::k_poison;
+        tctx.assert_now(poisoned, "reset memory is poisoned");
+    }
+#endif
+
+    // pmr containers
+    {
+        mem::FrameArena       arena;
+        std::pmr::vector<u64> vals{ arena.resource() };
+        for (u64 i = 0; i < 100'000; ++i)
+            vals.push_back(i * i);
+        bool ok = true;
+        for (u64 i = 0; i < vals.size(); ++i)
+            ok = ok && vals[i] == i * i;
+        tctx.assert_now(ok && vals.size() == 100'000, "pmr vector grows in the arena");
+
+        // same work next frame fits in what the last one left behind
+        arena.reset();
+        const usize           capacity = arena.capacity();
+        std::pmr::vector<u64> again{ arena.resource() };
+        for (u64 i = 0; i < 100'000; ++i)
+            again.push_back(i);
+        tctx.assert_now(arena.capacity() == capacity, "warmed up arena doesn't grow");
+    }
+
+    // engine ticks reset every thread's arena
+    {
+        mem::FrameArena& arena = mem::FrameArena::local();
+        arena.allocate(64);
+        engine->tick();
+        tctx.assert_now(arena.allocations() == 0, "tick resets the main thread's arena");
+
+        // the worker's arena resets the next time it asks for it
+        std::atomic<i32> phase{ 0 };
+        u64              before = 0, after = 0;
+        std::thread      worker(
+            [&]
+            {
+                mem::FrameArena::local().allocate(64);
+                before = mem::FrameArena::local().allocations();
+                phase  = 1;
+                while (phase.load() != 2)
+                    std::this_thread::yield();
+                after = mem::FrameArena::local().allocations();
+            });
+        while (phase.load() != 1)
+            std::this_thread::yield();
+        engine->tick();
+        phase = 2;
+        worker.join();
+        tctx.assert_now(before == 1 && after == 0, "tick resets other threads' arenas");
+    }
+
+    return tctx.is_failure();
+}
@@ -0,0 +1,166 @@
+// Flood fill lighting: basic sky/block light rules, then random edits across chunk
+// borders must end up with exactly the light a from-scratch relight produces
+
+#include <engine/contexts/async/async.h>
+#include <test.h>
+#include <world/light.h>
+
+using namespace v;
+
+namespace {
+    constexpr u16 k_stone = 1;
+    constexpr u16 k_torch = 5;
+
+    struct LitWorld {
+        std::unique_ptr<Engine> engine;
+        WorldDomain*            world;
+        LightEngine*            light;
+    };
+
+    LitWorld make_world(std::unique_ptr<Engine> engine)
+    {
+        auto& world = engine->add_domain<WorldDomain>();
+        auto& light = engine->add_domain<LightEngine>();
+        light.set_emission(k_torch, 14);
+        return { std::move(engine), &world, &light };
+    }
+
+    // 2x2x2 chunks, ground with a tunnel through it and some torches
+    void generate(WorldDomain& world)
+    {
+        for (i32 x = 0; x < 256; ++x)
+        {
+            for (i32 z = 0; z < 256; ++z)
+            {
+                const i32 h = 120 + (x * 7 + z * 13) % 24;
+                for (i32 y = 0; y < h; ++y)
+                {
+                    if (y > 60 && y < 68 && z % 64 < 48)
+                        continue;
+                    world.set_voxel({ x, y, z }, k_stone);
+                }
+            }
+        }
+        for (i32 i = 0; i < 64; ++i)
+        {
+            const WorldPos wp{ static_cast<i32>(rand::urange(0, 255)),
+                               static_cast<i32>(rand::urange(0, 255)),
+                               static_cast<i32>(rand::urange(0, 255)) };
+            world.set_voxel(wp, k_torch);
+        }
+    }
+
+    void relight_all(LitWorld& w)
+    {
+        w.world->for_each_chunk([&](ChunkDomain& chunk)
+                                { w.light->queue_relight(chunk.pos()); });
+        w.light->update();
+    }
+
+    void rule_checks(testing::TestContext& tctx)
+    {
+        auto w = make_world(std::make_unique<Engine>());
+        w.world->get_or_create_chunk({ 0, 0, 0 });
+
+        // a roof at y = 100 over part of the chunk
+        for (i32 x = 0; x < 64; ++x)
+            for (i32 z = 0; z < 64; ++z)
+                w.world->set_voxel({ x, 100, z }, k_stone);
+        relight_all(w);
+
+        auto& light = *w.light;
+        tctx.assert_now(light.sky_light({ 100, 0, 100 }) == 15, "open column fully lit");
+        tctx.assert_now(light.sky_light({ 32, 50, 32 }) < 15, "roof casts a shadow");
+        const u8 edge = light.sky_light({ 63, 50, 32 });
+        tctx.assert_now(
+            light.sky_light({ 64, 50, 32 }) == 15 && edge == 14,
+            "light falls off by one past the edge ({})", edge);
+
+        // a torch under the roof, then take it away again
+        light.set_voxel({ 10, 50, 10 }, k_torch);
+        light.update();
+        tctx.assert_now(light.block_light({ 10, 50, 10 }) == 14, "torch lights itself");
+        tctx.assert_now(light.block_light({ 13, 50, 10 }) == 11, "torch falls off");
+
+        light.set_voxel({ 10, 50, 10 }, 0);
+        light.update();
+        tctx.assert_now(light.block_light({ 13, 50, 10 }) == 0, "removed torch is dark");
+
+        // closing the roof darkens what's under it
+        light.set_voxel({ 64, 100, 32 }, k_stone);
+        light.update();
+        tctx.assert_now(light.sky_light({ 64, 50, 32 }) == 14, "covered column dimmed");
+    }
+} // namespace
+
+int main()
+{
+    auto [engine, tctx] = testing::init_test("lighting");
+    engine->add_ctx<AsyncContext>(4);
+
+    rule_checks(tctx);
+
+    rand::seed(29);
+    auto incremental = make_world(std::move(engine));
+    generate(*incremental.world);
+    relight_all(incremental);
+
+    tctx.assert_now(
+        incremental.light->chunk_count() == 8, "every chunk lit ({})",
+        incremental.light->chunk_count());
+
+    // edits biased towards the chunk borders, with an update every few edits
+    std::vector<std::pair<WorldPos, u16>> edits;
+    for (i32 i = 0; i < 2000; ++i)
+    {
+        const auto near_border = [](i32 max)
+        {
+            return rand::urange(0, 1) ? static_cast<i32>(rand::urange(126, 129))
+                                      : static_cast<i32>(rand::urange(0, max));
+        };
+        const WorldPos wp{ near_border(255), near_border(255), near_border(255) };
+        u16            v = 0;
+        if (rand::urange(0, 2) != 0)
+            v = rand::urange(0, 3) == 0 ? k_torch : k_stone;
+
+        edits.push_back({ wp, v });
+        incremental.light->set_voxel(wp, v);
+        if (i % 7 == 0)
+            incremental.light->update();
+    }
+    incremental.light->update();
+
+    // same world, lit from scratch
+    rand::seed(29);
+    auto reference = make_world(std::make_unique<Engine>());
+    generate(*reference.world);
+    for (const auto& [wp, v] : edits)
+        reference.world->set_voxel(wp, v);
+    relight_all(reference);
+
+    usize mismatched = 0;
+    reference.world->for_each_chunk(
+        [&](ChunkDomain& chunk)
+        {
+            const ChunkLight* a = incremental.light->try_get(chunk.pos());
+            const ChunkLight* b = reference.light->try_get(chunk.pos());
+            if (!a || !b)
+            {
+                mismatched += ChunkLight::k_volume;
+                return;
+            }
+            for (u32 i = 0; i < ChunkLight::k_volume; ++i)
+                mismatched += a->data()[i] != b->data()[i];
+        });
+
+    tctx.assert_now(
+        mismatched == 0, "incremental light matches a full relight ({} voxels off)",
+        mismatched);
+
+    const auto& stats = incremental.light->stats();
+    LOG_INFO(
+        "[lighting] {} chunk passes over {} rounds, {:.3f}s total", stats.chunk_passes,
+        stats.rounds, stats.total_update_secs);
+
+    return tctx.is_failure();
+}
@@ -0,0 +1,212 @@
+// CPU meshing: ambient occlusion from the neighbourhood lookup table and the padded
+// chunk copy must match a naive per vertex reference reading the world directly,
+// including across chunk borders. Baked light must match the light engine.
+
+#include <map>
+#include <test.h>
+#include <time/stopwatch.h>
+#include <world/light.h>
+#include <world/mesher.h>
+
+using namespace v;
+
+namespace {
+    constexpr i32 k_normal[6][3] = {
+        { -1, 0, 0 }, { 1, 0, 0 },  { 0, -1, 0 },
+        { 0, 1, 0 },  { 0, 0, -1 }, { 0, 0, 1 },
+    };
+
+    /// (voxel x, y, z, face, corner x, y, z)
+    using CornerKey = std::array<i32, 7>;
+
+    struct Expected {
+        u8 ao;
+        u8 light;
+    };
+
+    // the textbook version: three voxel fetches per vertex
+    std::map<CornerKey, Expected>
+    naive_mesh(const WorldDomain& world, const LightEngine& light, const ChunkPos& cp)
+    {
+        std::map<CornerKey, Expected> out;
+
+        const auto solid = [&](i32 x, i32 y, i32 z)
+        { return world.get_voxel({ x, y, z }) != 0; };
+
+        const i32 size = ChunkDomain::k_size;
+        for (i32 z = 0; z < size; ++z)
+        {
+            for (i32 y = 0; y < size; ++y)
+            {
+                for (i32 x = 0; x < size; ++x)
+                {
+                    const i32 wx = cp.x * size + x;
+                    const i32 wy = cp.y * size + y;
+                    const i32 wz = cp.z * size + z;
+                    if (!solid(wx, wy, wz))
+                        continue;
+
+                    for (i32 f = 0; f < 6; ++f)
+                    {
+                        const i32 fx = wx + k_normal[f][0];
+                        const i32 fy = wy + k_normal[f][1];
+                        const i32 fz = wz + k_normal[f][2];
+                        if (solid(fx, fy, fz))
+                            continue;
+
+                        // the two axes in the face plane
+                        const i32 axis = f / 2;
+                        const i32 ua   = axis == 0 ? 1 : 0;
+                        const i32 va   = axis == 2 ? 1 : 2;
+
+                        const u8 lit = static_cast<u8>(
+                            light.sky_light({ fx, fy, fz }) << 4 |
+                            light.block_light({ fx, fy, fz }));
+
+                        for (i32 su : { -1, 1 })
+                        {
+                            for (i32 sv : { -1, 1 })
+                            {
+                                std::array<i32, 3> u{}, v{};
+                                u[ua] = su;
+                                v[va] = sv;
+
+                                // relative to the voxel in front of the face
+                                const auto front = [&](i32 dx, i32 dy, i32 dz)
+                                { return solid(fx + dx, fy + dy, fz + dz); };
+
+                                const bool side1  = front(u[0], u[1], u[2]);
+                                const bool side2  = front(v[0], v[1], v[2]);
+                                const bool corner = front(
+                                    u[0] + v[0], u[1] + v[1], u[2] + v[2]);
+
+                                u8 ao = 3 - side1 - side2 - corner;
+                                if (side1 && side2)
+                                    ao = 0;
+
+                                std::array<i32, 3> pos{ x, y, z };
+                                pos[axis] += f & 1;
+                                pos[ua] += su > 0;
+                                pos[va] += sv > 0;
+
+                                out[{ x, y, z, f, pos[0], pos[1], pos[2] }] = { ao, lit };
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return out;
+    }
+
+    /// Compares a mesh against the reference, returns the number of mismatched corners
+    usize compare(const ChunkMesh& mesh, const std::map<CornerKey, Expected>& expected)
+    {
+        usize bad = mesh.quad_count() * 4 == expected.size() ? 0 : 1;
+        for (usize q = 0; q < mesh.quad_count(); ++q)
+        {
+            const ChunkVertex* quad = &mesh.vertices[q * 4];
+            const u8           f    = quad[0].face();
+            const i32          axis = f / 2;
+
+            // the voxel is the min corner of the quad, minus one on the normal axis for
+            // faces pointing the positive way
+            std::array<i32, 3> voxel{ 255, 255, 255 };
+            for (i32 i = 0; i < 4; ++i)
+            {
+                voxel[0] = std::min<i32>(voxel[0], quad[i].x);
+                voxel[1] = std::min<i32>(voxel[1], quad[i].y);
+                voxel[2] = std::min<i32>(voxel[2], quad[i].z);
+            }
+            voxel[axis] -= f & 1;
+
+            for (i32 i = 0; i < 4; ++i)
+            {
+                auto it = expected.find(
+                    { voxel[0], voxel[1], voxel[2], f, quad[i].x, quad[i].y, quad[i].z });
+                if (it == expected.end() || it->second.ao != quad[i].ao() ||
+                    it->second.light != quad[i].light)
+                    bad++;
+            }
+        }
+        return bad;
+    }
+} // namespace
+
+int main()
+{
+    auto [engine, tctx] = testing::init_test("meshing");
+
+    auto& world = engine->add_domain<WorldDomain>();
+    auto& light = engine->add_domain<LightEngine>();
+    light.set_emission(3, 12);
+
+    // a floor, a noisy blob straddling the +x and +y borders of chunk 0, and a
+    // few lights in it
+    rand::seed(30);
+    for (i32 x = 0; x < 128; ++x)
+        for (i32 z = 0; z < 128; ++z)
+            world.set_voxel({ x, 10, z }, 1);
+
+    for (i32 x = 100; x < 140; ++x)
+        for (i32 y = 100; y < 140; ++y)
+            for (i32 z = 0; z < 30; ++z)
+                if (rand::urange(0, 9) < 4)
+                    world.set_voxel({ x, y, z }, static_cast<u16>(rand::urange(1, 3)));
+
+    world.for_each_chunk([&](ChunkDomain& chunk) { light.queue_relight(chunk.pos()); });
+    light.update();
+
+    const ChunkDomain* chunk = world.find_chunk({ 0, 0, 0 });
+    tctx.assert_now(chunk != nullptr, "chunk exists");
+
+    ChunkMesher mesher{};
+    ChunkMesh   mesh{};
+    Stopwatch   sw{};
+    mesher.mesh(*chunk, mesh, &world, &light);
+    const f64 ao_secs = sw.elapsed();
+
+    const auto expected = naive_mesh(world, light, { 0, 0, 0 });
+    tctx.assert_now(
+        mesh.quad_count() * 4 == expected.size(), "same face count ({} vs {})",
+        mesh.quad_count(), expected.size() / 4);
+    tctx.assert_now(mesh.indices.size() == mesh.quad_count() * 6, "six indices per quad");
+
+    const usize bad = compare(mesh, expected);
+    tctx.assert_now(bad == 0, "AO and light match the reference ({} corners off)", bad);
+
+    // the flat floor far away from the blob is unoccluded
+    bool floor_clear = true;
+    for (const auto& vtx : mesh.vertices)
+    {
+        if (vtx.face() == 3 && vtx.y == 11 && vtx.x > 2 && vtx.x < 90 && vtx.z > 40 &&
+            vtx.z < 120)
+            floor_clear = floor_clear && vtx.ao() == 3;
+    }
+    tctx.assert_now(floor_clear, "open floor has no occlusion");
+
+    // without neighbours the border is empty, so faces against chunk 1 show up
+    ChunkMesh lonely{};
+    mesher.mesh(*chunk, lonely);
+    tctx.assert_now(
+        lonely.quad_count() > mesh.quad_count(), "empty border exposes faces ({} vs {})",
+        lonely.quad_count(), mesh.quad_count());
+
+    // AO should cost little on top of plain meshing
+    ChunkMesher plain_mesher{ { .ambient_occlusion = false } };
+    ChunkMesh   plain{};
+    sw.reset();
+    plain_mesher.mesh(*chunk, plain, &world, &light);
+    const f64 plain_secs = sw.elapsed();
+
+    bool all_clear = plain.quad_count() == mesh.quad_count();
+    for (const auto& vtx : plain.vertices)
+        all_clear = all_clear && vtx.ao() == 3;
+    tctx.assert_now(all_clear, "AO off gives the same faces, unoccluded");
+
+    LOG_INFO(
+        "[meshing] {} quads, {:.3f}ms with AO, {:.3f}ms without", mesh.quad_count(),
+        ao_secs * 1e3, plain_secs * 1e3);
+
+    return tctx.is_failure();
+}
@@ -0,0 +1,195 @@
+// Voxel physics: swept boxes have to stop exactly where a naive voxel by voxel sweep
+// does, land on floors and slide along walls, and stepping bodies in parallel has to
+// give the same result as stepping them one by one
+
+#include <engine/components.h>
+#include <engine/contexts/async/async.h>
+#include <test.h>
+#include <world/physics.h>
+
+using namespace v;
+
+namespace {
+    constexpr u16 k_stone = 1;
+
+    // hills with some pillars and overhangs, spanning chunk borders on every axis
+    void generate(WorldDomain& world)
+    {
+        for (i32 x = -40; x < 200; ++x)
+        {
+            for (i32 z = -40; z < 200; ++z)
+            {
+                const i32 h = 100 + (x * 7 + z * 13) % 40;
+                for (i32 y = 60; y < h; ++y)
+                    world.set_voxel({ x, y, z }, k_stone);
+
+                if ((x % 17) == 0 && (z % 11) == 0)
+                    for (i32 y = h; y < h + 20; ++y)
+                        world.set_voxel({ x, y, z }, k_stone);
+            }
+        }
+    }
+
+    // the textbook version: test every voxel of the swept hull on every axis
+    SweepResult
+    naive_sweep(const WorldDomain& world, const AABB& box, const glm::vec3& delta)
+    {
+        constexpr f32 skin = 1e-3f;
+        SweepResult   result{};
+        AABB          moving = box;
+        for (i32 axis : { 1, 0, 2 })
+        {
+            f32 move = delta[axis];
+            if (move == 0)
+                continue;
+
+            const AABB hull{ glm::min(moving.min, moving.min + delta),
+                             glm::max(moving.max, moving.max + delta) };
+            const VoxelBox r = VoxelCollider::voxels_of(hull);
+
+            const f32 face = move > 0 ? moving.max[axis] : moving.min[axis];
+            for (i32 z = r.min[2]; z < r.max[2]; ++z)
+            {
+                for (i32 y = r.min[1]; y < r.max[1]; ++y)
+                {
+                    for (i32 x = r.min[0]; x < r.max[0]; ++x)
+                    {
+                        if (world.get_voxel({ x, y, z }) == 0)
+                            continue;
+
+                        const i32 cell[3] = { x, y, z };
+                        bool      inside  = true;
+                        for (i32 a = 0; a < 3; ++a)
+                        {
+                            if (a == axis)
+                                continue;
+                            inside = inside && cell[a] < moving.max[a] - skin &&
+                                cell[a] + 1 > moving.min[a] + skin;
+                        }
+                        if (!inside)
+                            continue;
+
+                        if (move > 0 && cell[axis] >= face - skin)
+                            move = std::min(move, std::max(cell[axis] - face, 0.f));
+                        else if (move < 0 && cell[axis] + 1 <= face + skin)
+                            move = std::max(move, std::min(cell[axis] + 1 - face, 0.f));
+                    }
+                }
+            }
+
+            if (move != delta[axis])
+                result.blocked |= static_cast<u8>(1u << axis);
+            moving.min[axis] += move;
+            moving.max[axis] += move;
+            result.moved[axis] = move;
+        }
+        return result;
+    }
+
+    f32 frand(f32 lo, f32 hi) { return static_cast<f32>(rand::frange(lo, hi)); }
+
+    glm::vec3 random_vec(f32 lo, f32 hi)
+    {
+        return { frand(lo, hi), frand(lo, hi), frand(lo, hi) };
+    }
+
+    std::vector<entt::entity> spawn_bodies(Engine& engine, i32 count)
+    {
+        std::vector<entt::entity> out;
+        for (i32 i = 0; i < count; ++i)
+        {
+            const auto e = out.emplace_back(engine.registry().create());
+            engine.registry().emplace<Pos3d>(
+                e, glm::vec3{ frand(0, 160), frand(165, 185), frand(0, 160) });
+            engine.registry().emplace<Size3d>(e, glm::vec3{ 0.6f, 1.8f, 0.6f });
+            engine.registry().emplace<VoxelBody>(
+                e, VoxelBody{ .velocity = { frand(-2, 2), 0, frand(-2, 2) } });
+        }
+        return out;
+    }
+} // namespace
+
+int main()
+{
+    auto [engine, tctx] = testing::init_test("physics");
+
+    auto& world = engine->add_domain<WorldDomain>();
+    world.set_cache_config({ .memory_budget = 0 });
+    generate(world);
+
+    VoxelCollider collider{ world };
+
+    // a box dropped onto flat ground lands on top of it
+    for (i32 x = 300; x < 310; ++x)
+        for (i32 z = 300; z < 310; ++z)
+            world.set_voxel({ x, 50, z }, k_stone);
+    {
+        const AABB        box{ { 303.2f, 60, 303.2f }, { 304, 62, 304 } };
+        const SweepResult r = collider.sweep(box, { 0.5f, -20, 0 });
+        tctx.assert_now(
+            r.moved.y == -9 && r.blocked == 2 && r.moved.x == 0.5f,
+            "lands on the floor and keeps sliding ({}, {}, blocked {})", r.moved.x,
+            r.moved.y, r.blocked);
+        tctx.assert_now(!collider.overlaps(box.translated(r.moved)), "ends up outside");
+    }
+
+    // random sweeps all over the terrain, through chunk borders
+    rand::seed(31);
+    usize mismatched = 0;
+    for (i32 i = 0; i < 5000; ++i)
+    {
+        const glm::vec3 center = random_vec(-20, 180);
+        const glm::vec3 half   = random_vec(0.2f, 1.5f);
+        const AABB      box{ center - half, center + half };
+        const glm::vec3 delta = random_vec(-6, 6);
+
+        const SweepResult a = collider.sweep(box, delta);
+        const SweepResult b = naive_sweep(world, box, delta);
+        mismatched += a.moved != b.moved || a.blocked != b.blocked;
+    }
+    tctx.assert_now(mismatched == 0, "sweeps match the naive sweep ({} off)", mismatched);
+
+    // stepping serially and in parallel
+    rand::seed(31);
+    const auto serial_bodies = spawn_bodies(*engine, 2000);
+    auto& serial = engine->add_domain<VoxelPhysics>(PhysicsConfig{ .parallel = false });
+
+    auto other = std::make_unique<Engine>();
+    other->add_ctx<AsyncContext>(4);
+    auto& other_world = other->add_domain<WorldDomain>();
+    other_world.set_cache_config({ .memory_budget = 0 });
+    generate(other_world);
+    rand::seed(31);
+    const auto parallel_bodies = spawn_bodies(*other, 2000);
+    auto& parallel = other->add_domain<VoxelPhysics>(PhysicsConfig{ .batch_size = 64 });
+
+    for (i32 i = 0; i < 120; ++i)
+    {
+        serial.step(1.0 / 20);
+        parallel.step(1.0 / 20);
+    }
+
+    usize diverged = 0;
+    usize grounded = 0;
+    for (usize i = 0; i < serial_bodies.size(); ++i)
+    {
+        const auto& a = engine->registry().get<Pos3d>(serial_bodies[i]);
+        const auto& b = other->registry().get<Pos3d>(parallel_bodies[i]);
+        diverged += a.val != b.val;
+        grounded += engine->registry().get<VoxelBody>(serial_bodies[i]).on_ground;
+    }
+    tctx.assert_now(diverged == 0, "parallel step matches serial ({} off)", diverged);
+    // they keep sliding, so a few are always on their way down a ledge
+    tctx.assert_now(grounded > 1800, "bodies settled on the ground ({})", grounded);
+    tctx.assert_now(parallel.stats().batches > 1, "parallel step used batches");
+
+    usize stuck = 0;
+    for (auto [entity, pos, size] : engine->raw_view<Pos3d, Size3d>().each())
+    {
+        const glm::vec3 half = size.val * 0.5f;
+        stuck += collider.overlaps({ pos.val - half, pos.val + half });
+    }
+    tctx.assert_now(stuck == 0, "no body ended up inside terrain ({})", stuck);
+
+    return tctx.is_failure();
+}
@@ -0,0 +1,290 @@
+// DependentSink: tasks must keep their after/before order in both modes, independent
+// tasks must overlap with an executor, main thread tasks must stay on the thread that
+// executes, tasks connected mid execute only run from the next one, and timed tasks
+// report sensible durations
+
+#include <algorithm>
+#include <atomic>
+#include <engine/contexts/async/async.h>
+#include <engine/sink.h>
+#include <test.h>
+#include <thread>
+
+using namespace v;
+
+namespace {
+    /// Records when every task started and finished, in a global sequence
+    struct Trace {
+        std::atomic<u32>                 clock{ 0 };
+        std::array<std::atomic<u32>, 16> start{}, end{};
+        std::array<std::thread::id, 16>  thread{};
+        std::atomic<i32>                 running{ 0 }, max_running{ 0 };
+
+        void reset()
+        {
+            clock = 0;
+            for (auto& s : start)
+                s = 0;
+            for (auto& e : end)
+                e = 0;
+            running = max_running = 0;
+        }
+
+        std::function<void()> task(u32 i)
+        {
+            return [this, i]
+            {
+                start[i]     = ++clock;
+                thread[i]    = std::this_thread::get_id();
+                const i32 r  = ++running;
+                i32       mx = max_running.load();
+                while (r > mx && !max_running.compare_exchange_weak(mx, r))
+                    ;
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                --running;
+                end[i] = ++clock;
+            };
+        }
+
+        bool ordered(u32 a, u32 b) const { return end[a] != 0 && end[a] < start[b]; }
+    };
+
+    // a diamond 0 -> (1, 2, 3) -> 4 plus 5 before 0 through `before`, and 6 on its own
+    void build(DependentSink& sink, Trace& trace, TaskAffinity main_task)
+    {
+        sink.connect({}, {}, "root", trace.task(0));
+        sink.connect({ "root" }, {}, "a", trace.task(1));
+        sink.connect({ "root" }, {}, "b", trace.task(2), main_task);
+        sink.connect({ "root" }, { "join" }, "c", trace.task(3));
+        sink.connect({ "a", "b" }, {}, "join", trace.task(4));
+        sink.connect({}, { "root" }, "first", trace.task(5));
+        sink.connect({}, {}, "alone", trace.task(6));
+    }
+
+    bool diamond_ordered(const Trace& t)
+    {
+        return t.ordered(5, 0) && t.ordered(0, 1) && t.ordered(0, 2) && t.ordered(0, 3) &&
+            t.ordered(1, 4) && t.ordered(2, 4) && t.ordered(3, 4) && t.end[6] != 0;
+    }
+
+    /// Position of every name in sorted(), -1 if not connected
+    i64 position(const std::vector<std::string>& order, const std::string& name)
+    {
+        const auto it = std::ranges::find(order, name);
+        return it == order.end() ? -1 : it - order.begin();
+    }
+} // namespace
+
+int main()
+{
+    auto [engine, tctx] = testing::init_test("sink");
+    auto* async         = engine->add_ctx<AsyncContext>(4);
+
+    // serial, the default
+    {
+        DependentSink sink;
+        Trace         trace;
+        build(sink, trace, TaskAffinity::any);
+        sink.execute();
+        tctx.assert_now(diamond_ordered(trace), "serial run keeps the order");
+        tctx.assert_now(trace.max_running == 1, "serial run never overlaps");
+    }
+
+    // the order is kept incrementally, check what that has to get right
+    {
+        DependentSink sink;
+        std::string   ran;
+
+        // named before it exists, then connected, it has to move in front
+        sink.connect({ "y" }, {}, "z", [&] { ran += 'z'; });
+        sink.connect({}, {}, "x", [&] { ran += 'x'; });
+        sink.connect({ "x" }, {}, "y", [&] { ran += 'y'; });
+        sink.execute();
+        tctx.assert_now(ran == "xyz", "late dependency moves ahead, ran {}", ran);
+
+        // a cycle is refused and the rest keeps running
+        const bool connected = sink.connect({ "z" }, { "x" }, "w", [&] { ran += 'w'; });
+        tctx.assert_now(!connected, "cycle through x -> y -> z is refused");
+        tctx.assert_now(sink.size() == 3, "refused task isn't connected");
+        tctx.assert_now(
+            !sink.connect({ "v" }, {}, "v", [] {}), "self dependency refused");
+        ran.clear();
+        sink.execute();
+        tctx.assert_now(ran == "xyz", "graph unchanged by the refused tasks");
+
+        // removing the middle of a chain keeps the rest ordered, reconnecting fits it
+        // back in
+        sink.disconnect("y");
+        ran.clear();
+        sink.execute();
+        tctx.assert_now(ran == "xz", "disconnected task is gone, ran {}", ran);
+        sink.connect({ "x" }, {}, "y", [&] { ran += 'y'; });
+        ran.clear();
+        sink.execute();
+        tctx.assert_now(ran == "xyz", "reconnected task in place again, ran {}", ran);
+    }
+
+    // random dags connected in random order, every edge has to hold
+    {
+        constexpr i32 k_tasks = 300;
+        rand::seed(35);
+        for (i32 round = 0; round < 5; ++round)
+        {
+            // hidden order perm, edges only go forward in it
+            std::vector<i32> perm(k_tasks), connect_order(k_tasks);
+            for (i32 i = 0; i < k_tasks; ++i)
+                perm[i] = connect_order[i] = i;
+            for (i32 i = k_tasks - 1; i > 0; --i)
+            {
+                std::swap(perm[i], perm[rand::irange(0, i)]);
+                std::swap(connect_order[i], connect_order[rand::irange(0, i)]);
+            }
+
+            std::vector<std::vector<i32>> after(k_tasks);
+            for (i32 i = 1; i < k_tasks; ++i)
+                for (i32 e = 0; e < 3; ++e)
+                    after[perm[i]].push_back(perm[rand::irange(0, i - 1)]);
+
+            DependentSink sink;
+            for (const i32 t : connect_order)
+            {
+                std::vector<std::string> names;
+                for (const i32 a : after[t])
+                    names.push_back(std::format("t{}", a));
+                sink.connect(names, {}, std::format("t{}", t), [] {});
+            }
+
+            const auto order = sink.sorted();
+            bool       ok    = order.size() == k_tasks;
+            for (i32 t = 0; ok && t < k_tasks; ++t)
+                for (const i32 a : after[t])
+                    ok = ok &&
+                        position(order, std::format("t{}", a)) <
+                            position(order, std::format("t{}", t));
+            tctx.assert_now(ok, "random dag {} ordered", round);
+        }
+    }
+
+    // timing, in both modes, and through the engine
+    {
+        DependentSink sink;
+        sink.connect(
+            {}, {}, "slow",
+            [] { std::this_thread::sleep_for(std::chrono::milliseconds(2)); });
+        sink.connect({ "slow" }, {}, "fast", [] {});
+        sink.set_timing(true);
+
+        for (i32 mode = 0; mode < 2; ++mode)
+        {
+            sink.set_executor(mode == 0 ? nullptr : &async->executor());
+            for (i32 i = 0; i < 5; ++i)
+                sink.execute();
+
+            const auto timings = sink.timings();
+            tctx.assert_now(
+                timings.size() == 2 && timings[0].name == "slow" &&
+                    timings[1].name == "fast",
+                "timings follow the task order");
+            tctx.assert_now(
+                timings[0].runs == 5 * (mode + 1), "every run recorded ({})",
+                timings[0].runs);
+            const TaskTiming& slow = timings[0];
+            tctx.assert_now(
+                slow.p50_ns >= 2'000'000 && slow.max_ns >= slow.p99_ns &&
+                    slow.p99_ns >= slow.p50_ns,
+                "slow task p50 {} ns p99 {} ns max {} ns", slow.p50_ns, slow.p99_ns,
+                slow.max_ns);
+            tctx.assert_now(
+                timings[1].p50_ns < 1'000'000, "fast task p50 {} ns", timings[1].p50_ns);
+        }
+
+        engine->on_tick.connect({}, {}, "sink_test", [] {});
+        for (i32 i = 0; i < 3; ++i)
+            engine->tick();
+        const auto ticks = engine->tick_timings();
+        tctx.assert_now(
+            ticks.size() >= 3 && ticks[ticks.size() - 2].name == "post_tick" &&
+                ticks.back().name == "tick" && ticks.back().runs == 3,
+            "engine reports its tasks, the post_tick drain and the tick");
+        const auto is_test_task = [](const TaskTiming& t)
+        { return t.name == "sink_test" && t.runs == 3; };
+        tctx.assert_now(
+            std::ranges::any_of(ticks, is_test_task), "on_tick tasks are timed by default");
+        engine->on_tick.disconnect("sink_test");
+    }
+
+    // parallel
+    {
+        DependentSink sink;
+        Trace         trace;
+        build(sink, trace, TaskAffinity::main_thread);
+        sink.set_executor(&async->executor());
+
+        for (i32 i = 0; i < 5; ++i)
+        {
+            trace.reset();
+            sink.execute();
+            tctx.assert_now(diamond_ordered(trace), "parallel run {} keeps the order", i);
+        }
+        tctx.assert_now(
+            trace.max_running > 1, "independent tasks overlap ({} at once)",
+            trace.max_running.load());
+        tctx.assert_now(
+            trace.thread[2] == std::this_thread::get_id(),
+            "main thread task ran on the executing thread");
+
+        // a task connecting another mid execute, it shows up next time
+        std::atomic<i32> late{ 0 };
+        sink.connect(
+            { "join" }, {}, "spawner",
+            [&]
+            {
+                sink.connect({}, {}, "late", [&] { ++late; });
+                sink.disconnect("spawner");
+            });
+        trace.reset();
+        sink.execute();
+        tctx.assert_now(late == 0, "task connected mid execute waits");
+        trace.reset();
+        sink.execute();
+        tctx.assert_now(late == 1, "and runs on the next execute");
+        tctx.assert_now(diamond_ordered(trace), "graph still ordered after the change");
+
+        // exceptions from workers and the main thread reach the caller
+        sink.connect({}, {}, "throws", [] { throw std::runtime_error("worker"); });
+        bool caught = false;
+        try
+        {
+            sink.execute();
+        }
+        catch (const std::runtime_error&)
+        {
+            caught = true;
+        }
+        tctx.assert_now(caught, "worker exception reaches execute()");
+        sink.disconnect("throws");
+
+        sink.connect(
+            {}, {}, "throws_main", [] { throw std::runtime_error("main"); },
+            TaskAffinity::main_thread);
+        caught = false;
+        try
+        {
+            sink.execute();
+        }
+        catch (const std::runtime_error&)
+        {
+            caught = true;
+        }
+        tctx.assert_now(caught, "main thread exception reaches execute()");
+        sink.disconnect("throws_main");
+
+        // and back to serial
+        sink.set_executor(nullptr);
+        trace.reset();
+        sink.execute();
+        tctx.assert_now(trace.max_running == 1, "serial again without an executor");
+    }
+
+    return tctx.is_failure();
+}
@@ -0,0 +1,145 @@
+// Spatial index: radius, box and nearest queries have to match a scan over every
+// Pos3d while entities are added, moved through patch() and removed
+
+#include <algorithm>
+#include <engine/components.h>
+#include <engine/spatial.h>
+#include <test.h>
+
+using namespace v;
+
+namespace {
+    constexpr i32 k_entities = 4000;
+    constexpr i32 k_queries  = 300;
+    constexpr f32 k_extent   = 400;
+
+    f32 frand(f32 lo, f32 hi) { return static_cast<f32>(rand::frange(lo, hi)); }
+
+    glm::vec3 random_pos()
+    {
+        return { frand(-k_extent, k_extent), frand(-64, 64), frand(-k_extent, k_extent) };
+    }
+
+    f32 dist2(const glm::vec3& a, const glm::vec3& b)
+    {
+        const glm::vec3 d = a - b;
+        return glm::dot(d, d);
+    }
+
+    std::vector<entt::entity> sorted(std::vector<entt::entity> v)
+    {
+        std::ranges::sort(v);
+        return v;
+    }
+} // namespace
+
+int main()
+{
+    auto [engine, tctx] = testing::init_test("spatial");
+    auto& registry      = engine->registry();
+    rand::seed(33);
+
+    // half the entities exist before the index does
+    std::vector<entt::entity> entities;
+    const auto                spawn = [&]
+    {
+        const auto e = registry.create();
+        registry.emplace<Pos3d>(e, random_pos());
+        entities.push_back(e);
+    };
+    for (i32 i = 0; i < k_entities / 2; ++i)
+        spawn();
+
+    auto& index = engine->add_domain<SpatialIndex>(SpatialConfig{ .cell_size = 24 });
+    for (i32 i = 0; i < k_entities / 2; ++i)
+        spawn();
+    tctx.assert_now(
+        index.hash().size() == k_entities, "index has every entity ({})",
+        index.hash().size());
+
+    // move a third through patch, mostly small steps with some teleports
+    for (usize i = 0; i < entities.size(); i += 3)
+    {
+        registry.patch<Pos3d>(
+            entities[i],
+            [&](Pos3d& p)
+            {
+                if (i % 2)
+                    p.val += glm::vec3{ frand(-30, 30), frand(-5, 5), frand(-30, 30) };
+                else
+                    p.val = random_pos();
+            });
+    }
+
+    // and drop some
+    usize removed = 0;
+    for (usize i = 1; i < entities.size(); i += 7, ++removed)
+        registry.remove<Pos3d>(entities[i]);
+    tctx.assert_now(
+        index.hash().size() == k_entities - removed, "removed entities leave the index");
+
+    // everything compared against a plain scan
+    usize radius_bad = 0, box_bad = 0, nearest_bad = 0, hits = 0;
+    std::vector<entt::entity> got, expect;
+    for (i32 q = 0; q < k_queries; ++q)
+    {
+        const glm::vec3 center = random_pos();
+        // the last queries are huge to hit the path that walks occupied cells
+        const f32 radius = q < k_queries - 10 ? frand(1, 80) : frand(500, 2000);
+
+        got.clear();
+        expect.clear();
+        index.query_radius(center, radius, got);
+        for (auto [e, pos] : registry.view<Pos3d>().each())
+            if (dist2(pos.val, center) <= radius * radius)
+                expect.push_back(e);
+        radius_bad += sorted(got) != sorted(expect);
+        hits += expect.size();
+
+        const glm::vec3 half{ frand(1, 60), frand(1, 30), frand(1, 60) };
+        const AABB      box{ center - half, center + half };
+        got.clear();
+        expect.clear();
+        index.query_box(box, got);
+        for (auto [e, pos] : registry.view<Pos3d>().each())
+        {
+            const glm::vec3 p = pos.val;
+            if (p.x >= box.min.x && p.y >= box.min.y && p.z >= box.min.z &&
+                p.x <= box.max.x && p.y <= box.max.y && p.z <= box.max.z)
+                expect.push_back(e);
+        }
+        box_bad += sorted(got) != sorted(expect);
+
+        // compare distances, ties may pick different entities
+        const usize k        = 1 + q % 24;
+        const f32   max_dist = q % 5 == 0 ? 40.f : std::numeric_limits<f32>::infinity();
+        index.nearest(center, k, got, max_dist);
+
+        std::vector<f32> want;
+        for (auto [e, pos] : registry.view<Pos3d>().each())
+        {
+            const f32 d2 = dist2(pos.val, center);
+            if (d2 <= max_dist * max_dist)
+                want.push_back(d2);
+        }
+        std::ranges::sort(want);
+        want.resize(std::min(want.size(), k));
+
+        std::vector<f32> have;
+        for (const auto e : got)
+            have.push_back(dist2(registry.get<Pos3d>(e).val, center));
+        nearest_bad += have != want;
+    }
+
+    tctx.assert_now(hits > 0, "queries found something ({} hits)", hits);
+    tctx.assert_now(radius_bad == 0, "radius queries match a scan ({} off)", radius_bad);
+    tctx.assert_now(box_bad == 0, "box queries match a scan ({} off)", box_bad);
+    tctx.assert_now(
+        nearest_bad == 0, "nearest queries match a scan ({} off)", nearest_bad);
+
+    // a far away point still finds the closest entities
+    index.nearest({ 1e5f, 0, 1e5f }, 3, got);
+    tctx.assert_now(got.size() == 3, "nearest from far away finds 3 ({})", got.size());
+
+    return tctx.is_failure();
+}
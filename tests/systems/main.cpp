@@ -0,0 +1,196 @@
+// SystemScheduler: conflicting systems land in later batches, independent ones share a
+// batch, a parallel run ends in exactly the state of a serial one, the engine runs
+// its systems every tick, and systems writing observed components are rejected
+
+#include <engine/contexts/async/async.h>
+#include <engine/engine.h>
+#include <engine/systems.h>
+#include <test.h>
+
+using namespace v;
+
+namespace {
+    struct A {
+        f64 val;
+    };
+    struct B {
+        f64 val;
+    };
+    struct C {
+        f64 val;
+    };
+    struct D {
+        f64 val;
+    };
+
+    struct UpdateListener {
+        i32 updates{ 0 };
+
+        void on_update(entt::registry&, entt::entity) { updates++; }
+    };
+
+    constexpr i32 k_entities = 20'000;
+
+    void populate(entt::registry& registry)
+    {
+        rand::seed(41);
+        for (i32 i = 0; i < k_entities; ++i)
+        {
+            const auto e = registry.create();
+            registry.emplace<A>(e, rand::frange(-1.0, 1.0));
+            if (i % 2 == 0)
+                registry.emplace<B>(e, rand::frange(-1.0, 1.0));
+            if (i % 3 == 0)
+                registry.emplace<C>(e, rand::frange(-1.0, 1.0));
+            registry.emplace<D>(e, 0.0);
+        }
+    }
+
+    // none of these commute, so running conflicting systems out of order shows up in
+    // the results
+    void add_systems(SystemScheduler& systems)
+    {
+        systems.add<System<Read<A>, Write<B>>>(
+            "b_from_a",
+            [](auto view)
+            {
+                for (auto [e, a, b] : view.each())
+                    b.val = b.val * 0.5 + a.val;
+            });
+        systems.add<System<Read<A>, Write<C>>>(
+            "c_from_a",
+            [](auto view)
+            {
+                for (auto [e, a, c] : view.each())
+                    c.val = c.val * 0.25 - a.val;
+            });
+        systems.add<System<Read<B>, Write<A>>>(
+            "a_from_b",
+            [](auto view)
+            {
+                for (auto [e, b, a] : view.each())
+                    a.val = a.val * 0.75 + b.val * 0.1;
+            });
+        systems.add<System<Read<C>, Write<D>>>(
+            "d_from_c",
+            [](auto view)
+            {
+                for (auto [e, c, d] : view.each())
+                    d.val = d.val * 0.9 + c.val;
+            });
+        systems.add<System<Read<A>, Read<B>, Write<D>>>(
+            "d_from_ab",
+            [](auto view)
+            {
+                for (auto [e, a, b, d] : view.each())
+                    d.val = d.val - a.val * b.val;
+            });
+    }
+
+    template <typename T>
+    std::vector<f64> values(entt::registry& registry)
+    {
+        std::vector<f64> out;
+        for (auto [e, t] : registry.view<const T>().each())
+            out.push_back(t.val);
+        return out;
+    }
+} // namespace
+
+int main()
+{
+    auto [engine, tctx] = testing::init_test("systems");
+    auto* async         = engine->add_ctx<AsyncContext>(4);
+
+    // batches
+    {
+        entt::registry  registry;
+        SystemScheduler systems{ registry };
+        add_systems(systems);
+
+        const auto batches = systems.batches();
+        const std::vector<std::vector<std::string>> expected{
+            { "b_from_a", "c_from_a" },
+            { "a_from_b", "d_from_c" },
+            { "d_from_ab" },
+        };
+        tctx.assert_now(batches == expected, "systems batched by their conflicts");
+
+        // replacing keeps the place
+        systems.add<System<Read<A>, Write<C>>>("c_from_a", [](auto) {});
+        tctx.assert_now(
+            systems.size() == 5 && systems.batches() == expected,
+            "replaced system keeps its place");
+        tctx.assert_now(systems.remove("a_from_b"), "system removed");
+        tctx.assert_now(!systems.remove("a_from_b"), "system only removed once");
+        const std::vector<std::vector<std::string>> without{
+            { "b_from_a", "c_from_a" },
+            { "d_from_c" },
+            { "d_from_ab" },
+        };
+        tctx.assert_now(systems.batches() == without, "batches follow a removal");
+    }
+
+    // determinism
+    {
+        entt::registry serial_registry, parallel_registry;
+        populate(serial_registry);
+        populate(parallel_registry);
+
+        SystemScheduler serial{ serial_registry };
+        SystemScheduler parallel{ parallel_registry };
+        add_systems(serial);
+        add_systems(parallel);
+        parallel.set_executor(&async->executor());
+
+        for (i32 i = 0; i < 50; ++i)
+        {
+            serial.execute();
+            parallel.execute();
+        }
+
+        tctx.assert_now(
+            values<A>(serial_registry) == values<A>(parallel_registry) &&
+                values<B>(serial_registry) == values<B>(parallel_registry) &&
+                values<C>(serial_registry) == values<C>(parallel_registry) &&
+                values<D>(serial_registry) == values<D>(parallel_registry),
+            "parallel runs match serial runs exactly");
+    }
+
+    // through the engine
+    {
+        const auto e = engine->registry().create();
+        engine->registry().emplace<A>(e, 1.0);
+
+        engine->systems.set_executor(&async->executor());
+        engine->systems.add<System<Write<A>>>(
+            "double_a",
+            [](auto view)
+            {
+                for (auto [entity, a] : view.each())
+                    a.val *= 2;
+            });
+        for (i32 i = 0; i < 3; ++i)
+            engine->tick();
+
+        tctx.assert_now(
+            engine->registry().get<A>(e).val == 8.0, "engine runs systems every tick");
+        engine->systems.remove("double_a");
+    }
+
+    // writing through a view skips on_update, so observed components are off limits
+    {
+        entt::registry  registry;
+        SystemScheduler systems{ registry };
+
+        UpdateListener listener;
+        registry.on_update<C>().connect<&UpdateListener::on_update>(listener);
+
+        systems.add<System<Read<C>, Write<D>>>("reads_c", [](auto) {});
+        systems.add<System<Read<A>, Write<C>>>("writes_c", [](auto) {});
+        tctx.assert_now(
+            systems.size() == 1, "system writing an observed component rejected");
+    }
+
+    return tctx.is_failure();
+}
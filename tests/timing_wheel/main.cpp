@@ -0,0 +1,179 @@
+// TimingWheel: timers fire on the first advance at or past their deadline and never
+// early, across every level and past the last one, cancelled timers don't fire, ids
+// go stale, timers scheduled while firing wait for a later advance, and coroutine
+// sleeps go through it
+
+#include <containers/timing_wheel.h>
+#include <engine/contexts/async/async.h>
+#include <test.h>
+#include <time/stopwatch.h>
+
+using namespace v;
+
+int main()
+{
+    auto [engine, tctx] = testing::init_test("timing_wheel");
+
+    constexpr u64 res = 1'000'000;
+
+    // deadlines spread over every level, checked against the time they fired at
+    {
+        TimingWheel<u64> wheel{ res };
+        rand::seed(7);
+        std::vector<u64> deadlines;
+        for (i32 i = 0; i < 20'000; ++i)
+        {
+            // 1ms up to ~4.6 hours, log spread so every level gets some
+            const u64 range = u64{ 1 } << rand::urange(0, 24);
+            deadlines.push_back(rand::urange(0, range) * res + rand::urange(0, res - 1));
+        }
+        for (u64 i = 0; i < deadlines.size(); ++i)
+            wheel.schedule(deadlines[i], i);
+
+        bool early = false, late = false;
+        u64  fired = 0, now = 0;
+        // uneven steps, some of them skipping many ticks at once
+        while (!wheel.empty() && now < (u64{ 1 } << 26) * res)
+        {
+            const u64 prev = now;
+            now += res * (rand::urange(0, 4) == 0 ? rand::urange(1, 5000) : 1);
+            wheel.advance(
+                now,
+                [&](u64 i)
+                {
+                    fired++;
+                    early = early || deadlines[i] > now;
+                    // should have fired on the step before
+                    late = late || (deadlines[i] + res - 1) / res <= prev / res;
+                });
+        }
+        tctx.assert_now(
+            fired == deadlines.size(), "{} of {} timers fired", fired, deadlines.size());
+        tctx.assert_now(!early, "no timer fired early");
+        tctx.assert_now(!late, "no timer fired late");
+    }
+
+    // one step at a time, timers fire within a tick of their deadline
+    {
+        TimingWheel<u64> wheel{ res };
+        for (u64 ms = 0; ms < 70'000; ms += 7)
+            wheel.schedule(ms * res + 1, ms);
+
+        bool exact = true;
+        for (u64 now = 0; !wheel.empty(); now += res)
+            wheel.advance(
+                now,
+                [&](u64 ms)
+                { exact = exact && now >= ms * res + 1 && now <= (ms + 1) * res; });
+        tctx.assert_now(exact, "timers fire on the tick after their deadline");
+    }
+
+    // past the last level
+    {
+        TimingWheel<i32> wheel{ res };
+        const u64        far = (u64{ 1 } << 33) * res;
+        wheel.schedule(far, 1);
+        bool fired_early = false, fired = false;
+        // advance in big jumps, but through every slot of the top level
+        for (u64 now = 0; now < far; now += (u64{ 1 } << 24) * res)
+            wheel.advance(now, [&](i32) { fired_early = true; });
+        wheel.advance(far, [&](i32) { fired = true; });
+        tctx.assert_now(!fired_early && fired, "timer past the last level fires on time");
+    }
+
+    // cancelling
+    {
+        TimingWheel<i32> wheel{ res };
+        std::vector<TimingWheel<i32>::Id> ids;
+        for (i32 i = 0; i < 1000; ++i)
+            ids.push_back(wheel.schedule(static_cast<u64>(i % 300) * res * 50, i));
+        for (i32 i = 0; i < 1000; i += 2)
+            wheel.cancel(ids[i]);
+        tctx.assert_now(wheel.size() == 500, "cancelled timers are removed");
+
+        bool odd_only = true;
+        i32  fired    = 0;
+        wheel.advance(
+            400 * 50 * res,
+            [&](i32 i)
+            {
+                odd_only = odd_only && i % 2 == 1;
+                fired++;
+            });
+        tctx.assert_now(odd_only && fired == 500, "cancelled timers don't fire");
+        tctx.assert_now(!wheel.cancel(ids[1]), "fired timers can't be cancelled");
+        tctx.assert_now(!wheel.cancel(ids[0]), "cancelled timers can't be cancelled");
+
+        // the slot gets reused, the old id mustn't cancel the new timer
+        const auto reused = wheel.schedule(500 * 50 * res, 7);
+        tctx.assert_now(!wheel.cancel(ids[998]), "stale id doesn't cancel a new timer");
+        tctx.assert_now(wheel.cancel(reused) && wheel.empty(), "new id cancels");
+    }
+
+    // rescheduling while firing
+    {
+        TimingWheel<i32> wheel{ res, 10 * res };
+        i32              wakes = 0;
+        wheel.schedule(11 * res, 0);
+        for (i32 i = 0; i < 3; ++i)
+        {
+            wheel.advance(
+                20 * res + static_cast<u64>(i),
+                [&](i32)
+                {
+                    wakes++;
+                    // already due
+                    wheel.schedule(0, 0);
+                });
+        }
+        tctx.assert_now(wakes == 1, "rescheduled timer waits for a later tick");
+        wheel.advance(21 * res, [&](i32) { wakes++; });
+        tctx.assert_now(wakes == 2, "and fires on the next one");
+    }
+
+    // coroutine sleeps
+    {
+        auto* async = engine->add_ctx<AsyncContext>(1);
+        engine->on_tick.connect({}, {}, "async", [async] { async->update(); });
+
+        u64 ticks = 0;
+        engine->on_tick.connect({}, {}, "count", [&] { ticks++; });
+
+        i32  done           = 0;
+        bool twice_per_tick = false;
+        for (i32 i = 0; i < 100; ++i)
+        {
+            async->spawn(
+                [&, i](CoroutineInterface& ci) -> Coroutine<void>
+                {
+                    const u64 start = time::ns();
+                    co_await ci.sleep(1 + i % 20);
+                    const bool on_time = time::ns() - start >= (1 + i % 20) * 1'000'000;
+
+                    // back to back 1ms sleeps never wake twice in one tick
+                    u64 last = ticks;
+                    for (i32 j = 0; j < 5; ++j)
+                    {
+                        co_await ci.sleep(1);
+                        twice_per_tick = twice_per_tick || ticks == last;
+                        last           = ticks;
+                    }
+                    if (on_time)
+                        done++;
+                });
+        }
+
+        Stopwatch sw{};
+        while (done < 100 && sw.elapsed() < 10)
+        {
+            engine->tick();
+            time::sleep_ms(1);
+        }
+        tctx.assert_now(done == 100, "{} of 100 coroutines slept long enough", done);
+        tctx.assert_now(!twice_per_tick, "no coroutine woke twice in a tick");
+        tctx.assert_now(
+            async->scheduler().sleeping() == 0, "nothing left asleep in the scheduler");
+    }
+
+    return tctx.is_failure();
+}
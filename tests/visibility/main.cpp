@@ -0,0 +1,139 @@
+// Chunk visibility: the 8 wide frustum test must agree with the per box test, face
+// connectivity must follow walls and tunnels, and chunks behind a solid wall must be
+// culled until a hole is dug through it
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <test.h>
+#include <world/visibility.h>
+
+using namespace v;
+
+namespace {
+    constexpr u16 k_stone = 1;
+
+    f32 frand(f32 lo, f32 hi) { return static_cast<f32>(rand::frange(lo, hi)); }
+
+    glm::mat4 look(const glm::vec3& eye, const glm::vec3& target)
+    {
+        return glm::perspective(glm::radians(70.f), 16.f / 9.f, 0.1f, 2000.f) *
+            glm::lookAt(eye, target, glm::vec3{ 0, 1, 0 });
+    }
+
+    // a wall across the x axis of a chunk, thick enough to fill whole cells
+    void build_wall(WorldDomain& world, const ChunkPos& cp)
+    {
+        auto& chunk = world.get_or_create_chunk(cp);
+        for (i32 z = 0; z < ChunkDomain::k_size; ++z)
+            for (i32 y = 0; y < ChunkDomain::k_size; ++y)
+                for (i32 x = 60; x < 68; ++x)
+                    chunk.set({ x, y, z }, k_stone);
+    }
+
+    bool contains(const std::vector<const ChunkDomain*>& chunks, const ChunkPos& cp)
+    {
+        return std::ranges::any_of(
+            chunks, [&](const ChunkDomain* c) { return ChunkPosEq{}(c->pos(), cp); });
+    }
+} // namespace
+
+int main()
+{
+    auto [engine, tctx] = testing::init_test("visibility");
+
+    // frustum: the batched test against the one box at a time version
+    rand::seed(32);
+    const glm::vec3 eye{ 10, 20, 30 };
+    const Frustum   frustum =
+        Frustum::from_matrix(look(eye, { 200, -10, 90 }), glm::dvec3{ 0, 0, 0 });
+
+    constexpr i32    k_boxes = 1003;
+    constexpr f32    half    = 16;
+    std::vector<f32> cx(k_boxes), cy(k_boxes), cz(k_boxes);
+    for (i32 i = 0; i < k_boxes; ++i)
+    {
+        cx[i] = frand(-600, 600);
+        cy[i] = frand(-600, 600);
+        cz[i] = frand(-600, 600);
+    }
+    std::vector<u8> visible(k_boxes);
+    frustum.cull(cx, cy, cz, half, visible.data());
+
+    usize disagree = 0, inside = 0;
+    for (i32 i = 0; i < k_boxes; ++i)
+    {
+        const glm::vec3 c{ cx[i], cy[i], cz[i] };
+        const glm::vec3 e{ half };
+        const bool      expect = frustum.intersects({ c - e, c + e });
+        disagree += expect != static_cast<bool>(visible[i]);
+        inside += expect;
+    }
+    tctx.assert_now(disagree == 0, "batched frustum test agrees ({} off)", disagree);
+    tctx.assert_now(
+        inside > 0 && inside < k_boxes, "some boxes in, some out ({})", inside);
+
+    // connectivity
+    auto& world = engine->add_domain<WorldDomain>();
+    world.set_cache_config({ .memory_budget = 0 });
+
+    auto& solid = world.get_or_create_chunk({ 10, 10, 10 });
+    solid.svo().fill(k_stone);
+    tctx.assert_now(ChunkConnectivity::compute(solid) == 0, "solid chunk is closed");
+
+    // a 4x4 tunnel along x through the solid chunk
+    for (i32 x = 0; x < ChunkDomain::k_size; ++x)
+        for (i32 y = 60; y < 64; ++y)
+            for (i32 z = 60; z < 64; ++z)
+                solid.set({ x, y, z }, 0);
+    const u16 tunnel = ChunkConnectivity::compute(solid);
+    tctx.assert_now(
+        tunnel == 1u << ChunkConnectivity::pair(0, 1),
+        "tunnel joins -x and +x only ({:x})", tunnel);
+
+    // occlusion: camera in chunk 0 looking down +x, a wall in chunk 1, something to
+    // see in chunk 2 and behind the camera in chunk -2
+    build_wall(world, { 1, 0, 0 });
+    world.set_voxel({ 2 * 128 + 64, 64, 64 }, k_stone);
+    world.set_voxel({ -2 * 128 + 64, 64, 64 }, k_stone);
+
+    const u16 wall = ChunkConnectivity::compute(*world.find_chunk({ 1, 0, 0 }));
+    tctx.assert_now(
+        !ChunkConnectivity::connected(wall, 0, 1) &&
+            ChunkConnectivity::connected(wall, 0, 2),
+        "wall splits -x from +x ({:x})", wall);
+
+    ChunkCuller     culler{ { .view_distance = 4, .vertical_distance = 2 } };
+    const glm::vec3 cam{ 64, 64, 64 };
+    const glm::mat4 vp = look(cam, cam + glm::vec3{ 1, 0, 0 });
+
+    auto seen = culler.cull(world, vp, cam);
+    tctx.assert_now(contains(seen, { 1, 0, 0 }), "wall is visible");
+    tctx.assert_now(!contains(seen, { 2, 0, 0 }), "chunk behind the wall is culled");
+    tctx.assert_now(!contains(seen, { -2, 0, 0 }), "chunk behind the camera is culled");
+    tctx.assert_now(
+        culler.stats().occlusion_culled == 1 && culler.stats().frustum_culled >= 1,
+        "stats count the culled chunks ({} occluded, {} outside)",
+        culler.stats().occlusion_culled, culler.stats().frustum_culled);
+
+    ChunkCuller frustum_only{
+        { .view_distance = 4, .vertical_distance = 2, .occlusion = false },
+    };
+    tctx.assert_now(
+        contains(frustum_only.cull(world, vp, cam), { 2, 0, 0 }),
+        "frustum only culling keeps it");
+
+    // dig through, the edit bumps the chunk version so connectivity is rebuilt
+    auto& wall_chunk = world.get_or_create_chunk({ 1, 0, 0 });
+    for (i32 x = 60; x < 68; ++x)
+        for (i32 y = 60; y < 64; ++y)
+            for (i32 z = 60; z < 64; ++z)
+                wall_chunk.set({ x, y, z }, 0);
+
+    seen = culler.cull(world, vp, cam);
+    tctx.assert_now(contains(seen, { 2, 0, 0 }), "visible through the hole");
+    tctx.assert_now(
+        culler.stats().connectivity_rebuilds == 2,
+        "rebuilt the wall and built the newly reached chunk ({})",
+        culler.stats().connectivity_rebuilds);
+
+    return tctx.is_failure();
+}
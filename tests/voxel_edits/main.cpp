@@ -0,0 +1,251 @@
+// Voxel edit batching: codec round trips, then client edits over loopback that the
+// server applies and streams back as deltas, and batches the server must drop
+
+#include <engine/contexts/net/connection.h>
+#include <engine/contexts/net/ctx.h>
+#include <engine/contexts/net/listener.h>
+#include <map>
+#include <test.h>
+#include <time/time.h>
+#include <world/edit_codec.h>
+#include <world/streaming.h>
+
+using namespace v;
+
+namespace {
+    std::vector<std::byte> encode(std::vector<ChunkEdit> edits)
+    {
+        VoxelEditCodec::normalize(edits);
+        std::vector<std::byte> out;
+        ByteWriter             w{ out };
+        VoxelEditCodec::encode(w, edits);
+        return out;
+    }
+
+    std::vector<ChunkEdit> decode(const std::vector<std::byte>& bytes)
+    {
+        ByteReader             r{ reinterpret_cast<const u8*>(bytes.data()), bytes.size() };
+        std::vector<ChunkEdit> edits;
+        VoxelEditCodec::decode(r, edits);
+        return edits;
+    }
+
+    void codec_checks(testing::TestContext& tctx)
+    {
+        // last write wins, output is sorted
+        std::vector<ChunkEdit> edits{
+            { ChunkEdit::pack({ 3, 0, 0 }), 1 }, { ChunkEdit::pack({ 1, 0, 0 }), 2 },
+            { ChunkEdit::pack({ 3, 0, 0 }), 5 }, { ChunkEdit::pack({ 2, 0, 0 }), 2 },
+        };
+        auto out = decode(encode(edits));
+        tctx.assert_now(out.size() == 3, "duplicates collapsed ({})", out.size());
+        tctx.assert_now(
+            out.size() == 3 && out[0].value == 2 && out[1].value == 2 && out[2].value == 5,
+            "last write wins");
+
+        // a filled row is a single run
+        std::vector<ChunkEdit> row;
+        for (i32 x = 0; x < 128; ++x)
+            row.push_back({ ChunkEdit::pack({ x, 10, 20 }), 7 });
+        auto row_bytes = encode(row);
+        tctx.assert_now(row_bytes.size() <= 8, "row encodes as one run ({} bytes)",
+                        row_bytes.size());
+        tctx.assert_now(decode(row_bytes).size() == 128, "row decodes to 128 edits");
+
+        // random edits round trip
+        rand::seed(28);
+        std::map<u32, u16>     expected;
+        std::vector<ChunkEdit> random;
+        for (i32 i = 0; i < 5000; ++i)
+        {
+            const ChunkEdit e{ static_cast<u32>(rand::urange(0, (1u << 21) - 1)),
+                               static_cast<u16>(rand::urange(0, 6)) };
+            random.push_back(e);
+            expected[e.index] = e.value;
+        }
+        auto decoded = decode(encode(random));
+        bool same    = decoded.size() == expected.size();
+        usize i      = 0;
+        for (const auto& [index, value] : expected)
+        {
+            same = same && decoded[i].index == index && decoded[i].value == value;
+            i++;
+        }
+        tctx.assert_now(same, "random edits round trip");
+
+        // truncated input throws instead of reading garbage
+        auto bytes = encode(random);
+        bytes.resize(bytes.size() / 2);
+        bool threw = false;
+        try
+        {
+            decode(bytes);
+        }
+        catch (const std::exception&)
+        {
+            threw = true;
+        }
+        tctx.assert_now(threw, "truncated batch rejected");
+
+        // runs whose start or end wrap around u64, and a run past the edit cap, are
+        // rejected before they're expanded
+        const auto rejects = [](const std::vector<u64>& varints, u64 max_edits)
+        {
+            std::vector<std::byte> raw;
+            ByteWriter             w{ raw };
+            for (const u64 v : varints)
+                w.write_varint(v);
+            ByteReader r{ reinterpret_cast<const u8*>(raw.data()), raw.size() };
+            std::vector<ChunkEdit> edits;
+            try
+            {
+                VoxelEditCodec::decode(r, edits, max_edits);
+            }
+            catch (const std::exception&)
+            {
+                return edits.size() <= 1;
+            }
+            return false;
+        };
+        tctx.assert_now(
+            rejects({ 1, 1ull << 63, ~0ull, 1 }, VoxelEditCodec::k_index_limit),
+            "wrapping run start rejected");
+        tctx.assert_now(
+            rejects({ 1, 0, ~0ull, 1 }, VoxelEditCodec::k_index_limit),
+            "wrapping run length rejected");
+        tctx.assert_now(
+            rejects({ 2, 0, 1, 1, 1ull << 40, 1 }, VoxelEditCodec::k_index_limit),
+            "wrapping gap after a run rejected");
+        tctx.assert_now(rejects({ 1, 0, 127 << 1 | 1, 1 }, 100), "edit cap enforced");
+    }
+} // namespace
+
+int main()
+{
+    auto [server, tctx] = testing::init_test("voxel_edits");
+
+    codec_checks(tctx);
+
+    auto client = std::make_unique<Engine>();
+
+    const std::string host = "127.0.0.1";
+    const u16         port = 28557;
+
+    auto* server_net   = server->add_ctx<NetworkContext>(1.0 / 1000.0);
+    auto& server_world = server->add_domain<WorldDomain>();
+    auto& streamer     = server->add_domain<ChunkStreamer>(
+        ChunkStreamConfig{ .max_edits_per_batch = 4096 });
+    server_world.get_or_create_chunk({ 0, 0, 0 });
+    server_world.get_or_create_chunk({ 1, 0, 0 });
+
+    auto listener = server_net->listen_on(host, port);
+    listener->connected().connect([&](std::shared_ptr<NetConnection> con)
+                                  { streamer.add_connection(con); });
+    listener->disconnected().connect([&](std::shared_ptr<NetConnection> con)
+                                     { streamer.remove_connection(con); });
+
+    auto* client_net   = client->add_ctx<NetworkContext>(1.0 / 1000.0);
+    auto& client_world = client->add_domain<WorldDomain>();
+    auto& receiver     = client->add_domain<ChunkReceiver>();
+
+    auto con = client_net->create_connection(host, port);
+    receiver.attach(con);
+    receiver.set_interest({ 0, 0, 0 }, 2);
+
+    const auto step = [&]
+    {
+        server_net->update();
+        server->tick();
+        client_net->update();
+        client->tick();
+        v::time::sleep_ms(1);
+    };
+
+    for (u64 i = 0; i < 2000 && client_world.chunk_count() < 2; ++i)
+        step();
+    tctx.assert_now(client_world.chunk_count() == 2, "client has both chunks");
+
+    // a clustered box in one chunk and scattered edits across both, in one tick
+    std::map<std::tuple<i32, i32, i32>, u16> expected;
+    for (i32 x = 10; x < 26; ++x)
+        for (i32 y = 60; y < 68; ++y)
+            for (i32 z = 10; z < 26; ++z)
+            {
+                receiver.queue_edit({ x, y, z }, 4);
+                expected[{ x, y, z }] = 4;
+            }
+    for (i32 i = 0; i < 300; ++i)
+    {
+        const WorldPos wp{ static_cast<i32>(rand::urange(0, 255)),
+                           static_cast<i32>(rand::urange(0, 127)),
+                           static_cast<i32>(rand::urange(0, 127)) };
+        const u16      v = static_cast<u16>(rand::urange(1, 3));
+        receiver.queue_edit(wp, v);
+        expected[{ wp.x, wp.y, wp.z }] = v;
+    }
+
+    const auto matches = [&](const WorldDomain& world)
+    {
+        for (const auto& [p, v] : expected)
+        {
+            auto [x, y, z] = p;
+            if (world.get_voxel({ x, y, z }) != v)
+                return false;
+        }
+        return true;
+    };
+
+    bool server_ok = false;
+    bool client_ok = false;
+    for (u64 i = 0; i < 2000 && !(server_ok && client_ok); ++i)
+    {
+        step();
+        server_ok = matches(server_world);
+        client_ok = matches(client_world);
+    }
+
+    const auto& rstats = receiver.stats();
+    tctx.assert_now(server_ok, "server applied every edit");
+    tctx.assert_now(client_ok, "edits streamed back to the client");
+    tctx.assert_now(
+        streamer.stats().edits_received == rstats.edits_sent,
+        "server received {} of {} edits", streamer.stats().edits_received,
+        rstats.edits_sent);
+    tctx.assert_now(streamer.stats().full_sent == 2, "changes went out as deltas");
+
+    // batches for a chunk the server doesn't have, one out of view, and one over
+    // the size cap are dropped without creating anything
+    server_world.get_or_create_chunk({ 5, 0, 0 });
+    const usize chunks_before = server_world.chunk_count();
+    const u64   dropped       = streamer.stats().edits_dropped;
+    receiver.queue_edit({ 0, 0, -1 }, 6);
+    receiver.queue_edit({ 5 * 128, 0, 0 }, 6);
+    for (i32 x = 0; x < 128; ++x)
+        for (i32 y = 0; y < 40; ++y)
+            receiver.queue_edit({ x, y, 0 }, 6);
+
+    const u64 expected_dropped = dropped + 2 + 128 * 40;
+    for (u64 i = 0; i < 2000 && streamer.stats().edits_dropped < expected_dropped; ++i)
+        step();
+
+    tctx.assert_now(
+        streamer.stats().edits_dropped == expected_dropped, "dropped {} of {} edits",
+        streamer.stats().edits_dropped - dropped, expected_dropped - dropped);
+    tctx.assert_now(
+        server_world.chunk_count() == chunks_before, "dropped edits created no chunks");
+    tctx.assert_now(
+        server_world.get_voxel({ 5 * 128, 0, 0 }) == 0 &&
+            server_world.get_voxel({ 0, 0, 0 }) != 6,
+        "dropped edits weren't applied");
+
+    LOG_INFO(
+        "[voxel_edits] {} edits in {} bytes ({:.3f} bytes/edit)", rstats.edits_sent,
+        rstats.edit_bytes_sent,
+        static_cast<f64>(rstats.edit_bytes_sent) / std::max<u64>(rstats.edits_sent, 1));
+
+    con->request_close();
+    for (u64 i = 0; i < 50; ++i)
+        step();
+
+    return tctx.is_failure();
+}
@@ -180,7 +180,7 @@ def _classify_target(target: str) -> str:
         return "exe"
     elif target in ["vlib"] or target.endswith("lib"):
         return "lib"
-    elif target.startswith("vexp"):
+    elif target.startswith("vexp") or target.startswith("vbench-"):
         return "exe"
     else:
         # Try to infer from name
@@ -379,6 +379,9 @@ def run(
     elif target.startswith("vexp"):
         # Experiment targets are in experiments/ subdirectory
         exe = _build_dir(release, no_sanitize) / "experiments" / _exe_name(target)
+    elif target.startswith("vbench-"):
+        # Benchmark targets are in benchmarks/ subdirectory
+        exe = _build_dir(release, no_sanitize) / "benchmarks" / _exe_name(target)
     else:
         exe = _build_dir(release, no_sanitize) / _exe_name(target)
 
@@ -581,6 +584,8 @@ def profile(
         exe = _build_dir(release, no_sanitize) / "tests" / _exe_name(target)
     elif target.startswith("vexp"):
         exe = _build_dir(release, no_sanitize) / "experiments" / _exe_name(target)
+    elif target.startswith("vbench-"):
+        exe = _build_dir(release, no_sanitize) / "benchmarks" / _exe_name(target)
     else:
         exe = _build_dir(release, no_sanitize) / _exe_name(target)
 